@@ -30,6 +30,7 @@ endif(NOT STDC_HEADERS)
 
 
 check_include_files(unistd.h HAVE_UNISTD_H)
+check_include_files(sys/mman.h HAVE_SYS_MMAN_H)
 
 include(CheckDIRSymbolExists)
 check_dirsymbol_exists("sys/stat.h;sys/types.h;dirent.h" HAVE_DIRENT_H)
@@ -32,12 +32,15 @@
 #include "object.h"
 #include "complex.h"
 #include "circuit.h"
+#include "component_id.h"
 #include "sweep.h"
 #include "net.h"
+#include "arena.h"
 #include "netdefs.h"
 #include "analysis.h"
 #include "nasolver.h"
 #include "acsolver.h"
+#include "ratinterp.h"
 
 namespace qucs {
 
@@ -47,7 +50,7 @@ acsolver::acsolver () : nasolver<nr_complex_t> () {
   type = ANALYSIS_AC;
   setDescription ("AC");
   xn = NULL;
-  noise = 0;
+  noise = noiseProbes = 0;
 }
 
 // Constructor creates a named instance of the acsolver class.
@@ -56,7 +59,7 @@ acsolver::acsolver (char * n) : nasolver<nr_complex_t> (n) {
   type = ANALYSIS_AC;
   setDescription ("AC");
   xn = NULL;
-  noise = 0;
+  noise = noiseProbes = 0;
 }
 
 // Destructor deletes the acsolver class object.
@@ -71,6 +74,8 @@ acsolver::acsolver (acsolver & o) : nasolver<nr_complex_t> (o) {
   swp = o.swp ? new sweep (*(o.swp)) : NULL;
   xn = o.xn ? new tvector<nr_double_t> (*(o.xn)) : NULL;
   noise = o.noise;
+  noiseProbes = o.noiseProbes;
+  noiseOut = o.noiseOut;
 }
 
 /* This is the AC netlist solver.  It prepares the circuit list for
@@ -91,6 +96,22 @@ int acsolver::solve (void) {
   init ();
   setCalculation ((calculate_func_t) &calc);
   solve_pre ();
+  if (noise) selectNoiseOutputs ();
+
+  // adaptive sweeps need a monotonic frequency grid
+  int adaptive = !strcmp (getPropertyString ("Adaptive"), "yes") ? 1 : 0;
+  if (adaptive && swp->getType () != SWEEP_LINEAR &&
+      swp->getType () != SWEEP_LOGARITHMIC) {
+    logprint (LOG_ERROR, "WARNING: %s: adaptive sweep requires a lin or log "
+	      "sweep, solving all points\n", getName ());
+    adaptive = 0;
+  }
+  if (adaptive) {
+    solve_adaptive ();
+    solve_post ();
+    if (progress) logprogressclear (40);
+    return 0;
+  }
 
   swp->reset ();
   for (int i = 0; i < swp->getSize (); i++) {
@@ -117,6 +138,52 @@ int acsolver::solve (void) {
   return 0;
 }
 
+/* The adaptive AC sweep solves the netlist only at the frequencies
+   requested by the rational interpolation model and fills all the
+   remaining points of the frequency sweep from that model.  The
+   estimated relative error is saved alongside the results. */
+void acsolver::solve_adaptive (void) {
+  int N = countNodes ();
+  int M = countVoltageSources ();
+  int idx, size = swp->getSize ();
+  int channels = noise ? 2 * (N + M) : N + M;
+  tvector<nr_complex_t> y (channels);
+  ratinterp model (swp);
+  model.setTolerance (getPropertyDouble ("AdaptTol"));
+
+  // solve at the frequencies chosen by the model
+  while ((idx = model.next ()) >= 0) {
+    freq = swp->get (idx);
+    if (progress) logprogressbar (model.countSamples (), size, 40);
+    eqnAlgo = ALGO_LU_DECOMPOSITION;
+    solve_linear ();
+    if (noise) solve_noise ();
+    for (int r = 0; r < N + M; r++) {
+      y.set (r, x->get (r));
+      if (noise) y.set (r + N + M, xn->get (r));
+    }
+    model.add (idx, y);
+  }
+
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: adaptive sweep solved %d of %d "
+	    "frequencies\n", getName (), model.countSamples (), size);
+#endif
+
+  // fill the output grid from the model
+  for (int i = 0; i < size; i++) {
+    freq = swp->get (i);
+    nr_double_t err = model.evaluate (i, y);
+    for (int r = 0; r < N + M; r++) {
+      x->set (r, y.get (r));
+      if (noise) xn->set (r, real (y.get (r + N + M)));
+    }
+    saveSolution ();
+    saveAllResults (freq);
+    saveVariable ("AdaptErr", err, data->findDependency ("acfrequency"));
+  }
+}
+
 /* Goes through the list of circuit objects and runs its calcAC()
    function. */
 void acsolver::calc (acsolver * self) {
@@ -130,6 +197,7 @@ void acsolver::calc (acsolver * self) {
 /* Goes through the list of circuit objects and runs its initAC()
    function. */
 void acsolver::init (void) {
+  subnet->getArena()->restart ();
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
     if (c->isNonLinear ()) c->calcOperatingPoints ();
@@ -178,11 +246,63 @@ void acsolver::saveNoiseResults (qucs::vector * f) {
     vn = nn > 0 ? xn->get (nn - 1) : 0.0;
     c->setOperatingPoint ("Vr", fabs ((vp - vn) * sqrt (kB * T0)));
     c->setOperatingPoint ("Vi", 0.0);
+    if (noiseProbes) {
+      saveVariable (std::string (c->getName ()) + ".vn",
+		    nr_complex_t (c->getOperatingPoint ("Vr"), 0.0), f);
+    }
+  }
+
+  // only the probes have been computed
+  if (noiseProbes) {
+    for (int r = 0; r < M; r++) {
+      circuit * vs = findVoltageSource (r);
+      if (vs->getType () == CIR_IPROBE)
+	saveVariable (std::string (vs->getName ()) + ".in", x->get (r + N), f);
+    }
+    return;
   }
 
   saveResults ("vn", "in", 0, f);
 }
 
+/* The function collects the MNA rows the noise is computed for: the
+   terminals of voltage probes, the current probes and, unless the
+   'NoiseOut' property restricts it to the probes, each node voltage
+   and source current saved into the dataset. */
+void acsolver::selectNoiseOutputs (void) {
+  int N = countNodes ();
+  int M = countVoltageSources ();
+  std::vector<bool> out (N + M, false);
+  noiseProbes = !strcmp (getPropertyString ("NoiseOut"), "probes") ? 1 : 0;
+
+  circuit * root = subnet->getRoot ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (!c->isProbe ()) continue;
+    int np = getNodeNr (c->getNode (NODE_1)->getName ());
+    int nn = getNodeNr (c->getNode (NODE_2)->getName ());
+    if (np > 0) out[np - 1] = true;
+    if (nn > 0) out[nn - 1] = true;
+  }
+  for (int r = 0; r < M; r++) {
+    circuit * vs = findVoltageSource (r);
+    if (vs->getType () == CIR_IPROBE) out[r + N] = true;
+    else if (!noiseProbes && vs->isVSource () &&
+	     !vs->isInternalVoltageSource () && vs->getSubcircuit ().empty ())
+      out[r + N] = true;
+  }
+  if (!noiseProbes) {
+    for (int r = 0; r < N; r++) {
+      if (nlist->isInternal (r)) continue;
+      if (nlist->get (r).find ('.') != std::string::npos) continue;
+      out[r] = true;
+    }
+  }
+
+  noiseOut.clear ();
+  for (int r = 0; r < N + M; r++)
+    if (out[r]) noiseOut.push_back (r);
+}
+
 /* This function runs the AC noise analysis.  It saves its results in
    the 'xn' vector. */
 void acsolver::solve_noise (void) {
@@ -211,14 +331,15 @@ void acsolver::solve_noise (void) {
   convHelper = CONV_None;
   eqnAlgo = ALGO_LU_SUBSTITUTION_CROUT;
 
-  // compute noise voltage for each node (and voltage source)
-  for (int i = 0; i < N + M; i++) {
+  // compute noise voltage for each requested node (and voltage source)
+  xn->set (0.0);
+  for (int i : noiseOut) {
     z->set (0); z->set (i, -1); // modify right hand side appropriately
     runMNA ();                  // solve
     zn = *x;                    // save transimpedance vector
 
     // compute actual noise voltage
-    xn->set (i, sqrt (real (scalar (zn * (*C), conj (zn)))));
+    xn->set (i, sqrt (calcNoise (zn)));
   }
 
   // restore usual AC results
@@ -231,10 +352,14 @@ PROP_REQ [] = {
   PROP_NO_PROP };
 PROP_OPT [] = {
   { "Noise", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "NoiseOut", PROP_STR, { PROP_NO_VAL, "all" },
+    PROP_RNG_STR2 ("all", "probes") },
   { "Start", PROP_REAL, { 1e9, PROP_NO_STR }, PROP_POS_RANGE },
   { "Stop", PROP_REAL, { 10e9, PROP_NO_STR }, PROP_POS_RANGE },
   { "Points", PROP_INT, { 10, PROP_NO_STR }, PROP_MIN_VAL (2) },
   { "Values", PROP_LIST, { 10, PROP_NO_STR }, PROP_POS_RANGE },
+  { "Adaptive", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "AdaptTol", PROP_REAL, { 1e-4, PROP_NO_STR }, PROP_RNG_X01I },
   PROP_NO_PROP };
 struct define_t acsolver::anadef =
   { "AC", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
@@ -25,6 +25,8 @@
 #ifndef __ACSOLVER_H__
 #define __ACSOLVER_H__
 
+#include <vector>
+
 #include "nasolver.h"
 
 namespace qucs {
@@ -41,15 +43,19 @@ class acsolver : public nasolver<nr_complex_t>
   ~acsolver ();
   int  solve (void);
   void solve_noise (void);
+  void solve_adaptive (void);
   static void calc (acsolver *);
   void init (void);
   void saveAllResults (nr_double_t);
   void saveNoiseResults (qucs::vector *);
+  void selectNoiseOutputs (void);
 
  private:
   sweep * swp;
   nr_double_t freq;
   int noise;
+  int noiseProbes;
+  std::vector<int> noiseOut;
   tvector<nr_double_t> * xn;
 };
 
@@ -58,6 +58,7 @@ analysis::analysis () : object () {
   type = ANALYSIS_UNKNOWN;
   runs = 0;
   progress = true;
+  sweeping = false;
 }
 
 // Constructor creates a named instance of the analysis class.
@@ -69,6 +70,7 @@ analysis::analysis (const std::string &n) : object (n) {
   type = ANALYSIS_UNKNOWN;
   runs = 0;
   progress = true;
+  sweeping = false;
 }
 
 // Destructor deletes the analysis class object.
@@ -86,6 +88,7 @@ analysis::analysis (analysis & a) : object (a) {
   type = a.type;
   runs = a.runs;
   progress = a.progress;
+  sweeping = a.sweeping;
 }
 
 /* This function adds the given analysis to the actions being
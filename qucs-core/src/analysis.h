@@ -267,6 +267,28 @@ public:
         progress = p;
     }
 
+    /*! \fn getSweeping
+     * \brief get
+     * \param sweeping
+     *
+     */
+    bool getSweeping (void)
+    {
+        return sweeping;
+    }
+
+    /*! \fn setSweeping
+     * \brief Sets the sweeping flag
+     * \param s new value of the sweeping flag
+     *
+     * Marks the analysis as being solved repeatedly by a parameter
+     * sweep with only a few component values changing in between.
+     */
+    void setSweeping (bool s)
+    {
+        sweeping = s;
+    }
+
 protected:
     int runs;
     int type;
@@ -275,6 +297,7 @@ protected:
     environment * env;
     ptrlist<analysis> * actions;
     bool progress;
+    bool sweeping;
 };
 
 } // namespace qucs
@@ -0,0 +1,106 @@
+/*
+ * arena.cpp - matrix storage arena class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "complex.h"
+#include "arena.h"
+
+// size of the first block in matrix entries
+#define ARENA_MINSIZE 1024
+
+namespace qucs {
+
+// Constructor creates an empty arena.
+arena::arena () {
+  current = NULL;
+  wanted = 0;
+}
+
+// Destructor gives up the arena's reference to the current block.
+arena::~arena () {
+  release (current);
+}
+
+// Creates a new block held by the arena only.
+arenablock * arena::create (int size) {
+  arenablock * b = new arenablock;
+  b->data = new nr_complex_t[size];
+  b->size = size;
+  b->used = 0;
+  b->refs = 1;
+  return b;
+}
+
+/* Drops a reference to the given block and frees it as soon as it is
+   not referenced anymore. */
+void arena::release (arenablock * b) {
+  if (b != NULL && --b->refs <= 0) {
+    delete[] b->data;
+    delete b;
+  }
+}
+
+/* This function is called before the circuits get (re-)initialised.
+   The slices handed out so far stay valid for circuits which are not
+   initialised again.  If no circuit uses the current block anymore it
+   is reused, otherwise a new block large enough for all slices of the
+   last run is started. */
+void arena::restart (void) {
+  if (current != NULL && current->refs == 1 && current->size >= wanted) {
+    current->used = 0;
+  }
+  else {
+    release (current);
+    current = create (wanted > ARENA_MINSIZE ? wanted : ARENA_MINSIZE);
+  }
+  wanted = 0;
+}
+
+/* Returns a slice of the given number of zeroed matrix entries and
+   passes the block containing it.  The caller releases the block by
+   calling release() once the slice is not needed anymore. */
+nr_complex_t * arena::alloc (int n, arenablock *& b) {
+  if (current == NULL || current->used + n > current->size) {
+    int size = current ? 2 * current->size : ARENA_MINSIZE;
+    release (current);
+    current = create (n > size ? n : size);
+  }
+  nr_complex_t * data = current->data + current->used;
+  std::fill_n (data, n, nr_complex_t (0));
+  current->used += n;
+  current->refs++;
+  wanted += n;
+  b = current;
+  return data;
+}
+
+} // namespace qucs
@@ -0,0 +1,62 @@
+/*
+ * arena.h - matrix storage arena class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+namespace qucs {
+
+/* A block of matrix entries handed out by the arena.  It is freed
+   once the arena and each circuit owning a slice of it let go. */
+struct arenablock {
+  nr_complex_t * data;
+  int size;
+  int used;
+  int refs;
+};
+
+/* The arena lays out the MNA matrices of all circuits of a netlist
+   one after the other in a single block.  As the circuits are
+   initialised in list order before each analysis, the stamps of
+   neighbouring devices end up next to each other in memory. */
+class arena
+{
+ public:
+  arena ();
+  ~arena ();
+  void restart (void);
+  nr_complex_t * alloc (int, arenablock *&);
+  static void release (arenablock *);
+
+ private:
+  arenablock * create (int);
+
+ private:
+  arenablock * current;
+  int wanted;
+};
+
+} // namespace qucs
+
+#endif /* __ARENA_H__ */
@@ -36,89 +36,316 @@
 #include "complex.h"
 #include "object.h"
 #include "vector.h"
-#include "matrix.h"
-#include "matvec.h"
 #include "dataset.h"
 #include "strlist.h"
 #include "constants.h"
+#include "mappedfile.h"
 #include "check_citi.h"
 
 using namespace qucs;
 
 qucs::dataset * citi_result = NULL;
-struct citi_package_t * citi_root = NULL;
 
-/* Returns the number of vectors in a package. */
-static int citi_count_vectors (struct citi_package_t * p) {
-  int i = 0;
-  for (qucs::vector * v = p->data; v != NULL; v = (qucs::vector *) v->getNext ()) i++;
-  return i;
+/* data formats of CITIfile variables */
+enum citi_format_t {
+  CITI_RI,
+  CITI_MAG,
+  CITI_MAGANGLE,
+  CITI_DBANGLE
+};
+
+/* State of the CITIfile reader.  The file is read straight from
+   memory, line by line. */
+struct citi_reader_t {
+  const char * p;     // current position
+  const char * end;   // end of the file contents
+  int line;           // current line number
+};
+
+/* A variable defined by a `VAR' or `DATA' line in the header of a
+   package. */
+struct citi_header_t {
+  char var[128];      // name of the variable
+  int format;         // data format
+  int i1, i2;         // indices of the variable, -1 if unused
+  int n;              // length of independent variables, -1 otherwise
+  struct citi_header_t * next;
+};
+
+// Skips spaces up to the end of the current line.
+static void citi_skip (citi_reader_t & r) {
+  while (r.p < r.end && (*r.p == ' ' || *r.p == '\t')) r.p++;
 }
 
-/* Returns the number of variables in a package. */
-static int citi_count_variables (struct citi_package_t * p) {
-  int i = 0;
-  for (struct citi_header_t * h = p->head; h != NULL; h = h->next) {
-    if (h->var != NULL) i++;
+/* Consumes the end of the current line.  Returns non-zero if there
+   was one. */
+static int citi_eol (citi_reader_t & r) {
+  if (r.p < r.end && (*r.p == '\n' || *r.p == '\r')) {
+    if (*r.p == '\r' && r.p + 1 < r.end && r.p[1] == '\n') r.p++;
+    r.p++;
+    r.line++;
+    return 1;
   }
-  return i;
+  return 0;
+}
+
+// Skips the rest of the current line.
+static void citi_skipline (citi_reader_t & r) {
+  while (r.p < r.end && *r.p != '\n' && *r.p != '\r') r.p++;
+  citi_eol (r);
+}
+
+// Returns non-zero if the given character ends a word or number.
+static int citi_isdelim (char c) {
+  return isspace (c) || c == ',' || c == '[' || c == ']';
 }
 
-/* Returns the n-th vector in the package. */
-static qucs::vector * citi_get_vector (struct citi_package_t * p, int n) {
-  qucs::vector * v = p->data;
-  for (int i = 0; v != NULL; v = (qucs::vector *) v->getNext (), i++) {
-    if (i == n) return v;
+/* Skips empty lines and comments.  Returns zero at the end of the
+   file, otherwise the reader points to the next item. */
+static int citi_next (citi_reader_t & r) {
+  for (;;) {
+    citi_skip (r);
+    if (citi_eol (r)) continue;
+    if (r.p < r.end && *r.p == '#') {
+      citi_skipline (r);
+    }
+    else if (r.end - r.p >= 7 && !strncmp (r.p, "COMMENT", 7) &&
+	     (r.end - r.p == 7 || citi_isdelim (r.p[7]))) {
+      citi_skipline (r);
+    }
+    else break;
   }
-  return NULL;
+  return r.p < r.end;
 }
 
-/* Returns the number of packages. */
-static int citi_count_packages (struct citi_package_t * p) {
-  int i = 0;
-  for (; p != NULL; p = p->next) i++;
-  return i;
+/* Reads the word at the current position into the given buffer.
+   Longer words are truncated. */
+static void citi_word (citi_reader_t & r, char * buf, int len) {
+  int n = 0;
+  while (r.p < r.end && !citi_isdelim (*r.p)) {
+    if (n < len - 1) buf[n++] = *r.p;
+    r.p++;
+  }
+  buf[n] = '\0';
+  citi_skip (r);
+}
+
+// Reads an identifier, which must not be empty.
+static int citi_ident (citi_reader_t & r, char * buf, int len) {
+  citi_word (r, buf, len);
+  if (buf[0] == '\0') {
+    logprint (LOG_ERROR, "line %d: syntax error, missing identifier\n",
+	      r.line);
+    return -1;
+  }
+  return 0;
+}
+
+/* Ensures that nothing else follows on the current line. */
+static int citi_endline (citi_reader_t & r) {
+  citi_skip (r);
+  if (r.p < r.end && !citi_eol (r)) {
+    logprint (LOG_ERROR, "line %d: syntax error, unexpected `%c'\n",
+	      r.line, *r.p);
+    return -1;
+  }
+  return 0;
+}
+
+// Consumes the given character which must follow.
+static int citi_expect (citi_reader_t & r, char c) {
+  if (r.p >= r.end || *r.p != c) {
+    logprint (LOG_ERROR, "line %d: syntax error, missing `%c'\n", r.line, c);
+    return -1;
+  }
+  r.p++;
+  citi_skip (r);
+  return 0;
+}
+
+// Returns non-zero if the given character can be part of a number.
+static int citi_isnum (char c) {
+  return isdigit (c) || c == '.' || c == '+' || c == '-' ||
+    c == 'e' || c == 'E';
+}
+
+/* Reads the number at the current position.  Returns zero on success
+   and non-zero (after emitting an error message) otherwise. */
+static int citi_number (citi_reader_t & r, nr_double_t & f) {
+  char buf[64], * end;
+  int n = 0;
+  while (r.p < r.end && n < 63 && citi_isnum (*r.p)) buf[n++] = *r.p++;
+  buf[n] = '\0';
+  f = strtod (buf, &end);
+  if (n == 0 || *end != '\0' || (r.p < r.end && !citi_isdelim (*r.p))) {
+    while (r.p < r.end && n < 63 && !citi_isdelim (*r.p)) buf[n++] = *r.p++;
+    buf[n] = '\0';
+    logprint (LOG_ERROR, "line %d: syntax error, invalid number `%s'\n",
+	      r.line, buf);
+    return -1;
+  }
+  citi_skip (r);
+  return 0;
+}
+
+// Reads a non-negative integer.
+static int citi_integer (citi_reader_t & r, int & i) {
+  nr_double_t f;
+  if (citi_number (r, f) != 0) return -1;
+  i = (int) f;
+  if (i != f || i < 0) {
+    logprint (LOG_ERROR, "line %d: syntax error, invalid integer `%g'\n",
+	      r.line, f);
+    return -1;
+  }
+  return 0;
+}
+
+/* Counts the packages of the file, i.e. the lines starting with the
+   `CITIFILE' keyword. */
+static int citi_count_packages (const char * p, const char * end) {
+  int n = 0, bol = 1;
+  for (; p < end; p++) {
+    if (*p == '\n' || *p == '\r') {
+      bol = 1;
+    }
+    else if (bol && *p != ' ' && *p != '\t') {
+      if (end - p >= 8 && !strncmp (p, "CITIFILE", 8)) n++;
+      bol = 0;
+    }
+  }
+  return n;
+}
+
+/* Reads the `VAR' or `DATA' header line of a variable, the keyword
+   has been consumed already. */
+static int citi_variable (citi_reader_t & r, citi_header_t * h,
+			  int independent) {
+  char type[16];
+  if (citi_ident (r, h->var, sizeof (h->var)) != 0) return -1;
+  if (!independent && r.p < r.end && *r.p == '[') {
+    r.p++;
+    citi_skip (r);
+    if (citi_integer (r, h->i1) != 0) return -1;
+    if (r.p < r.end && *r.p == ',') {
+      r.p++;
+      citi_skip (r);
+      if (citi_integer (r, h->i2) != 0) return -1;
+    }
+    if (citi_expect (r, ']') != 0) return -1;
+  }
+  citi_word (r, type, sizeof (type));
+  if (!strcmp (type, "RI"))
+    h->format = CITI_RI;
+  else if (!strcmp (type, "MAG"))
+    h->format = CITI_MAG;
+  else if (!strcmp (type, "MAGANGLE"))
+    h->format = CITI_MAGANGLE;
+  else if (!strcmp (type, "DBANGLE"))
+    h->format = CITI_DBANGLE;
+  else {
+    logprint (LOG_ERROR, "line %d: syntax error, invalid format `%s'\n",
+	      r.line, type);
+    return -1;
+  }
+  if (independent && citi_integer (r, h->n) != 0) return -1;
+  return citi_endline (r);
 }
 
-/* Find name of the package in its headers. */
-static char * citi_get_package (struct citi_package_t * p) {
-  for (struct citi_header_t * h = p->head; h != NULL; h = h->next) {
-    if (h->package != NULL) return h->package;
+// Converts a data item of the given format into a complex value.
+static nr_complex_t citi_value (int format, nr_double_t a, nr_double_t b) {
+  switch (format) {
+  case CITI_MAGANGLE:
+    return std::polar (a, deg2rad (b));
+  case CITI_DBANGLE:
+    return std::polar (std::pow (10.0, a / 20.0), deg2rad (b));
   }
-  return NULL;
+  return nr_complex_t (a, b);
 }
 
-/* Create a valid vector for the dataset. */
-static qucs::vector * citi_create_vector (struct citi_package_t * p, int i,
-				    char * n, char * type) {
-  qucs::vector * vec;
-  vec = citi_get_vector (p, i); // fetch vector
-  vec = new qucs::vector (*vec);      // copy vector
-  vec->reverse ();              // reverse vector
-
-  // convert data if necessary
-  if (!strcmp (type, "MAGANGLE")) {
-    for (int i = 0; i < vec->getSize (); i++) {
-      nr_complex_t val = vec->get (i);
-      val = std::polar (real (val), deg2rad (imag (val)));
-      vec->set (val, i);
+/* Reads the values of a data block up to the given end keyword.  A
+   value is either a single number or a pair of numbers separated by
+   a comma on each line. */
+static int citi_values (citi_reader_t & r, qucs::vector * v, int format,
+			const char * stop) {
+  char buf[32];
+  nr_double_t a, b;
+  while (citi_next (r)) {
+    if (isalpha (*r.p)) {
+      citi_word (r, buf, sizeof (buf));
+      if (strcmp (buf, stop)) {
+	logprint (LOG_ERROR, "line %d: syntax error, unexpected `%s'\n",
+		  r.line, buf);
+	return -1;
+      }
+      return citi_endline (r);
+    }
+    b = 0.0;
+    if (citi_number (r, a) != 0) return -1;
+    if (r.p < r.end && *r.p == ',') {
+      r.p++;
+      citi_skip (r);
+      if (citi_number (r, b) != 0) return -1;
     }
+    if (citi_endline (r) != 0) return -1;
+    v->add (citi_value (format, a, b));
   }
-  else if (!strcmp (type, "DBANGLE")) {
-    for (int i = 0; i < vec->getSize (); i++) {
-      nr_complex_t val = vec->get (i);
-      val = std::polar (std::pow (10.0, real (val) / 20.0), deg2rad (imag (val)));
-      vec->set (val, i);
+  logprint (LOG_ERROR, "line %d: syntax error, missing `%s'\n", r.line, stop);
+  return -1;
+}
+
+/* Reads the data block starting with the given keyword, which has been
+   consumed already.  The expected number of values is used to
+   preallocate the vector.  Returns NULL on errors. */
+static qucs::vector * citi_block (citi_reader_t & r, const char * key,
+				  int format, int size) {
+  qucs::vector * v;
+  char buf[32];
+  int ret;
+
+  if (citi_endline (r) != 0) return NULL;
+  if (!strcmp (key, "SEG_LIST_BEGIN")) {
+    /* a linear sweep given by start, stop and number of points */
+    nr_double_t start, stop;
+    int n;
+    citi_next (r);
+    citi_word (r, buf, sizeof (buf));
+    if (strcmp (buf, "SEG")) {
+      logprint (LOG_ERROR, "line %d: syntax error, missing `SEG'\n", r.line);
+      return NULL;
+    }
+    if (citi_number (r, start) != 0 || citi_number (r, stop) != 0 ||
+	citi_integer (r, n) != 0 || citi_endline (r) != 0)
+      return NULL;
+    citi_next (r);
+    citi_word (r, buf, sizeof (buf));
+    if (strcmp (buf, "SEG_LIST_END")) {
+      logprint (LOG_ERROR, "line %d: syntax error, missing `SEG_LIST_END'\n",
+		r.line);
+      return NULL;
     }
+    if (citi_endline (r) != 0) return NULL;
+    return new qucs::vector (linspace (start, stop, n));
   }
 
-  // return named vector
-  vec->setName (n);
-  return vec;
+  /* the values are read directly into the vector, the size of the
+     file limits the number of values */
+  if (size > (r.end - r.p) / 2) size = (r.end - r.p) / 2;
+  v = new qucs::vector ();
+  if (size > 0) v->reserve (size);
+  if (!strcmp (key, "VAR_LIST_BEGIN"))
+    ret = citi_values (r, v, CITI_RI, "VAR_LIST_END");
+  else
+    ret = citi_values (r, v, format, "END");
+  if (ret != 0) {
+    delete v;
+    return NULL;
+  }
+  return v;
 }
 
 /* Returns dependent variable length for the given dependencies. */
-static int citi_vector_length (strlist deps) {
+static int citi_vector_length (strlist & deps) {
   int n = 1;
   // no dependencies
   if (deps.length () <= 0)
@@ -132,7 +359,8 @@ static int citi_vector_length (strlist deps) {
 }
 
 /* Checks length of variable vectors. */
-static int citi_check_dep_length (qucs::vector * v, strlist deps, char * package) {
+static int citi_check_dep_length (qucs::vector * v, strlist & deps,
+				  const char * package) {
   int rlength = v->getSize ();
   int dlength = citi_vector_length (deps);
   if (rlength != dlength) {
@@ -144,144 +372,185 @@ static int citi_check_dep_length (qucs::vector * v, strlist deps, char * package
   return 0;
 }
 
-// Destroys data used by the CITIfile parser.
-void citi_finalize (void) {
-  struct citi_package_t * p, * pn;
-  /* go through all packages */
-  for (p = citi_root; p != NULL; p = pn) {
-    struct citi_header_t * h, * hn;
-    /* go through each header */
-    for (h = p->head; h != NULL; h = hn) {
-      free (h->package);
-      free (h->var);
-      free (h->type);
-      hn = h->next;
-      free (h);
+/* Names the vector read for the given variable and puts it into the
+   dataset.  Returns the number of checker errors. */
+static int citi_create_vector (qucs::vector * v, citi_header_t * h,
+			       const char * opack, strlist & deps,
+			       const char * package) {
+  char txt[300];
+  int errors = 0;
+
+  if (h->i1 >= 0 && h->i2 >= 0)
+    sprintf (txt, "%s%s[%d,%d]", opack, h->var, h->i1, h->i2);
+  else if (h->i1 >= 0)
+    sprintf (txt, "%s%s[%d]", opack, h->var, h->i1);
+  else
+    sprintf (txt, "%s%s", opack, h->var);
+  v->setName (txt);
+
+  if (h->n >= 0) {
+    /* independent variable */
+    if (v->getSize () != h->n) {
+      logprint (LOG_ERROR, "checker error, vector `%s' length (%d) "
+		"does not equal defined length (%d) in package `%s'\n",
+		h->var, v->getSize (), h->n, package);
+      errors++;
     }
-    qucs::vector * v, * vn;
-    /* go through each vector */
-    for (v = p->data; v != NULL; v = vn) {
-      vn = (qucs::vector *) v->getNext ();
-      delete v;
+    deps.add (txt);
+    if (!citi_result->findDependency (txt)) {
+      /* add independent vectors only once */
+      citi_result->addDependency (v);
     }
-    pn = p->next;
-    free (p);
+    else delete v;
+  }
+  else {
+    /* dependent variable */
+    v->setDependencies (new strlist (deps));
+    errors += citi_check_dep_length (v, deps, package);
+    citi_result->addVariable (v);
   }
-  citi_lex_destroy ();
+  return errors;
 }
 
-/* This function is the checker routine for a parsed CITIfile.  It
-   returns zero on success or non-zero if it contained errors. */
-int citi_check (void) {
+/* Reads a package, i.e. its header and the data blocks of the
+   variables in header order.  Returns non-zero on syntax errors,
+   checker errors are counted in the given variable. */
+static int citi_package (citi_reader_t & r, int packages, int & errors) {
+  citi_header_t * root = NULL, * h, ** tail = &root;
+  char buf[128], package[128] = "", opack[132];
+  const char * pos;
+  int ret = 0, cvec = 0, cvar = 0;
+  strlist deps;
 
-  int errors = 0;
+  citi_word (r, buf, sizeof (buf));
+  if (strcmp (buf, "CITIFILE")) {
+    logprint (LOG_ERROR, "line %d: syntax error, unexpected `%s'\n",
+	      r.line, buf);
+    return -1;
+  }
+  citi_word (r, buf, sizeof (buf));
+  if (buf[0] == '\0') {
+    logprint (LOG_ERROR, "line %d: syntax error, missing version\n", r.line);
+    return -1;
+  }
+  if (citi_endline (r) != 0) return -1;
 
-  /* create dataset */
-  citi_result = new dataset ();
-  /* get root package */
-  struct citi_package_t * p = citi_root;
-  /* count packages */
-  int packages = citi_count_packages (p);
-
-  /* go through all packages */
-  for (p = citi_root; p != NULL; p = p->next) {
-    struct citi_header_t * h;
-    char * package = citi_get_package (p);
-    int n = 0;
-    strlist deps;
-
-    /* check number of defined variables and vectors */
-    int cvec = citi_count_vectors (p);
-    int cvar = citi_count_variables (p);
-    if (cvec != cvar) {
-      logprint (LOG_ERROR, "checker error, no. of vectors (%d) does not equal "
-		"no. of variables (%d) in package `%s'\n", cvec, cvar,
-		package);
-      errors++;
+  /* read the header lines */
+  while (ret == 0 && citi_next (r)) {
+    pos = r.p;
+    citi_word (r, buf, sizeof (buf));
+    if (!strcmp (buf, "NAME")) {
+      if ((ret = citi_ident (r, package, sizeof (package))) == 0)
+	ret = citi_endline (r);
+    }
+    else if (!strcmp (buf, "VAR") || !strcmp (buf, "DATA")) {
+      h = (citi_header_t *) calloc (sizeof (citi_header_t), 1);
+      h->i1 = h->i2 = h->n = -1;
+      *tail = h;
+      tail = &h->next;
+      ret = citi_variable (r, h, buf[0] == 'V');
+      cvar++;
+    }
+    else if (!strcmp (buf, "CONSTANT")) {
+      /* ignore constants */
+      citi_skipline (r);
+    }
+    else {
+      /* the data blocks start here */
+      r.p = pos;
       break;
     }
+  }
+
+  /* no package info if there is just one */
+  if (packages < 2) {
+    opack[0] = '\0';
+  } else {
+    sprintf (opack, "%s.", package);
+  }
 
-    /* no package info if there is just one */
-    char opack[256];
-    if (packages < 2) {
-      opack[0] = '\0';
-    } else {
-      sprintf (opack, "%s.", package);
+  /* read the data blocks, one for each variable */
+  h = root;
+  while (ret == 0 && citi_next (r)) {
+    qucs::vector * v;
+    int size = 0;
+    pos = r.p;
+    citi_word (r, buf, sizeof (buf));
+    if (strcmp (buf, "BEGIN") && strcmp (buf, "SEG_LIST_BEGIN") &&
+	strcmp (buf, "VAR_LIST_BEGIN")) {
+      r.p = pos;
+      break;
+    }
+    if (h != NULL) {
+      size = h->n >= 0 ? h->n : citi_vector_length (deps);
+    }
+    if ((v = citi_block (r, buf, h ? h->format : CITI_RI, size)) == NULL) {
+      ret = -1;
     }
+    else if (h != NULL) {
+      errors += citi_create_vector (v, h, opack, deps, package);
+      h = h->next;
+    }
+    else delete v;
+    cvec++;
+  }
 
-    /* go through each header */
-    for (h = p->head; h != NULL; h = h->next) {
-      qucs::vector * v;
-      if (h->var != NULL) {
-	char txt[256];
-	if (h->i1 >= 0) {
-	  /* dependent variables */
-	  if (h->i2 >= 0) {
-	    sprintf (txt, "%s%s[%d,%d]", opack, h->var, h->i1, h->i2);
-	    v = citi_create_vector (p, n, txt, h->type);
-	    v->setDependencies (new strlist (deps));
-	    errors += citi_check_dep_length (v, deps, package);
-	    citi_result->addVariable (v);
-	    n++;
-	  } else {
-	    sprintf (txt, "%s%s[%d]", opack, h->var, h->i1);
-	    v = citi_create_vector (p, n, txt, h->type);
-	    v->setDependencies (new strlist (deps));
-	    errors += citi_check_dep_length (v, deps, package);
-	    citi_result->addVariable (v);
-	    n++;
-	  }
-	} else if (h->n >= 0) {
-	  /* independent variable */
-	  sprintf (txt, "%s%s", opack, h->var);
-	  v = citi_create_vector (p, n, txt, h->type);
-	  deps.add (txt);
-	  if (!citi_result->findDependency (txt)) {
-	    /* add independent vectors only once */
-	    citi_result->addDependency (v);
-	  }
-	  n++;
-	  // check length of independent vector
-	  if (v->getSize () != h->n) {
-	    logprint (LOG_ERROR, "checker error, vector `%s' length (%d) "
-		      "does not equal defined length (%d) in package `%s'\n",
-		      h->var, v->getSize (), h->n, package);
-	    errors++;
-	  }
-	} else {
-	  /* dependent variables, no indices */
-	  sprintf (txt, "%s%s", opack, h->var);
-	  v = citi_create_vector (p, n, txt, h->type);
-	  v->setDependencies (new strlist (deps));
-	  errors += citi_check_dep_length (v, deps, package);
-	  citi_result->addVariable (v);
-	  n++;
-	}
-      }
+  /* check number of defined variables and vectors */
+  if (ret == 0 && cvec != cvar) {
+    logprint (LOG_ERROR, "checker error, no. of vectors (%d) does not equal "
+	      "no. of variables (%d) in package `%s'\n", cvec, cvar, package);
+    ret = -1;
+  }
+
+  /* free the header */
+  for (h = root; h != NULL; h = root) {
+    root = h->next;
+    free (h);
+  }
+  return ret;
+}
+
+/* This function reads the given CITIfile into a dataset which is
+   available as citi_result then.  It returns zero on success or
+   non-zero if the file contained errors. */
+int citi_read (const char * file) {
+  citi_reader_t r;
+  mappedfile map;
+  int errors = 0, packages;
+
+  citi_result = NULL;
+  if (map.open (file) != 0) return -1;
+  r.p = map.getData ();
+  r.end = r.p + map.getSize ();
+  r.line = 1;
+
+  /* create dataset and go through all packages */
+  citi_result = new dataset ();
+  packages = citi_count_packages (r.p, r.end);
+  while (citi_next (r)) {
+    if (citi_package (r, packages, errors) != 0) {
+      errors++;
+      break;
     }
   }
 
-  citi_finalize ();
-  citi_root = NULL;
+  if (errors) {
+    delete citi_result;
+    citi_result = NULL;
+  }
   return errors ? -1 : 0;
 }
 
-// Destroys data used by the CITIfile parser and checker.
+// Destroys data used by the CITIfile reader.
 void citi_destroy (void) {
   if (citi_result != NULL) {
     // delete associated dataset
     delete citi_result;
     citi_result = NULL;
   }
-  if (citi_root != NULL) {
-    citi_finalize ();
-    citi_root = NULL;
-  }
 }
 
-// Initializes the CITIfile checker.
+// Initializes the CITIfile reader.
 void citi_init (void) {
   citi_result = NULL;
-  citi_root = NULL;
 }
-
@@ -22,48 +22,21 @@
  *
  */
 
+
 #ifndef __CHECK_CITI_H__
 #define __CHECK_CITI_H__
 
+// forward declarations
 namespace qucs {
   class dataset;
-  class vector;
 }
 
 extern qucs::dataset * citi_result;
-extern struct citi_package_t * citi_root;
-
-struct citi_header_t {
-  char * package;
-  char * var;
-  char * type;
-  int i1, i2;
-  int n;
-  struct citi_header_t * next;
-};
-
-struct citi_package_t {
-  struct citi_header_t * head;
-  qucs::vector * data;
-  struct citi_package_t * next;
-};
-
-/* Externalize variables used by the scanner and parser. */
-extern int citi_lineno;
-extern FILE * citi_in;
-void citi_restart (FILE *);
 
 __BEGIN_DECLS
 
-/* Externalize variables used by the scanner and parser. */
-extern struct citi_t citi_options;
-
-/* Available functions of the checker. */
-int citi_parse (void);
-int citi_error (const char *);
-int citi_lex (void);
-int citi_lex_destroy (void);
-int citi_check (void);
+/* Available functions of the reader. */
+int citi_read (const char *);
 void citi_init (void);
 void citi_destroy (void);
 
@@ -30,7 +30,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cmath>
-#include <assert.h>
 #include <float.h>
 
 #include "logging.h"
@@ -49,6 +48,7 @@ using namespace qucs::eqn;
 /* Global definitions for parser and checker. */
 struct definition_t * definition_root = NULL;
 struct definition_t * subcircuit_root = NULL;
+struct instance_t * instance_root = NULL;
 environment * env_root = NULL;
 
 /* The function counts the nodes in a definition line. */
@@ -1259,263 +1259,56 @@ checker_build_subcircuits (struct definition_t * root)
     return root;
 }
 
-/* The function produces a copy of the given circuit definition and
-   marks it as a copy.  The node definition are not included within
-   the copy. */
-static struct definition_t *
-checker_copy_subcircuit (struct definition_t * sub)
+/* The function returns the name of the internal node 'node' of the
+   subcircuit instance 'inst'.  The name is unique to the instance. */
+std::string netlist_instance_node (struct instance_t * inst,
+                                   const std::string & node)
 {
-    struct definition_t * copy;
-    copy = (struct definition_t *) calloc (sizeof (struct definition_t), 1);
-    copy->action = sub->action;
-    copy->nonlinear = sub->nonlinear;
-    copy->substrate = sub->substrate;
-    copy->nodeset = sub->nodeset;
-    copy->define = sub->define;
-    copy->pairs = sub->pairs;
-    copy->ncount = sub->ncount;
-    copy->type = strdup (sub->type);
-    copy->copy = 1;
-    return copy;
+    return std::string (inst->type->instance) + "." + inst->path + "." + node;
 }
 
-/* This function translates the node definitions of the given
-   subcircuit element 'sub'.  The translation is based upon the node
-   definitions of the subcircuit 'type' and the instance 'inst' of
-   such a subcircuit.  The translated nodes are saved in an extra
-   'xlate' field of each node of the subcircuit element 'sub'. */
-static void checker_xlat_subcircuit_nodes (struct definition_t * type,
-        struct definition_t * inst,
-        struct definition_t * sub)
+/* The function returns the name of the given element 'def' of the
+   subcircuit instance 'inst'. */
+std::string netlist_instance_name (struct instance_t * inst,
+                                   struct definition_t * def)
 {
-    struct node_t * n, * ninst, * ntype;
-    int i;
-    // go through nodes of the subcircuit 'type' and 'inst'
-    for (i = 1, ntype = type->nodes, ninst = inst->nodes; ntype != NULL;
-            ntype = ntype->next, ninst = ninst->next, i++)
-    {
-        for (n = sub->nodes; n != NULL; n = n->next)
-        {
-            /* check whether a node in the subcircuit element 'sub' corresponds
-            with the 'type', then assign the 'inst's node name */
-            if (!strcmp (n->node, ntype->node))
-            {
-                n->xlate = strdup (ninst->node);
-                n->xlatenr = i;
-            }
-        }
-    }
+    return std::string (inst->type->instance) + "." + inst->path + "." +
+           def->instance;
 }
 
-/* The function creates a subcircuit node name consisting of the given
-   arguments.  If the given 'instances' is NULL it is left out.  The
-   caller is responsible to free() the returned string. */
-static char * checker_subcircuit_node (char * type, char * instances,
-                                       char * instance, char * node)
+/* This function creates the instance of the subcircuit 'type' given
+   by the definition 'def' and the instances of all the subcircuits
+   within.  The subcircuit elements are not copied, the instance
+   refers to the shared subcircuit definition and carries an own
+   environment for the instance parameters only. */
+static struct instance_t *
+checker_create_instance (struct definition_t * type, struct definition_t * def,
+                         struct instance_t * parent, environment * penv)
 {
-    char * txt = (char *)
-                 calloc (1, strlen (type) + strlen (instance) + strlen (node) +
-                         (instances ? strlen (instances) : 0) + 4);
-    if (instances)
-        sprintf (txt, "%s.%s.%s.%s", type, instances, instance, node);
-    else
-        sprintf (txt, "%s.%s.%s", type, instance, node);
-    return txt;
-}
-
-/* The function reverses the order of the given node list and returns
-   the reversed list. */
-struct node_t * netlist_reverse_nodes (struct node_t * nodes)
-{
-    struct node_t * root, * next;
-    for (root = NULL; nodes != NULL; nodes = next)
+    struct instance_t * inst;
+    inst = (struct instance_t *) calloc (sizeof (struct instance_t), 1);
+    inst->type = type;
+    inst->def = def;
+    inst->parent = parent;
+    if (parent)
     {
-        next = nodes->next;
-        nodes->next = root;
-        root = nodes;
-    }
-    return root;
-}
-
-/* This function assigns new node names to the subcircuit element
-   'copy' based upon the previous node translation between the
-   subcircuit 'type' and the instance 'inst' of this type.  The global
-   'gnd' node is not touched. */
-static void
-checker_copy_subcircuit_nodes (struct definition_t * type,
-                               struct definition_t * inst,
-                               struct definition_t * sub,
-                               struct definition_t * copy,
-                               char * instances)
-{
-    struct node_t * n, * ncopy, * root = NULL;
-
-    // go through the list of the subcircuit element's 'sub' nodes
-    for (n = sub->nodes; n != NULL; n = n->next)
-    {
-
-        // create new node based upon the node translation
-        ncopy = (struct node_t *) calloc (sizeof (struct node_t), 1);
-        ncopy->xlatenr = n->xlatenr;
-        if (n->xlate)   // translated node
-        {
-            if (instances == NULL)
-                ncopy->node = strdup (n->xlate);
-            else
-                ncopy->node = NULL; // leave it blank yet, indicates translation
-        }
-        else if (!strcmp (n->node, "gnd"))   // ground node
-        {
-            ncopy->node = strdup (n->node);
-        }
-        else if (n->node[strlen (n->node) - 1] == '!')   // global node
-        {
-            ncopy->node = strdup (n->node);
-        }
-        else   // internal subcircuit element node
-        {
-            ncopy->node = checker_subcircuit_node (type->instance, instances,
-                                                   inst->instance, n->node);
-        }
-        // chain the new node list
-        ncopy->next = root;
-        root = ncopy;
+        inst->path = (char *)
+                     malloc (strlen (parent->path) + strlen (def->instance) + 2);
+        sprintf (inst->path, "%s.%s", parent->path, def->instance);
     }
-
-    /* and finally reverse the created node list and assign it to the
-       subcircuit element's 'copy' */
-    copy->nodes = netlist_reverse_nodes (root);
-}
-
-// Returns the node at the given position.
-static struct node_t * checker_get_circuit_node (struct node_t * root, int n)
-{
-    for (int i = 1; i < n; i++)
-    {
-        root = root->next;
-        assert (root != NULL);
-    }
-    return root;
-}
-
-// The function cleans the translated nodes of a subcircuit template.
-static void checker_cleanup_xlat_nodes (struct definition_t * sub)
-{
-    for (struct node_t * n = sub->nodes; n != NULL; n = n->next)
-    {
-        free (n->xlate);
-        n->xlate = NULL;
-        n->xlatenr = 0;
-    }
-}
-
-/* The function is used to assign the nodes of the 'copy' subcircuit
-   element which were left blank intentionally by the element copy in
-   order to indicate that it is an external node.  Again, if the
-   current node translation indicates an external node it is blanked
-   again, otherwise the node gets a unique internal name.  If the
-   'instances' list is NULL, then this indicates the root circuit list
-   and node translations are done though they are 'external'. */
-static void
-checker_copy_circuit_nodes (struct definition_t * type,
-                            struct definition_t * inst,
-                            struct definition_t * sub,
-                            struct definition_t * copy,
-                            char * instances)
-{
-    struct node_t * n, * ncopy;
-
-    // go through the list of the subcircuit element's 'copy' nodes
-    for (ncopy = copy->nodes; ncopy != NULL; ncopy = ncopy->next)
+    else
     {
-        // these NULL nodes have intentionally been blanked
-        if (ncopy->node == NULL)
-        {
-            assert (ncopy->xlatenr != 0);
-            // get translated node
-            n = checker_get_circuit_node (sub->nodes, ncopy->xlatenr);
-            ncopy->xlatenr = n->xlatenr;
-            if (n->xlate)   // translated node
-            {
-                if (instances == NULL)
-                    // external node indicated by no instances given
-                    ncopy->node = strdup (n->xlate);
-                else
-                    ncopy->node = NULL; // keep blank
-            }
-            else if (!strcmp (n->node, "gnd"))   // global ground node
-            {
-                ncopy->node = strdup (n->node);
-            }
-            else if (n->node[strlen (n->node) - 1] == '!')   // other global node
-            {
-                ncopy->node = strdup (n->node);
-            }
-            else   // internal subcircuit element node
-            {
-                ncopy->node = checker_subcircuit_node (type->instance, instances,
-                                                       inst->instance, n->node);
-            }
-        }
+        inst->path = strdup (def->instance);
     }
-}
-
-/* This function returns the last entry of the given list of
-   definitions or NULL if there is no such element. */
-static struct definition_t *
-checker_find_last_definition (struct definition_t * root)
-{
-    for (struct definition_t * def = root; def != NULL; def = def->next)
-        if (def->next == NULL) return def;
-    return NULL;
-}
-
-/* Based upon the the given subcircuit instance identifier list the
-   function returns a "." - concatenated string or NULL. */
-static char * checker_subcircuit_instance_list (strlist * instances)
-{
-    if (instances && instances->length () > 0)
-        return instances->toString (".");
-    return NULL;
-}
-
-/* The function creates a subcircuit instance name consisting of the
-   given arguments.  If the given 'instances' is NULL it is left out.
-   The caller is responsible to free() the returned string. */
-static char * checker_subcircuit_instance (char * type, char * instances,
-        char * instance, char * base)
-{
-    char * txt = (char *)
-                 calloc (1, strlen (type) + strlen (instance) + strlen (base) +
-                         (instances ? strlen (instances) : 0) + 4);
-    if (instances)
-        sprintf (txt, "%s.%s.%s.%s", type, instances, instance, base);
-    else
-        sprintf (txt, "%s.%s.%s", type, instance, base);
-    return txt;
-}
-
-/* This function produces a copy of the given subcircuit 'type'
-   containing the subcircuit elements.  Based upon the instance 'inst'
-   definitions (node names and instance name) it assign new element
-   instances and node names.  The function returns a NULL terminated
-   circuit element list in reverse order. */
-static struct definition_t *
-checker_copy_subcircuits (struct definition_t * type,
-                          struct definition_t * inst, strlist * * instances,
-                          environment * parent)
-{
-    struct definition_t * def, * copy;
-    struct definition_t * root = NULL;
-    strlist * instcopy;
-    char * list;
 
     // create environment for subcircuit instance
     environment * child = new environment (*(type->env));
-    parent->push_front_Child (child);
+    child->setName (std::string (type->instance) + "." + inst->path);
+    penv->push_front_Child (child);
+    inst->env = child;
 
     // put instance properties into subcircuit environment
-    for (struct pair_t * pair = inst->pairs; pair != NULL; pair = pair->next)
+    for (struct pair_t * pair = def->pairs; pair != NULL; pair = pair->next)
     {
         // anything else than the 'Type'
         if (strcmp (pair->key, "Type"))
@@ -1534,74 +1327,19 @@ checker_copy_subcircuits (struct definition_t * type,
         }
     }
 
-    // go through element list of subcircuit
-    for (def = type->sub; def != NULL; def = def->next)
+    // allow recursive subcircuits
+    for (struct definition_t * sub = type->sub; sub != NULL; sub = sub->next)
     {
-
-        // translate the node list
-        checker_xlat_subcircuit_nodes (type, inst, def);
-
-        // allow recursive subcircuits
-        if (!strcmp (def->type, "Sub"))
+        if (!strcmp (sub->type, "Sub"))
         {
-            // get subcircuit template definition
-            struct definition_t * sub = checker_get_subcircuit (def);
-            // create a copy of the current subcircuit instance list
-            if ((*instances) == NULL) (*instances) = new strlist ();
-            instcopy = new strlist (*(*instances));
-            // append instance name to recursive instance list
-            (*instances)->append (inst->instance);
-            copy = checker_copy_subcircuits (sub, def, instances, child);
-            // put the expanded definitions into the sublist
-            if (copy)
-            {
-                list = checker_subcircuit_instance_list (instcopy);
-                // assign blanked node names to each subcircuit
-                for (struct definition_t * c = copy; c != NULL; c = c->next)
-                {
-                    checker_copy_circuit_nodes (type, inst, def, c, list);
-                }
-                // append the copies to the subcircuit list
-                struct definition_t * last = checker_find_last_definition (copy);
-                last->next = root;
-                root = copy;
-            }
-            // restore original instance list
-            delete *instances;
-            *instances = instcopy;
+            struct instance_t * c;
+            c = checker_create_instance (checker_get_subcircuit (sub), sub,
+                                         inst, child);
+            c->next = inst->children;
+            inst->children = c;
         }
-        else
-        {
-            // element copy
-            copy = checker_copy_subcircuit (def);
-            // assign new instance name to the element
-            list = checker_subcircuit_instance_list (*instances);
-            copy->instance =
-                checker_subcircuit_instance (type->instance, list,
-                                             inst->instance, def->instance);
-            copy->subcircuit = strdup (type->instance);
-            // assign node list
-            checker_copy_subcircuit_nodes (type, inst, def, copy, list);
-            // apply environment
-            copy->env = child;
-            // chain definition (circuit) list
-            copy->next = root;
-            root = copy;
-        }
-
-        // cleanup translated nodes
-        checker_cleanup_xlat_nodes (def);
-    }
-
-    // try giving child environment a unique name
-    strlist * icopy = new strlist ();
-    icopy->append (type->instance);
-    icopy->append (*(instances));
-    icopy->append (inst->instance);
-    child->setName (std::string(icopy->toString (".")));
-    delete icopy;
-
-    return root;
+    }
+    return inst;
 }
 
 /* The function checks whether the subcircuit 'instance' with the
@@ -1935,7 +1673,7 @@ static void netlist_free_pairs (struct pair_t * pp)
 static void netlist_free_definition (struct definition_t * def)
 {
     netlist_free_nodes (def->nodes);
-    if (!def->copy) netlist_free_pairs (def->pairs);
+    netlist_free_pairs (def->pairs);
     free (def->subcircuit);
     free (def->type);
     free (def->instance);
@@ -1967,14 +1705,14 @@ netlist_unchain_definition (struct definition_t * root,
     return root;
 }
 
-/* The function expands the subcircuits within the given definition
-   list and returns the expanded list with the subcircuit definitions
-   removed. */
+/* The function creates the instances of the subcircuits within the
+   given definition list and returns the list with the subcircuit
+   instance definitions removed.  These definitions are kept by the
+   instances. */
 static struct definition_t *
 checker_expand_subcircuits (struct definition_t * root, environment * parent)
 {
-    struct definition_t * def, * sub, * copy, * next, * prev;
-    strlist * instances = NULL;
+    struct definition_t * def, * next, * prev;
 
     // go through the list of definitions
     for (prev = NULL, def = root; def != NULL; def = next)
@@ -1983,15 +1721,11 @@ checker_expand_subcircuits (struct definition_t * root, environment * parent)
         // is this a subcircuit instance definition ?
         if (!strcmp (def->type, "Sub"))
         {
-            // get the subcircuit type definition
-            sub = checker_get_subcircuit (def);
-            // and make a copy of it
-            copy = checker_copy_subcircuits (sub, def, &instances, parent);
-            if (instances)
-            {
-                delete instances;
-                instances = NULL;
-            }
+            struct instance_t * inst;
+            inst = checker_create_instance (checker_get_subcircuit (def), def,
+                                            NULL, parent);
+            inst->next = instance_root;
+            instance_root = inst;
             // remove the subcircuit instance from the original list
             if (prev)
             {
@@ -2001,15 +1735,7 @@ checker_expand_subcircuits (struct definition_t * root, environment * parent)
             {
                 root = next;
             }
-            netlist_free_definition (def);
-            // put the expanded definitions into the netlist
-            if (copy)
-            {
-                struct definition_t * last = checker_find_last_definition (copy);
-                last->next = root;
-                if (!prev) prev = last;
-                root = copy;
-            }
+            def->next = NULL;
         }
         // component in the root environment
         else
@@ -2146,6 +1872,17 @@ static void netlist_lister (struct definition_t * root, const char * prefix)
     }
 }
 
+/* Debug function: Prints the subcircuit instances. */
+static void netlist_list_instances (struct instance_t * root)
+{
+    for (struct instance_t * inst = root; inst != NULL; inst = inst->next)
+    {
+        logprint (LOG_STATUS, "instance %s.%s\n", inst->type->instance,
+                  inst->path);
+        netlist_list_instances (inst->children);
+    }
+}
+
 /* Debug function: Prints the overall netlist representation. */
 void netlist_list (void)
 {
@@ -2157,9 +1894,27 @@ void netlist_list (void)
         logprint (LOG_STATUS, "subcircuit %s\n", def->instance);
         netlist_lister (def->sub, "  ");
     }
+    netlist_list_instances (instance_root);
 }
 #endif /* DEBUG */
 
+/* The function returns the number of elements of the given type within
+   the given subcircuit instances. */
+static int checker_count_instances (struct instance_t * root,
+                                    const char * type)
+{
+    int count = 0;
+    for (struct instance_t * inst = root; inst != NULL; inst = inst->next)
+    {
+        for (struct definition_t * def = inst->type->sub; def; def = def->next)
+        {
+            if (!strcmp (def->type, type)) count++;
+        }
+        count += checker_count_instances (inst->children, type);
+    }
+    return count;
+}
+
 /* The function logs the content of the current netlist by telling how
    many instances of which kind of components are used in the netlist. */
 void netlist_status (void)
@@ -2176,6 +1931,9 @@ void netlist_status (void)
         {
             if (!strcmp (def->type, cir->type)) count++;
         }
+        // subcircuit instances are expanded
+        if (strcmp (def->type, "Sub"))
+            count += checker_count_instances (instance_root, def->type);
         if (count > 0)
         {
             logprint (LOG_STATUS, "  %5d %s instances\n", count, def->type);
@@ -2331,9 +2089,26 @@ static void netlist_destroy_intern (struct definition_t * root)
     }
 }
 
+/* The function deletes the given subcircuit instances.  The
+   definitions of the top level instances belong to them. */
+static void netlist_destroy_instances (struct instance_t * root)
+{
+    struct instance_t * inst, * next;
+    for (inst = root; inst != NULL; inst = next)
+    {
+        next = inst->next;
+        netlist_destroy_instances (inst->children);
+        if (inst->parent == NULL) netlist_free_definition (inst->def);
+        free (inst->path);
+        free (inst);
+    }
+}
+
 /* Deletes all available definition lists. */
 void netlist_destroy (void)
 {
+    netlist_destroy_instances (instance_root);
+    instance_root = NULL;
     netlist_destroy_intern (definition_root);
     for (struct definition_t * def = subcircuit_root; def; def = def->next)
     {
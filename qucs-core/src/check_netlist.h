@@ -25,6 +25,8 @@
 #ifndef __CHECK_NETLIST_H__
 #define __CHECK_NETLIST_H__
 
+#include <string>
+
 #include "netdefs.h"
 
 /* Forward declarations. */
@@ -40,6 +42,7 @@ __BEGIN_DECLS
 
 /* Externalize variables used by the scanner and parser. */
 extern struct definition_t * definition_root;
+extern struct instance_t * instance_root;
 
 /* Available functions of the checker. */
 void netlist_status (void);
@@ -59,4 +62,8 @@ netlist_unchain_definition (struct definition_t *, struct definition_t *);
 
 __END_DECLS
 
+/* Names of the elements within subcircuit instances. */
+std::string netlist_instance_name (struct instance_t *, struct definition_t *);
+std::string netlist_instance_node (struct instance_t *, const std::string &);
+
 #endif /* __CHECK_NETLIST_H__ */
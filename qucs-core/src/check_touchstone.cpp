@@ -41,15 +41,15 @@
 #include "dataset.h"
 #include "strlist.h"
 #include "constants.h"
+#include "mappedfile.h"
 #include "check_touchstone.h"
 
 #define ZREF 50.0 /* reference impedance */
 
 using namespace qucs;
 
-strlist * touchstone_idents = NULL;
+static strlist * touchstone_idents = NULL;
 dataset * touchstone_result = NULL;
-qucs::vector  * touchstone_vector = NULL;
 
 /* default touchstone options */
 struct touchstone_t touchstone_options = {
@@ -59,98 +59,70 @@ struct touchstone_t touchstone_options = {
 static const char * touchstone_valid_options[] = {
   "hz", "khz", "mhz", "ghz", "s", "y", "z", "g", "h", "ma", "db", "ri", NULL };
 
-/* This subroutine is going to join vectors on multiple lines.  The
-   input and output list of vectors of this function is the
-   touchstone_vector variable. */
-static void touchstone_join (void) {
-  qucs::vector * yroot, * xroot, * next = NULL;
-  /* go through each vector */
-  for (yroot = touchstone_vector; yroot != NULL; yroot = next) {
-    /* go through each trailing vector */
-    next = (qucs::vector *) yroot->getNext ();
-    for (xroot = next; xroot != NULL; xroot = next) {
-      next = (qucs::vector *) xroot->getNext ();
-      /* append xroot vector to yroot vector (even no. of values) ? */
-      if ((xroot->getSize () & 1) == 0) {
-	/* yes, delete the xroot vector and adjust list */
-	yroot->add (xroot);
-	yroot->setNext (next);
-	delete xroot;
-      }
-      else {
-	/* no, handle next vectors */
-	next = xroot;
-	break;
-      }
-    }
-  }
-}
+/* matrix formats of Touchstone 2.0 files */
+enum touchstone_format_t {
+  TOUCHSTONE_FULL,
+  TOUCHSTONE_LOWER,
+  TOUCHSTONE_UPPER
+};
+
+/* State of the Touchstone reader.  The file is read straight from
+   memory, number by number. */
+struct touchstone_reader_t {
+  const char * p;     // current position
+  const char * end;   // end of the file contents
+  int line;           // current line number
+};
+
+/* Additional properties of the file which are not part of the option
+   line. */
+struct touchstone_header_t {
+  int version;        // file format version (1 or 2)
+  int order;          // '12_21' data order of 2-ports ?
+  int frequencies;    // number of frequencies, -1 if unknown
+  int noises;         // number of noise frequencies, -1 if unknown
+  int format;         // matrix format
+  qucs::vector * ref; // per-port reference impedances
+};
+
+/* The function checks the identifiers of the option line.  It returns
+   the number of errors found. */
+static int touchstone_options_check (void) {
+  int i, n, errors = 0;
 
-/* This subroutine checks the size and overall conformance of each
-   touchstone matrix at a given frequency derived from the first
-   matrix.  The function return zero on success and non-zero
-   otherwise. */
-static int touchstone_vector_check (void) {
-  qucs::vector * root = touchstone_vector, * next;
-  int even = 0, errors = 0, size = root->getSize (), noise = 0, lines = 1;
-  nr_double_t f = real (root->get (0));
-
-  /* check size of first line */
-  if ((size & 1) == 0) {
-    logprint (LOG_ERROR, "checker error, first data line has %d (even) "
-	      "values\n", size);
+  /* first checking the options */
+  if (touchstone_idents->length () > 3) {
+    logprint (LOG_ERROR, "checker error, found %d options\n",
+	      touchstone_idents->length ());
     errors++;
-    even = 1;
   }
-  /* first line determines the number of expected ports */
-  touchstone_options.ports = (int) std::sqrt ((size - 1) / 2.0);
-
-  /* check first frequency value */
-  if (f < 0.0) {
-    logprint (LOG_ERROR, "checker error, negative data frequency "
-	      "value %g\n", f);
-    errors++;
+  /* touchstone is case insensitive */
+  for (i = 0; i < touchstone_idents->length (); i++) {
+    for (char * p = touchstone_idents->get (i); *p != '\0'; p++)
+      *p = tolower (*p);
   }
-
-  /* go through each vector */
-  for (root = (qucs::vector *) root->getNext (); root != NULL; root = next) {
-    next = (qucs::vector *) root->getNext ();
-    nr_double_t freq = real (root->get (0));
-
-    /* check increasing frequency value */
-    if (f >= freq) {
-      if (!noise) {
-	/* determined start of noise parameters */
-	noise++;
-	size = 5;
-	if (freq < 0.0) {
-	  logprint (LOG_ERROR, "checker error, negative noise frequency "
-		    "value %g\n", freq);
-	  errors++;
-	}
-      }
-      else {
-	logprint (LOG_ERROR, "checker error, %s line (f = %g) has "
-		  "decreasing frequency value\n", noise ? "noise" : "data",
-		  freq);
-	errors++;
-      }
+  /* check duplicate options */
+  for (i = 0; i < touchstone_idents->length (); i++) {
+    char * str = touchstone_idents->get (i);
+    if ((n = touchstone_idents->contains (str)) != 1) {
+      logprint (LOG_ERROR, "checker error, option `%s' occurred %dx\n",
+		str, n);
+      errors++;
     }
-    f = freq;
-
-    /* check size of vector */
-    if (!even && root->getSize () != size) {
-      logprint (LOG_ERROR, "checker error, %s line (f = %g) has %d values, "
-		"%d required\n", noise ? "noise" : "data",
-		real (root->get (0)), root->getSize (), size);
+  }
+  /* check valid options */
+  for (i = 0; i < touchstone_idents->length (); i++) {
+    char * str = touchstone_idents->get (i);
+    int valid = 0;
+    for (int v = 0; touchstone_valid_options[v] != NULL; v++) {
+      if (!strcmp (touchstone_valid_options[v], str))
+	valid = 1;
+    }
+    if (!valid) {
+      logprint (LOG_ERROR, "checker error, invalid option `%s'\n", str);
       errors++;
     }
-
-    /* count number of data lines without noise entries */
-    if (!noise) lines++;
   }
-  touchstone_options.noise = noise;
-  touchstone_options.lines = lines;
   return errors;
 }
 
@@ -214,16 +186,343 @@ static char * touchstone_create_set (int r, int c) {
   return text;
 }
 
-/* The function actually creates the resulting dataset. */
-static void touchstone_create (void) {
-  qucs::vector * f, * v, * root, * next, * nf = NULL;
-  int ports = touchstone_options.ports, n;
-  nr_complex_t val;
+// Skips spaces and comments up to the end of the current line.
+static void touchstone_skip (touchstone_reader_t & r) {
+  while (r.p < r.end) {
+    if (isspace (*r.p) && *r.p != '\n' && *r.p != '\r') {
+      r.p++;
+    }
+    else if (*r.p == '!') {
+      while (r.p < r.end && *r.p != '\n' && *r.p != '\r') r.p++;
+    }
+    else break;
+  }
+}
+
+/* Consumes the end of the current line.  Returns non-zero if there
+   was one. */
+static int touchstone_eol (touchstone_reader_t & r) {
+  if (r.p < r.end && (*r.p == '\n' || *r.p == '\r')) {
+    if (*r.p == '\r' && r.p + 1 < r.end && r.p[1] == '\n') r.p++;
+    r.p++;
+    r.line++;
+    return 1;
+  }
+  return 0;
+}
+
+/* Skips empty lines and comments.  Returns zero at the end of the
+   file, otherwise the reader points to the next item. */
+static int touchstone_next (touchstone_reader_t & r) {
+  do touchstone_skip (r); while (touchstone_eol (r));
+  return r.p < r.end;
+}
+
+// Returns non-zero if the given character can be part of a number.
+static int touchstone_isnum (char c) {
+  return isdigit (c) || c == '.' || c == '+' || c == '-' ||
+    c == 'e' || c == 'E';
+}
+
+/* Reads the number at the current position.  Returns zero on success
+   and non-zero (after emitting an error message) otherwise. */
+static int touchstone_number (touchstone_reader_t & r, nr_double_t & f) {
+  char buf[64], * end;
+  int n = 0;
+  while (r.p < r.end && n < 63 && touchstone_isnum (*r.p)) buf[n++] = *r.p++;
+  buf[n] = '\0';
+  f = strtod (buf, &end);
+  if (n == 0 || *end != '\0' ||
+      (r.p < r.end && !isspace (*r.p) && *r.p != '!')) {
+    while (r.p < r.end && n < 63 && !isspace (*r.p)) buf[n++] = *r.p++;
+    buf[n] = '\0';
+    logprint (LOG_ERROR, "line %d: syntax error, invalid number `%s'\n",
+	      r.line, buf);
+    return -1;
+  }
+  touchstone_skip (r);
+  return 0;
+}
+
+/* Reads the next number of a data record which may continue on the
+   following lines. */
+static int touchstone_value (touchstone_reader_t & r, nr_double_t & f) {
+  if (r.p < r.end && (*r.p == '\n' || *r.p == '\r')) touchstone_next (r);
+  if (r.p >= r.end || *r.p == '[') {
+    logprint (LOG_ERROR, "line %d: syntax error, incomplete data line\n",
+	      r.line);
+    return -1;
+  }
+  return touchstone_number (r, f);
+}
+
+/* Reads an identifier (or keyword argument) and returns it in lower
+   case in the given buffer. */
+static void touchstone_word (touchstone_reader_t & r, char * buf, int len) {
+  int n = 0;
+  while (r.p < r.end && !isspace (*r.p) && *r.p != '!' && *r.p != ']') {
+    if (n < len - 1) buf[n++] = tolower (*r.p);
+    r.p++;
+  }
+  buf[n] = '\0';
+  touchstone_skip (r);
+}
+
+/* Ensures that nothing but a comment follows on the current line. */
+static int touchstone_endline (touchstone_reader_t & r) {
+  touchstone_skip (r);
+  if (r.p < r.end && !touchstone_eol (r)) {
+    logprint (LOG_ERROR, "line %d: syntax error, unexpected `%c'\n",
+	      r.line, *r.p);
+    return -1;
+  }
+  return 0;
+}
+
+/* Reads the option line, the leading '#' has been consumed already. */
+static int touchstone_optionline (touchstone_reader_t & r) {
+  char buf[64];
+  if (touchstone_idents != NULL) {
+    logprint (LOG_ERROR, "line %d: syntax error, duplicate option line\n",
+	      r.line);
+    return -1;
+  }
+  touchstone_idents = new strlist ();
+  touchstone_options.resistance = 50.0;
+  touchstone_skip (r);
+  while (r.p < r.end && *r.p != '\n' && *r.p != '\r') {
+    touchstone_word (r, buf, sizeof (buf));
+    if (!strcmp (buf, "r")) {
+      if (touchstone_number (r, touchstone_options.resistance) != 0)
+	return -1;
+    }
+    else if (buf[0] != '\0') {
+      touchstone_idents->add (buf);
+    }
+    else {
+      logprint (LOG_ERROR, "line %d: syntax error, unexpected `%c'\n",
+		r.line, *r.p);
+      return -1;
+    }
+  }
+  return touchstone_endline (r);
+}
+
+/* Reads a Touchstone 2.0 keyword, the leading '[' has been consumed
+   already.  The keyword is returned in lower case, with single
+   spaces between its words. */
+static int touchstone_keyword (touchstone_reader_t & r, char * buf, int len) {
+  int n = 0;
+  while (r.p < r.end && *r.p != ']' && *r.p != '\n' && *r.p != '\r') {
+    if (isspace (*r.p)) {
+      if (n > 0 && buf[n - 1] != ' ' && n < len - 1) buf[n++] = ' ';
+    }
+    else if (n < len - 1) buf[n++] = tolower (*r.p);
+    r.p++;
+  }
+  if (n > 0 && buf[n - 1] == ' ') n--;
+  buf[n] = '\0';
+  if (r.p >= r.end || *r.p != ']') {
+    logprint (LOG_ERROR, "line %d: syntax error, missing `]'\n", r.line);
+    return -1;
+  }
+  r.p++;
+  touchstone_skip (r);
+  return 0;
+}
+
+/* Reads an integer argument of a keyword. */
+static int touchstone_integer (touchstone_reader_t & r, int & i) {
+  nr_double_t f;
+  if (touchstone_number (r, f) != 0) return -1;
+  i = (int) f;
+  if (i != f || i < 0) {
+    logprint (LOG_ERROR, "line %d: syntax error, invalid count `%g'\n",
+	      r.line, f);
+    return -1;
+  }
+  return 0;
+}
+
+/* Reads the lines up to the network data.  These are comments, the
+   option line and, in Touchstone 2.0 files, the keywords describing
+   the data. */
+static int touchstone_header (touchstone_reader_t & r,
+			      touchstone_header_t & h) {
+  char key[64], arg[64];
+  while (touchstone_next (r)) {
+    if (*r.p == '#') {
+      r.p++;
+      if (touchstone_optionline (r) != 0) return -1;
+      // Touchstone 1.x data follows right away
+      if (h.version == 1) return 0;
+      continue;
+    }
+    if (*r.p != '[') {
+      if (h.version == 1 && touchstone_idents == NULL) {
+	logprint (LOG_ERROR, "line %d: syntax error, option line "
+		  "expected\n", r.line);
+      } else {
+	logprint (LOG_ERROR, "line %d: syntax error, `[Network Data]' "
+		  "expected\n", r.line);
+      }
+      return -1;
+    }
+    r.p++;
+    if (touchstone_keyword (r, key, sizeof (key)) != 0) return -1;
+
+    if (!strcmp (key, "version")) {
+      nr_double_t v;
+      if (touchstone_number (r, v) != 0) return -1;
+      if (v < 2.0 || v >= 3.0) {
+	logprint (LOG_ERROR, "line %d: unsupported Touchstone version "
+		  "%g\n", r.line, v);
+	return -1;
+      }
+      h.version = 2;
+    }
+    else if (h.version == 1) {
+      logprint (LOG_ERROR, "line %d: syntax error, `[Version]' expected\n",
+		r.line);
+      return -1;
+    }
+    else if (!strcmp (key, "number of ports")) {
+      if (touchstone_integer (r, touchstone_options.ports) != 0) return -1;
+    }
+    else if (!strcmp (key, "two-port data order")) {
+      touchstone_word (r, arg, sizeof (arg));
+      if (!strcmp (arg, "12_21")) h.order = 1;
+      else if (!strcmp (arg, "21_12")) h.order = 0;
+      else {
+	logprint (LOG_ERROR, "line %d: invalid two-port data order `%s'\n",
+		  r.line, arg);
+	return -1;
+      }
+    }
+    else if (!strcmp (key, "number of frequencies")) {
+      if (touchstone_integer (r, h.frequencies) != 0) return -1;
+    }
+    else if (!strcmp (key, "number of noise frequencies")) {
+      if (touchstone_integer (r, h.noises) != 0) return -1;
+    }
+    else if (!strcmp (key, "reference")) {
+      nr_double_t z;
+      if (touchstone_options.ports <= 0) {
+	logprint (LOG_ERROR, "line %d: `[Reference]' requires "
+		  "`[Number of Ports]'\n", r.line);
+	return -1;
+      }
+      delete h.ref;
+      h.ref = new qucs::vector ();
+      for (int i = 0; i < touchstone_options.ports; i++) {
+	if (touchstone_value (r, z) != 0) return -1;
+	h.ref->add (z);
+      }
+    }
+    else if (!strcmp (key, "matrix format")) {
+      touchstone_word (r, arg, sizeof (arg));
+      if (!strcmp (arg, "full")) h.format = TOUCHSTONE_FULL;
+      else if (!strcmp (arg, "lower")) h.format = TOUCHSTONE_LOWER;
+      else if (!strcmp (arg, "upper")) h.format = TOUCHSTONE_UPPER;
+      else {
+	logprint (LOG_ERROR, "line %d: invalid matrix format `%s'\n",
+		  r.line, arg);
+	return -1;
+      }
+    }
+    else if (!strcmp (key, "begin information")) {
+      // skip everything up to the end of the information section
+      for (;;) {
+	while (r.p < r.end && *r.p != '[') r.p++, touchstone_eol (r);
+	if (r.p >= r.end) {
+	  logprint (LOG_ERROR, "line %d: `[End Information]' missing\n",
+		    r.line);
+	  return -1;
+	}
+	r.p++;
+	if (touchstone_keyword (r, key, sizeof (key)) != 0) return -1;
+	if (!strcmp (key, "end information")) break;
+      }
+    }
+    else if (!strcmp (key, "network data")) {
+      if (touchstone_idents == NULL) {
+	logprint (LOG_ERROR, "line %d: option line missing\n", r.line);
+	return -1;
+      }
+      if (touchstone_options.ports <= 0) {
+	logprint (LOG_ERROR, "line %d: `[Number of Ports]' missing\n",
+		  r.line);
+	return -1;
+      }
+      return touchstone_endline (r);
+    }
+    else if (!strcmp (key, "mixed-mode order")) {
+      logprint (LOG_ERROR, "line %d: mixed-mode parameters are not "
+		"supported\n", r.line);
+      return -1;
+    }
+    else {
+      logprint (LOG_ERROR, "line %d: unknown keyword `[%s]'\n", r.line, key);
+      return -1;
+    }
+    if (touchstone_endline (r) != 0) return -1;
+  }
+  logprint (LOG_ERROR, "checker error, no data in touchstone file\n");
+  return -1;
+}
+
+/* Determines the number of ports of a Touchstone 1.x file from the
+   first data record without actually reading it.  The record starts
+   with an odd number of values in its first line and continues in
+   lines with an even number of values.  Returns the length of the
+   record in bytes, or -1 on errors. */
+static int touchstone_ports (touchstone_reader_t & r) {
+  touchstone_reader_t s = r;
+  const char * start = r.p, * last = r.p;
+  int size = 0, n;
+  while (touchstone_next (s)) {
+    for (n = 0; s.p < s.end && *s.p != '\n' && *s.p != '\r'; n++) {
+      while (s.p < s.end && !isspace (*s.p) && *s.p != '!') s.p++;
+      touchstone_skip (s);
+    }
+    if (size > 0 && (n & 1)) break;
+    size += n;
+    last = s.p;
+  }
+  int ports = (int) std::sqrt ((size - 1) / 2.0);
+  if ((size & 1) == 0 || 2 * ports * ports + 1 != size) {
+    logprint (LOG_ERROR, "checker error, first data line has %d values\n",
+	      size);
+    return -1;
+  }
+  touchstone_options.ports = ports;
+  return last - start;
+}
+
+/* The function converts the given pair of values into a complex number
+   according to the data format. */
+static nr_complex_t touchstone_pair (nr_double_t a, nr_double_t b) {
+  switch (touchstone_options.format[0]) {
+  case 'R':
+    return nr_complex_t (a, b);
+  case 'M':
+    return qucs::polar (a, deg2rad (b));
+  default:
+    return qucs::polar (std::pow (10.0, a / 20.0), deg2rad (b));
+  }
+}
+
+/* The function creates the vectors of the resulting dataset.  The
+   variable vectors are returned in the given array. */
+static void touchstone_create (qucs::vector ** var, int n) {
+  qucs::vector * f, * v;
+  int ports = touchstone_options.ports;
   strlist * s;
 
   /* create dataset and frequency vector */
   touchstone_result = new dataset ();
   f = new qucs::vector ("frequency");
+  if (n > 0) f->reserve (n);
   touchstone_result->appendDependency (f);
   s = new strlist ();
   s->add (f->getName ());
@@ -233,97 +532,224 @@ static void touchstone_create (void) {
       v = new qucs::vector ();
       v->setName (touchstone_create_set (r, c));
       v->setDependencies (new strlist (*s));
+      if (n > 0) v->reserve (n);
       touchstone_result->appendVariable (v);
+      var[r * ports + c] = v;
     }
   }
   delete s;
+}
 
-  /* create noise vectors if necessary */
-  if (touchstone_options.noise) {
-    nf = new qucs::vector ("nfreq");
-    touchstone_result->appendDependency (nf);
-    s = new strlist ();
-    s->add (nf->getName ());
-    /* append noise parameters to dataset */
-    v = new qucs::vector ("Fmin");
-    v->setDependencies (new strlist (*s));
-    touchstone_result->appendVariable (v);
-    v = new qucs::vector ("Sopt");
-    v->setDependencies (new strlist (*s));
-    touchstone_result->appendVariable (v);
-    v = new qucs::vector ("Rn");
-    v->setDependencies (new strlist (*s));
-    touchstone_result->appendVariable (v);
-    delete s;
-  }
-
-  /* go through each vector */
-  for (n = 0, root = touchstone_vector; root != NULL; root = next, n++) {
-    next = (qucs::vector *) root->getNext ();
-    // handle data lines
-    if (n < touchstone_options.lines) {
-      /* fill frequency vector */
-      f->add (real (root->get (0)) * touchstone_options.factor);
-      /* go through each variable vector */
-      v = touchstone_result->getVariables ();
-      for (int i = 0; i < ports; i++) {
-	for (int j = 0; j < ports; j++) {
-	  int pos = 1 + j * 2 + i * 2 * ports;
-	  /* handle special case for 2-port touchstone data, '21' data
-	     precedes the '12' data */
-	  if (ports == 2 && i != j) {
-	    pos = 1 + i * 2 + j * 2 * ports;
-	  }
-	  /* depending on the touchstone data format */
-	  if (!strcmp (touchstone_options.format, "RI")) {
-	    val = nr_complex_t (real (root->get (pos + 0)),
-			real (root->get (pos + 1)));
-	  }
-	  else if (!strcmp (touchstone_options.format, "MA")) {
-	    val = qucs::polar (real (root->get (pos + 0)),
-			 deg2rad (real (root->get (pos + 1))));
-	  }
-	  else if (!strcmp (touchstone_options.format, "dB")) {
-	    val = qucs::polar (std::pow (10.0, real (root->get (pos + 0)) / 20.0),
-			 deg2rad (real (root->get (pos + 1))));
-	  }
-	  v->add (val);
-	  v = (qucs::vector *) v->getNext ();
+/* Creates the noise vectors of the resulting dataset. */
+static void touchstone_create_noise (int n) {
+  qucs::vector * nf, * v;
+  strlist * s;
+  nf = new qucs::vector ("nfreq");
+  if (n > 0) nf->reserve (n);
+  touchstone_result->appendDependency (nf);
+  s = new strlist ();
+  s->add (nf->getName ());
+  /* append noise parameters to dataset */
+  v = new qucs::vector ("Fmin");
+  v->setDependencies (new strlist (*s));
+  touchstone_result->appendVariable (v);
+  v = new qucs::vector ("Sopt");
+  v->setDependencies (new strlist (*s));
+  touchstone_result->appendVariable (v);
+  v = new qucs::vector ("Rn");
+  v->setDependencies (new strlist (*s));
+  touchstone_result->appendVariable (v);
+  delete s;
+}
+
+/* Reads the noise records which follow the network data of 2-ports.
+   The first value of the first record has already been read. */
+static int touchstone_noise (touchstone_reader_t & r, nr_double_t freq,
+			     int n) {
+  nr_double_t val[4], prev = -1;
+  qucs::vector * nf, * fmin, * sopt, * rn;
+  nr_complex_t z;
+
+  if (touchstone_options.ports != 2) {
+    logprint (LOG_ERROR, "checker error, noise parameters for %d-ports not "
+	      "defined\n", touchstone_options.ports);
+    return -1;
+  }
+  touchstone_create_noise (n);
+  nf = touchstone_result->findDependency ("nfreq");
+  fmin = touchstone_result->findVariable ("Fmin");
+  sopt = touchstone_result->findVariable ("Sopt");
+  rn = touchstone_result->findVariable ("Rn");
+
+  for (;;) {
+    if (freq < 0.0) {
+      logprint (LOG_ERROR, "checker error, negative noise frequency "
+		"value %g\n", freq);
+      return -1;
+    }
+    if (freq <= prev) {
+      logprint (LOG_ERROR, "checker error, noise line (f = %g) has "
+		"decreasing frequency value\n", freq);
+      return -1;
+    }
+    for (int i = 0; i < 4; i++)
+      if (touchstone_value (r, val[i]) != 0) return -1;
+    if (touchstone_endline (r) != 0) return -1;
+
+    /* fill frequency vector */
+    nf->add (freq * touchstone_options.factor);
+    /* fill minimum noise figure vector */
+    fmin->add (std::pow (10.0, val[0] / 10.0));
+    /* fill optimal noise reflexion coefficient vector */
+    z = qucs::polar (val[1], deg2rad (val[2]));
+    if (ZREF != touchstone_options.resistance) {
+      // re-normalize reflexion coefficient if necessary
+      nr_double_t g = (ZREF - touchstone_options.resistance) /
+	(ZREF + touchstone_options.resistance);
+      z = (z - g) / (1.0 - g * z);
+    }
+    sopt->add (z);
+    /* fill equivalent noise resistance vector */
+    rn->add (val[3] * touchstone_options.resistance);
+
+    prev = freq;
+    if (!touchstone_next (r) || *r.p == '[') break;
+    if (touchstone_number (r, freq) != 0) return -1;
+  }
+  touchstone_options.noise = nf->getSize ();
+  return 0;
+}
+
+/* Reads the network data records (and the noise records if there are
+   any) directly into the vectors of the resulting dataset. */
+static int touchstone_data (touchstone_reader_t & r,
+			    touchstone_header_t & h, int estimate) {
+  int ports = touchstone_options.ports, i, j, k, lines = 0;
+  int entries = h.format == TOUCHSTONE_FULL ?
+    ports * ports : ports * (ports + 1) / 2;
+  qucs::vector ** var = new qucs::vector * [ports * ports];
+  qucs::vector * f;
+  nr_double_t freq, prev = -1, a, b;
+  nr_complex_t val;
+  int errors = 0;
+
+  touchstone_create (var, h.frequencies >= 0 ? h.frequencies : estimate);
+  f = touchstone_result->getDependencies ();
+
+  while (!errors && touchstone_next (r)) {
+    // Touchstone 2.0 keywords following the network data
+    if (*r.p == '[' && h.version == 2) {
+      char key[64];
+      r.p++;
+      if (touchstone_keyword (r, key, sizeof (key)) != 0 ||
+	  touchstone_endline (r) != 0) {
+	errors++;
+      }
+      else if (!strcmp (key, "end")) {
+	break;
+      }
+      else if (!strcmp (key, "noise data")) {
+	if (!touchstone_next (r) || *r.p == '[') {
+	  logprint (LOG_ERROR, "line %d: no noise data\n", r.line);
+	  errors++;
+	}
+	else if (touchstone_number (r, freq) != 0 ||
+		 touchstone_noise (r, freq, h.noises) != 0) {
+	  errors++;
 	}
       }
+      else {
+	logprint (LOG_ERROR, "line %d: unexpected keyword `[%s]'\n",
+		  r.line, key);
+	errors++;
+      }
+      continue;
+    }
+
+    if (touchstone_number (r, freq) != 0) {
+      errors++;
+      break;
+    }
+    /* check increasing frequency value */
+    if (lines == 0 && freq < 0.0) {
+      logprint (LOG_ERROR, "checker error, negative data frequency "
+		"value %g\n", freq);
+      errors++;
+      break;
     }
-    // handle noise lines
-    else if (touchstone_options.noise) {
-      /* fill frequency vector */
-      nf->add (real (root->get (0)) * touchstone_options.factor);
-      /* fill minimum noise figure vector */
-      v = touchstone_result->findVariable ("Fmin");
-      val = std::pow (10.0, real (root->get (1)) / 10.0);
-      v->add (val);
-      /* fill optimal noise reflexion coefficient vector */
-      v = touchstone_result->findVariable ("Sopt");
-      val = qucs::polar (real (root->get (2)), deg2rad (real (root->get (3))));
-      if (ZREF != touchstone_options.resistance) {
-	// re-normalize reflexion coefficient if necessary
-	nr_double_t r = (ZREF - touchstone_options.resistance) /
-	  (ZREF + touchstone_options.resistance);
-	val = (val - r) / (1.0 - r * val);
+    if (lines > 0 && freq <= prev) {
+      // noise parameters follow the network data in Touchstone 1.x
+      if (h.version == 1) {
+	errors += touchstone_noise (r, freq, estimate) ? 1 : 0;
+	break;
+      }
+      logprint (LOG_ERROR, "checker error, data line (f = %g) has "
+		"decreasing frequency value\n", freq);
+      errors++;
+      break;
+    }
+    prev = freq;
+
+    /* fill frequency vector */
+    f->add (freq * touchstone_options.factor);
+    /* go through the matrix entries */
+    for (k = i = 0; i < ports && !errors; i++) {
+      int start = h.format == TOUCHSTONE_UPPER ? i : 0;
+      int stop = h.format == TOUCHSTONE_LOWER ? i + 1 : ports;
+      for (j = start; j < stop; j++, k++) {
+	if (touchstone_value (r, a) != 0 || touchstone_value (r, b) != 0) {
+	  errors++;
+	  break;
+	}
+	val = touchstone_pair (a, b);
+	/* handle special case for 2-port touchstone data, '21' data
+	   precedes the '12' data */
+	if (ports == 2 && i != j && !h.order) {
+	  var[j * ports + i]->add (val);
+	}
+	else {
+	  var[i * ports + j]->add (val);
+	}
+	if (i != j && h.format != TOUCHSTONE_FULL) {
+	  var[j * ports + i]->add (val);
+	}
       }
-      v->add (val);
-      /* fill equivalent noise resistance vector */
-      v = touchstone_result->findVariable ("Rn");
-      val = real (root->get (4)) * touchstone_options.resistance;
-      v->add (val);
     }
+    if (!errors && k == entries && touchstone_endline (r) != 0) {
+      logprint (LOG_ERROR, "line %d: data line (f = %g) has more than %d "
+		"values\n", r.line, freq, 1 + 2 * entries);
+      errors++;
+    }
+    lines++;
   }
+
+  if (!errors && lines == 0) {
+    logprint (LOG_ERROR, "checker error, no data in touchstone file\n");
+    errors++;
+  }
+  if (!errors && h.frequencies >= 0 && lines != h.frequencies) {
+    logprint (LOG_ERROR, "checker error, %d frequencies found, %d "
+	      "expected\n", lines, h.frequencies);
+    errors++;
+  }
+  if (!errors && h.noises >= 0 && touchstone_options.noise != h.noises) {
+    logprint (LOG_ERROR, "checker error, %d noise frequencies found, %d "
+	      "expected\n", touchstone_options.noise, h.noises);
+    errors++;
+  }
+  touchstone_options.lines = lines;
+  delete[] var;
+  return errors;
 }
 
 /* The function re-normalizes S-parameters to the internal reference
-   impedance 50 Ohms. */
-static void touchstone_normalize_sp (void) {
+   impedance 50 Ohms.  The given vector contains the reference
+   impedances of the ports. */
+static void touchstone_normalize_sp (qucs::vector * zref) {
   int ports = touchstone_options.ports;
   qucs::vector * v = touchstone_result->getVariables ();
   int i, j, n, len = v->getSize ();
+  qucs::vector z0 (ports, ZREF);
   matrix s = matrix (ports);
 
   // go through each matrix entry
@@ -337,7 +763,7 @@ static void touchstone_normalize_sp (void) {
       }
     }
     // convert the temporary matrix
-    s = stos (s, touchstone_options.resistance, ZREF);
+    s = stos (s, *zref, z0);
     v = touchstone_result->getVariables ();
     // restore the results in the entries
     for (i = 0; i < ports; i++) {
@@ -351,16 +777,27 @@ static void touchstone_normalize_sp (void) {
 
 /* The function transforms the reference impedance given in the
    touchstone file to the internal reference impedance 50 Ohms. */
-static void touchstone_normalize (void) {
+static void touchstone_normalize (touchstone_header_t & h) {
   qucs::vector * v = touchstone_result->getVariables ();
   int ports = touchstone_options.ports;
 
   // transform S-parameters if necessary
   if (touchstone_options.parameter == 'S') {
-    if (touchstone_options.resistance != ZREF)
-      touchstone_normalize_sp ();
+    qucs::vector * zref = h.ref;
+    if (zref == NULL)
+      zref = new qucs::vector (ports, touchstone_options.resistance);
+    for (int i = 0; i < ports; i++) {
+      if (real (zref->get (i)) != ZREF) {
+	touchstone_normalize_sp (zref);
+	break;
+      }
+    }
+    if (zref != h.ref) delete zref;
     return;
   }
+  // other parameters are not normalized in Touchstone 2.0 files
+  if (h.version == 2) return;
+
   // transform any other X-parameters
   for (int i = 1; i <= ports; i++) {
     for (int j = 1; j <= ports; j++) {
@@ -391,17 +828,10 @@ static void touchstone_normalize (void) {
 
 /* Removes temporary data items from memory if necessary. */
 static void touchstone_finalize (void) {
-  qucs::vector * root, * next;
-  for (root = touchstone_vector; root != NULL; root = next) {
-    next = (qucs::vector *) root->getNext ();
-    delete root;
-  }
-  touchstone_vector = NULL;
   if (touchstone_idents != NULL) {
     delete touchstone_idents;
     touchstone_idents = NULL;
   }
-  touchstone_lex_destroy ();
   /* apply default values again */
   touchstone_options.unit = "GHz";
   touchstone_options.parameter = 'S';
@@ -413,85 +843,77 @@ static void touchstone_finalize (void) {
   touchstone_options.lines = 0;
 }
 
+/* This function reads the given Touchstone file (version 1.x or 2.0)
+   into a new dataset available in touchstone_result.  The file is
+   read straight from memory and the values go directly into the
+   vectors of the dataset.  It returns zero on success or non-zero if
+   the file contained errors. */
+int touchstone_read (const char * file) {
+  touchstone_header_t h = { 1, -1, -1, -1, TOUCHSTONE_FULL, NULL };
+  touchstone_reader_t r;
+  mappedfile map;
+  int errors = 0, estimate = 16;
 
-/* This function is the checker routine for a parsed touchstone.  It
-   returns zero on success or non-zero if the parsed touchstone
-   contained errors. */
-int touchstone_check (void) {
-
-  int i, n, errors = 0;
+  touchstone_result = NULL;
+  if (map.open (file) != 0) return -1;
+  r.p = map.getData ();
+  r.end = r.p + map.getSize ();
+  r.line = 1;
 
-  /* first checking the options */
-  if (touchstone_idents->length () > 3) {
-    logprint (LOG_ERROR, "checker error, found %d options\n",
-	      touchstone_idents->length ());
+  /* read and evaluate the option line and keywords */
+  if (touchstone_header (r, h) != 0) {
     errors++;
   }
-  /* touchstone is case insensitive */
-  for (i = 0; i < touchstone_idents->length (); i++) {
-    for (char * p = touchstone_idents->get (i); *p != '\0'; p++)
-      *p = tolower (*p);
+  else {
+    errors += touchstone_options_check ();
+    touchstone_options_eval ();
   }
-  /* check duplicate options */
-  for (i = 0; i < touchstone_idents->length (); i++) {
-    char * str = touchstone_idents->get (i);
-    if ((n = touchstone_idents->contains (str)) != 1) {
-      logprint (LOG_ERROR, "checker error, option `%s' occurred %dx\n",
-		str, n);
+  if (!errors && h.version == 1) {
+    int len;
+    if (!touchstone_next (r)) {
+      logprint (LOG_ERROR, "checker error, no data in touchstone file\n");
       errors++;
     }
-  }
-  /* check valid options */
-  for (i = 0; i < touchstone_idents->length (); i++) {
-    char * str = touchstone_idents->get (i);
-    int valid = 0;
-    for (int v = 0; touchstone_valid_options[v] != NULL; v++) {
-      if (!strcmp (touchstone_valid_options[v], str))
-	valid = 1;
-    }
-    if (!valid) {
-      logprint (LOG_ERROR, "checker error, invalid option `%s'\n", str);
+    else if ((len = touchstone_ports (r)) < 0) {
       errors++;
     }
+    else {
+      /* estimate the number of frequencies from the file size */
+      estimate = (r.end - r.p) / (len + 1) + 1;
+    }
   }
 
-  /* evaluate the option line and put values into touchstone_options
-     structure */
-  touchstone_options_eval ();
-
-  if (touchstone_vector == NULL) {
-    logprint (LOG_ERROR, "checker error, no data in touchstone file\n");
+  /* check validity of ports and parameters */
+  if (!errors && (touchstone_options.parameter == 'G' ||
+		  touchstone_options.parameter == 'H') &&
+      touchstone_options.ports != 2) {
+    logprint (LOG_ERROR, "checker error, %c-parameters for %d-ports not "
+	      "defined\n", touchstone_options.parameter,
+	      touchstone_options.ports);
     errors++;
   }
-  else {
-    /* join vectors on multiple lines */
-    touchstone_join ();
-
-    /* check each vector */
-    errors += touchstone_vector_check ();
-
-    /* check validity of ports and parameters */
-    if ((touchstone_options.parameter == 'G' ||
-	 touchstone_options.parameter == 'H') &&
-	touchstone_options.ports != 2) {
-      logprint (LOG_ERROR, "checker error, %c-parameters for %d-ports not "
-		"defined\n", touchstone_options.parameter,
-		touchstone_options.ports);
-      errors++;
-    }
-
-    /* check noise parameter compatibility */
-    if (touchstone_options.noise && touchstone_options.ports != 2) {
-      logprint (LOG_ERROR, "checker error, noise parameters for %d-ports not "
-		"defined\n", touchstone_options.ports);
-      errors++;
+  if (!errors && touchstone_options.ports == 2 && h.order < 0) {
+    if (h.version == 2 && h.format == TOUCHSTONE_FULL) {
+      logprint (LOG_ERROR, "WARNING: `[Two-Port Data Order]' missing, "
+		"assuming 21_12\n");
     }
+    h.order = 0;
+  }
+  if (h.format != TOUCHSTONE_FULL) {
+    // matrix formats other than 'Full' are mirrored, keep the order
+    h.order = 1;
   }
 
-  /* finally create a dataset */
+  /* finally read the data */
   if (!errors) {
-    touchstone_create ();
-    touchstone_normalize ();
+    errors += touchstone_data (r, h, estimate);
+  }
+  if (!errors) {
+    touchstone_normalize (h);
+  }
+  else if (touchstone_result != NULL) {
+    delete touchstone_result;
+    touchstone_result = NULL;
   }
 
 #if DEBUG
@@ -504,27 +926,24 @@ int touchstone_check (void) {
 #endif
 
   /* free temporary memory */
+  delete h.ref;
   touchstone_finalize ();
 
   return errors ? -1 : 0;
 }
 
-// Destroys data used by the Touchstone file lexer, parser and checker.
+// Destroys data used by the Touchstone file reader.
 void touchstone_destroy (void) {
   if (touchstone_result != NULL) {
     // delete associated dataset
     delete touchstone_result;
     touchstone_result = NULL;
   }
-  if (touchstone_vector != NULL) {
-    touchstone_finalize ();
-    touchstone_vector = NULL;
-  }
+  touchstone_finalize ();
 }
 
-// Initializes the Touchstone file checker.
+// Initializes the Touchstone file reader.
 void touchstone_init (void) {
   touchstone_result = NULL;
-  touchstone_vector = NULL;
   touchstone_idents = NULL;
 }
@@ -40,13 +40,9 @@
 // forward declarations
 namespace qucs {
   class dataset;
-  class vector;
-  class strlist;
 }
 
 extern qucs::dataset * touchstone_result;
-extern qucs::vector  * touchstone_vector;
-extern qucs::strlist * touchstone_idents;
 
 struct touchstone_t {
   const char * unit;
@@ -59,22 +55,13 @@ struct touchstone_t {
   int lines;
 };
 
-/* Externalize variables used by the scanner and parser. */
-extern int touchstone_lineno;
-extern FILE * touchstone_in;
-void touchstone_restart (FILE *);
-
 __BEGIN_DECLS
 
-/* Externalize variables used by the scanner and parser. */
+/* Options of the file being read. */
 extern struct touchstone_t touchstone_options;
 
-/* Available functions of the checker. */
-int touchstone_parse (void);
-int touchstone_error (const char *);
-int touchstone_lex (void);
-int touchstone_lex_destroy (void);
-int touchstone_check (void);
+/* Available functions of the reader. */
+int touchstone_read (const char *);
 void touchstone_init (void);
 void touchstone_destroy (void);
 
@@ -41,6 +41,8 @@
 #include "tvector.h"
 #include "history.h"
 #include "circuit.h"
+#include "net.h"
+#include "arena.h"
 #include "microstrip/substrate.h"
 #include "operatingpoint.h"
 #include "characteristic.h"
@@ -60,6 +62,7 @@ circuit::circuit () : object (), integrator () {
   VectorQ = VectorE = VectorI = VectorV = VectorJ = NULL;
   MatrixQV = NULL;
   VectorCV = VectorGV = NULL;
+  mnablock = NULL;
   nodes = NULL;
   pacport = 0;
   pol = 1;
@@ -74,6 +77,7 @@ circuit::circuit () : object (), integrator () {
   deltas = NULL;
   histories = NULL;
   nHistories = 0;
+  bypassV = NULL;
   type = CIR_UNKNOWN;
 }
 
@@ -89,6 +93,7 @@ circuit::circuit (int s) : object (), integrator () {
   VectorQ = VectorE = VectorI = VectorV = VectorJ = NULL;
   MatrixQV = NULL;
   VectorCV = VectorGV = NULL;
+  mnablock = NULL;
   pacport = 0;
   pol = 1;
   flag = CIRCUIT_ORIGINAL | CIRCUIT_LINEAR;
@@ -102,6 +107,7 @@ circuit::circuit (int s) : object (), integrator () {
   deltas = NULL;
   histories = NULL;
   nHistories = 0;
+  bypassV = NULL;
   type = CIR_UNKNOWN;
 }
 
@@ -124,6 +130,9 @@ circuit::circuit (const circuit & c) : object (c), integrator (c) {
   deltas = c.deltas;
   nHistories = c.nHistories;
   histories = NULL;
+  bypassV = NULL;
+  MODFLAG (false, CIRCUIT_BYPASS);
+  mnablock = NULL;
   subcircuit = c.subcircuit;
 
   if (size > 0) {
@@ -189,6 +198,7 @@ circuit::~circuit () {
     freeMatrixHB ();
     delete[] nodes;
   }
+  delete[] bypassV;
   deleteHistory ();
 }
 
@@ -207,6 +217,8 @@ void circuit::setSize (int s) {
     MatrixS = MatrixN = NULL;
     freeMatrixMNA ();
     delete[] nodes; nodes = NULL;
+    delete[] bypassV; bypassV = NULL;
+    restartBypass ();
   }
 
   if ((size = s) > 0) {
@@ -266,44 +278,56 @@ void circuit::allocMatrixN (int sources) {
   MatrixN = new nr_complex_t[(size + sources) * (size + sources)];
 }
 
-/* Allocates the matrix memory for the MNA matrices. */
+/* Allocates the matrix memory for the MNA matrices.  All of them are
+   placed in one piece of memory, taken from the netlist's arena if the
+   circuit belongs to one. */
 void circuit::allocMatrixMNA (void) {
   freeMatrixMNA ();
   if (size > 0) {
-    MatrixY = new nr_complex_t[size * size];
-    VectorI = new nr_complex_t[size];
-    VectorV = new nr_complex_t[size];
+    int n = size * size + 2 * size +
+      vsources * (2 * size + vsources + 2);
+    nr_complex_t * p;
+    if (subnet != NULL)
+      p = subnet->getArena()->alloc (n, mnablock);
+    else
+      p = new nr_complex_t[n];
+    MatrixY = p; p += size * size;
+    VectorI = p; p += size;
+    VectorV = p; p += size;
     if (vsources > 0) {
-      MatrixB = new nr_complex_t[vsources * size];
-      MatrixC = new nr_complex_t[vsources * size];
-      MatrixD = new nr_complex_t[vsources * vsources];
-      VectorE = new nr_complex_t[vsources];
-      VectorJ = new nr_complex_t[vsources];
+      MatrixB = p; p += vsources * size;
+      MatrixC = p; p += vsources * size;
+      MatrixD = p; p += vsources * vsources;
+      VectorE = p; p += vsources;
+      VectorJ = p;
     }
   }
 }
 
 /* Free()'s all memory used by the MNA matrices. */
 void circuit::freeMatrixMNA (void) {
-  if (MatrixY) { delete[] MatrixY; MatrixY = NULL; }
-  if (MatrixB) { delete[] MatrixB; MatrixB = NULL; }
-  if (MatrixC) { delete[] MatrixC; MatrixC = NULL; }
-  if (MatrixD) { delete[] MatrixD; MatrixD = NULL; }
-  if (VectorE) { delete[] VectorE; VectorE = NULL; }
-  if (VectorI) { delete[] VectorI; VectorI = NULL; }
-  if (VectorV) { delete[] VectorV; VectorV = NULL; }
-  if (VectorJ) { delete[] VectorJ; VectorJ = NULL; }
+  if (mnablock) {
+    arena::release (mnablock);
+    mnablock = NULL;
+  }
+  else {
+    delete[] MatrixY;
+  }
+  MatrixY = MatrixB = MatrixC = MatrixD = NULL;
+  VectorE = VectorI = VectorV = VectorJ = NULL;
 }
 
 /* This function sets the name and port number of one of the circuit's
    nodes.  It also tells the appropriate node about the circuit it
    belongs to.  The optional 'intern' argument is used to mark a node
-   to be for internal use only. */
-void circuit::setNode (int i, const std::string &n, int intern) {
+   to be for internal use only.  The optional 'id' is the number of
+   the node given by the netlist input, renamed nodes lose it. */
+void circuit::setNode (int i, const std::string &n, int intern, int id) {
   nodes[i].setName (n);
   nodes[i].setCircuit (this);
   nodes[i].setPort (i);
   nodes[i].setInternal (intern);
+  nodes[i].setId (id);
 }
 
 // Returns one of the circuit's nodes.
@@ -433,6 +457,33 @@ void circuit::setJ (int nr, nr_complex_t z) {
   VectorJ[nr - vsource] = z;
 }
 
+/* The function decides whether the (non-linear) circuit may skip the
+   evaluation of its model in the current iteration.  This is the case
+   if none of its node voltages changed by more than the given absolute
+   plus relative tolerance since the last evaluation.  Otherwise the
+   node voltages are remembered for the next decision and the function
+   returns false. */
+bool circuit::bypass (nr_double_t abstol, nr_double_t reltol) {
+  int i;
+  if (RETFLAG (CIRCUIT_BYPASS)) {
+    for (i = 0; i < size; i++) {
+      nr_double_t v = real (VectorV[i]);
+      if (fabs (v - bypassV[i]) >= abstol + reltol * fabs (v)) break;
+    }
+    if (i >= size) return true;
+  }
+  storeBypass ();
+  return false;
+}
+
+/* Remembers the node voltages the circuit is evaluated at for the
+   next bypass decision. */
+void circuit::storeBypass (void) {
+  if (bypassV == NULL) bypassV = new nr_double_t[size];
+  for (int i = 0; i < size; i++) bypassV[i] = real (VectorV[i]);
+  MODFLAG (true, CIRCUIT_BYPASS);
+}
+
 // Returns the circuits voltage value at the given port.
 nr_complex_t circuit::getV (int port) {
   return VectorV[port];
@@ -57,6 +57,7 @@
 
 #include <map>
 #include <string>
+#include <limits>
 
 #include "integrator.h"
 #include "valuelist.h"
@@ -73,6 +74,10 @@ enum circuit_flag {
   CIRCUIT_VARSIZE     = 64,
   CIRCUIT_PROBE       = 128,
   CIRCUIT_HISTORY     = 256,
+  CIRCUIT_POOLED      = 512,
+  CIRCUIT_BYPASS      = 1024,
+  CIRCUIT_SERIAL      = 2048,
+  CIRCUIT_LATENT      = 4096,
 };
 
 class node;
@@ -82,6 +87,7 @@ class matrix;
 class net;
 class environment;
 class history;
+struct arenablock;
 
 /*! \class circuit
  * \brief base class for qucs circuit elements.
@@ -133,6 +139,17 @@ class circuit : public object, public integrator
   virtual void calcAC (nr_double_t) { }
   virtual void initTR (void) { allocMatrixMNA (); }
   virtual void calcTR (nr_double_t) { }
+  /*! \fn nextBreakpoint
+   * \brief returns the next discontinuity of a transient source
+   *
+   * Sources with piecewise defined waveforms override this function
+   * and return the first time beyond the given one at which their
+   * waveform (or its slope) changes abruptly.  The transient step
+   * controller lands exactly on these times.  The default returns
+   * infinity, i.e. no breakpoints.
+   */
+  virtual nr_double_t nextBreakpoint (nr_double_t) {
+    return std::numeric_limits<nr_double_t>::infinity (); }
   virtual void initHB (void) { allocMatrixMNA (); }
   virtual void calcHB (nr_double_t) { }
   virtual void initHB (int) { allocMatrixMNA (); }
@@ -144,7 +161,7 @@ class circuit : public object, public integrator
   virtual void saveCharacteristics (nr_complex_t) { }
 
   // basic circuit element functionality
-  void   setNode (int, const std::string&, int intern = 0);
+  void   setNode (int, const std::string&, int intern = 0, int id = 0);
   node * getNode (int);
   void   setType (int t) { type = t; }
   int    getType (void) { return type; }
@@ -237,6 +254,19 @@ class circuit : public object, public integrator
   int getHistorySize (void);
   nr_double_t getHistoryTFromIndex (int);
 
+  // device bypass
+  bool bypass (nr_double_t, nr_double_t);
+  void storeBypass (void);
+  void restartBypass (void) { MODFLAG (false, CIRCUIT_BYPASS); }
+
+  // circuits which must not be evaluated concurrently with others
+  bool isSerial (void) { return RETFLAG (CIRCUIT_SERIAL); }
+  void setSerial (bool s) { MODFLAG (s, CIRCUIT_SERIAL); }
+
+  // circuits of latent blocks which are not evaluated at all
+  bool isLatent (void) { return RETFLAG (CIRCUIT_LATENT); }
+  void setLatent (bool l) { MODFLAG (l, CIRCUIT_LATENT); }
+
   // s-parameter helpers
   int  getPort (void) { return pacport; }
   void setPort (int p) { pacport = p; }
@@ -244,6 +274,8 @@ class circuit : public object, public integrator
   void setInserted (int i) { inserted = i; }
   bool isOriginal (void) { return RETFLAG (CIRCUIT_ORIGINAL); }
   void setOriginal (bool o) { MODFLAG (o, CIRCUIT_ORIGINAL); }
+  bool isPooled (void) { return RETFLAG (CIRCUIT_POOLED); }
+  void setPooled (bool p) { MODFLAG (p, CIRCUIT_POOLED); }
 
   // microstrip helpers
   substrate * getSubstrate (void);
@@ -358,6 +390,7 @@ class circuit : public object, public integrator
   nr_complex_t * MatrixQV;
   nr_complex_t * VectorGV;
   nr_complex_t * VectorCV;
+  arenablock * mnablock;
   std::string subcircuit;
   node * nodes;
   substrate * subst;
@@ -368,6 +401,7 @@ class circuit : public object, public integrator
   nr_double_t * deltas;
   int nHistories;
   history * histories;
+  nr_double_t * bypassV;
 };
 
 } // namespace qucs
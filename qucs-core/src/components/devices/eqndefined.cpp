@@ -38,6 +38,7 @@ using namespace qucs::eqn;
 // Constructor for the equation defined device.
 eqndefined::eqndefined () : circuit () {
   type = CIR_EQNDEFINED;
+  setSerial (true);
   setVariableSized (true);
   veqn = NULL;
   ieqn = NULL;
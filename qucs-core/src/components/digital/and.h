@@ -31,6 +31,7 @@ class logicand : public digital
   CREATOR (logicand);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __AND_H__ */
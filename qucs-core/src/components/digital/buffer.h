@@ -31,6 +31,7 @@ class buffer : public digital
   CREATOR (buffer);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __BUFFER_H__ */
@@ -65,8 +65,13 @@ void digisource::initTR (void) {
 }
 
 void digisource::calcTR (nr_double_t t) {
-  const char * const init = getPropertyString ("init");
   nr_double_t v = getPropertyDouble ("V");
+  setE (VSRC_1, getLogic (t) ? v : 0);
+}
+
+// Returns non-zero if the digital signal is high at the given time.
+int digisource::getLogic (nr_double_t t) {
+  const char * const init = getPropertyString ("init");
   qucs::vector * values = getPropertyVector ("times");
   bool lo = !strcmp (init, "low");
   nr_double_t ti = 0;
@@ -76,8 +81,23 @@ void digisource::calcTR (nr_double_t t) {
     ti += real (values->get (i));
     if (t >= ti) lo = !lo; else break;
   }
+  return !lo;
+}
 
-  setE (VSRC_1, lo ? 0 : v);
+// Returns the next edge of the digital signal beyond the given time.
+nr_double_t digisource::nextBreakpoint (nr_double_t t) {
+  qucs::vector * values = getPropertyVector ("times");
+  if (T <= 0) return circuit::nextBreakpoint (t);
+  // edges of the current and the following period
+  nr_double_t s = T * qucs::floor (t / T);
+  for (int n = 0; n < 2; n++, s += T) {
+    nr_double_t ti = s;
+    for (int i = 0; i < values->getSize (); i++) {
+      ti += real (values->get (i));
+      if (ti > t) return ti;
+    }
+  }
+  return s;
 }
 
 // properties
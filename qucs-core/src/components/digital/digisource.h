@@ -34,6 +34,8 @@ class digisource : public qucs::circuit
   void initAC (void);
   void initTR (void);
   void calcTR (nr_double_t);
+  nr_double_t nextBreakpoint (nr_double_t);
+  int getLogic (nr_double_t);
 
  private:
   nr_double_t T;
@@ -48,6 +48,7 @@ digital::digital () : circuit () {
   Vout = 0;
   Tdelay = 0;
   delay = false;
+  event = false;
 }
 
 // Destructor.
@@ -165,7 +166,15 @@ void digital::initTR (void) {
   nr_double_t t = getPropertyDouble ("t");
   initDC ();
   deleteHistory ();
-  if (t > 0.0) {
+  if (event) {
+    // the output is an ideal voltage source set by the event driven
+    // simulation, the delay is applied there as well
+    for (i = 0; i < getSize () - 1; i++) {
+      setC (VSRC_1, NODE_IN1 + i, 0);
+    }
+    setE (VSRC_1, -Vout);
+  }
+  else if (t > 0.0) {
     delay = true;
     setHistory (true);
     initHistory (t);
@@ -175,7 +184,10 @@ void digital::initTR (void) {
 
 // Computes MNA entries during transient analysis.
 void digital::calcTR (nr_double_t t) {
-  if (delay) {
+  if (event) {
+    setE (VSRC_1, -Vout);
+  }
+  else if (delay) {
     Tdelay = t - getPropertyDouble ("t");
     calcOutput ();
     setE (VSRC_1, Vout);
@@ -184,3 +196,8 @@ void digital::calcTR (nr_double_t t) {
     calcDC ();
   }
 }
+
+// Sets the output level during the event driven transient analysis.
+void digital::setLogic (int high) {
+  Vout = high ? getPropertyDouble ("V") : 0;
+}
@@ -40,6 +40,12 @@ class digital : public qucs::circuit
   void calcTR (nr_double_t);
   void calcOperatingPoints (void);
 
+  // event driven transient analysis
+  virtual int calcLogic (const int *) { return 0; }
+  void setEventDriven (bool e) { event = e; }
+  bool isEventDriven (void) { return event; }
+  void setLogic (int);
+
  protected:
   virtual void calcOutput (void) { }
   virtual void calcDerivatives (void) { }
@@ -54,6 +60,7 @@ class digital : public qucs::circuit
   nr_double_t Vout, Veq, Tdelay;
   int i;
   bool delay;
+  bool event;
 
  private:
   void initDigital (void);
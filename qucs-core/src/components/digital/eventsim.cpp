@@ -0,0 +1,368 @@
+/*
+ * eventsim.cpp - event driven digital simulation implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <algorithm>
+
+#include "component.h"
+#include "net.h"
+#include "digital.h"
+#include "digisource.h"
+#include "eventsim.h"
+
+#define NODE_OUT 0 /* first node is output node */
+#define NODE_IN1 1 /* input nodes start here */
+
+// types of events
+#define EVENT_OUTPUT 0
+#define EVENT_INPUT  1
+#define EVENT_SOURCE 2
+
+// maximum number of zero delay iterations at a single time
+#define MAX_DELTA_CYCLES 10000
+
+namespace qucs {
+
+// Constructor creates an empty timing wheel.
+timingwheel::timingwheel (nr_double_t res, int n) : slots (n) {
+  resolution = res > 0 ? res : 1;
+  now = 0;
+  count = 0;
+}
+
+// Returns the slot number of the given time.
+long long timingwheel::tick (nr_double_t t) {
+  return (long long) std::floor (t / resolution);
+}
+
+/* Puts the given event into its slot.  Events in the past are put into
+   the current slot. */
+void timingwheel::insert (const digievent_t & e) {
+  long long k = std::max (tick (e.t), now);
+  if (k - now < (long long) slots.size ())
+    slots[k % slots.size ()].push_back (e);
+  else
+    overflow.insert (std::make_pair (e.t, e));
+  count++;
+}
+
+// Returns the time of the earliest pending event.
+nr_double_t timingwheel::next (void) {
+  if (count > (int) overflow.size ()) {
+    int n = slots.size ();
+    for (int k = 0; k < n; k++) {
+      std::vector<digievent_t> & s = slots[(now + k) % n];
+      if (s.empty ()) continue;
+      nr_double_t t = s[0].t;
+      for (auto & e : s) t = std::min (t, e.t);
+      return t;
+    }
+  }
+  return overflow.begin()->first;
+}
+
+/* The function turns the wheel to the given time (which must be the
+   earliest one) and removes all events of exactly this time. */
+void timingwheel::pop (nr_double_t t, std::vector<digievent_t> & out) {
+  int n = slots.size ();
+  long long k = std::max (tick (t), now);
+  if (k != now) {
+    now = k;
+    // move events from the overflow list into the wheel
+    while (!overflow.empty ()) {
+      auto it = overflow.begin ();
+      long long j = std::max (tick (it->first), now);
+      if (j - now >= n) break;
+      slots[j % n].push_back (it->second);
+      overflow.erase (it);
+    }
+  }
+  out.clear ();
+  std::vector<digievent_t> & s = slots[now % n];
+  for (size_t i = 0; i < s.size (); ) {
+    if (s[i].t == t) {
+      out.push_back (s[i]);
+      s[i] = s.back ();
+      s.pop_back ();
+    }
+    else i++;
+  }
+  count -= out.size ();
+}
+
+// Constructor creates an empty digital simulation.
+eventsim::eventsim () {
+  wheel = NULL;
+}
+
+// Destructor deletes the digital simulation.
+eventsim::~eventsim () {
+  delete wheel;
+}
+
+// Returns the gates to their analog models.
+void eventsim::release (void) {
+  for (auto & g : gates) g.c->setEventDriven (false);
+  gates.clear ();
+}
+
+/* The function collects the digital gates and sources of the given
+   netlist, finds the nets carrying logic values and switches the gates
+   into event driven mode.  The given resolution is the width of a slot
+   of the timing wheel.  Returns the number of gates. */
+int eventsim::init (net * subnet, nr_double_t resolution) {
+  circuit * c, * root = subnet->getRoot ();
+
+  // count the digital outputs connected to each net
+  for (c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    switch (c->getType ()) {
+    case CIR_AND: case CIR_NAND: case CIR_OR: case CIR_NOR:
+    case CIR_XOR: case CIR_XNOR: case CIR_INVERTER: case CIR_BUFFER:
+    case CIR_DIGISOURCE:
+      drivers[c->getNode(NODE_OUT)->getName ()]++;
+      break;
+    }
+  }
+
+  for (c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getType () == CIR_DIGISOURCE) {
+      source_t s;
+      s.c = c;
+      s.signal = findSignal (c->getNode(NODE_OUT)->getName (),
+			     c->getPropertyDouble ("V"));
+      if (s.signal >= 0) sources.push_back (s);
+      continue;
+    }
+    switch (c->getType ()) {
+    case CIR_AND: case CIR_NAND: case CIR_OR: case CIR_NOR:
+    case CIR_XOR: case CIR_XNOR: case CIR_INVERTER: case CIR_BUFFER:
+      break;
+    default:
+      continue;
+    }
+    gate_t g;
+    g.c = (digital *) c;
+    g.delay = c->getPropertyDouble ("t");
+    g.threshold = c->getPropertyDouble ("V") / 2;
+    g.output = findSignal (c->getNode(NODE_OUT)->getName (),
+			   c->getPropertyDouble ("V"));
+    g.value = g.scheduled = 0;
+    g.dirty = false;
+    gates.push_back (g);
+    g.c->setEventDriven (true);
+  }
+
+  // connect the gate inputs, all signals are known now
+  for (size_t k = 0; k < gates.size (); k++) {
+    gate_t & g = gates[k];
+    for (int i = NODE_IN1; i < g.c->getSize (); i++) {
+      input_t in;
+      in.signal = findSignal (g.c->getNode(i)->getName (), 0);
+      in.value = 0;
+      in.vprev = in.tprev = 0;
+      g.inputs.push_back (in);
+      if (in.signal >= 0) {
+	std::vector<int> & f = signals[in.signal].fanout;
+	if (f.empty () || f.back () != (int) k) f.push_back (k);
+      }
+    }
+  }
+
+  drivers.clear ();
+  ids.clear ();
+  wheel = new timingwheel (resolution);
+  return gates.size ();
+}
+
+/* Returns the signal of the given net if it is driven by a single
+   digital output, otherwise -1.  The signal is created on first use
+   with the given high level. */
+int eventsim::findSignal (const std::string & name, nr_double_t level) {
+  auto it = ids.find (name);
+  if (it != ids.end ()) return it->second;
+  if (name == "gnd" || drivers[name] != 1) return -1;
+  signal_t s;
+  s.value = 0;
+  s.level = level;
+  signals.push_back (s);
+  return ids[name] = signals.size () - 1;
+}
+
+/* Schedules a new event. */
+void eventsim::schedule (nr_double_t t, int type, int index, int port,
+			 int value) {
+  digievent_t e;
+  e.t = t;
+  e.type = type;
+  e.index = index;
+  e.port = port;
+  e.value = value;
+  wheel->insert (e);
+}
+
+/* The function takes the initial logic values from the operating point
+   found by the initial DC analysis (using the analog gate models) and
+   schedules the first events. */
+void eventsim::start (void) {
+  for (size_t k = 0; k < sources.size (); k++) {
+    digisource * s = (digisource *) sources[k].c;
+    signals[sources[k].signal].value = s->getLogic (0);
+    nr_double_t t = s->nextBreakpoint (0);
+    if (std::isfinite (t)) schedule (t, EVENT_SOURCE, k, 0, 0);
+  }
+  for (auto & g : gates) {
+    g.value = g.scheduled = real (g.c->getV (NODE_OUT)) > g.threshold;
+    g.c->setLogic (g.value);
+    if (g.output >= 0) signals[g.output].value = g.value;
+    for (size_t i = 0; i < g.inputs.size (); i++) {
+      input_t & in = g.inputs[i];
+      in.vprev = real (g.c->getV (NODE_IN1 + i));
+      in.value = in.vprev > g.threshold;
+      in.tprev = 0;
+    }
+  }
+  // gates not settled at the operating point switch after their delay
+  for (auto & g : gates) evaluate (g, 0);
+}
+
+// Returns the logic value of the given gate input.
+int eventsim::getInput (gate_t & g, int i) {
+  input_t & in = g.inputs[i];
+  if (in.signal < 0) return in.value;
+  signal_t & s = signals[in.signal];
+  return s.value && s.level > g.threshold;
+}
+
+/* Evaluates the logic function of the given gate at the given time and
+   schedules its output if it changes. */
+void eventsim::evaluate (gate_t & g, nr_double_t t) {
+  int n = g.inputs.size ();
+  values.resize (n);
+  for (int i = 0; i < n; i++) values[i] = getInput (g, i);
+  int out = g.c->calcLogic (&values[0]);
+  if (out != g.scheduled) {
+    g.scheduled = out;
+    schedule (t + g.delay, EVENT_OUTPUT, &g - &gates[0], 0, out);
+  }
+  g.dirty = false;
+}
+
+/* Applies the given events (all at the same time) and collects the
+   gates to be evaluated. */
+void eventsim::process (std::vector<digievent_t> & events,
+			std::vector<int> & dirty) {
+  for (auto & e : events) {
+    signal_t * s = NULL;
+    if (e.type == EVENT_OUTPUT) {
+      gate_t & g = gates[e.index];
+      g.value = e.value;
+      g.c->setLogic (e.value);
+      if (g.output >= 0) {
+	s = &signals[g.output];
+	s->value = e.value;
+      }
+    }
+    else if (e.type == EVENT_INPUT) {
+      gate_t & g = gates[e.index];
+      g.inputs[e.port].value = e.value;
+      if (!g.dirty) dirty.push_back (e.index);
+      g.dirty = true;
+    }
+    else if (e.type == EVENT_SOURCE) {
+      digisource * c = (digisource *) sources[e.index].c;
+      // the value is taken in the middle to the following edge
+      nr_double_t t = c->nextBreakpoint (e.t);
+      s = &signals[sources[e.index].signal];
+      s->value = c->getLogic (std::isfinite (t) ? (e.t + t) / 2 : e.t);
+      if (std::isfinite (t)) schedule (t, EVENT_SOURCE, e.index, 0, 0);
+    }
+    if (s == NULL) continue;
+    for (int k : s->fanout) {
+      if (!gates[k].dirty) dirty.push_back (k);
+      gates[k].dirty = true;
+    }
+  }
+}
+
+/* The transient analysis calls this function for each accepted time
+   step.  It samples the analog gate inputs and processes all events up
+   to the given time (plus tolerance).  The new output values apply to
+   the following time steps. */
+void eventsim::update (nr_double_t t, nr_double_t tol) {
+  // compare the analog inputs against the thresholds
+  for (size_t k = 0; k < gates.size (); k++) {
+    gate_t & g = gates[k];
+    for (size_t i = 0; i < g.inputs.size (); i++) {
+      input_t & in = g.inputs[i];
+      if (in.signal >= 0) continue;
+      nr_double_t v = real (g.c->getV (NODE_IN1 + i));
+      int value = v > g.threshold;
+      if (value != in.value && t > in.tprev) {
+	// time of the threshold crossing
+	nr_double_t tc = in.tprev + (g.threshold - in.vprev) /
+	  (v - in.vprev) * (t - in.tprev);
+	tc = std::min (std::max (tc, in.tprev), t);
+	schedule (tc, EVENT_INPUT, k, i, value);
+      }
+      in.vprev = v;
+      in.tprev = t;
+    }
+  }
+
+  // run the events
+  std::vector<digievent_t> events;
+  std::vector<int> dirty;
+  nr_double_t last = -1;
+  int cycles = 0;
+  while (!wheel->isEmpty ()) {
+    nr_double_t te = wheel->next ();
+    if (te > t + tol) break;
+    wheel->pop (te, events);
+    cycles = (te == last) ? cycles + 1 : 0;
+    last = te;
+    if (cycles > MAX_DELTA_CYCLES) {
+      logprint (LOG_ERROR, "WARNING: digital simulation does not settle at "
+		"t = %.3e, dropping events\n", (double) te);
+      continue;
+    }
+    dirty.clear ();
+    process (events, dirty);
+    for (int k : dirty) evaluate (gates[k], te);
+  }
+}
+
+// Returns the time of the next event or infinity.
+nr_double_t eventsim::nextEvent (void) {
+  if (wheel == NULL || wheel->isEmpty ())
+    return std::numeric_limits<nr_double_t>::infinity ();
+  return wheel->next ();
+}
+
+} // namespace qucs
@@ -0,0 +1,139 @@
+/*
+ * eventsim.h - event driven digital simulation definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __EVENTSIM_H__
+#define __EVENTSIM_H__
+
+#include <vector>
+#include <map>
+#include <string>
+
+class digital;
+
+namespace qucs {
+
+class net;
+class circuit;
+
+/* A single event of the digital simulation: at the given time either
+   the output of a gate, an analog gate input or the signal of a
+   digital source changes its logic value. */
+struct digievent_t {
+  nr_double_t t;
+  int type;
+  int index;
+  int port;
+  int value;
+};
+
+/* The timing wheel keeps the pending events.  Each slot holds the
+   events of a time interval of the given resolution, the events beyond
+   the span of the wheel wait in an ordered overflow list. */
+class timingwheel
+{
+ public:
+  timingwheel (nr_double_t, int slots = 256);
+  void insert (const digievent_t &);
+  bool isEmpty (void) { return count == 0; }
+  nr_double_t next (void);
+  void pop (nr_double_t, std::vector<digievent_t> &);
+
+ private:
+  long long tick (nr_double_t);
+
+ private:
+  nr_double_t resolution;
+  long long now;
+  int count;
+  std::vector< std::vector<digievent_t> > slots;
+  std::multimap<nr_double_t, digievent_t> overflow;
+};
+
+/* The event driven simulation of the digital gates during a transient
+   analysis.  The gates are evaluated by their logic functions whenever
+   one of their inputs changes and their outputs follow after the gate
+   delay.  Nets driven by a single gate output or digital source carry
+   a logic value (D/A: the output is an ideal voltage source).  All
+   other gate inputs are analog ones and are compared against half the
+   supply voltage of the gate at each accepted time step (A/D). */
+class eventsim
+{
+ public:
+  eventsim ();
+  ~eventsim ();
+  int init (net *, nr_double_t);
+  void start (void);
+  void update (nr_double_t, nr_double_t);
+  nr_double_t nextEvent (void);
+  void release (void);
+
+ private:
+  // a net driven by a single digital output
+  struct signal_t {
+    int value;
+    nr_double_t level;
+    std::vector<int> fanout;
+  };
+  // the input of a gate
+  struct input_t {
+    int signal;          // driving signal or -1 for an analog input
+    int value;
+    nr_double_t vprev;   // last sample of an analog input
+    nr_double_t tprev;
+  };
+  struct gate_t {
+    digital * c;
+    nr_double_t delay;
+    nr_double_t threshold;
+    int output;          // driven signal or -1
+    int value;
+    int scheduled;       // last scheduled output value
+    bool dirty;
+    std::vector<input_t> inputs;
+  };
+  struct source_t {
+    circuit * c;
+    int signal;
+  };
+
+  int findSignal (const std::string &, nr_double_t);
+  void schedule (nr_double_t, int, int, int, int);
+  void evaluate (gate_t &, nr_double_t);
+  int getInput (gate_t &, int);
+  void process (std::vector<digievent_t> &, std::vector<int> &);
+
+ private:
+  timingwheel * wheel;
+  std::vector<signal_t> signals;
+  std::vector<gate_t> gates;
+  std::vector<source_t> sources;
+  std::vector<int> values;
+  // number of digital outputs and signal of each net during init()
+  std::map<std::string, int> drivers;
+  std::map<std::string, int> ids;
+};
+
+} // namespace qucs
+
+#endif /* __EVENTSIM_H__ */
@@ -46,6 +46,10 @@ void inverter::calcDerivatives (void) {
   g[0] = - 0.5 * calcDerivativeX (0);
 }
 
+int inverter::calcLogic (const int * in) {
+  return !in[0];
+}
+
 // properties
 PROP_REQ [] = {
   { "V", PROP_REAL, { 1, PROP_NO_STR }, PROP_POS_RANGE }, PROP_NO_PROP };
@@ -31,6 +31,7 @@ class inverter : public digital
   CREATOR (inverter);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __INVERTER_H__ */
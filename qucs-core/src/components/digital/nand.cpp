@@ -59,6 +59,13 @@ void logicnand::calcDerivatives (void) {
   }
 }
 
+int logicnand::calcLogic (const int * in) {
+  for (i = 0; i < getSize () - 1; i++) {
+    if (!in[i]) return 1;
+  }
+  return 0;
+}
+
 // properties
 PROP_REQ [] = {
   { "V", PROP_REAL, { 1, PROP_NO_STR }, PROP_POS_RANGE }, PROP_NO_PROP };
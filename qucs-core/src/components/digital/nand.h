@@ -31,6 +31,7 @@ class logicnand : public digital
   CREATOR (logicnand);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __NAND_H__ */
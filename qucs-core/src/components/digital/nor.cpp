@@ -59,6 +59,13 @@ void logicnor::calcDerivatives (void) {
   }
 }
 
+int logicnor::calcLogic (const int * in) {
+  for (i = 0; i < getSize () - 1; i++) {
+    if (in[i]) return 0;
+  }
+  return 1;
+}
+
 // properties
 PROP_REQ [] = {
   { "V", PROP_REAL, { 1, PROP_NO_STR }, PROP_POS_RANGE }, PROP_NO_PROP };
@@ -31,6 +31,7 @@ class logicnor : public digital
   CREATOR (logicnor);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __NOR_H__ */
@@ -31,6 +31,7 @@ class logicor : public digital
   CREATOR (logicor);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __OR_H__ */
@@ -58,6 +58,14 @@ void logicxnor::calcDerivatives (void) {
   }
 }
 
+int logicxnor::calcLogic (const int * in) {
+  int x = 1;
+  for (i = 0; i < getSize () - 1; i++) {
+    x ^= in[i];
+  }
+  return x;
+}
+
 // properties
 PROP_REQ [] = {
   { "V", PROP_REAL, { 1, PROP_NO_STR }, PROP_POS_RANGE }, PROP_NO_PROP };
@@ -31,6 +31,7 @@ class logicxnor : public digital
   CREATOR (logicxnor);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __XNOR_H__ */
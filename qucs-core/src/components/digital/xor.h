@@ -31,6 +31,7 @@ class logicxor : public digital
   CREATOR (logicxor);
   void calcOutput (void);
   void calcDerivatives (void);
+  int calcLogic (const int *);
 };
 
 #endif /* __XOR_H__ */
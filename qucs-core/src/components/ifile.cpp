@@ -124,6 +124,15 @@ void ifile::calcTR (nr_double_t t) {
   setI (NODE_1, +G * i); setI (NODE_2, -G * i);
 }
 
+/* Returns the next sample of the file beyond the given time.  Cubic
+   interpolation is smooth across the samples. */
+nr_double_t ifile::nextBreakpoint (nr_double_t t) {
+  if (inter == NULL || interpolType == INTERPOL_CUBIC)
+    return circuit::nextBreakpoint (t);
+  nr_double_t T = getPropertyDouble ("T");
+  return T + inter->nextSample (t - T);
+}
+
 // properties
 PROP_REQ [] = {
   { "File", PROP_STR, { PROP_NO_VAL, "ifile.dat" }, PROP_NO_RANGE },
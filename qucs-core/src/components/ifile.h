@@ -40,6 +40,7 @@ class ifile : public qucs::circuit
   void initAC (void);
   void initTR (void);
   void calcTR (nr_double_t);
+  nr_double_t nextBreakpoint (nr_double_t);
   void prepare (void);
 
 private:
@@ -87,6 +87,19 @@ void ipulse::calcTR (nr_double_t t) {
   setI (NODE_1, +it * s); setI (NODE_2, -it * s);
 }
 
+// Returns the next corner of the pulse beyond the given time.
+nr_double_t ipulse::nextBreakpoint (nr_double_t t) {
+  nr_double_t t1 = getPropertyDouble ("T1");
+  nr_double_t t2 = getPropertyDouble ("T2");
+  nr_double_t tr = getPropertyDouble ("Tr");
+  nr_double_t tf = getPropertyDouble ("Tf");
+  nr_double_t b[4] = { t1, t1 + tr, t2 - tf, t2 };
+  for (int i = 0; i < 4; i++) {
+    if (b[i] > t) return b[i];
+  }
+  return circuit::nextBreakpoint (t);
+}
+
 // properties
 PROP_REQ [] = {
   { "I1", PROP_REAL, { 0, PROP_NO_STR }, PROP_NO_RANGE },
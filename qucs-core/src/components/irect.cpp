@@ -95,6 +95,30 @@ void irect::calcTR (nr_double_t t) {
   setI (NODE_1, +it * s); setI (NODE_2, -it * s);
 }
 
+// Returns the next corner of the rectangular wave beyond the given time.
+nr_double_t irect::nextBreakpoint (nr_double_t t) {
+  nr_double_t th = getPropertyDouble ("TH");
+  nr_double_t tl = getPropertyDouble ("TL");
+  nr_double_t tr = getPropertyDouble ("Tr");
+  nr_double_t tf = getPropertyDouble ("Tf");
+  nr_double_t td = getPropertyDouble ("Td");
+
+  if (tr > th) tr = th;
+  if (tf > tl) tf = tl;
+
+  if (t < td) return td;
+  nr_double_t p = th + tl;
+  nr_double_t b[4] = { 0, tr, th, th + tf };
+  // corners of the current and the following period
+  nr_double_t s = td + p * qucs::floor ((t - td) / p);
+  for (int n = 0; n < 2; n++, s += p) {
+    for (int i = 0; i < 4; i++) {
+      if (s + b[i] > t) return s + b[i];
+    }
+  }
+  return s;
+}
+
 // properties
 PROP_REQ [] = {
   { "I", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_NO_RANGE },
@@ -34,6 +34,7 @@ class irect : public qucs::circuit
   void initAC (void);
   void initTR (void);
   void calcTR (nr_double_t);
+  nr_double_t nextBreakpoint (nr_double_t);
 };
 
 #endif /* __IRECT_H__ */
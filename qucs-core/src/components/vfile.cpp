@@ -129,6 +129,15 @@ void vfile::calcTR (nr_double_t t) {
   setE (VSRC_1, G * u);
 }
 
+/* Returns the next sample of the file beyond the given time.  Cubic
+   interpolation is smooth across the samples. */
+nr_double_t vfile::nextBreakpoint (nr_double_t t) {
+  if (inter == NULL || interpolType == INTERPOL_CUBIC)
+    return circuit::nextBreakpoint (t);
+  nr_double_t T = getPropertyDouble ("T");
+  return T + inter->nextSample (t - T);
+}
+
 // properties
 PROP_REQ [] = {
   { "File", PROP_STR, { PROP_NO_VAL, "vfile.dat" }, PROP_NO_RANGE },
@@ -41,6 +41,7 @@ class vfile : public qucs::circuit
   void initAC (void);
   void initTR (void);
   void calcTR (nr_double_t);
+  nr_double_t nextBreakpoint (nr_double_t);
   void prepare (void);
 
 private:
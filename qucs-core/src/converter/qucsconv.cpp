@@ -374,19 +374,8 @@ int qucs2mat (struct actionset_t * action, char * infile, char * outfile) {
 
 // CITIfile to Qucs conversion.
 int citi2qucs (struct actionset_t * action, char * infile, char * outfile) {
-  int ret = 0;
   citi_init ();
-  if ((citi_in = open_file (infile, "r")) == NULL) {
-    ret = -1;
-  } else if (citi_parse () != 0) {
-    ret = -1;
-  } else if (citi_check () != 0) {
-    ret = -1;
-  }
-  citi_lex_destroy ();
-  if (citi_in)
-    fclose (citi_in);
-  if (ret) {
+  if (citi_read (infile) != 0) {
     citi_destroy ();
     return -1;
   }
@@ -401,19 +390,8 @@ int citi2qucs (struct actionset_t * action, char * infile, char * outfile) {
 
 // Touchstone to Qucs conversion.
 int touch2qucs (struct actionset_t * action, char * infile, char * outfile) {
-  int ret = 0;
   touchstone_init ();
-  if ((touchstone_in = open_file (infile, "r")) == NULL) {
-    ret = -1;
-  } else if (touchstone_parse () != 0) {
-    ret = -1;
-  } else if (touchstone_check () != 0) {
-    ret = -1;
-  }
-  touchstone_lex_destroy ();
-  if (touchstone_in)
-    fclose (touchstone_in);
-  if (ret) {
+  if (touchstone_read (infile) != 0) {
     touchstone_destroy ();
     return -1;
   }
@@ -41,7 +41,7 @@ using namespace qucs;
 
 /* Global variables. */
 /* dataset * qucs_data = NULL;   -- already defined in CSV producer */
-/* FILE * touchstone_out = NULL; -- already defined in Touchstone lexer */
+FILE * touchstone_out = NULL; // output file stream
 
 struct touchstone_data_t {
   char parameter;      // type of variable
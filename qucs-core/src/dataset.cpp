@@ -394,6 +394,11 @@ void dataset::printVariable (vector * v, FILE * f) {
    the dataset class.  It prints the data items of the given vector
    object to the given output stream. */
 void dataset::printData (vector * v, FILE * f) {
+  if (v->isReal ()) {
+    for (int i = 0; i < v->getSize (); i++)
+      fprintf (f, "  %+." "20" "e\n", (double) v->getReal (i));
+    return;
+  }
   for (int i = 0; i < v->getSize (); i++) {
     nr_complex_t c = v->get (i);
     if (imag (c) == 0.0) {
@@ -438,23 +443,9 @@ dataset * dataset::load (const char * file) {
    file and returns it.  On failure the function emits appropriate
    error messages and returns NULL. */
 dataset * dataset::load_touchstone (const char * file) {
-  FILE * f;
-  if ((f = fopen (file, "r")) == NULL) {
-    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+  if (touchstone_read (file) != 0) {
     return NULL;
   }
-  touchstone_in = f;
-  touchstone_restart (touchstone_in);
-  if (touchstone_parse () != 0) {
-    fclose (f);
-    return NULL;
-  }
-  if (touchstone_check () != 0) {
-    fclose (f);
-    return NULL;
-  }
-  fclose (f);
-  touchstone_lex_destroy ();
   touchstone_result->setFile (file);
   return touchstone_result;
 }
@@ -488,23 +479,9 @@ dataset * dataset::load_csv (const char * file) {
    returns it.  On failure the function emits appropriate error
    messages and returns NULL. */
 dataset * dataset::load_citi (const char * file) {
-  FILE * f;
-  if ((f = fopen (file, "r")) == NULL) {
-    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
-    return NULL;
-  }
-  citi_in = f;
-  citi_restart (citi_in);
-  if (citi_parse () != 0) {
-    fclose (f);
+  if (citi_read (file) != 0) {
     return NULL;
   }
-  if (citi_check () != 0) {
-    fclose (f);
-    return NULL;
-  }
-  fclose (f);
-  citi_lex_destroy ();
   citi_result->setFile (file);
   return citi_result;
 }
@@ -32,6 +32,7 @@
 #include "complex.h"
 #include "circuit.h"
 #include "net.h"
+#include "arena.h"
 #include "netdefs.h"
 #include "analysis.h"
 #include "nasolver.h"
@@ -90,6 +91,10 @@ int dcsolver::solve (void) {
     eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
   else if (!strcmp (solver, "GolubSVD"))
     eqnAlgo = ALGO_SV_DECOMPOSITION;
+  else if (!strcmp (solver, "BiCGStab"))
+    eqnAlgo = ALGO_BICGSTAB;
+  else if (!strcmp (solver, "CG"))
+    eqnAlgo = ALGO_CG;
 
   // local variables for the fallback thingies
   int retry = -1, error, fallback = 0, preferred;
@@ -120,7 +125,20 @@ int dcsolver::solve (void) {
   if (!subnet->isNonLinear ()) {
     // Start the linear solver.
     convHelper = CONV_None;
-    error = solve_linear ();
+    try_running () {
+      error = solve_linear ();
+    }
+    // The iterative equation system solvers may fail.
+    catch_exception () {
+    case EXCEPTION_NO_CONVERGENCE:
+      estack.print ();
+      logprint (LOG_ERROR, "ERROR: %s: %s analysis failed\n", getName (),
+		getDescription ().c_str ());
+      solve_post ();
+      return -1;
+    default:
+      break;
+    }
   }
   else do {
     // Run the DC solver once.
@@ -170,17 +188,20 @@ int dcsolver::solve (void) {
 }
 
 /* Goes through the list of circuit objects and runs its calcDC()
-   function. */
+   function unless the circuit is bypassed. */
 void dcsolver::calc (dcsolver * self) {
-  circuit * root = self->getNet()->getRoot ();
-  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
-    c->calcDC ();
-  }
+  self->evaluate ((evaluate_func_t) &evalDC);
+}
+
+// Evaluates a single circuit.
+void dcsolver::evalDC (circuit * c, dcsolver *) {
+  c->calcDC ();
 }
 
 /* Goes through the list of circuit objects and runs its initDC()
    function. */
 void dcsolver::init (void) {
+  subnet->getArena()->restart ();
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
     c->initDC ();
@@ -213,6 +234,7 @@ PROP_OPT [] = {
   { "abstol", PROP_REAL, { 1e-12, PROP_NO_STR }, PROP_RNG_X01I },
   { "vntol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
   { "reltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
+  { "bypasstol", PROP_REAL, { 0, PROP_NO_STR }, PROP_RNGII (0, 1) },
   { "saveOPs", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
   { "Temp", PROP_REAL, { 26.85, PROP_NO_STR }, PROP_MIN_VAL (K) },
   { "saveAll", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
@@ -220,6 +242,7 @@ PROP_OPT [] = {
     PROP_RNG_STR6 ("none", "SourceStepping", "gMinStepping",
 		   "LineSearch", "Attenuation", "SteepestDescent") },
   { "Solver", PROP_STR, { PROP_NO_VAL, "CroutLU" }, PROP_RNG_SOL },
+  { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
   PROP_NO_PROP };
 struct define_t dcsolver::anadef =
   { "DC", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
@@ -38,6 +38,7 @@ class dcsolver : public nasolver<nr_double_t>
   ~dcsolver ();
   int  solve (void);
   static void calc (dcsolver *);
+  static void evalDC (circuit *, dcsolver *);
   void init (void);
   void restart (void);
   void saveOperatingPoints (void);
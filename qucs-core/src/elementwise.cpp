@@ -0,0 +1,470 @@
+/*
+ * elementwise.cpp - fused element-wise vector evaluation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+
+#include "logging.h"
+#include "complex.h"
+#include "object.h"
+#include "vector.h"
+#include "strlist.h"
+#include "equation.h"
+#include "evaluate.h"
+#include "elementwise.h"
+#include "exception.h"
+#include "exceptionstack.h"
+
+using namespace qucs;
+using namespace qucs::eqn;
+
+// Short helper macros.
+#define C(con) ((constant *) (con))
+#define A(con) ((application *) (con))
+
+// Number of items each operation works on in turn.
+#define BLOCK 256
+
+// Operations of a fused evaluation.
+enum {
+  OP_LOADV, OP_LOADD, OP_LOADC,
+  OP_NOP, OP_NEG, OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+  OP_REAL, OP_IMAG, OP_ABS, OP_CONJ, OP_NORM, OP_DB,
+  OP_EXP, OP_SIN, OP_COS, OP_TAN, OP_SINH, OP_COSH, OP_TANH,
+  OP_RAD2DEG, OP_DEG2RAD,
+  // the following operations may have complex results for real arguments
+  OP_ARG, OP_PHASE, OP_SQRT, OP_LN, OP_LOG10, OP_LOG2,
+  OP_POW, OP_POWVD, OP_POWDV
+};
+
+// Evaluation functions which can be fused and their operations.
+static struct {
+  evaluator_t eval;
+  int op;
+} kernels[] = {
+  { evaluate::plus_v,    OP_NOP },
+  { evaluate::minus_v,   OP_NEG },
+  { evaluate::plus_v_v,  OP_ADD }, { evaluate::plus_v_d,  OP_ADD },
+  { evaluate::plus_d_v,  OP_ADD }, { evaluate::plus_v_c,  OP_ADD },
+  { evaluate::plus_c_v,  OP_ADD },
+  { evaluate::minus_v_v, OP_SUB }, { evaluate::minus_v_d, OP_SUB },
+  { evaluate::minus_d_v, OP_SUB }, { evaluate::minus_v_c, OP_SUB },
+  { evaluate::minus_c_v, OP_SUB },
+  { evaluate::times_v_v, OP_MUL }, { evaluate::times_v_d, OP_MUL },
+  { evaluate::times_d_v, OP_MUL }, { evaluate::times_v_c, OP_MUL },
+  { evaluate::times_c_v, OP_MUL },
+  { evaluate::over_v_v,  OP_DIV }, { evaluate::over_v_d,  OP_DIV },
+  { evaluate::over_d_v,  OP_DIV }, { evaluate::over_v_c,  OP_DIV },
+  { evaluate::over_c_v,  OP_DIV },
+  { evaluate::power_v_v, OP_POW }, { evaluate::power_v_d, OP_POWVD },
+  { evaluate::power_d_v, OP_POWDV }, { evaluate::power_v_c, OP_POW },
+  { evaluate::power_c_v, OP_POW },
+  { evaluate::real_v,    OP_REAL },
+  { evaluate::imag_v,    OP_IMAG },
+  { evaluate::abs_v,     OP_ABS },
+  { evaluate::conj_v,    OP_CONJ },
+  { evaluate::norm_v,    OP_NORM },
+  { evaluate::arg_v,     OP_ARG },
+  { evaluate::phase_v,   OP_PHASE },
+  { evaluate::dB_v,      OP_DB },
+  { evaluate::sqrt_v,    OP_SQRT },
+  { evaluate::exp_v,     OP_EXP },
+  { evaluate::ln_v,      OP_LN },
+  { evaluate::log10_v,   OP_LOG10 },
+  { evaluate::log2_v,    OP_LOG2 },
+  { evaluate::sin_v,     OP_SIN },
+  { evaluate::cos_v,     OP_COS },
+  { evaluate::tan_v,     OP_TAN },
+  { evaluate::sinh_v,    OP_SINH },
+  { evaluate::cosh_v,    OP_COSH },
+  { evaluate::tanh_v,    OP_TANH },
+  { evaluate::rad2deg_v, OP_RAD2DEG },
+  { evaluate::deg2rad_v, OP_DEG2RAD },
+  { NULL, -1 }
+};
+
+// A single operation, leaves carry their evaluated result.
+struct instr {
+  int op;
+  constant * leaf;
+};
+
+/* The function returns the operation of the given node if it is an
+   element-wise vector application which can be fused and otherwise
+   -1. */
+static int kernel (node * n)
+{
+    if (n->getTag () != APPLICATION || n->getType () != TAG_VECTOR)
+        return -1;
+    for (int i = 0; kernels[i].eval != NULL; i++)
+        if (kernels[i].eval == A(n)->eval)
+            return kernels[i].op;
+    return -1;
+}
+
+/* Returns non-zero if the application and at least one of its
+   arguments can be evaluated in a single loop. */
+int elementwise::fusable (application * app)
+{
+    if (kernel (app) < 0)
+        return 0;
+    for (node * arg = app->args; arg != NULL; arg = arg->getNext ())
+        if (kernel (arg) >= 0)
+            return 1;
+    return 0;
+}
+
+/* Evaluates the given leaf of a fused application tree the same way
+   application::evaluate() does it for its arguments.  Returns zero on
+   success. */
+static int evaluateLeaf (node * arg, solver * solvee, strlist *& apreps)
+{
+    arg->solvee = solvee;
+    arg->evaluate ();
+    if (arg->getResult () == NULL)
+    {
+        if (arg->getTag () == REFERENCE)
+        {
+            logprint (LOG_ERROR, "evaluate error, no such generated variable "
+                      "`%s'\n", arg->toString ());
+        }
+        else
+        {
+            logprint (LOG_ERROR, "evaluate error, unable to evaluate "
+                      "`%s'\n", arg->toString ());
+        }
+        return 1;
+    }
+    // inherit drop/prep dependencies
+    if (arg->getResult()->dropdeps)
+    {
+        strlist * preps = arg->getResult()->getPrepDependencies ();
+        // recall longest prep dependencies' list of arguments
+        if (preps && (preps->length () > apreps->length ()))
+        {
+            delete apreps;
+            apreps = new strlist (*preps);
+        }
+    }
+    arg->evaluated++;
+    return 0;
+}
+
+/* The function translates the application tree below the given node
+   into stack operations (arguments first).  Leaves are evaluated on
+   the way.  Returns the number of errors. */
+static int compile (node * n, solver * solvee, std::vector<instr> & prog,
+                    int & sp, int & depth, strlist *& apreps)
+{
+    instr in;
+    int op = kernel (n), errors = 0;
+
+    // the leaves are loaded as a whole
+    if (op < 0)
+    {
+        if (evaluateLeaf (n, solvee, apreps))
+            return 1;
+        in.leaf = n->getResult ();
+        switch (in.leaf->getType ())
+        {
+        case TAG_VECTOR:
+            in.op = OP_LOADV;
+            break;
+        case TAG_DOUBLE:
+            in.op = OP_LOADD;
+            break;
+        default:
+            in.op = OP_LOADC;
+            break;
+        }
+        prog.push_back (in);
+        if (++sp > depth) depth = sp;
+        return 0;
+    }
+
+    // arguments first, then the operation itself
+    for (node * arg = A(n)->args; arg != NULL; arg = arg->getNext ())
+        errors += compile (arg, solvee, prog, sp, depth, apreps);
+    if (errors) return errors;
+
+    // keep the exception of the division by a scalar zero
+    if (A(n)->eval == evaluate::over_v_d || A(n)->eval == evaluate::over_v_c)
+    {
+        constant * d = prog.back().leaf;
+        if ((d->getType () == TAG_DOUBLE && d->d == 0.0) ||
+                (d->getType () == TAG_COMPLEX && *(d->c) == 0.0))
+        {
+            qucs::exception * e = new qucs::exception (EXCEPTION_MATH);
+            e->setText ("division by zero");
+            throw_exception (e);
+        }
+    }
+
+    in.op = op;
+    in.leaf = NULL;
+    prog.push_back (in);
+    if (A(n)->nargs == 2) sp--;
+    return 0;
+}
+
+// Helpers to load and store items of either type.
+static inline void load (nr_double_t & x, qucs::vector * v, int i)
+{
+    x = v->getReal (i);
+}
+static inline void load (nr_complex_t & x, qucs::vector * v, int i)
+{
+    x = v->get (i);
+}
+static inline void load (nr_double_t & x, constant * c)
+{
+    x = c->getType () == TAG_DOUBLE ? c->d : real (*(c->c));
+}
+static inline void load (nr_complex_t & x, constant * c)
+{
+    x = c->getType () == TAG_DOUBLE ? nr_complex_t (c->d) : *(c->c);
+}
+static inline nr_double_t realpart (nr_double_t x) { return x; }
+static inline nr_double_t realpart (nr_complex_t z) { return std::real (z); }
+static inline nr_double_t imagpart (nr_double_t) { return 0.0; }
+static inline nr_double_t imagpart (nr_complex_t z) { return std::imag (z); }
+static inline nr_double_t magnitude (nr_double_t x) { return std::fabs (x); }
+static inline nr_double_t magnitude (nr_complex_t z) { return std::abs (z); }
+static inline nr_double_t conjugate (nr_double_t x) { return x; }
+static inline nr_complex_t conjugate (nr_complex_t z) { return std::conj (z); }
+static inline nr_double_t squared (nr_double_t x) { return x * x; }
+static inline nr_double_t squared (nr_complex_t z) { return std::norm (z); }
+static inline void put (nr_double_t & x, const nr_complex_t z)
+{
+    x = real (z);
+}
+static inline void put (nr_complex_t & x, const nr_complex_t z)
+{
+    x = z;
+}
+
+/* Runs the given operations on blocks of items and stores the results
+   in the given vector.  The scratch area (one block per stack level)
+   is reused for all blocks.  The operations with possibly complex
+   results are only run with complex items. */
+template <class nr_type_t>
+static void run (const std::vector<instr> & prog, int depth,
+                 qucs::vector * res)
+{
+    int len = res->getSize ();
+    nr_type_t * s = new nr_type_t[depth * BLOCK];
+    for (int i = 0; i < len; i += BLOCK)
+    {
+        int n = std::min (BLOCK, len - i), sp = 0, j, k, size;
+        nr_type_t * a, * b;
+        for (unsigned int p = 0; p < prog.size (); p++)
+        {
+            const instr & in = prog[p];
+            a = s + (sp > 0 ? sp - 1 : 0) * BLOCK;
+            b = s + sp * BLOCK;
+            switch (in.op)
+            {
+            case OP_LOADV:
+                size = in.leaf->v->getSize ();
+                for (j = 0, k = i % size; j < n; j++)
+                {
+                    load (b[j], in.leaf->v, k);
+                    if (++k >= size) k = 0;
+                }
+                sp++;
+                break;
+            case OP_LOADD:
+            case OP_LOADC:
+                load (b[0], in.leaf);
+                for (j = 1; j < n; j++) b[j] = b[0];
+                sp++;
+                break;
+            case OP_NOP:
+                break;
+            case OP_NEG:
+                for (j = 0; j < n; j++) a[j] = -a[j];
+                break;
+            case OP_ADD:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++) a[j] += b[j];
+                break;
+            case OP_SUB:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++) a[j] -= b[j];
+                break;
+            case OP_MUL:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++) a[j] *= b[j];
+                break;
+            case OP_DIV:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++) a[j] /= b[j];
+                break;
+            case OP_REAL:
+                for (j = 0; j < n; j++) a[j] = realpart (a[j]);
+                break;
+            case OP_IMAG:
+                for (j = 0; j < n; j++) a[j] = imagpart (a[j]);
+                break;
+            case OP_ABS:
+                for (j = 0; j < n; j++) a[j] = magnitude (a[j]);
+                break;
+            case OP_CONJ:
+                for (j = 0; j < n; j++) a[j] = conjugate (a[j]);
+                break;
+            case OP_NORM:
+                for (j = 0; j < n; j++) a[j] = squared (a[j]);
+                break;
+            case OP_DB:
+                for (j = 0; j < n; j++) a[j] = 10.0 * std::log10 (squared (a[j]));
+                break;
+            case OP_EXP:
+                for (j = 0; j < n; j++) a[j] = qucs::exp (a[j]);
+                break;
+            case OP_SIN:
+                for (j = 0; j < n; j++) a[j] = qucs::sin (a[j]);
+                break;
+            case OP_COS:
+                for (j = 0; j < n; j++) a[j] = qucs::cos (a[j]);
+                break;
+            case OP_TAN:
+                for (j = 0; j < n; j++) a[j] = qucs::tan (a[j]);
+                break;
+            case OP_SINH:
+                for (j = 0; j < n; j++) a[j] = qucs::sinh (a[j]);
+                break;
+            case OP_COSH:
+                for (j = 0; j < n; j++) a[j] = qucs::cosh (a[j]);
+                break;
+            case OP_TANH:
+                for (j = 0; j < n; j++) a[j] = qucs::tanh (a[j]);
+                break;
+            case OP_RAD2DEG:
+                for (j = 0; j < n; j++) a[j] = qucs::rad2deg (a[j]);
+                break;
+            case OP_DEG2RAD:
+                for (j = 0; j < n; j++) a[j] = qucs::deg2rad (a[j]);
+                break;
+            case OP_ARG:
+                for (j = 0; j < n; j++) put (a[j], std::arg (nr_complex_t (a[j])));
+                break;
+            case OP_PHASE:
+                for (j = 0; j < n; j++)
+                    put (a[j], qucs::rad2deg (std::arg (nr_complex_t (a[j]))));
+                break;
+            case OP_SQRT:
+                for (j = 0; j < n; j++) put (a[j], qucs::sqrt (nr_complex_t (a[j])));
+                break;
+            case OP_LN:
+                for (j = 0; j < n; j++) put (a[j], qucs::log (nr_complex_t (a[j])));
+                break;
+            case OP_LOG10:
+                for (j = 0; j < n; j++) put (a[j], qucs::log10 (nr_complex_t (a[j])));
+                break;
+            case OP_LOG2:
+                for (j = 0; j < n; j++) put (a[j], qucs::log2 (nr_complex_t (a[j])));
+                break;
+            case OP_POW:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++)
+                    put (a[j], qucs::pow (nr_complex_t (a[j]), nr_complex_t (b[j])));
+                break;
+            case OP_POWVD:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++)
+                    put (a[j], qucs::pow (nr_complex_t (a[j]), realpart (b[j])));
+                break;
+            case OP_POWDV:
+                sp--; b = a; a -= BLOCK;
+                for (j = 0; j < n; j++)
+                    put (a[j], qucs::pow (realpart (a[j]), nr_complex_t (b[j])));
+                break;
+            }
+        }
+        for (j = 0; j < n; j++) res->set (s[j], i + j);
+    }
+    delete[] s;
+}
+
+/* The function evaluates the given application and all element-wise
+   applications below it in a single pass and returns the result.  It
+   behaves like application::evaluate() for the whole tree. */
+constant * elementwise::evaluate (application * app)
+{
+    std::vector<instr> prog;
+    strlist * apreps = new strlist ();
+    int sp = 0, depth = 0;
+
+    int errors = compile (app, app->solvee, prog, sp, depth, apreps);
+    if (!errors)
+    {
+        // length of the result, shorter vectors are repeated
+        int len = 0, isreal = 1;
+        for (unsigned int p = 0; p < prog.size (); p++)
+        {
+            const instr & in = prog[p];
+            if (in.op == OP_LOADV)
+            {
+                int size = in.leaf->v->getSize ();
+                if (size == 0 || len < 0) len = -1;
+                else if (size > len) len = size;
+                if (!in.leaf->v->isReal ()) isreal = 0;
+            }
+            else if (in.op == OP_LOADC && imag (*(in.leaf->c)) != 0.0)
+                isreal = 0;
+            else if (in.op >= OP_ARG)
+                isreal = 0;
+        }
+
+        constant * res = new constant (TAG_VECTOR);
+        res->v = new qucs::vector (len > 0 ? len : 0);
+        if (len > 0)
+        {
+            if (isreal)
+                run<nr_double_t> (prog, depth, res->v);
+            else
+                run<nr_complex_t> (prog, depth, res->v);
+        }
+        delete app->getResult ();
+        app->setResult (res);
+    }
+
+    // inherit prep dependencies of arguments if necessary
+    if (app->getResult () && !app->getResult()->dropdeps &&
+            apreps->length () > 0)
+    {
+        app->getResult()->dropdeps = 1;
+        app->getResult()->appendPrepDependencies (apreps);
+    }
+    delete apreps;
+
+    return app->getResult ();
+}
@@ -0,0 +1,51 @@
+/*
+ * elementwise.h - definitions for fused element-wise vector evaluation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __ELEMENTWISE_H__
+#define __ELEMENTWISE_H__
+
+namespace qucs {
+
+namespace eqn {
+
+class constant;
+class application;
+
+/* This class evaluates a tree of element-wise vector applications
+   (such as 'dB(S[2,1]) - 20*log10(abs(x))') in a single loop over the
+   data instead of creating a temporary vector for each application.
+   The tree is translated into a short list of stack operations which
+   are run on blocks of items. */
+class elementwise
+{
+ public:
+  static int fusable (application *);
+  static constant * evaluate (application *);
+};
+
+} // namespace eqn
+
+} // namespace qucs
+
+#endif /* __ELEMENTWISE_H__ */
@@ -34,7 +34,9 @@
 #include <cmath>
 #include <float.h>
 
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "compat.h"
 #include "logging.h"
@@ -60,6 +62,12 @@ eqnsys<nr_type_t>::eqnsys () {
   nPvt = NULL;
   cMap = rMap = NULL;
   update = 1;
+  luDone = 0;
+  lowRank = 0;
+  A0 = LU = NULL;
+  lrRank = 0;
+  sparse = 0;
+  AD = NULL;
   pivoting = PIVOT_PARTIAL;
   N = 0;
 }
@@ -73,6 +81,9 @@ eqnsys<nr_type_t>::~eqnsys () {
   delete S;
   delete E;
   delete V;
+  delete A0;
+  delete LU;
+  delete AD;
   delete[] rMap;
   delete[] cMap;
   delete[] nPvt;
@@ -90,6 +101,12 @@ eqnsys<nr_type_t>::eqnsys (eqnsys & e) {
   cMap = rMap = NULL;
   nPvt = NULL;
   update = 1;
+  luDone = 0;
+  lowRank = 0;
+  A0 = LU = NULL;
+  lrRank = 0;
+  sparse = 0;
+  AD = NULL;
   X = e.X;
   N = 0;
 }
@@ -106,12 +123,37 @@ void eqnsys<nr_type_t>::passEquationSys (tmatrix<nr_type_t> * nA,
   if (nA != NULL) {
     A = nA;
     update = 1;
-    if (N != A->getCols ()) {
-      N = A->getCols ();
-      delete[] cMap; cMap = new int[N];
-      delete[] rMap; rMap = new int[N];
-      delete[] nPvt; nPvt = new nr_double_t[N];
-    }
+    sparse = 0;
+    resize (A->getCols ());
+  }
+  else {
+    update = 0;
+  }
+  delete B;
+  B = new tvector<nr_type_t> (*nB);
+  X = refX;
+}
+
+/*! This function passes an equation system with a sparse matrix to
+   the Krylov methods (BiCGStab and CG).  The matrix is given in
+   compressed rows: the column indices and values of row r are at the
+   positions nRow[r] to nRow[r+1]-1 of nCol and nVal, sorted by column
+   and including the diagonal.  Without values the previous matrix is
+   kept.  The other algorithms require the dense matrix. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::passSparseSys (std::vector<int> * nRow,
+				       std::vector<int> * nCol,
+				       std::vector<nr_type_t> * nVal,
+				       tvector<nr_type_t> * refX,
+				       tvector<nr_type_t> * nB) {
+  if (nVal != NULL) {
+    sRow = *nRow;
+    sCol = *nCol;
+    sVal = *nVal;
+    A = NULL;
+    update = 1;
+    sparse = 1;
+    resize ((int) sRow.size () - 1);
   }
   else {
     update = 0;
@@ -121,6 +163,31 @@ void eqnsys<nr_type_t>::passEquationSys (tmatrix<nr_type_t> * nA,
   X = refX;
 }
 
+// Adjusts the pivoting and ordering arrays to the size of the system.
+template <class nr_type_t>
+void eqnsys<nr_type_t>::resize (int n) {
+  if (N != n) {
+    N = n;
+    delete[] cMap; cMap = new int[N];
+    delete[] rMap; rMap = new int[N];
+    delete[] nPvt; nPvt = new nr_double_t[N];
+    rOrder.clear ();
+  }
+}
+
+/*! The function enables or disables the low-rank updates of the LU
+   decomposition (see solve_lowrank()).  Disabling them releases the
+   base decomposition. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::setLowRank (int l) {
+  lowRank = l;
+  if (!lowRank && A0 != NULL) {
+    delete A0; A0 = NULL;
+    delete LU; LU = NULL;
+    lrRank = 0;
+  }
+}
+
 /*! Depending on the algorithm applied to the equation system solver
    the function stores the solution of the system into the matrix
    pointed to by the X matrix reference. */
@@ -140,7 +207,10 @@ void eqnsys<nr_type_t>::solve (void) {
     solve_gauss_jordan ();
     break;
   case ALGO_LU_DECOMPOSITION_CROUT:
-    solve_lu_crout ();
+    if (lowRank)
+      solve_lowrank ();
+    else
+      solve_lu_crout ();
     break;
   case ALGO_LU_DECOMPOSITION_DOOLITTLE:
     solve_lu_doolittle ();
@@ -163,6 +233,12 @@ void eqnsys<nr_type_t>::solve (void) {
   case ALGO_SOR:
     solve_sor ();
     break;
+  case ALGO_BICGSTAB:
+    solve_bicgstab ();
+    break;
+  case ALGO_CG:
+    solve_cg ();
+    break;
   case ALGO_QR_DECOMPOSITION:
     solve_qr ();
     break;
@@ -502,6 +578,192 @@ void eqnsys<nr_type_t>::substitute_lu_doolittle (void) {
   }
 }
 
+// maximum rank of the low-rank update of the LU decomposition
+#define LOWRANK_MAX  32
+// smallest relative pivot of the capacitance matrix
+#define LOWRANK_PIVT 1e-9
+
+/*! The function solves the equation system by updating an earlier LU
+   decomposition (the base) instead of decomposing the matrix once
+   again.  If the new matrix differs from the base matrix A0 in k rows
+   (or columns) only, the difference is written as U*W with U having k
+   columns, and the Sherman-Morrison-Woodbury formula
+
+     (A0 + U*W)^-1 = A0^-1 - Z * (I + W*Z)^-1 * W * A0^-1, Z = A0^-1 * U
+
+   takes k + 1 substitutions and the decomposition of a small k by k
+   matrix instead of O(N^3) operations.  This is the case for a
+   parameter sweep over a few linear components.  Beyond a rank
+   threshold or if the update turns out to be ill-conditioned the new
+   matrix becomes the base. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_lowrank (void) {
+  if (update) {
+    if (!update_lowrank ()) factorize_base ();
+  }
+  else if (LU == NULL) {
+    // the matrix has been decomposed by another algorithm
+    substitute_lu_crout ();
+    return;
+  }
+  if (!substitute_lowrank () && lrRank > 0) {
+    // the matrix A is still unchanged, thus start over
+    factorize_base ();
+    substitute_lowrank ();
+  }
+}
+
+/*! The function saves the current matrix as the base matrix and keeps
+   its LU decomposition. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::factorize_base (void) {
+  if (A0 == NULL)
+    A0 = new tmatrix<nr_type_t> (*A);
+  else
+    *A0 = *A;
+  factorize_lu_crout ();
+  if (LU == NULL)
+    LU = new tmatrix<nr_type_t> (*A);
+  else
+    *LU = *A;
+  lMap.assign (rMap, rMap + N);
+  lrRank = 0;
+}
+
+/*! The function compares the matrix A with the base matrix and
+   prepares the low-rank update of the base decomposition.  It returns
+   zero if there is no base or the rank of the difference is too large
+   or the update is ill-conditioned. */
+template <class nr_type_t>
+int eqnsys<nr_type_t>::update_lowrank (void) {
+  int r, c, i, j, k, kmax = std::min (N / 4, LOWRANK_MAX);
+  if (A0 == NULL || A0->getCols () != N) return 0;
+
+  // find the rows and columns which differ from the base
+  std::vector<int> rows, cols;
+  std::vector<char> mark (N, 0);
+  int marked = 0;
+  for (r = 0; r < N; r++) {
+    int changed = 0;
+    for (c = 0; c < N; c++) {
+      if (A_(r, c) != (*A0)(r, c)) {
+	changed = 1;
+	if (!mark[c]) { mark[c] = 1; marked++; }
+      }
+    }
+    if (changed) rows.push_back (r);
+    if ((int) rows.size () > kmax && marked > kmax) return 0;
+  }
+  for (c = 0; c < N; c++) if (mark[c]) cols.push_back (c);
+
+  // write the difference as U * W and compute Z = A0^-1 * U
+  k = (int) std::min (rows.size (), cols.size ());
+  lrW.assign (k * N, 0);
+  lrZ.assign (k * N, 0);
+  std::vector<nr_type_t> u (N);
+  for (i = 0; i < k; i++) {
+    if (rows.size () <= cols.size ()) {
+      // U are unit columns, W the changed rows
+      r = rows[i];
+      for (c = 0; c < N; c++) lrW[i * N + c] = A_(r, c) - (*A0)(r, c);
+      std::fill (u.begin (), u.end (), 0);
+      u[r] = 1;
+    }
+    else {
+      // U are the changed columns, W unit rows
+      c = cols[i];
+      for (r = 0; r < N; r++) u[r] = A_(r, c) - (*A0)(r, c);
+      lrW[i * N + c] = 1;
+    }
+    substitute_base (u.data (), &lrZ[i * N]);
+  }
+
+  // decompose the capacitance matrix I + W * Z using partial pivoting
+  lrC.assign (k * k, 0);
+  lrPvt.resize (k);
+  nr_double_t MaxPivot = 0;
+  for (i = 0; i < k; i++) {
+    for (j = 0; j < k; j++) {
+      nr_type_t f = (i == j) ? 1 : 0;
+      for (c = 0; c < N; c++) f += lrW[i * N + c] * lrZ[j * N + c];
+      lrC[i * k + j] = f;
+      MaxPivot = std::max (MaxPivot, (nr_double_t) abs (f));
+    }
+  }
+  for (j = 0; j < k; j++) {
+    int pivot = j;
+    for (r = j + 1; r < k; r++)
+      if (abs (lrC[r * k + j]) > abs (lrC[pivot * k + j])) pivot = r;
+    if (!(abs (lrC[pivot * k + j]) > LOWRANK_PIVT * MaxPivot)) return 0;
+    lrPvt[j] = pivot;
+    if (pivot != j)
+      for (c = 0; c < k; c++)
+	std::swap (lrC[j * k + c], lrC[pivot * k + c]);
+    for (r = j + 1; r < k; r++) {
+      nr_type_t f = lrC[r * k + j] /= lrC[j * k + j];
+      for (c = j + 1; c < k; c++) lrC[r * k + c] -= f * lrC[j * k + c];
+    }
+  }
+  lrRank = k;
+  return 1;
+}
+
+/*! Forward and backward substitution using the base decomposition
+   (Crout's definition) for the right hand side b into the vector x. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::substitute_base (nr_type_t * b, nr_type_t * x) {
+  tmatrix<nr_type_t> & L = *LU;
+  nr_type_t f;
+  int i, c;
+
+  for (i = 0; i < N; i++) {
+    f = b[lMap[i]];
+    for (c = 0; c < i; c++) f -= L (i, c) * x[c];
+    x[i] = f / L (i, i);
+  }
+  for (i = N - 1; i >= 0; i--) {
+    f = x[i];
+    for (c = i + 1; c < N; c++) f -= L (i, c) * x[c];
+    x[i] = f;
+  }
+}
+
+/*! The function solves the equation system using the base
+   decomposition and its low-rank update.  It returns zero if the
+   solution is not finite. */
+template <class nr_type_t>
+int eqnsys<nr_type_t>::substitute_lowrank (void) {
+  std::vector<nr_type_t> b (N), y (N);
+  int i, j, c, k = lrRank;
+
+  for (i = 0; i < N; i++) b[i] = B_(i);
+  substitute_base (b.data (), y.data ());
+
+  if (k > 0) {
+    // t = (I + W * Z)^-1 * W * y
+    std::vector<nr_type_t> t (k, 0);
+    for (i = 0; i < k; i++)
+      for (c = 0; c < N; c++) t[i] += lrW[i * N + c] * y[c];
+    for (j = 0; j < k; j++) std::swap (t[j], t[lrPvt[j]]);
+    for (j = 0; j < k; j++)
+      for (i = j + 1; i < k; i++) t[i] -= lrC[i * k + j] * t[j];
+    for (i = k - 1; i >= 0; i--) {
+      for (c = i + 1; c < k; c++) t[i] -= lrC[i * k + c] * t[c];
+      t[i] /= lrC[i * k + i];
+    }
+    // x = y - Z * t
+    for (j = 0; j < k; j++)
+      for (c = 0; c < N; c++) y[c] -= lrZ[j * N + c] * t[j];
+  }
+
+  int finite = 1;
+  for (i = 0; i < N; i++) {
+    if (!std::isfinite (abs (y[i]))) finite = 0;
+    X_(i) = y[i];
+  }
+  return finite;
+}
+
 /*! The function solves the equation system using a full-step iterative
    method (called Jacobi's method) or a single-step method (called
    Gauss-Seidel) depending on the given algorithm.  If the current X
@@ -518,11 +780,8 @@ void eqnsys<nr_type_t>::solve_iterative (void) {
   nr_double_t abstol = NR_TINY;
   nr_double_t diff, crit;
 
-  // ensure that all diagonal values are non-zero
-  ensure_diagonal ();
-
-  // try to raise diagonal dominance
-  preconditioner ();
+  // ensure non-zero diagonal values and raise diagonal dominance
+  reorder ();
 
   // decide here about possible convergence
   if ((crit = convergence_criteria ()) >= 1) {
@@ -535,11 +794,12 @@ void eqnsys<nr_type_t>::solve_iterative (void) {
   }
 
   // normalize the equation system to have ones on its diagonal
-  for (r = 0; r < N; r++) {
-    f = A_(r, r);
-    assert (f != 0); // singular matrix
-    for (c = 0; c < N; c++) A_(r, c) /= f;
-    B_(r) /= f;
+  normalize ();
+
+  // the LU decomposition of an earlier fallback is still valid
+  if (!update && luDone) {
+    substitute_lu_crout ();
+    return;
   }
 
   // the current X vector is a good initial guess for the iteration
@@ -583,7 +843,9 @@ void eqnsys<nr_type_t>::solve_iterative (void) {
     logprint (LOG_ERROR,
 	      "WARNING: no convergence after %d %s iterations\n",
 	      i, algo == ALGO_JACOBI ? "jacobi" : "gauss-seidel");
-    solve_lu_crout ();
+    if (update || !luDone) factorize_lu_crout ();
+    luDone = 1;
+    substitute_lu_crout ();
   }
 #if DEBUG && 0
   else {
@@ -607,11 +869,8 @@ void eqnsys<nr_type_t>::solve_sor (void) {
   nr_double_t abstol = NR_TINY;
   nr_double_t diff, crit, l = 1, d, s;
 
-  // ensure that all diagonal values are non-zero
-  ensure_diagonal ();
-
-  // try to raise diagonal dominance
-  preconditioner ();
+  // ensure non-zero diagonal values and raise diagonal dominance
+  reorder ();
 
   // decide here about possible convergence
   if ((crit = convergence_criteria ()) >= 1) {
@@ -624,11 +883,12 @@ void eqnsys<nr_type_t>::solve_sor (void) {
   }
 
   // normalize the equation system to have ones on its diagonal
-  for (r = 0; r < N; r++) {
-    f = A_(r, r);
-    assert (f != 0); // singular matrix
-    for (c = 0; c < N; c++) A_(r, c) /= f;
-    B_(r) /= f;
+  normalize ();
+
+  // the LU decomposition of an earlier fallback is still valid
+  if (!update && luDone) {
+    substitute_lu_crout ();
+    return;
   }
 
   // the current X vector is a good initial guess for the iteration
@@ -679,7 +939,9 @@ void eqnsys<nr_type_t>::solve_sor (void) {
     logprint (LOG_ERROR,
 	      "WARNING: no convergence after %d sor iterations (l = %g)\n",
 	      i, l);
-    solve_lu_crout ();
+    if (update || !luDone) factorize_lu_crout ();
+    luDone = 1;
+    substitute_lu_crout ();
   }
 #if DEBUG && 0
   else {
@@ -689,6 +951,301 @@ void eqnsys<nr_type_t>::solve_sor (void) {
 #endif
 }
 
+/*! The function solves the equation system with the stabilized
+   bi-conjugate gradient method (BiCGStab).  The non-zero elements of
+   the matrix are kept in compressed rows and the method is right
+   preconditioned by an incomplete LU factorization without fill-in,
+   thus neither time nor memory grow with the square of the number of
+   unknowns as for the direct methods.  As long as the left hand side
+   does not change the factorization is reused.  On divergence the
+   method falls back to LU decomposition if the system is small
+   enough (see solve_fallback()), otherwise the solution vector is
+   left unchanged. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_bicgstab (void) {
+  int MaxIter = std::max (N, 20);
+  nr_double_t reltol = 1e-12;
+  nr_double_t abstol = NR_TINY;
+  int i, it, conv = 0;
+
+  if (update) {
+    if (!sparse) compress ();
+    factorize_ilu ();
+    luDone = 0;
+  }
+  else if (luDone) {
+    // the LU decomposition of an earlier fallback is still valid
+    substitute_lu_crout ();
+    return;
+  }
+
+  std::vector<nr_type_t> x (N), r (N), r0 (N), p (N, 0), v (N, 0);
+  std::vector<nr_type_t> s (N), t (N), y (N), z (N);
+  nr_type_t rho = 1, alpha = 1, omega = 1, rho1, beta;
+  nr_double_t bnorm = 0;
+
+  // the current X vector is a good initial guess
+  for (i = 0; i < N; i++) {
+    x[i] = X_(i);
+    bnorm += norm (B_(i));
+  }
+  bnorm = sqrt (bnorm);
+  multiply_sparse (x, r);
+  for (i = 0; i < N; i++) r0[i] = r[i] = B_(i) - r[i];
+  nr_double_t tol = reltol * bnorm + abstol;
+
+  for (it = 0; it < MaxIter; it++) {
+    if (sqrt (abs (dot (r, r))) <= tol) { conv = 1; break; }
+    rho1 = dot (r0, r);
+    if (rho1 == 0.0) break;
+    if (it == 0) {
+      p = r;
+    }
+    else {
+      beta = (rho1 / rho) * (alpha / omega);
+      for (i = 0; i < N; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    }
+    // v = A * M^-1 * p
+    apply_ilu (p, y);
+    multiply_sparse (y, v);
+    nr_type_t d = dot (r0, v);
+    if (d == 0.0) break;
+    alpha = rho1 / d;
+    for (i = 0; i < N; i++) s[i] = r[i] - alpha * v[i];
+    if (sqrt (abs (dot (s, s))) <= tol) {
+      for (i = 0; i < N; i++) x[i] += alpha * y[i];
+      conv = 1;
+      break;
+    }
+    // t = A * M^-1 * s
+    apply_ilu (s, z);
+    multiply_sparse (z, t);
+    nr_type_t tt = dot (t, t);
+    if (tt == 0.0) break;
+    omega = dot (t, s) / tt;
+    for (i = 0; i < N; i++) {
+      x[i] += alpha * y[i] + omega * z[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    if (!std::isfinite (abs (omega)) || omega == 0.0) break;
+    rho = rho1;
+  }
+
+  if (!conv) {
+    logprint (LOG_ERROR,
+	      "WARNING: no convergence after %d bicgstab iterations\n", it);
+    if (!solve_fallback ()) {
+      // leave X alone and let the analysis handle the failure
+      qucs::exception * e = new qucs::exception (EXCEPTION_NO_CONVERGENCE);
+      e->setText ("no convergence after %d bicgstab iterations", it);
+      throw_exception (e);
+    }
+    return;
+  }
+  for (i = 0; i < N; i++) X_(i) = x[i];
+}
+
+/*! The function solves the equation system with the preconditioned
+   conjugate gradient method.  It requires a symmetric positive
+   definite matrix, which is the case for circuits made of resistors,
+   capacitors and current sources only, and takes less work per
+   iteration than BiCGStab.  The incomplete LU factorization of such a
+   matrix equals an incomplete Cholesky factorization and serves as
+   preconditioner.  If the matrix turns out to be indefinite the method
+   falls back to LU decomposition like BiCGStab does. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::solve_cg (void) {
+  int MaxIter = std::max (N, 20);
+  nr_double_t reltol = 1e-12;
+  nr_double_t abstol = NR_TINY;
+  int i, it, conv = 0;
+
+  if (update) {
+    if (!sparse) compress ();
+    factorize_ilu ();
+    luDone = 0;
+  }
+  else if (luDone) {
+    // the LU decomposition of an earlier fallback is still valid
+    substitute_lu_crout ();
+    return;
+  }
+
+  std::vector<nr_type_t> x (N), r (N), z (N), p (N), q (N);
+  nr_type_t rho, rho1 = 1, alpha, beta;
+  nr_double_t bnorm = 0;
+
+  // the current X vector is a good initial guess
+  for (i = 0; i < N; i++) {
+    x[i] = X_(i);
+    bnorm += norm (B_(i));
+  }
+  bnorm = sqrt (bnorm);
+  multiply_sparse (x, r);
+  for (i = 0; i < N; i++) r[i] = B_(i) - r[i];
+  nr_double_t tol = reltol * bnorm + abstol;
+
+  for (it = 0; it < MaxIter; it++) {
+    if (sqrt (abs (dot (r, r))) <= tol) { conv = 1; break; }
+    // z = M^-1 * r
+    apply_ilu (r, z);
+    rho = dot (r, z);
+    if (real (rho) <= 0.0) break;
+    if (it == 0) {
+      p = z;
+    }
+    else {
+      beta = rho / rho1;
+      for (i = 0; i < N; i++) p[i] = z[i] + beta * p[i];
+    }
+    multiply_sparse (p, q);
+    nr_type_t d = dot (p, q);
+    // the matrix is not positive definite
+    if (real (d) <= 0.0) break;
+    alpha = rho / d;
+    for (i = 0; i < N; i++) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    rho1 = rho;
+  }
+
+  if (!conv) {
+    logprint (LOG_ERROR,
+	      "WARNING: no convergence after %d cg iterations\n", it);
+    if (!solve_fallback ()) {
+      // leave X alone and let the analysis handle the failure
+      qucs::exception * e = new qucs::exception (EXCEPTION_NO_CONVERGENCE);
+      e->setText ("no convergence after %d cg iterations", it);
+      throw_exception (e);
+    }
+    return;
+  }
+  for (i = 0; i < N; i++) X_(i) = x[i];
+}
+
+// largest equation system the Krylov methods fall back to LU for
+#define FALLBACK_MAX 2000
+
+/*! If a Krylov method does not converge, the function solves the
+   equation system by LU decomposition and keeps the decomposition
+   for further right hand sides.  A sparse matrix is expanded for this
+   purpose.  Large systems are left alone, neither the dense matrix
+   nor the cubic effort of the decomposition would be affordable.  The
+   function returns zero if there has been no fallback, the caller
+   then throws an EXCEPTION_NO_CONVERGENCE. */
+template <class nr_type_t>
+int eqnsys<nr_type_t>::solve_fallback (void) {
+  if (N > FALLBACK_MAX) return 0;
+  if (update || !luDone) {
+    if (sparse) {
+      delete AD;
+      AD = new tmatrix<nr_type_t> (N);
+      for (int r = 0; r < N; r++)
+	for (int k = sRow[r]; k < sRow[r + 1]; k++)
+	  AD->set (r, sCol[k], sVal[k]);
+      A = AD;
+    }
+    factorize_lu_crout ();
+  }
+  luDone = 1;
+  substitute_lu_crout ();
+  return 1;
+}
+
+//! This function copies the non-zero elements of A into compressed rows.
+template <class nr_type_t>
+void eqnsys<nr_type_t>::compress (void) {
+  sRow.assign (N + 1, 0);
+  sCol.clear ();
+  sVal.clear ();
+  for (int r = 0; r < N; r++) {
+    for (int c = 0; c < N; c++) {
+      if (A_(r, c) != 0.0 || c == r) {
+	sCol.push_back (c);
+	sVal.push_back (A_(r, c));
+      }
+    }
+    sRow[r + 1] = (int) sCol.size ();
+  }
+}
+
+/*! This function computes the incomplete LU factorization ILU(0) of
+   the compressed rows, i.e. Gaussian elimination dropping all fill-in
+   elements.  L (with unit diagonal) and U share the compressed rows.
+   The diagonal must be part of the pattern.  The rows are not
+   reordered: the zero diagonals of the voltage source rows at the end
+   of the MNA matrix get filled during the elimination of their node
+   rows. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::factorize_ilu (void) {
+  int r, c, k, j;
+
+  // position of the diagonal in each row
+  sDiag.assign (N, -1);
+  for (r = 0; r < N; r++) {
+    for (k = sRow[r]; k < sRow[r + 1]; k++)
+      if (sCol[k] == r) sDiag[r] = k;
+    assert (sDiag[r] >= 0);
+  }
+
+  // incomplete factorization on the pattern of A
+  sLU = sVal;
+  std::vector<int> pos (N, -1);
+  for (r = 0; r < N; r++) {
+    for (k = sRow[r]; k < sRow[r + 1]; k++) pos[sCol[k]] = k;
+    for (k = sRow[r]; k < sDiag[r]; k++) {
+      c = sCol[k];
+      if (sLU[sDiag[c]] == 0.0) continue;
+      sLU[k] /= sLU[sDiag[c]];
+      for (j = sDiag[c] + 1; j < sRow[c + 1]; j++) {
+	if (pos[sCol[j]] >= 0) sLU[pos[sCol[j]]] -= sLU[k] * sLU[j];
+      }
+    }
+    for (k = sRow[r]; k < sRow[r + 1]; k++) pos[sCol[k]] = -1;
+    // keep the preconditioner regular
+    if (sLU[sDiag[r]] == 0.0) sLU[sDiag[r]] = 1;
+  }
+}
+
+/*! Applies the incomplete LU factorization to the vector r by forward
+   and backward substitution, i.e. z = (LU)^-1 * r. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::apply_ilu (std::vector<nr_type_t> & r,
+				  std::vector<nr_type_t> & z) {
+  int i, k;
+  nr_type_t f;
+  for (i = 0; i < N; i++) {
+    for (f = r[i], k = sRow[i]; k < sDiag[i]; k++) f -= sLU[k] * z[sCol[k]];
+    z[i] = f;
+  }
+  for (i = N - 1; i >= 0; i--) {
+    f = z[i];
+    for (k = sDiag[i] + 1; k < sRow[i + 1]; k++) f -= sLU[k] * z[sCol[k]];
+    z[i] = f / sLU[sDiag[i]];
+  }
+}
+
+//! Multiplies the compressed rows of the matrix with the vector x.
+template <class nr_type_t>
+void eqnsys<nr_type_t>::multiply_sparse (std::vector<nr_type_t> & x,
+					std::vector<nr_type_t> & y) {
+  for (int i = 0; i < N; i++) {
+    nr_type_t f = 0;
+    for (int k = sRow[i]; k < sRow[i + 1]; k++) f += sVal[k] * x[sCol[k]];
+    y[i] = f;
+  }
+}
+
+//! Returns the inner product of the vectors a and b.
+template <class nr_type_t>
+nr_type_t eqnsys<nr_type_t>::dot (std::vector<nr_type_t> & a,
+				  std::vector<nr_type_t> & b) {
+  nr_type_t f = 0;
+  for (int i = 0; i < N; i++) f += conj (a[i]) * b[i];
+  return f;
+}
+
 /*! The function computes the convergence criteria for iterative
    methods like Jacobi or Gauss-Seidel as defined by Schmidt and
    v.Mises. */
@@ -703,75 +1260,139 @@ nr_double_t eqnsys<nr_type_t>::convergence_criteria (void) {
   return sqrt (f);
 }
 
-/*! The function tries to ensure that there are non-zero diagonal
-   elements in the equation system matrix A.  This is required for
-   iterative solution methods. */
+/*! The function brings the rows of the equation system into an order
+   with non-zero diagonal elements and raised diagonal dominance, as
+   required by the iterative solution methods.  The zero structure of
+   the MNA matrix (from voltage sources and inductors) does not change
+   within an analysis, thus the row order found for the first system
+   is reused for the following ones as long as it still yields a
+   non-zero diagonal. */
 template <class nr_type_t>
-void eqnsys<nr_type_t>::ensure_diagonal (void) {
-  ensure_diagonal_MNA ();
+void eqnsys<nr_type_t>::reorder (void) {
+  if (!update && (int) rOrder.size () == N) {
+    // the matrix is still arranged, the new right hand side is not
+    tvector<nr_type_t> b (*B);
+    for (int i = 0; i < N; i++) B_(i) = b (rOrder[i]);
+    return;
+  }
+  luDone = 0;
+  std::vector<int> order (rOrder);
+  rOrder.resize (N);
+  for (int i = 0; i < N; i++) rOrder[i] = i;
+  if ((int) order.size () == N) {
+    permuteRows (order);
+    int i;
+    for (i = 0; i < N; i++) if (A_(i, i) == 0) break;
+    if (i >= N) return;
+  }
+  ensure_diagonal ();
+  preconditioner ();
 }
 
-/*! The function ensures that there are non-zero diagonal elements in
-   the equation system matrix A.  It achieves this condition for
-   non-singular matrices which have been produced by the modified
-   nodal analysis.  It takes advantage of the fact that the zero
-   diagonal elements have pairs of 1 and -1 on the same column and
-   row. */
+/*! The function scales the rows of the equation system to have ones
+   on the diagonal of the matrix.  If the matrix has been normalized
+   before only the right hand side is scaled. */
 template <class nr_type_t>
-void eqnsys<nr_type_t>::ensure_diagonal_MNA (void) {
-  int restart, exchanged, begin = 0, pairs;
-  int pivot1, pivot2, i;
-  do {
-    restart = exchanged = 0;
-    /* search for zero diagonals with lone pairs */
-    for (i = begin; i < N; i++) {
-      if (A_(i, i) == 0) {
-	pairs = countPairs (i, pivot1, pivot2);
-	if (pairs == 1) { /* lone pair found, substitute rows */
-	  A->exchangeRows (i, pivot1);
-	  B->exchangeRows (i, pivot1);
-	  exchanged = 1;
-	}
-	else if ((pairs > 1) && !restart) {
-	  restart = 1;
-	  begin = i;
-	}
-      }
+void eqnsys<nr_type_t>::normalize (void) {
+  int r, c;
+  if (update || (int) rScale.size () != N) {
+    rScale.resize (N);
+    for (r = 0; r < N; r++) {
+      nr_type_t f = A_(r, r);
+      assert (f != 0); // singular matrix
+      for (c = 0; c < N; c++) A_(r, c) /= f;
+      rScale[r] = f;
     }
+  }
+  for (r = 0; r < N; r++) B_(r) /= rScale[r];
+}
 
-    /* all lone pairs are gone, look for zero diagonals with multiple pairs */
-    if (restart) {
-      for (i = begin; !exchanged && i < N; i++) {
-	if (A_(i, i) == 0) {
-	  pairs = countPairs (i, pivot1, pivot2);
-	  A->exchangeRows (i, pivot1);
-	  B->exchangeRows (i, pivot1);
-	  exchanged = 1;
-	}
-      }
+/*! The function arranges the rows of the equation system in the given
+   order of original rows. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::permuteRows (std::vector<int> & order) {
+  std::vector<int> pos (N);
+  for (int i = 0; i < N; i++) pos[rOrder[i]] = i;
+  for (int i = 0; i < N; i++) {
+    int j = pos[order[i]];
+    if (j != i) {
+      pos[rOrder[i]] = j;
+      pos[rOrder[j]] = i;
+      swapRows (i, j);
     }
   }
-  while (restart);
 }
 
-/*! Helper function for the above ensure_diagonal_MNA() function.  It
-   looks for the pairs of 1 and -1 on the given row and column index. */
+//! Exchanges two rows of the equation system and records the row order.
 template <class nr_type_t>
-int eqnsys<nr_type_t>::countPairs (int i, int& r1, int& r2) {
-  int pairs = 0;
-  for (int r = 0; r < N; r++) {
-    if (fabs (real (A_(r, i))) == 1.0) {
-      r1 = r;
-      pairs++;
-      for (r++; r < N; r++) {
-	if (fabs (real (A_(r, i))) == 1.0) {
-	  r2 = r;
-	  if (++pairs >= 2) return pairs;
-	}
+void eqnsys<nr_type_t>::swapRows (int i, int j) {
+  A->exchangeRows (i, j);
+  B->exchangeRows (i, j);
+  Swap (int, rOrder[i], rOrder[j]);
+}
+
+/*! The function ensures that there are non-zero diagonal elements in
+   the equation system matrix A.  It computes a maximum transversal of
+   the matrix (a row for each column with a non-zero element on the
+   intersection) by searching augmenting paths, keeping the rows with
+   non-zero diagonal elements in place where possible.  For
+   structurally singular matrices the remaining zero diagonals stay. */
+template <class nr_type_t>
+void eqnsys<nr_type_t>::ensure_diagonal (void) {
+  int r, c, k;
+
+  // rows of the non-zero elements of each column
+  std::vector< std::vector<int> > cols (N);
+  for (r = 0; r < N; r++)
+    for (c = 0; c < N; c++)
+      if (A_(r, c) != 0) cols[c].push_back (r);
+
+  // keep the non-zero diagonals
+  std::vector<int> rowMatch (N, -1), colMatch (N, -1), visit (N, -1);
+  for (c = 0; c < N; c++) {
+    if (A_(c, c) != 0) colMatch[c] = rowMatch[c] = c;
+  }
+
+  // search augmenting paths for the other columns
+  struct step_t { int col, next; };
+  std::vector<step_t> path;
+  for (c = 0; c < N; c++) {
+    if (colMatch[c] >= 0) continue;
+    int found = -1;
+    path.clear ();
+    path.push_back ({c, 0});
+    while (!path.empty () && found < 0) {
+      step_t & s = path.back ();
+      if (s.next >= (int) cols[s.col].size ()) {
+	path.pop_back ();
+	continue;
       }
+      r = cols[s.col][s.next++];
+      if (visit[r] == c) continue;
+      visit[r] = c;
+      if (rowMatch[r] < 0)
+	found = r;
+      else
+	path.push_back ({rowMatch[r], 0});
+    }
+    // flip the matching along the path
+    for (k = (int) path.size () - 1; found >= 0 && k >= 0; k--) {
+      int j = path[k].col;
+      r = colMatch[j];
+      colMatch[j] = found;
+      rowMatch[found] = j;
+      found = r;
     }
   }
-  return pairs;
+
+  // the row order, unmatched rows fill the remaining positions
+  std::vector<int> order (N);
+  for (r = 0, c = 0; c < N; c++) {
+    if (colMatch[c] >= 0) { order[c] = rOrder[colMatch[c]]; continue; }
+    while (rowMatch[r] >= 0) r++;
+    order[c] = rOrder[r++];
+  }
+  permuteRows (order);
 }
 
 /*! The function tries to raise the absolute value of diagonal elements
@@ -791,10 +1412,7 @@ void eqnsys<nr_type_t>::preconditioner (void) {
       }
     }
     // swap matrix rows if possible
-    if (i != pivot) {
-      A->exchangeRows (i, pivot);
-      B->exchangeRows (i, pivot);
-    }
+    if (i != pivot) swapRows (i, pivot);
   }
 }
 
@@ -26,6 +26,7 @@
 #define __EQNSYS_H__
 
 #include <limits>
+#include <vector>
 
 //! Definition of equation system solving algorithms.
 enum algo_type {
@@ -45,6 +46,8 @@ enum algo_type {
   ALGO_QR_DECOMPOSITION           = 0x0400,
   ALGO_QR_DECOMPOSITION_LS        = 0x0800,
   ALGO_SV_DECOMPOSITION           = 0x1000,
+  ALGO_BICGSTAB                   = 0x4000,
+  ALGO_CG                         = 0x8000,
   // testing
   ALGO_QR_DECOMPOSITION_2         = 0x2000,
 };
@@ -70,8 +73,12 @@ class eqnsys
   ~eqnsys ();
   void setAlgo (int a) { algo = a; }
   int  getAlgo (void) { return algo; }
+  void setLowRank (int);
   void passEquationSys (tmatrix<nr_type_t> *, tvector<nr_type_t> *,
 			tvector<nr_type_t> *);
+  void passSparseSys (std::vector<int> *, std::vector<int> *,
+		      std::vector<nr_type_t> *, tvector<nr_type_t> *,
+		      tvector<nr_type_t> *);
   void solve (void);
 
  private:
@@ -82,6 +89,30 @@ class eqnsys
   int * cMap;
   int N;
   nr_double_t * nPvt;
+  std::vector<int> rOrder;
+  std::vector<nr_type_t> rScale;
+  int luDone;
+
+  // compressed rows of the matrix and its incomplete LU factorization
+  int sparse;
+  std::vector<int> sRow;
+  std::vector<int> sCol;
+  std::vector<int> sDiag;
+  std::vector<nr_type_t> sVal;
+  std::vector<nr_type_t> sLU;
+  // dense copy of the compressed rows for the LU fallback
+  tmatrix<nr_type_t> * AD;
+
+  // base LU decomposition and its low-rank update
+  int lowRank;
+  tmatrix<nr_type_t> * A0;
+  tmatrix<nr_type_t> * LU;
+  std::vector<int> lMap;
+  int lrRank;
+  std::vector<nr_type_t> lrW;
+  std::vector<nr_type_t> lrZ;
+  std::vector<nr_type_t> lrC;
+  std::vector<int> lrPvt;
 
   tmatrix<nr_type_t> * A;
   tmatrix<nr_type_t> * V;
@@ -125,12 +156,28 @@ class eqnsys
   void factorize_svd (void);
   void substitute_svd (void);
   void diagonalize_svd (void);
+  void solve_lowrank (void);
+  void factorize_base (void);
+  int  update_lowrank (void);
+  void substitute_base (nr_type_t *, nr_type_t *);
+  int  substitute_lowrank (void);
   void solve_iterative (void);
   void solve_sor (void);
+  void solve_bicgstab (void);
+  void solve_cg (void);
+  int  solve_fallback (void);
+  void compress (void);
+  void factorize_ilu (void);
+  void apply_ilu (std::vector<nr_type_t> &, std::vector<nr_type_t> &);
+  void multiply_sparse (std::vector<nr_type_t> &, std::vector<nr_type_t> &);
+  nr_type_t dot (std::vector<nr_type_t> &, std::vector<nr_type_t> &);
   nr_double_t convergence_criteria (void);
+  void resize (int);
+  void reorder (void);
+  void normalize (void);
+  void permuteRows (std::vector<int> &);
+  void swapRows (int, int);
   void ensure_diagonal (void);
-  void ensure_diagonal_MNA (void);
-  int countPairs (int, int&, int&);
   void preconditioner (void);
 };
 
@@ -44,6 +44,7 @@
 #include "equation.h"
 #include "evaluate.h"
 #include "differentiate.h"
+#include "elementwise.h"
 #include "constants.h"
 #include "range.h"
 #include "exception.h"
@@ -915,6 +916,12 @@ constant * application::evaluate (void)
         return getResult ();
     }
 
+    // Evaluate chains of element-wise vector functions in one go.
+    if (elementwise::fusable (this))
+    {
+        return elementwise::evaluate (this);
+    }
+
     int errors = 0;
     strlist * apreps = new strlist ();
 
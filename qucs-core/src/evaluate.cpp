@@ -3923,14 +3923,14 @@ constant * evaluate::kbd_d_d (constant * args) {
   qucs::vector v (size);
   for (i = 0; i < size / 2; i++) {
     sval += fspecial::i0 (pi * alpha * std::sqrt (1.0 - sqr (4.0 * i / size - 1.0)));
-    v (i) = sval;
+    v.set (sval, i);
   }
   // need to add one more value to the normalization factor at size/2
   sval += fspecial::i0 (pi * alpha * std::sqrt (1.0 - sqr (4.0 * (size / 2) / size - 1.0)));
   // normalize the window and fill in the righthand side of the window
   for (i = 0; i < size / 2; i++) {
-    v (i) = std::sqrt (v (i) / sval);
-    v (size - 1 - i) = v (i);
+    v.set (std::sqrt (v.getReal (i) / sval), i);
+    v.set (v.getReal (i), size - 1 - i);
   }
   _RETV (v);
 }
@@ -4857,8 +4857,8 @@ constant * evaluate::receiver_v_v (constant * args) {
   qucs::vector * rvec = new qucs::vector (rlen);
   qucs::vector * rfeq = new qucs::vector (rlen);
   for (int i = 0; i < rlen; i++) {
-    (*rvec)(i) = real (ed->get (i));
-    (*rfeq)(i) = imag (ed->get (i));
+    rvec->set (real (ed->get (i)), i);
+    rfeq->set (imag (ed->get (i)), i);
   }
   delete ed;
 
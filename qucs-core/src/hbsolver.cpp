@@ -38,6 +38,7 @@
 #include "circuit.h"
 #include "component_id.h"
 #include "net.h"
+#include "arena.h"
 #include "netdefs.h"
 #include "strlist.h"
 #include "ptrlist.h"
@@ -307,6 +308,7 @@ void hbsolver::calc (hbsolver * self) {
 /* Goes through the list of circuit objects and runs its initHB()
    function. */
 void hbsolver::initHB (void) {
+  subnet->getArena()->restart ();
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
     c->initHB ();
@@ -316,6 +318,7 @@ void hbsolver::initHB (void) {
 /* Goes through the list of circuit objects and runs its initDC()
    function. */
 void hbsolver::initDC (void) {
+  subnet->getArena()->restart ();
   circuit * root = subnet->getRoot ();
   for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
     c->initDC ();
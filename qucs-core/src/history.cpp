@@ -40,60 +40,66 @@
 namespace qucs {
 
 
+/* The function doubles the capacity of the ring buffer.  The values
+   are moved to their places according to the new mask. */
+void histbuffer::grow (void)
+{
+  std::size_t cap = buf.empty () ? 64 : 2 * buf.size ();
+  std::vector<nr_double_t> b (cap);
+  for (std::size_t n = head; n < tail; n++)
+    b[n & (cap - 1)] = buf[n & mask];
+  buf.swap (b);
+  mask = cap - 1;
+}
+
 /* This function drops those values in the history which are newer
    than the specified time. */
 void history::truncate (const nr_double_t tcut)
 {
-    std::size_t i;
-    std::size_t ts = this->t->size ();
-
-    for (i = this->leftidx (); i < ts; i++)
-    {
-      if ( (*this->t)[i] > tcut)
-      {
-	break;
-      }
-    }
-    this->resize (ts - i);
+  std::size_t l = this->t->begin ();
+  std::size_t r = this->t->end ();
+  // find the first time value newer than tcut
+  while (l < r) {
+    std::size_t i = l + (r - l) / 2;
+    if ((*this->t)[i] > tcut)
+      r = i;
+    else
+      l = i + 1;
+  }
+  this->t->dropFrom (l);
+  this->values->dropFrom (l);
+  if (this->cursor >= l)
+    this->cursor = this->leftidx ();
 }
 
-
 /* This function drops those values in the history which are older
-   than the specified age of the history instance. */
+   than the specified age of the history instance.  Values whose time
+   has already been dropped are of no use anymore either. */
 void history::drop (void) {
-  if(this->values->empty())
+  if (age <= 0.0 || this->values->empty ())
     return;
-  nr_double_t f = this->first ();
   nr_double_t l = this->last ();
-  if (age > 0.0 && l - f > age) {
-    std::size_t r;
-    std::size_t i = this->leftidx ();
-    for (r = 0; i < this->t->size (); r++, i++)
-      if (l - (*this->t)[i] < age)
-	break;
-    // keep 2 values being older than specified age
-    r += this->unused ();
-    if (r >= 2)
-      r -= 2;
-    r = std::min(r,this->values->size()-1);
-    if (r > 127)
-      /* erase the first r value */
-      this->values->erase(this->values->begin(),this->values->begin()+r);
-  }
+  std::size_t n = this->leftidx ();
+  // keep 2 values being older than specified age
+  while (n + 2 < this->t->end () && l - (*this->t)[n + 2] >= age)
+    n++;
+  this->values->dropBefore (n);
 }
 
 /* Interpolates a value using 2 left side and 2 right side values if
    possible. */
-nr_double_t history::interpol (nr_double_t tval, int idx, bool left) {
+nr_double_t history::interpol (nr_double_t tval, std::size_t idx,
+			       bool left) {
   static spline spl (SPLINE_BC_NATURAL);
   static tvector<nr_double_t> x (4);
   static tvector<nr_double_t> y (4);
 
-  unsigned int n = left ? idx + 1: idx;
-  if (n > 1 && n + 2 < this->values->size ()) {
-    int i, k, l = this->leftidx ();
+  std::size_t n = left ? idx + 1: idx;
+  if (n >= this->leftidx () + 2 && n + 2 < this->rightidx ()) {
+    std::size_t i;
+    int k;
     for (k = 0, i = n - 2; k < 4; i++, k++) {
-      x (k) = (*this->t)[i + l];
+      x (k) = (*this->t)[i];
       y (k) = (*this->values)[i];
     }
     spl.vectors (y, x);
@@ -107,51 +113,53 @@ nr_double_t history::interpol (nr_double_t tval, int idx, bool left) {
    the otional parameter is true then additionally cubic spline
    interpolation is used. */
 nr_double_t history::nearest (nr_double_t tval, bool interpolate) {
-  if (t->empty())
+  std::size_t l = this->leftidx ();
+  std::size_t r = this->rightidx ();
+  if (l >= r)
     return 0.0;
 
-  int l = this->leftidx ();
-  int r = t->size () - 1;
-  int i = -1;
-  nr_double_t diff = std::numeric_limits<nr_double_t>::max();
-  sign = true;
-  i = seek (tval, l, r, diff, i);
-  i = i - l;
-  if (interpolate)
+  std::size_t i = seek (tval, l, r);
+  if (interpolate && (*this->t)[i] != tval)
     return interpol (tval, i, sign);
   return (*this->values)[i];
 }
 
 /* The function is utilized in order to find the nearest value to a
-   given time value.  Since the time vector is ordered a recursive
-   lookup algorithm can be used.  The function returns the current
-   index into the time vector as well as the error in time. */
-int history::seek (nr_double_t tval, int l, int r, nr_double_t& diff,
-		   int idx) {
-  int i = (l + r) / 2;
-  if (l == r)
-    return i;
-  nr_double_t v = (*this->t)[i];
-  nr_double_t d = v - tval;
-  if (fabs (d) < diff) {
-    // better approximation
-    diff = fabs (d);
-    sign = d < 0.0 ? true : false;
-    idx = i;
-  }
-  else if (i == l) {
-    // no better
-    return idx;
-  }
-  if (d < 0.0) {
-    // look later
-    return seek (tval, i, r, diff, idx);
+   given time value within the sample numbers [l,r).  Since delayed
+   lookups usually advance with the simulation time the interval at
+   the cursor of the previous lookup and its successor are checked
+   first, otherwise the ordered time values are bisected.  The
+   function returns the sample number of the nearest time value and
+   sets the sign if it is older than the given time. */
+std::size_t history::seek (nr_double_t tval, std::size_t l, std::size_t r) {
+  std::size_t i = r;
+  for (std::size_t c = this->cursor; c < this->cursor + 2; c++) {
+    if (c >= l && c + 1 < r &&
+	(*this->t)[c] <= tval && tval <= (*this->t)[c + 1]) {
+      i = c + 1;
+      break;
+    }
   }
-  else if (d > 0.0) {
-    // look earlier
-    return seek (tval, l, i, diff, idx);
+  if (i == r) {
+    // first time value not older than the given one
+    std::size_t lo = l, hi = r;
+    while (lo < hi) {
+      std::size_t m = lo + (hi - lo) / 2;
+      if ((*this->t)[m] < tval)
+	lo = m + 1;
+      else
+	hi = m;
+    }
+    i = lo;
   }
-  return idx;
+  if (i > l)
+    this->cursor = i - 1;
+
+  // choose the nearer one of the neighbours
+  if (i == r || (i > l && tval - (*this->t)[i - 1] < (*this->t)[i] - tval))
+    i--;
+  sign = (*this->t)[i] < tval;
+  return i;
 }
 
 } // namespace qucs
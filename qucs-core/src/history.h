@@ -27,10 +27,64 @@
 
 #include <memory>
 #include <vector>
-#include <utility>
+#include <cstddef>
+#include <algorithm>
 
 namespace qucs {
 
+/* The histbuffer class is a ring buffer of values addressed by an
+   absolute sample number, i.e. the number of values ever appended
+   before.  Values are appended at the end and dropped at the front
+   in constant time; the buffer grows only if the retained values do
+   not fit anymore. */
+class histbuffer
+{
+public:
+  histbuffer () : head (0), tail (0), mask (0) {}
+
+  //! Returns the sample number of the oldest value.
+  std::size_t begin (void) const { return head; }
+  //! Returns the sample number following the youngest value.
+  std::size_t end (void) const { return tail; }
+  std::size_t size (void) const { return tail - head; }
+  bool empty (void) const { return tail == head; }
+
+  nr_double_t operator [] (const std::size_t n) const {
+    return buf[n & mask];
+  }
+
+  void push_back (const nr_double_t val) {
+    if (size () == buf.size ())
+      grow ();
+    buf[tail++ & mask] = val;
+  }
+
+  //! Drops all values older than the given sample number.
+  void dropBefore (const std::size_t n) {
+    if (n > head) head = n < tail ? n : tail;
+  }
+
+  //! Drops all values from the given sample number on.
+  void dropFrom (const std::size_t n) {
+    if (n < tail) tail = n > head ? n : head;
+  }
+
+  //! Empties the buffer, the next value gets the given sample number.
+  void restart (const std::size_t n) { head = tail = n; }
+
+private:
+  void grow (void);
+
+  std::vector<nr_double_t> buf;
+  std::size_t head;
+  std::size_t tail;
+  std::size_t mask;
+};
+
+/* A history holds the values of a node voltage or branch current
+   during the transient analysis.  The time values are kept in a
+   separate buffer which is shared by all histories (see apply()),
+   the value and the time of a sample have the same sample number. */
 class history
 {
 public:
@@ -38,34 +92,33 @@ public:
   history ():
     sign(false),
     age(0),
-    values(std::make_shared<std::vector<nr_double_t>>()),
-    t(std::make_shared<std::vector<nr_double_t>>()) 
+    cursor(0),
+    values(std::make_shared<histbuffer>()),
+    t(std::make_shared<histbuffer>())
   {};
-  
+
   /*! The copy constructor creates a new instance based on the given
       history object. */
   history (const history &h)
   {
+      this->sign = h.sign;
       this->age = h.age;
-      this->t = std::make_shared<std::vector<nr_double_t>>(*(h.t));
-      this->values = std::make_shared<std::vector<nr_double_t>>(*(h.values));
+      this->cursor = h.cursor;
+      this->values = std::make_shared<histbuffer>(*(h.values));
+      if (h.t == h.values)
+        this->t = this->values;
+      else
+        this->t = std::make_shared<histbuffer>(*(h.t));
   }
 
   /*! The function appends the given value to the history. */
   void push_back (const nr_double_t val) {
     this->values->push_back(val);
-    if (this->values != this->t) 
+    if (this->values != this->t)
       this->drop ();
   }
 
-  /* This function drops the most recent n values in the history. */
-  void truncate (const std::size_t n) = delete;
-  void resize(const std::size_t n)
-  {
-    this->t->resize (n);
-    this->values->resize (n);
-  }
-
+  //! Returns the number of time values in the history.
   std::size_t size (void) const
   {
     return t->size ();
@@ -74,62 +127,69 @@ public:
   void setAge (const nr_double_t a) { this->age = a; }
   nr_double_t getAge (void) const { return this->age; }
 
-  // apply history
+  /* Applies the time values of the given history.  The values stored
+     so far are discarded, the next one belongs to the youngest time
+     value. */
   void apply (const history & h) {
     this->t = h.t;
+    this->values->restart (t->empty () ? t->end () : t->end () - 1);
+    this->cursor = this->values->begin ();
   }
 
   //! Returns the last (youngest) time value in the history
   nr_double_t last (void) const {
-    return this->t->empty() ? 0.0 : this->t->back();
+    return this->t->empty() ? 0.0 : (*this->t)[t->end () - 1];
   }
 
   //! Returns the first (oldest) time value in the history.
   nr_double_t first (void) const {
-    return this->t->empty() ? 0.0 : (*this->t)[leftidx ()];
-  }
-
-  // Returns left-most valid index into the time value vector.
-  unsigned int leftidx (void) const {
-    int ts = this->t->size ();
-    int vs = this->values->size ();
-    return ts - vs > 0 ? ts - vs : 0;
+    std::size_t n = leftidx ();
+    return n < t->end () ? (*this->t)[n] : 0.0;
   }
 
-  /*! Returns number of unused values (time value vector shorter than
-   value vector). */
-  std::size_t unused (void) {
-    int ts = t->size ();
-    int vs = values->size ();
-    return vs - ts > 0 ? vs - ts : 0;
-  }
-  
   //! Returns the duration of the history.
   nr_double_t duration(void) const {
      return last () - first ();
   }
-  
+
   void truncate (const nr_double_t);
-  
+
   void drop (void);
   void self (void) { this->t = this->values; }
 
-  nr_double_t interpol (nr_double_t, int, bool);
+  nr_double_t interpol (nr_double_t, std::size_t, bool);
   nr_double_t nearest (nr_double_t, bool interpolate = true);
-  int seek (nr_double_t, int, int, nr_double_t&, int);
+  std::size_t seek (nr_double_t, std::size_t, std::size_t);
 
-  nr_double_t getTfromidx (const int idx)  {
-    return this->t == NULL ? 0.0 : (*this->t)[idx];
+  //! Returns the time value at the given index, the oldest being 0.
+  nr_double_t getTfromidx (const int idx) const {
+    std::size_t n = t->begin () + idx;
+    return n < t->end () ? (*this->t)[n] : 0.0;
+  }
+  //! Returns the value belonging to the time value at the given index.
+  nr_double_t getValfromidx (const int idx) const {
+    std::size_t n = t->begin () + idx;
+    if (n < values->begin () || n >= values->end ())
+      return 0.0;
+    return (*this->values)[n];
+  }
+
+ private:
+  //! Returns the sample number of the oldest value having a time.
+  std::size_t leftidx (void) const {
+    return std::max (values->begin (), t->begin ());
   }
-  nr_double_t getValfromidx (const int idx) {
-    return this->values == NULL ? 0.0 : (*this->values)[idx];
+  //! Returns the sample number following the youngest value having a time.
+  std::size_t rightidx (void) const {
+    return std::min (values->end (), t->end ());
   }
 
  private:
   bool sign;
   nr_double_t age;
-  std::shared_ptr<std::vector<nr_double_t>> values;
-  std::shared_ptr<std::vector<nr_double_t>> t;
+  std::size_t cursor;
+  std::shared_ptr<histbuffer> values;
+  std::shared_ptr<histbuffer> t;
 };
 
 } // namespace qucs
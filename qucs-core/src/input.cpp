@@ -123,14 +123,11 @@ qucs::vector * input::createVector (struct value_t * values) {
 void input::factory (void) {
 
   struct definition_t * def, * next;
-  struct node_t * nodes;
   struct pair_t * pairs;
-  circuit * c;
-  object * o;
   analysis * a;
-  substrate * s;
-  nodeset * n;
-  int i;
+
+  // node numbers start at one
+  nodeNames.assign (1, std::string ());
 
   // go through the list of input definitions
   for (def = definition_root; def != NULL; def = next) {
@@ -186,119 +183,272 @@ void input::factory (void) {
     next = def->next;
     // handle substrate definitions
     if (!def->action && def->substrate) {
-      if ((s = createSubstrate (def->type)) != NULL) {
-	s->setName (def->instance);
-
-	// add the properties to substrate
-	for (pairs = def->pairs; pairs != NULL; pairs = pairs->next)
-	  if (pairs->value->ident) {
-	    // a variable
-	    if (pairs->value->var) {
-	      // at this stage it should be ensured that the variable is
-	      // already in the root environment
-	      variable * v = def->env->getVariable (pairs->value->ident);
-	      s->addProperty (pairs->key, v);
-	    }
-	    // a usual string property
-	    else {
-	      s->addProperty (pairs->key, pairs->value->ident);
-	    }
-	  } else {
-	    s->addProperty (pairs->key, pairs->value->value);
-	  }
-	// additionally add missing optional properties
-	assignDefaultProperties (s, def->define);
-
-	// put new substrate definition into environment
-	char * n = strrchr (def->instance, '.');
-	variable * v = new variable (n ? n + 1 : def->instance);
-	v->setSubstrate (s);
-	def->env->addVariable (v);
-      }
+      factorySubstrate (def, NULL);
       // remove this definition from the list
       definition_root = netlist_unchain_definition (definition_root, def);
     }
     // handle nodeset definitions
     else if (!def->action && def->nodeset) {
-      n = new nodeset ();
-      n->setName (def->nodes->node);
-      n->setValue (def->pairs->value->value);
-      subnet->addNodeset (n);
+      factoryNodeset (def, NULL);
       // remove this definition from the list
       definition_root = netlist_unchain_definition (definition_root, def);
     }
   }
+  factoryInstances (instance_root, 0);
 
   // go through the list of input definitions
   for (def = definition_root; def != NULL; def = next) {
     next = def->next;
     // handle component definitions
     if (!def->action && !def->substrate && !def->nodeset) {
-      c = createCircuit (def->type);
-      assert (c != NULL);
-      o = (object *) c;
-      c->setName (def->instance);
-      c->setNonLinear (def->nonlinear != 0);
-      c->setSubcircuit (def->subcircuit == nullptr ? "" : def->subcircuit);
-
-      // change size (number of ports) of variable sized components
-      if (c->isVariableSized ()) {
-	c->setSize (def->ncount);
+      factoryCircuit (def, NULL);
+      // remove this definition from the list
+      definition_root = netlist_unchain_definition (definition_root, def);
+    }
+  }
+  factoryInstances (instance_root, 1);
+
+  // the node numbers are kept in the circuit nodes
+  nodeNumbers.clear ();
+  nodeNames.clear ();
+  localNodes.clear ();
+  instanceNumbers.clear ();
+}
+
+// Returns non-zero if the given node name denotes a global node.
+static int input_global_node (const char * node) {
+  return !strcmp (node, "gnd") || node[strlen (node) - 1] == '!';
+}
+
+/* The function returns the number of the top level or global node
+   with the given name.  New names get the next free number. */
+int input::topNode (const char * node) {
+  int & nr = nodeNumbers[node];
+  if (nr == 0) {
+    nr = nodeNames.size ();
+    nodeNames.push_back (node);
+  }
+  return nr;
+}
+
+/* This function returns the local node indices of the subcircuit
+   'type'.  The ports come first in the order of the subcircuit
+   definition, followed by the internal nodes of its elements.  Global
+   nodes are not local.  The indices are shared by all instances. */
+std::map<std::string, int> &
+input::subcircuitNodes (struct definition_t * type) {
+  std::map<std::string, int> & nodes = localNodes[type];
+  if (nodes.empty ()) {
+    struct node_t * n;
+    int nr = 0;
+    for (n = type->nodes; n != NULL; n = n->next, nr++)
+      nodes.insert (std::make_pair (std::string (n->node), nr));
+    for (struct definition_t * def = type->sub; def; def = def->next) {
+      for (n = def->nodes; n != NULL; n = n->next) {
+	if (!input_global_node (n->node) &&
+	    nodes.insert (std::make_pair (std::string (n->node), nr)).second)
+	  nr++;
+      }
+    }
+  }
+  return nodes;
+}
+
+/* The function returns the node numbers of the given subcircuit
+   instance, indexed by the local node indices of its subcircuit.  The
+   ports get the numbers of the nodes they are connected to in the
+   enclosing instance, the internal nodes get new numbers. */
+std::vector<int> & input::instanceNodes (struct instance_t * inst) {
+  std::vector<int> & nrs = instanceNumbers[inst];
+  if (nrs.empty ()) {
+    std::map<std::string, int> & nodes = subcircuitNodes (inst->type);
+    std::map<std::string, int>::iterator it;
+    struct node_t * t, * p;
+    int i, ports = 0;
+    for (t = inst->type->nodes; t != NULL; t = t->next) ports++;
+    nrs.assign (ports + nodes.size (), 0);
+    // follow the ports to the nodes of the enclosing instance
+    for (i = 0, t = inst->type->nodes, p = inst->def->nodes; t && p;
+	 t = t->next, p = p->next, i++)
+      nrs[i] = instanceNode (inst->parent, p->node);
+    // number the internal nodes
+    for (it = nodes.begin (); it != nodes.end (); it++) {
+      if (it->second >= ports) {
+	nrs[it->second] = nodeNames.size ();
+	nodeNames.push_back (netlist_instance_node (inst, it->first));
+      }
+    }
+  }
+  return nrs;
+}
+
+/* The function returns the number of the given node of an element
+   within the subcircuit instance 'inst', or at top level if 'inst' is
+   NULL. */
+int input::instanceNode (struct instance_t * inst, const char * node) {
+  if (inst == NULL)
+    return topNode (node);
+  std::map<std::string, int> & nodes = subcircuitNodes (inst->type);
+  std::map<std::string, int>::iterator it = nodes.find (node);
+  if (it == nodes.end ())
+    return topNode (node);
+  return instanceNodes (inst)[it->second];
+}
+
+/* The function creates the substrates and nodesets (pass zero) or the
+   circuits (pass one) of the given subcircuit instances including the
+   instances of nested subcircuits.  The subcircuit definitions are
+   shared by all instances, the names of the elements and their nodes
+   are created here. */
+void input::factoryInstances (struct instance_t * root, int pass) {
+  for (struct instance_t * inst = root; inst != NULL; inst = inst->next) {
+    for (struct definition_t * def = inst->type->sub; def; def = def->next) {
+      if (def->action || !strcmp (def->type, "Sub"))
+	continue;
+      if (pass == 0) {
+	if (def->substrate)
+	  factorySubstrate (def, inst);
+	else if (def->nodeset)
+	  factoryNodeset (def, inst);
+      }
+      else if (!def->substrate && !def->nodeset) {
+	factoryCircuit (def, inst);
       }
-      // add appropriate nodes to circuit
-      for (i = 0, nodes = def->nodes; nodes; nodes = nodes->next, i++)
-	if (i < c->getSize ())
-	  c->setNode (i, nodes->node);
-
-      // add the properties to circuit
-      for (pairs = def->pairs; pairs != NULL; pairs = pairs->next) {
-	if (pairs->value == NULL) {
-	  // zero-length value lists
-	  variable * v = new variable (pairs->key);
-	  eqn::constant * c = new eqn::constant (eqn::TAG_VECTOR);
-	  c->v = new qucs::vector ();
-	  v->setConstant (c);
-	  o->addProperty (pairs->key, v);
+    }
+    factoryInstances (inst->children, pass);
+  }
+}
+
+/* This function creates the substrate given by the definition 'def'
+   and puts it into the environment of the top level netlist or of the
+   given subcircuit instance. */
+void input::factorySubstrate (struct definition_t * def,
+			      struct instance_t * inst) {
+  struct pair_t * pairs;
+  substrate * s;
+  environment * e = inst ? inst->env : def->env;
+
+  if ((s = createSubstrate (def->type)) != NULL) {
+    s->setName (inst ? netlist_instance_name (inst, def) : def->instance);
+
+    // add the properties to substrate
+    for (pairs = def->pairs; pairs != NULL; pairs = pairs->next)
+      if (pairs->value->ident) {
+	// a variable
+	if (pairs->value->var) {
+	  // at this stage it should be ensured that the variable is
+	  // already in the root environment
+	  variable * v = e->getVariable (pairs->value->ident);
+	  s->addProperty (pairs->key, v);
 	}
-	else if (pairs->value->ident) {
-	  if (pairs->value->var) {
-	    // at this stage it should be ensured that the variable is
-	    // already in the root environment
-	    variable * v = def->env->getVariable (pairs->value->ident);
-	    o->addProperty (pairs->key, v);
-	  } else {
-	    if (pairs->value->subst) {
-	      variable * v = def->env->getVariable (pairs->value->ident);
-	      c->setSubstrate (v->getSubstrate ());
-	    }
-	    o->addProperty (pairs->key, pairs->value->ident);
-	  }
-	} else {
-	  if (pairs->value->var) {
-	    // add value lists to the properties
-	    variable * v = new variable (pairs->key);
-	    eqn::constant * c = new eqn::constant (eqn::TAG_VECTOR);
-	    c->v = createVector (pairs->value);
-	    v->setConstant (c);
-	    o->addProperty (pairs->key, v);
-	  } else {
-	    o->addProperty (pairs->key, pairs->value->value);
-	  }
+	// a usual string property
+	else {
+	  s->addProperty (pairs->key, pairs->value->ident);
 	}
+      } else {
+	s->addProperty (pairs->key, pairs->value->value);
       }
-      // set local circuit environment
-      c->setEnv (def->env);
+    // additionally add missing optional properties
+    assignDefaultProperties (s, def->define);
+
+    // put new substrate definition into environment
+    char * n = strrchr (def->instance, '.');
+    variable * v = new variable (n ? n + 1 : def->instance);
+    v->setSubstrate (s);
+    e->addVariable (v);
+  }
+}
+
+/* The function creates the nodeset given by the definition 'def'. */
+void input::factoryNodeset (struct definition_t * def,
+			    struct instance_t * inst) {
+  nodeset * n = new nodeset ();
+  int nr = instanceNode (inst, def->nodes->node);
+  n->setName ((char *) nodeNames[nr].c_str ());
+  n->setValue (def->pairs->value->value);
+  subnet->addNodeset (n);
+}
 
-      // additionally add missing optional properties
-      assignDefaultProperties (c, def->define);
+/* This function creates the circuit given by the definition 'def' and
+   inserts it into the netlist.  Within subcircuit instances the names
+   of the circuit and its nodes are derived from the instance. */
+void input::factoryCircuit (struct definition_t * def,
+			    struct instance_t * inst) {
+  struct node_t * nodes;
+  struct pair_t * pairs;
+  environment * e = inst ? inst->env : def->env;
+  circuit * c;
+  object * o;
+  int i;
 
-      // insert the circuit into the netlist object
-      subnet->insertCircuit (c);
+  c = createCircuit (def->type);
+  assert (c != NULL);
+  o = (object *) c;
+  c->setNonLinear (def->nonlinear != 0);
+  if (inst) {
+    c->setName (netlist_instance_name (inst, def));
+    c->setSubcircuit (inst->type->instance);
+  }
+  else {
+    c->setName (def->instance);
+    c->setSubcircuit (def->subcircuit == nullptr ? "" : def->subcircuit);
+  }
 
-      // remove this definition from the list
-      definition_root = netlist_unchain_definition (definition_root, def);
+  // change size (number of ports) of variable sized components
+  if (c->isVariableSized ()) {
+    c->setSize (def->ncount);
+  }
+  // add appropriate nodes to circuit
+  for (i = 0, nodes = def->nodes; nodes; nodes = nodes->next, i++)
+    if (i < c->getSize ()) {
+      int nr = instanceNode (inst, nodes->node);
+      c->setNode (i, nodeNames[nr], 0, nr);
+    }
+
+  // add the properties to circuit
+  for (pairs = def->pairs; pairs != NULL; pairs = pairs->next) {
+    if (pairs->value == NULL) {
+      // zero-length value lists
+      variable * v = new variable (pairs->key);
+      eqn::constant * c = new eqn::constant (eqn::TAG_VECTOR);
+      c->v = new qucs::vector ();
+      v->setConstant (c);
+      o->addProperty (pairs->key, v);
+    }
+    else if (pairs->value->ident) {
+      if (pairs->value->var) {
+	// at this stage it should be ensured that the variable is
+	// already in the root environment
+	variable * v = e->getVariable (pairs->value->ident);
+	o->addProperty (pairs->key, v);
+      } else {
+	if (pairs->value->subst) {
+	  variable * v = e->getVariable (pairs->value->ident);
+	  c->setSubstrate (v->getSubstrate ());
+	}
+	o->addProperty (pairs->key, pairs->value->ident);
+      }
+    } else {
+      if (pairs->value->var) {
+	// add value lists to the properties
+	variable * v = new variable (pairs->key);
+	eqn::constant * c = new eqn::constant (eqn::TAG_VECTOR);
+	c->v = createVector (pairs->value);
+	v->setConstant (c);
+	o->addProperty (pairs->key, v);
+      } else {
+	o->addProperty (pairs->key, pairs->value->value);
+      }
     }
   }
+  // set local circuit environment
+  c->setEnv (e);
+
+  // additionally add missing optional properties
+  assignDefaultProperties (c, def->define);
+
+  // insert the circuit into the netlist object
+  subnet->insertCircuit (c);
 }
 
 /* This static function applies the optional missing properties's
@@ -25,6 +25,10 @@
 #ifndef __INPUT_H__
 #define __INPUT_H__
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace qucs {
 
 class net;
@@ -50,10 +54,25 @@ class input : public object
   static void assignDefaultProperties (object *, struct define_t *);
   static qucs::vector * createVector (struct value_t *);
 
+ private:
+  void factoryInstances (struct instance_t *, int);
+  void factorySubstrate (struct definition_t *, struct instance_t *);
+  void factoryNodeset (struct definition_t *, struct instance_t *);
+  void factoryCircuit (struct definition_t *, struct instance_t *);
+  int topNode (const char *);
+  int instanceNode (struct instance_t *, const char *);
+  std::map<std::string, int> & subcircuitNodes (struct definition_t *);
+  std::vector<int> & instanceNodes (struct instance_t *);
+
  private:
   FILE * fd;
   net * subnet;
   environment * env;
+  // flat node numbering, only used while creating the netlist
+  std::map<std::string, int> nodeNumbers;
+  std::vector<std::string> nodeNames;
+  std::map<struct definition_t *, std::map<std::string, int> > localNodes;
+  std::map<struct instance_t *, std::vector<int> > instanceNumbers;
 };
 
 // externalize global variable
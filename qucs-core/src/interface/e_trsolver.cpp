@@ -211,6 +211,10 @@ int e_trsolver::init (nr_double_t start, nr_double_t firstdelta, int mode)
         eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
     else if (!strcmp (solver, "GolubSVD"))
         eqnAlgo = ALGO_SV_DECOMPOSITION;
+    else if (!strcmp (solver, "BiCGStab"))
+        eqnAlgo = ALGO_BICGSTAB;
+    else if (!strcmp (solver, "CG"))
+        eqnAlgo = ALGO_CG;
 
     // Perform initial DC analysis.
     if (initialDC)
@@ -492,7 +496,7 @@ int e_trsolver::stepsolve_sync(nr_double_t synctime)
     if (error) return -1;
 
     // check whether Jacobian matrix is still non-singular
-    if (!A->isFinite ())
+    if (!isMatrixFinite ())
     {
 //        messagefcn (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
 //                  "aborting %s analysis\n", getName (), (double) current,
@@ -728,7 +732,7 @@ int e_trsolver::stepsolve_async(nr_double_t steptime)
         if (rejected) continue;
 
         // check whether Jacobian matrix is still non-singular
-        if (!A->isFinite ())
+        if (!isMatrixFinite ())
         {
             messagefcn (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
                       "aborting %s analysis\n", getName (), (double) current,
@@ -1060,17 +1064,17 @@ void e_trsolver::truncateHistory (nr_double_t t)
 
 int e_trsolver::getJacRows()
 {
-    return A->getRows();
+    return getN () + getM ();
 }
 
 int e_trsolver::getJacCols()
 {
-    return A->getCols();
+    return getN () + getM ();
 }
 
 void e_trsolver::getJacData(int r, int c, nr_double_t& data)
 {
-    data = A->get(r,c);
+    data = getMatrix (r, c);
 }
 
 // properties
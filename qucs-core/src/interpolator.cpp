@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <limits>
 
 #include "poly.h"
 #include "spline.h"
@@ -309,6 +310,26 @@ nr_double_t interpolator::rinterpolate (nr_double_t x) {
   return res;
 }
 
+/* Returns the position of the first sample beyond the given value,
+   taking repetitions into account, or infinity if there is none. */
+nr_double_t interpolator::nextSample (nr_double_t x) {
+  nr_double_t base = 0.0;
+  if (length <= 1)
+    return std::numeric_limits<nr_double_t>::infinity ();
+  if (repeat & REPEAT_YES) {
+    base = std::floor (x / duration) * duration;
+    x -= base;
+  }
+  if (x < rx[0])
+    return base + rx[0];
+  int idx = findIndex (x);
+  if (idx < length - 1)
+    return base + rx[idx + 1];
+  if (repeat & REPEAT_YES)
+    return base + duration;
+  return std::numeric_limits<nr_double_t>::infinity ();
+}
+
 /* This function interpolates for complex values.  Returns the complex
    interpolation of the real y-vector for the given value in the
    x-vector. */
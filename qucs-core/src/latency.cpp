@@ -0,0 +1,288 @@
+/*
+ * latency.cpp - latent circuit blocks of the transient analysis
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <algorithm>
+#include <map>
+
+#include "compat.h"
+#include "object.h"
+#include "node.h"
+#include "complex.h"
+#include "circuit.h"
+#include "nodelist.h"
+#include "component_id.h"
+#include "latency.h"
+
+// number of quiet time steps before a block becomes latent
+#define LATENCY_STEPS 3
+
+namespace qucs {
+
+// Constructor creates an empty partition.
+latency::latency () {
+  circuits = 0;
+  steps = 0;
+  skipped = 0;
+}
+
+/* Destructor.  The circuits may already be gone at this point, thus
+   release() must have been called before. */
+latency::~latency () {
+}
+
+/* The function decides whether the given circuit drives its nodes on
+   its own account, i.e. independently of its node voltages.  Such
+   circuits are evaluated at each time step. */
+bool latency::isStimulus (circuit * c) {
+  if (c->isVSource () || c->hasHistory ()) return true;
+  switch (c->getType ()) {
+  case CIR_IDC:
+  case CIR_IAC:
+  case CIR_IEXP:
+  case CIR_IFILE:
+  case CIR_IPULSE:
+  case CIR_IRECT:
+  case CIR_TSWITCH:
+  case CIR_INVERTER:
+  case CIR_NOR:
+  case CIR_OR:
+  case CIR_NAND:
+  case CIR_AND:
+  case CIR_XNOR:
+  case CIR_XOR:
+  case CIR_DIGISOURCE:
+  case CIR_BUFFER:
+    return true;
+  }
+  return false;
+}
+
+// Checks whether a voltage moved beyond the tolerances.
+bool latency::moved (nr_double_t v, nr_double_t w,
+		     nr_double_t vntol, nr_double_t reltol) {
+  return fabs (v - w) >= vntol + reltol * std::max (fabs (v), fabs (w));
+}
+
+// Returns the representative node row of the given node row.
+int latency::find (int r) {
+  while (parent[r] != r) {
+    parent[r] = parent[parent[r]];
+    r = parent[r];
+  }
+  return r;
+}
+
+/* The function partitions the N nodes of the given node list into
+   blocks.  The nodes of voltage sources separate the blocks, all other
+   nodes of a circuit belong to the same block.  Blocks containing
+   other sources can never become latent and are dropped.  M is the
+   number of branch currents.  Returns the number of blocks. */
+int latency::init (nodelist * nlist, int N, int M) {
+  release ();
+  steps = skipped = 0;
+
+  // the node rows of each circuit
+  std::vector<circuit *> cirs;
+  std::vector< std::vector<int> > ports;
+  std::map<circuit *, int> index;
+  for (int r = 0; r < N; r++) {
+    for (auto & n : *nlist->getNode (r)) {
+      circuit * c = n->getCircuit ();
+      std::map<circuit *, int>::iterator it = index.find (c);
+      if (it == index.end ()) {
+	it = index.insert (std::make_pair (c, (int) cirs.size ())).first;
+	cirs.push_back (c);
+	ports.push_back (std::vector<int> ());
+      }
+      ports[it->second].push_back (r);
+    }
+  }
+  circuits = (int) cirs.size ();
+
+  // nodes of voltage sources and nodes driven by other sources
+  std::vector<char> boundary (N, 0), driven (N, 0);
+  for (int i = 0; i < circuits; i++) {
+    if (!isStimulus (cirs[i])) continue;
+    for (int r : ports[i]) {
+      if (cirs[i]->isVSource ())
+	boundary[r] = 1;
+      else
+	driven[r] = 1;
+    }
+  }
+
+  // join the remaining nodes of each circuit
+  parent.resize (N);
+  for (int r = 0; r < N; r++) parent[r] = r;
+  for (int i = 0; i < circuits; i++) {
+    if (isStimulus (cirs[i])) continue;
+    int first = -1;
+    for (int r : ports[i]) {
+      if (boundary[r]) continue;
+      if (first < 0)
+	first = r;
+      else
+	parent[find (r)] = find (first);
+    }
+  }
+
+  // collect the nodes of each block
+  std::vector<int> number (N, -1);
+  std::vector<char> active;
+  for (int r = 0; r < N; r++) {
+    if (boundary[r]) continue;
+    int root = find (r);
+    if (number[root] < 0) {
+      number[root] = (int) blocks.size ();
+      blocks.push_back (block_t ());
+      active.push_back (0);
+    }
+    block_t & b = blocks[number[root]];
+    b.nodes.push_back (r);
+    b.rows.push_back (r);
+    if (driven[r]) active[number[root]] = 1;
+  }
+
+  // assign the circuits to the blocks
+  for (int i = 0; i < circuits; i++) {
+    circuit * c = cirs[i];
+    if (isStimulus (c)) continue;
+    int nr = -1;
+    for (int r : ports[i]) {
+      if (boundary[r])
+	continue;
+      nr = number[find (r)];
+      break;
+    }
+    if (nr < 0) continue;
+    block_t & b = blocks[nr];
+    b.circuits.push_back (c);
+    for (int r : ports[i])
+      if (boundary[r]) b.inputs.push_back (r);
+    for (int k = 0; k < c->getVoltageSources (); k++)
+      b.rows.push_back (N + c->getVoltageSource () + k);
+  }
+
+  // drop the blocks which are never latent
+  std::vector<block_t> latent;
+  for (size_t i = 0; i < blocks.size (); i++) {
+    block_t & b = blocks[i];
+    if (active[i] || b.circuits.empty ()) continue;
+    std::sort (b.inputs.begin (), b.inputs.end ());
+    b.inputs.erase (std::unique (b.inputs.begin (), b.inputs.end ()),
+		    b.inputs.end ());
+    b.last.assign (b.nodes.size (), 0);
+    b.held.assign (b.inputs.size (), 0);
+    b.quiet = 0;
+    b.latent = false;
+    latent.push_back (b);
+  }
+  blocks.swap (latent);
+  rowLatent.assign (N + M, 0);
+  return (int) blocks.size ();
+}
+
+/* The function is called for each accepted time step after its
+   solution x has been passed on to the states of the circuits.
+   Active blocks whose node voltages stayed within the tolerances for
+   a few steps become latent, latent blocks whose inputs or nodes
+   moved are woken up. */
+void latency::update (tvector<nr_double_t> * x,
+		      nr_double_t vntol, nr_double_t reltol) {
+  steps++;
+  for (block_t & b : blocks) {
+    size_t i;
+    if (b.latent) {
+      for (i = 0; i < b.inputs.size (); i++)
+	if (moved (x->get (b.inputs[i]), b.held[i], vntol, reltol)) break;
+      if (i >= b.inputs.size ()) {
+	for (i = 0; i < b.nodes.size (); i++)
+	  if (moved (x->get (b.nodes[i]), b.last[i], vntol, reltol)) break;
+	if (i >= b.nodes.size ()) {
+	  skipped += b.circuits.size ();
+	  continue;
+	}
+      }
+      resume (b);
+    }
+    else {
+      for (i = 0; i < b.nodes.size (); i++)
+	if (moved (x->get (b.nodes[i]), b.last[i], vntol, reltol)) break;
+      b.quiet = (i >= b.nodes.size ()) ? b.quiet + 1 : 0;
+    }
+    for (i = 0; i < b.nodes.size (); i++) b.last[i] = x->get (b.nodes[i]);
+    if (b.quiet >= LATENCY_STEPS) hold (b, x);
+  }
+}
+
+/* Makes the given block latent.  The states of its circuits are
+   filled with the values of the last accepted step, so the integrators
+   continue from a steady history when the block is woken up. */
+void latency::hold (block_t & b, tvector<nr_double_t> * x) {
+  b.latent = true;
+  for (size_t i = 0; i < b.inputs.size (); i++)
+    b.held[i] = x->get (b.inputs[i]);
+  for (circuit * c : b.circuits) {
+    c->setLatent (true);
+    for (int s = 0; s < c->getStates (); s++)
+      c->fillState (s, c->getState (s, 1));
+  }
+  for (int r : b.rows) rowLatent[r] = 1;
+}
+
+// Evaluates the circuits of the given block again.
+void latency::resume (block_t & b) {
+  b.latent = false;
+  b.quiet = 0;
+  for (circuit * c : b.circuits) c->setLatent (false);
+  for (int r : b.rows) rowLatent[r] = 0;
+}
+
+/* Wakes up all latent blocks, e.g. behind a breakpoint of the sources
+   or if the time step failed to converge. */
+void latency::wake (void) {
+  for (block_t & b : blocks)
+    if (b.latent) resume (b);
+}
+
+// Wakes up all blocks and forgets about the partition.
+void latency::release (void) {
+  wake ();
+  blocks.clear ();
+  parent.clear ();
+  rowLatent.clear ();
+}
+
+/* Returns the fraction of the circuit evaluations at the accepted time
+   steps which have been skipped. */
+nr_double_t latency::getSkipped (void) {
+  if (steps <= 0 || circuits <= 0) return 0;
+  return skipped / (steps * circuits);
+}
+
+} // namespace qucs
@@ -0,0 +1,87 @@
+/*
+ * latency.h - latent circuit blocks of the transient analysis
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <vector>
+
+#include "tvector.h"
+
+namespace qucs {
+
+class circuit;
+class nodelist;
+
+/* The nodes of the circuit are partitioned into blocks which are
+   separated by the nodes of voltage sources (the inputs of the
+   blocks).  A block without sources of its own whose node voltages
+   stay within the tolerances for a few accepted time steps becomes
+   latent: its circuits are not evaluated anymore and keep their last
+   matrix entries until the voltages of its inputs or of its own nodes
+   move again.  The rows of the latent blocks do not limit the step
+   size either. */
+class latency
+{
+ public:
+  latency ();
+  ~latency ();
+  int init (nodelist *, int, int);
+  void update (tvector<nr_double_t> *, nr_double_t, nr_double_t);
+  void wake (void);
+  void release (void);
+  const char * getLatentRows (void) { return rowLatent.data (); }
+  int getBlocks (void) { return (int) blocks.size (); }
+  nr_double_t getSkipped (void);
+
+ private:
+  struct block_t {
+    std::vector<int> nodes;        // node rows of the block
+    std::vector<int> rows;         // all solution rows incl. branches
+    std::vector<int> inputs;       // rows of the adjacent source nodes
+    std::vector<circuit *> circuits;
+    std::vector<nr_double_t> last; // node voltages of the last step
+    std::vector<nr_double_t> held; // input voltages when becoming latent
+    int quiet;
+    bool latent;
+  };
+
+  static bool isStimulus (circuit *);
+  static bool moved (nr_double_t, nr_double_t, nr_double_t, nr_double_t);
+  int find (int);
+  void hold (block_t &, tvector<nr_double_t> *);
+  void resume (block_t &);
+
+ private:
+  std::vector<int> parent;
+  std::vector<block_t> blocks;
+  std::vector<char> rowLatent;
+  int circuits;
+  nr_double_t steps;
+  nr_double_t skipped;
+};
+
+} // namespace qucs
+
+#endif /* __LATENCY_H__ */
@@ -0,0 +1,125 @@
+/*
+ * mappedfile.cpp - read-only file mapping class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#if HAVE_SYS_MMAN_H
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "logging.h"
+#include "mappedfile.h"
+
+namespace qucs {
+
+// Constructor creates an unused instance of the mappedfile class.
+mappedfile::mappedfile () {
+  data = NULL;
+  size = 0;
+  mapped = 0;
+}
+
+// Destructor releases the file contents.
+mappedfile::~mappedfile () {
+  close ();
+}
+
+/* Makes the contents of the given file available.  Returns zero on
+   success, otherwise the function emits an error message and returns
+   non-zero. */
+int mappedfile::open (const char * file) {
+  close ();
+
+#if HAVE_SYS_MMAN_H
+  int fd;
+  struct stat st;
+  if ((fd = ::open (file, O_RDONLY)) < 0 || fstat (fd, &st) != 0) {
+    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+    if (fd >= 0) ::close (fd);
+    return -1;
+  }
+  if (S_ISREG (st.st_mode) && st.st_size > 0) {
+    void * p = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+      madvise (p, st.st_size, MADV_SEQUENTIAL);
+#endif
+      ::close (fd);
+      data = (char *) p;
+      size = st.st_size;
+      mapped = 1;
+      return 0;
+    }
+  }
+  ::close (fd);
+#endif /* HAVE_SYS_MMAN_H */
+
+  // read the file into a buffer
+  FILE * f;
+  if ((f = fopen (file, "rb")) == NULL) {
+    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+    return -1;
+  }
+  size_t n, len = 0, avail = 65536;
+  char * buf = (char *) malloc (avail);
+  while ((n = fread (buf + len, 1, avail - len, f)) > 0) {
+    len += n;
+    if (len == avail) buf = (char *) realloc (buf, avail *= 2);
+  }
+  if (ferror (f)) {
+    logprint (LOG_ERROR, "error loading `%s': %s\n", file, strerror (errno));
+    fclose (f);
+    free (buf);
+    return -1;
+  }
+  fclose (f);
+  data = buf;
+  size = len;
+  return 0;
+}
+
+// Releases the file contents.
+void mappedfile::close (void) {
+#if HAVE_SYS_MMAN_H
+  if (mapped) munmap (data, size);
+  else
+#endif
+  free (data);
+  data = NULL;
+  size = 0;
+  mapped = 0;
+}
+
+} // namespace qucs
@@ -0,0 +1,53 @@
+/*
+ * mappedfile.h - read-only file mapping class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+#include <cstddef>
+
+namespace qucs {
+
+/* Gives read access to the contents of a file.  The file is mapped
+   into memory if the system supports it, otherwise it is read into a
+   buffer.  The contents are not terminated by a zero byte. */
+class mappedfile
+{
+ public:
+  mappedfile ();
+  ~mappedfile ();
+  int open (const char *);
+  void close (void);
+  const char * getData (void) { return data; }
+  size_t getSize (void) { return size; }
+
+ private:
+  char * data;
+  size_t size;
+  int mapped;
+};
+
+} // namespace qucs
+
+#endif /* __MAPPEDFILE_H__ */
@@ -90,6 +90,8 @@
 #include <cstdlib>
 #include <string.h>
 #include <cmath>
+#include <algorithm>
+#include <utility>
 
 #include "logging.h"
 #include "object.h"
@@ -117,8 +119,7 @@ matrix::matrix () {
     \todo Why not s const?
 */
 matrix::matrix (int s)  {
-  rows = cols = s;
-  data = (s > 0) ? new nr_complex_t[s * s] : NULL;
+  alloc (s, s);
 }
 
 /*!\brief Creates a matrix
@@ -131,9 +132,25 @@ matrix::matrix (int s)  {
    \todo Assert r >= 0 and c >= 0
 */
 matrix::matrix (int r, int c)  {
+  alloc (r, c);
+}
+
+/*!\brief Sets up the (zeroed) storage for the given size
+
+   Small matrices use the storage within the object, larger ones get
+   their data from the heap.
+   \param[in] r number of rows
+   \param[in] c number of column
+*/
+void matrix::alloc (int r, int c) {
   rows = r;
   cols = c;
-  data = (r > 0 && c > 0) ? new nr_complex_t[r * c] : NULL;
+  if (r <= 0 || c <= 0)
+    data = NULL;
+  else if (r * c <= MATRIX_FIXED)
+    data = fixed;
+  else
+    data = new nr_complex_t[r * c];
 }
 
 /*!\brief copy constructor
@@ -143,21 +160,38 @@ matrix::matrix (int r, int c)  {
    \todo Add assert tests
 */
 matrix::matrix (const matrix & m) {
-  rows = m.rows;
-  cols = m.cols;
-  data = NULL;
+  alloc (m.rows, m.cols);
 
   // copy matrix elements
-  if (rows > 0 && cols > 0) {
-    data = new nr_complex_t[rows * cols];
+  if (data) {
     memcpy (data, m.data, sizeof (nr_complex_t) * rows * cols);
   }
 }
 
+/*!\brief move constructor
+
+   The move constructor takes over the data of the given matrix
+   object which is left empty.
+*/
+matrix::matrix (matrix && m) {
+  rows = m.rows;
+  cols = m.cols;
+  if (m.data == m.fixed) {
+    data = fixed;
+    memcpy (data, m.data, sizeof (nr_complex_t) * rows * cols);
+  }
+  else {
+    data = m.data;
+  }
+  m.rows = m.cols = 0;
+  m.data = NULL;
+}
+
 /*!\brief Assignment operator
 
   The assignment copy constructor creates a new instance based on the
-  given matrix object.
+  given matrix object.  The storage is kept if the size does not
+  change.
 
   \param[in] m object to copy
   \return assigned object
@@ -165,16 +199,40 @@ matrix::matrix (const matrix & m) {
 */
 const matrix& matrix::operator=(const matrix & m) {
   if (&m != this) {
+    if (rows * cols != m.rows * m.cols || !data) {
+      if (data != fixed) delete[] data;
+      alloc (m.rows, m.cols);
+    }
     rows = m.rows;
     cols = m.cols;
     if (data) {
-      delete[] data;
-      data = NULL;
+      memcpy (data, m.data, sizeof (nr_complex_t) * rows * cols);
     }
-    if (rows > 0 && cols > 0) {
-      data = new nr_complex_t[rows * cols];
+  }
+  return *this;
+}
+
+/*!\brief Move assignment operator
+
+  Takes over the data of the given matrix object which is left empty.
+
+  \param[in] m object to move
+  \return assigned object
+*/
+matrix& matrix::operator=(matrix && m) {
+  if (&m != this) {
+    if (data != fixed) delete[] data;
+    rows = m.rows;
+    cols = m.cols;
+    if (m.data == m.fixed) {
+      data = fixed;
       memcpy (data, m.data, sizeof (nr_complex_t) * rows * cols);
     }
+    else {
+      data = m.data;
+    }
+    m.rows = m.cols = 0;
+    m.data = NULL;
   }
   return *this;
 }
@@ -184,7 +242,7 @@ const matrix& matrix::operator=(const matrix & m) {
    Destructor deletes a matrix object.
 */
 matrix::~matrix () {
-  delete[] data;
+  if (data != fixed) delete[] data;
 }
 
 /*!\brief  Returns the matrix element at the given row and column.
@@ -193,7 +251,7 @@ matrix::~matrix () {
    \todo Why not inline and synonymous of ()
    \todo c and r const
 */
-nr_complex_t matrix::get (int r, int c) {
+nr_complex_t matrix::get (int r, int c) const {
   return data[r * cols + c];
 }
 
@@ -225,9 +283,8 @@ void matrix::print (void) {
    \param[a] first matrix
    \param[b] second matrix
    \note assert same size
-   \todo a and b are const
 */
-matrix operator + (matrix a, matrix b) {
+matrix operator + (const matrix & a, const matrix & b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
 
   matrix res (a.getRows (), a.getCols ());
@@ -240,9 +297,8 @@ matrix operator + (matrix a, matrix b) {
 /*!\brief Intrinsic matrix addition.
    \param[in] a matrix to add
    \note assert same size
-   \todo a is const
 */
-matrix matrix::operator += (matrix a) {
+matrix& matrix::operator += (const matrix & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
 
   int r, c, i;
@@ -256,9 +312,8 @@ matrix matrix::operator += (matrix a) {
    \param[a] first matrix
    \param[b] second matrix
    \note assert same size
-   \todo a and b are const
 */
-matrix operator - (matrix a, matrix b) {
+matrix operator - (const matrix & a, const matrix & b) {
   assert (a.getRows () == b.getRows () && a.getCols () == b.getCols ());
 
   matrix res (a.getRows (), a.getCols ());
@@ -282,7 +337,7 @@ matrix matrix::operator - () {
    \param[in] a matrix to substract
    \note assert same size
 */
-matrix matrix::operator -= (matrix a) {
+matrix& matrix::operator -= (const matrix & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
   int r, c, i;
   for (i = 0, r = 0; r < a.getRows (); r++)
@@ -298,11 +353,16 @@ matrix matrix::operator -= (matrix a) {
    \todo Why not a and z const
 */
 matrix operator * (matrix a, nr_complex_t z) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) * z);
-  return res;
+  a *= z;
+  return a;
+}
+
+/*!\brief Intrinsic matrix scaling complex version
+   \param[in] z scaling complex
+*/
+matrix& matrix::operator *= (nr_complex_t z) {
+  for (int i = 0; i < rows * cols; i++) data[i] *= z;
+  return *this;
 }
 
 /*!\brief Matrix scaling complex version (different order)
@@ -323,11 +383,16 @@ matrix operator * (nr_complex_t z, matrix a) {
    \todo Why not d and a const
 */
 matrix operator * (matrix a, nr_double_t d) {
-  matrix res (a.getRows (), a.getCols ());
-  for (int r = 0; r < a.getRows (); r++)
-    for (int c = 0; c < a.getCols (); c++)
-      res.set (r, c, a.get (r, c) * d);
-  return res;
+  a *= d;
+  return a;
+}
+
+/*!\brief Intrinsic matrix scaling real version
+   \param[in] d scaling real
+*/
+matrix& matrix::operator *= (nr_double_t d) {
+  for (int i = 0; i < rows * cols; i++) data[i] *= d;
+  return *this;
 }
 
 /*!\brief Matrix scaling real version (different order)
@@ -375,21 +440,37 @@ matrix operator / (matrix a, nr_double_t d) {
     \param[a] first matrix
     \param[b] second matrix
     \note assert compatibility
-    \todo a and b are const
-*/
-matrix operator * (matrix a, matrix b) {
-  assert (a.getCols () == b.getRows ());
-
-  int r, c, i, n = a.getCols ();
-  nr_complex_t z;
-  matrix res (a.getRows (), b.getCols ());
-  for (r = 0; r < a.getRows (); r++) {
-    for (c = 0; c < b.getCols (); c++) {
-      for (i = 0, z = 0; i < n; i++) z += a.get (r, i) * b.get (i, c);
-      res.set (r, c, z);
+*/
+matrix operator * (const matrix & a, const matrix & b) {
+  matrix res;
+  multiply (a, b, res);
+  return res;
+}
+
+/*! Matrix multiplication into a given result matrix.
+
+    The storage of the result is reused if it has got the right size
+    already, so repeated products (e.g. in frequency loops) do not
+    allocate memory.
+    \param[in] a first matrix
+    \param[in] b second matrix
+    \param[out] res product, must not be 'a' or 'b'
+*/
+void multiply (const matrix & a, const matrix & b, matrix & res) {
+  assert (a.cols == b.rows && &res != &a && &res != &b);
+
+  int r, c, i, n = a.cols;
+  if (res.rows != a.rows || res.cols != b.cols) {
+    res = matrix (a.rows, b.cols);
+  }
+  nr_complex_t z, * dst = res.data;
+  for (r = 0; r < a.rows; r++) {
+    const nr_complex_t * row = a.data + r * n;
+    for (c = 0; c < b.cols; c++) {
+      for (i = 0, z = 0; i < n; i++) z += row[i] * b.data[i * b.cols + c];
+      *dst++ = z;
     }
   }
-  return res;
 }
 
 /*!\brief Complex scalar addition.
@@ -798,14 +879,24 @@ matrix inverseLaplace (matrix a) {
    \param[in] a matrix to invert
 */
 matrix inverseGaussJordan (matrix a) {
+  invert (a);
+  return a;
+}
+
+/*!\brief Invert the given matrix in place
+
+   Same Gauss-Jordan elimination as inverseGaussJordan(), but working
+   on the given matrix instead of a copy of it.
+   \note assert non singular matrix
+   \param[in,out] b matrix to invert
+*/
+void invert (matrix & b) {
   nr_double_t MaxPivot;
   nr_complex_t f;
-  matrix b, e;
-  int i, c, r, pivot, n = a.getCols ();
+  int i, c, r, pivot, n = b.getCols ();
 
-  // create temporary matrix and the result matrix
-  b = matrix (a);
-  e = eye (n);
+  // create the result matrix
+  matrix e = eye (n);
 
   // create the eye matrix in 'b' and the result in 'e'
   for (i = 0; i < n; i++) {
@@ -839,7 +930,7 @@ matrix inverseGaussJordan (matrix a) {
       }
     }
   }
-  return e;
+  b = std::move (e);
 }
 
 /*!\brief Compute inverse matrix
@@ -1545,15 +1636,9 @@ matrix cytocz (matrix cy, matrix z) {
   \todo r1 and r2 const
 */
 void matrix::exchangeRows (int r1, int r2) {
-  nr_complex_t * s = new nr_complex_t[cols];
-  int len = sizeof (nr_complex_t) * cols;
-
   assert (r1 >= 0 && r2 >= 0 && r1 < rows && r2 < rows);
 
-  memcpy (s, &data[r1 * cols], len);
-  memcpy (&data[r1 * cols], &data[r2 * cols], len);
-  memcpy (&data[r2 * cols], s, len);
-  delete[] s;
+  std::swap_ranges (&data[r1 * cols], &data[(r1 + 1) * cols], &data[r2 * cols]);
 }
 
 /*!\brief The function swaps the given column with each other.
@@ -30,6 +30,10 @@
 #ifndef __MATRIX_H__
 #define __MATRIX_H__
 
+/*! Matrices with up to this many entries (i.e. up to 4-port matrices)
+    keep their data within the object instead of the heap. */
+#define MATRIX_FIXED 16
+
 namespace qucs {
 
 class vector;
@@ -55,6 +59,8 @@ nr_complex_t det (matrix);
 matrix inverseLaplace (matrix);
 matrix inverseGaussJordan (matrix);
 matrix inverse (matrix);
+void invert (matrix &);
+void multiply (const matrix &, const matrix &, matrix &);
 matrix stos (matrix, nr_complex_t, nr_complex_t z0 = 50.0);
 matrix stos (matrix, nr_double_t, nr_double_t z0 = 50.0);
 matrix stos (matrix, vector, nr_complex_t z0 = 50.0);
@@ -100,24 +106,26 @@ class matrix
   matrix (int);
   matrix (int, int);
   matrix (const matrix &);
+  matrix (matrix &&);
   const matrix& operator = (const matrix &);
+  matrix& operator = (matrix &&);
   ~matrix ();
-  nr_complex_t get (int, int);
+  nr_complex_t get (int, int) const;
   void set (int, int, nr_complex_t);
-  int getCols (void) { return cols; }
-  int getRows (void) { return rows; }
+  int getCols (void) const { return cols; }
+  int getRows (void) const { return rows; }
   nr_complex_t * getData (void) { return data; }
   void print (void);
   void exchangeRows (int, int);
   void exchangeCols (int, int);
 
   // operator functions
-  friend matrix operator + (matrix, matrix);
+  friend matrix operator + (const matrix &, const matrix &);
   friend matrix operator + (nr_complex_t, matrix);
   friend matrix operator + (matrix, nr_complex_t);
   friend matrix operator + (nr_double_t, matrix);
   friend matrix operator + (matrix, nr_double_t);
-  friend matrix operator - (matrix, matrix);
+  friend matrix operator - (const matrix &, const matrix &);
   friend matrix operator - (nr_complex_t, matrix);
   friend matrix operator - (matrix, nr_complex_t);
   friend matrix operator - (nr_double_t, matrix);
@@ -128,12 +136,14 @@ class matrix
   friend matrix operator * (matrix, nr_complex_t);
   friend matrix operator * (nr_double_t, matrix);
   friend matrix operator * (matrix, nr_double_t);
-  friend matrix operator * (matrix, matrix);
+  friend matrix operator * (const matrix &, const matrix &);
 
   // intrinsic operator functions
   matrix operator  - ();
-  matrix operator += (matrix);
-  matrix operator -= (matrix);
+  matrix& operator += (const matrix &);
+  matrix& operator -= (const matrix &);
+  matrix& operator *= (nr_complex_t);
+  matrix& operator *= (nr_double_t);
 
   // block operations
   matrix getBlock(int, int, int, int);
@@ -167,6 +177,8 @@ class matrix
   friend matrix inverseLaplace (matrix);
   friend matrix inverseGaussJordan (matrix);
   friend matrix inverse (matrix);
+  friend void invert (matrix &);
+  friend void multiply (const matrix &, const matrix &, matrix &);
   friend matrix stos (matrix, nr_complex_t, nr_complex_t);
   friend matrix stos (matrix, nr_double_t, nr_double_t);
   friend matrix stos (matrix, qucs::vector, nr_complex_t);
@@ -221,6 +233,9 @@ class matrix
   */
   nr_complex_t& operator () (int r, int c) { return data[r * cols + c]; }
 
+ private:
+  void alloc (int, int);
+
  private:
   /*! Number of colunms */
   int cols;
@@ -228,6 +243,8 @@ class matrix
   int rows;
   /*! Matrix data */
   nr_complex_t * data;
+  /*! Storage of small matrices */
+  nr_complex_t fixed[MATRIX_FIXED];
 };
 
 } // namespace qucs
@@ -35,7 +35,10 @@
 #include <cmath>
 #include <float.h>
 #include <assert.h>
+#include <algorithm>
 #include <limits>
+#include <map>
+#include <vector>
 
 #include "logging.h"
 #include "complex.h"
@@ -66,14 +69,18 @@ template <class nr_type_t>
 nasolver<nr_type_t>::nasolver () : analysis ()
 {
     nlist = NULL;
-    A = C = NULL;
+    A = NULL;
     z = x = xprev = zprev = NULL;
     reltol = abstol = vntol = 0;
     calculate_func = NULL;
+    evaluate_func = NULL;
+    pool = NULL;
     convHelper = fixpoint = 0;
     eqnAlgo = ALGO_LU_DECOMPOSITION;
     updateMatrix = 1;
     gMin = srcFactor = 0;
+    bypassTol = 0;
+    bypass = bypassed = 0;
     eqns = new eqnsys<nr_type_t> ();
 }
 
@@ -82,14 +89,18 @@ template <class nr_type_t>
 nasolver<nr_type_t>::nasolver (const std::string &n) : analysis (n)
 {
     nlist = NULL;
-    A = C = NULL;
+    A = NULL;
     z = x = xprev = zprev = NULL;
     reltol = abstol = vntol = 0;
     calculate_func = NULL;
+    evaluate_func = NULL;
+    pool = NULL;
     convHelper = fixpoint = 0;
     eqnAlgo = ALGO_LU_DECOMPOSITION;
     updateMatrix = 1;
     gMin = srcFactor = 0;
+    bypassTol = 0;
+    bypass = bypassed = 0;
     eqns = new eqnsys<nr_type_t> ();
 }
 
@@ -98,13 +109,13 @@ template <class nr_type_t>
 nasolver<nr_type_t>::~nasolver ()
 {
     delete nlist;
-    delete C;
     delete A;
     delete z;
     delete x;
     delete xprev;
     delete zprev;
     delete eqns;
+    deinitThreads ();
 }
 
 /* The copy constructor creates a new instance of the nasolver class
@@ -114,7 +125,11 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
 {
     nlist = o.nlist ? new nodelist (*(o.nlist)) : NULL;
     A = o.A ? new tmatrix<nr_type_t> (*(o.A)) : NULL;
-    C = o.C ? new tmatrix<nr_type_t> (*(o.C)) : NULL;
+    sRow = o.sRow;
+    sCol = o.sCol;
+    sVal = o.sVal;
+    sRows = o.sRows;
+    Cy = o.Cy;
     z = o.z ? new tvector<nr_type_t> (*(o.z)) : NULL;
     x = o.x ? new tvector<nr_type_t> (*(o.x)) : NULL;
     xprev = zprev = NULL;
@@ -123,12 +138,16 @@ nasolver<nr_type_t>::nasolver (nasolver & o) : analysis (o)
     vntol = o.vntol;
     desc = o.desc;
     calculate_func = o.calculate_func;
+    evaluate_func = o.evaluate_func;
+    pool = NULL;
     convHelper = o.convHelper;
     eqnAlgo = o.eqnAlgo;
     updateMatrix = o.updateMatrix;
     fixpoint = o.fixpoint;
     gMin = o.gMin;
     srcFactor = o.srcFactor;
+    bypassTol = o.bypassTol;
+    bypass = bypassed = 0;
     eqns = new eqnsys<nr_type_t> (*(o.eqns));
     solution = nasolution<nr_type_t> (o.solution);
 }
@@ -175,6 +194,14 @@ int nasolver<nr_type_t>::solve_once (void)
         throw_exception (e);
         error++;
         break;
+    case EXCEPTION_NO_CONVERGENCE:
+        // the iterative equation system solver failed, the callers
+        // report the failure of the analysis
+        logprint (LOG_ERROR, "WARNING: %s: %s\n", getName (),
+                  top_exception()->getText ());
+        pop_exception ();
+        error++;
+        break;
     case EXCEPTION_SINGULAR:
         do
         {
@@ -207,6 +234,7 @@ void nasolver<nr_type_t>::solve_post (void)
 {
     delete nlist;
     nlist = NULL;
+    deinitThreads ();
 }
 
 /* Run this function before the actual solver. */
@@ -225,21 +253,134 @@ void nasolver<nr_type_t>::solve_pre (void)
     nlist->print ();
 #endif
 
-    // create matrix, solution vector and right hand side vector
+    // create solution vector and right hand side vector, the matrix
+    // gets created with the first equation system
     int M = countVoltageSources ();
     int N = countNodes ();
     delete A;
-    A = new tmatrix<nr_type_t> (M + N);
+    A = NULL;
+    sRow.clear ();
+    sRows.clear ();
     delete z;
     z = new tvector<nr_type_t> (N + M);
     delete x;
     x = new tvector<nr_type_t> (N + M);
 
+    // prepare the concurrent evaluation of the circuits
+    initThreads ();
+
 #if DEBUG
     logprint (LOG_STATUS, "NOTIFY: %s: solving %s netlist\n", getName (), desc.c_str());
 #endif
 }
 
+/* The function creates the worker threads for the evaluation of the
+   circuits if the analysis asks for more than one thread.  Only the
+   non-linear circuits are worth to be evaluated in parallel.  Circuits
+   which share state with others (such as equation defined devices) are
+   evaluated on the calling thread. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::initThreads (void)
+{
+    deinitThreads ();
+    int n = hasProperty ("Threads") ? getPropertyInteger ("Threads") : 1;
+    if (n <= 0) n = threadpool::hardwareThreads ();
+    if (n <= 1) return;
+
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->isNonLinear () && !c->isSerial ())
+            parallelCircuits.push_back (c);
+        else
+            serialCircuits.push_back (c);
+    }
+    // not worth the effort
+    if (parallelCircuits.size () < 2)
+    {
+        deinitThreads ();
+        return;
+    }
+    if (n > (int) parallelCircuits.size ()) n = parallelCircuits.size ();
+    pool = new threadpool (n);
+    threadBypassed.assign (n, 0);
+#if DEBUG
+    logprint (LOG_STATUS, "NOTIFY: %s: evaluating %d circuits on %d threads\n",
+              getName (), (int) parallelCircuits.size (), n);
+#endif
+}
+
+// Stops the worker threads.
+template <class nr_type_t>
+void nasolver<nr_type_t>::deinitThreads (void)
+{
+    delete pool;
+    pool = NULL;
+    serialCircuits.clear ();
+    parallelCircuits.clear ();
+    threadBypassed.clear ();
+}
+
+/* The calculation functions of the solvers run the given evaluation
+   function for each circuit by this function, except for the bypassed
+   circuits and the circuits of latent blocks.  With worker threads the
+   non-linear circuits are evaluated concurrently, each thread taking
+   every n-th of them.  This is possible since a circuit writes into its
+   own matrix entries only, which are put into the MNA matrix afterwards
+   by createMatrix(). */
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluate (evaluate_func_t func)
+{
+    if (pool == NULL)
+    {
+        circuit * root = subnet->getRoot ();
+        for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+        {
+            if (c->isLatent ())
+                continue;
+            if (bypassCircuit (c))
+                bypassed++;
+            else
+                (*func) (c, this);
+        }
+        return;
+    }
+
+    evaluate_func = func;
+    for (circuit * c : serialCircuits)
+    {
+        if (c->isLatent ())
+            continue;
+        if (bypassCircuit (c))
+            bypassed++;
+        else
+            (*func) (c, this);
+    }
+    pool->run (&evaluateThread, this);
+    for (int n : threadBypassed) bypassed += n;
+}
+
+// The job of each thread evaluating the non-linear circuits.
+template <class nr_type_t>
+void nasolver<nr_type_t>::evaluateThread (void * data, int t)
+{
+    nasolver<nr_type_t> * self = (nasolver<nr_type_t> *) data;
+    int n = self->pool->getThreads ();
+    int count = (int) self->parallelCircuits.size ();
+    int bypassed = 0;
+    for (int i = t; i < count; i += n)
+    {
+        circuit * c = self->parallelCircuits[i];
+        if (c->isLatent ())
+            continue;
+        if (self->bypassCircuit (c))
+            bypassed++;
+        else
+            (*self->evaluate_func) (c, self);
+    }
+    self->threadBypassed[t] = bypassed;
+}
+
 /* This function goes through the nodeset list of the current netlist
    and applies the stored values to the current solution vector.  Then
    the function saves the solution vector back into the actual
@@ -452,13 +593,14 @@ template <class nr_type_t>
 int nasolver<nr_type_t>::solve_nonlinear (void)
 {
     qucs::exception * e;
-    int convergence, run = 0, MaxIterations, error = 0;
+    int convergence, run = 0, MaxIterations, error = 0, verify = 0;
 
     // fetch simulation properties
     MaxIterations = getPropertyInteger ("MaxIter");
     reltol = getPropertyDouble ("reltol");
     abstol = getPropertyDouble ("abstol");
     vntol = getPropertyDouble ("vntol");
+    bypassTol = getPropertyDouble ("bypasstol");
     updateMatrix = 1;
 
     if (convHelper == CONV_GMinStepping)
@@ -478,14 +620,23 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
         return error;
     }
 
+    // the device bypass starts with a complete evaluation of all circuits
+    if (bypassTol > 0) restartBypass ();
+
     // run solving loop until convergence is reached
     do
     {
+        bypass = bypassTol > 0 && !verify;
+        bypassed = 0;
         error = solve_once ();
         if (!error)
         {
             // convergence check
             convergence = (run > 0) ? checkConvergence () : 0;
+            // a convergence with bypassed circuits must be confirmed by
+            // an iteration evaluating all circuits
+            verify = convergence && bypassed;
+            if (verify) convergence = 0;
             savePreviousIteration ();
             run++;
             // control fixpoint iterations
@@ -509,6 +660,7 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
     }
     while (!convergence &&
             run < MaxIterations * (1 + convHelper ? 1 : 0));
+    bypass = 0;
 
     if (run >= MaxIterations || error)
     {
@@ -527,8 +679,20 @@ int nasolver<nr_type_t>::solve_nonlinear (void)
 template <class nr_type_t>
 int nasolver<nr_type_t>::solve_linear (void)
 {
+    qucs::exception * e;
+    int error;
+
     updateMatrix = 1;
-    return solve_once ();
+    error = solve_once ();
+
+    // the equation system solver did not converge
+    if (error && top_exception () == NULL)
+    {
+        e = new qucs::exception (EXCEPTION_NO_CONVERGENCE);
+        e->setText ("no convergence in %s analysis", desc.c_str());
+        throw_exception (e);
+    }
+    return error;
 }
 
 /* Applying the MNA (Modified Nodal Analysis) to a circuit with
@@ -545,8 +709,14 @@ void nasolver<nr_type_t>::createMatrix (void)
                                 | C D |
     		      +-   -+.
        Each of these minor matrices is going to be generated here. */
-    if (updateMatrix)
+    if (updateMatrix && isSparse ())
+    {
+        createSparseMatrix ();
+    }
+    else if (updateMatrix)
     {
+        if (A == NULL)
+            A = new tmatrix<nr_type_t> (countNodes () + countVoltageSources ());
         createGMatrix ();
         createBMatrix ();
         createCMatrix ();
@@ -560,7 +730,10 @@ void nasolver<nr_type_t>::createMatrix (void)
         int M = countVoltageSources ();
         for (int n = 0; n < N + M; n++)
         {
-            A->set (n, n, A->get (n, n) + gMin);
+            if (isSparse ())
+                sVal[sparseIndex (n, n)] += gMin;
+            else
+                A->set (n, n, A->get (n, n) + gMin);
         }
     }
 
@@ -738,118 +911,194 @@ void nasolver<nr_type_t>::createGMatrix (void)
     }
 }
 
-/* The following function creates the (N+M)x(N+M) noise current
-   correlation matrix used during the AC noise computations.  */
+/* The function finds the MNA rows each circuit contributes to: the
+   rows of its ports (none for ground) followed by the rows of its
+   voltage sources. */
 template <class nr_type_t>
-void nasolver<nr_type_t>::createNoiseMatrix (void)
+void nasolver<nr_type_t>::mapRows (std::map<circuit *, std::vector<int> > & rows)
 {
-    int pr, pc, N = countNodes ();
+    int N = countNodes ();
     int M = countVoltageSources ();
-    struct nodelist_t * n;
-    nr_type_t val;
-    int r, c, ri, ci;
-    struct nodelist_t * nr, * nc;
     circuit * ct;
 
-    // create new Cy matrix if necessary
-    delete C;
-    C = new tmatrix<nr_type_t> (N + M);
-
-    // go through each column of the Cy matrix
-    for (c = 0; c < N; c++)
+    // find the MNA row of each circuit port
+    for (int r = 0; r < N; r++)
     {
-        nc = nlist->getNode (c);
-        // go through each row of the Cy matrix
-        for (r = 0; r < N; r++)
+        for (auto & current : *nlist->getNode (r))
         {
-            nr = nlist->getNode (r);
-            val = 0.0;
-            // sum up the noise-correlation of each connected circuit
-            for (auto & currentnc: *nc)
-		/* a = 0; a < nc->size(); a++ */
-	      for (auto &currentnr : *nr)
-		/* b = 0; b < nr->size(); b++) */
-                    if (currentnc->getCircuit () == currentnr->getCircuit ())
-                    {
-                        ct = currentnc->getCircuit ();
-                        pc = currentnc->getPort ();
-                        pr = currentnr->getPort ();
-                        val += MatVal (ct->getN (pr, pc));
-                    }
-            // put value into Cy matrix
-            C->set (r, c, val);
+            ct = current->getCircuit ();
+            std::vector<int> & v = rows[ct];
+            if (v.empty ())
+                v.assign (ct->getSize () + ct->getVoltageSources (), -1);
+            v[current->getPort ()] = r;
         }
     }
 
-    // go through each additional voltage source and put coefficients into
-    // the noise current correlation matrix
-    circuit * vsr, * vsc;
-    for (r = 0; r < M; r++)
+    // and the MNA row of each additional voltage source
+    for (int r = 0; r < M; r++)
     {
-        vsr = findVoltageSource (r);
-        for (c = 0; c < M; c++)
+        ct = findVoltageSource (r);
+        std::vector<int> & v = rows[ct];
+        if (v.empty ())
+            v.assign (ct->getSize () + ct->getVoltageSources (), -1);
+        v[ct->getSize () + r - ct->getVoltageSource ()] = r + N;
+    }
+}
+
+// Returns non-zero if the equation system solver works on sparse matrices.
+template <class nr_type_t>
+int nasolver<nr_type_t>::isSparse (void)
+{
+    return eqnAlgo == ALGO_BICGSTAB || eqnAlgo == ALGO_CG;
+}
+
+/* The Krylov methods get the MNA matrix in compressed rows, which
+   avoids the (N+M)x(N+M) dense matrix and the assembly walking all
+   pairs of nodes.  The pattern follows from the MNA rows of each
+   circuit once per netlist, afterwards each circuit adds its G, B, C
+   and D entries (see createGMatrix() etc.) at their positions. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::createSparseMatrix (void)
+{
+    int i, j, r, s, vs;
+    circuit * ct;
+
+    // create the pattern including the diagonal
+    if (sRow.empty ())
+    {
+        int N = countNodes () + countVoltageSources ();
+        std::vector<std::vector<int> > cols (N);
+        mapRows (sRows);
+        for (r = 0; r < N; r++) cols[r].push_back (r);
+        for (auto & it : sRows)
         {
-            vsc = findVoltageSource (c);
-            val = 0.0;
-            if (vsr == vsc)
+            std::vector<int> & v = it.second;
+            for (i = 0; i < (int) v.size (); i++)
             {
-                ri = vsr->getSize () + r - vsr->getVoltageSource ();
-                ci = vsc->getSize () + c - vsc->getVoltageSource ();
-                val = MatVal (vsr->getN (ri, ci));
+                if (v[i] < 0) continue;
+                for (j = 0; j < (int) v.size (); j++)
+                    if (v[j] >= 0) cols[v[i]].push_back (v[j]);
             }
-            C->set (r + N, c + N, val);
+        }
+        sRow.assign (N + 1, 0);
+        sCol.clear ();
+        for (r = 0; r < N; r++)
+        {
+            std::sort (cols[r].begin (), cols[r].end ());
+            cols[r].erase (std::unique (cols[r].begin (), cols[r].end ()),
+                           cols[r].end ());
+            sCol.insert (sCol.end (), cols[r].begin (), cols[r].end ());
+            sRow[r + 1] = (int) sCol.size ();
         }
     }
 
-    // go through each additional voltage source
-    for (r = 0; r < M; r++)
+    // sum up the entries of each circuit
+    sVal.assign (sCol.size (), 0.0);
+    for (auto & it : sRows)
     {
-        vsr = findVoltageSource (r);
-        // go through each node
-        for (c = 0; c < N; c++)
+        ct = it.first;
+        std::vector<int> & v = it.second;
+        s = ct->getSize ();
+        vs = ct->getVoltageSource ();
+        for (i = 0; i < (int) v.size (); i++)
         {
-            val = 0.0;
-            n = nlist->getNode (c);
-            for (auto &currentn: *n)
-	      /*i = 0; i < n->size(); i++ )*/
+            if (v[i] < 0) continue;
+            for (j = 0; j < (int) v.size (); j++)
             {
-                // is voltage source connected to node ?
-                if (currentn->getCircuit () == vsr)
-                {
-                    ri = vsr->getSize () + r - vsr->getVoltageSource ();
-                    ci = currentn->getPort ();
-                    val += MatVal (vsr->getN (ri, ci));
-                }
+                if (v[j] < 0) continue;
+                nr_type_t val;
+                if (i < s && j < s)
+                    val = MatVal (ct->getY (i, j));
+                else if (i < s)
+                    val = MatVal (ct->getB (i, vs + j - s));
+                else if (j < s)
+                    val = MatVal (ct->getC (vs + i - s, j));
+                else
+                    val = MatVal (ct->getD (vs + i - s, vs + j - s));
+                sVal[sparseIndex (v[i], v[j])] += val;
             }
-            // put value into Cy matrix
-            C->set (r + N, c, val);
         }
     }
+}
 
-    // go through each voltage source
-    for (c = 0; c < M; c++)
+/* Returns the position of the given entry within the compressed rows
+   of the MNA matrix or -1 if it is not part of the pattern. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::sparseIndex (int r, int c)
+{
+    std::vector<int>::iterator b = sCol.begin () + sRow[r];
+    std::vector<int>::iterator e = sCol.begin () + sRow[r + 1];
+    std::vector<int>::iterator it = std::lower_bound (b, e, c);
+    return (it != e && *it == c) ? (int) (it - sCol.begin ()) : -1;
+}
+
+/* The function returns zero if the MNA matrix has got non-finite
+   entries, e.g. due to a singular Jacobian. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::isMatrixFinite (void)
+{
+    if (A != NULL) return A->isFinite ();
+    for (auto & val : sVal)
+        if (!std::isfinite (real (val))) return 0;
+    return 1;
+}
+
+// Returns the given entry of the MNA matrix.
+template <class nr_type_t>
+nr_type_t nasolver<nr_type_t>::getMatrix (int r, int c)
+{
+    if (A != NULL) return A->get (r, c);
+    int k = sRow.empty () ? -1 : sparseIndex (r, c);
+    return k < 0 ? 0.0 : sVal[k];
+}
+
+/* The following function creates the sparse (N+M)x(N+M) noise current
+   correlation matrix used during the AC noise computations.  Each
+   circuit contributes the correlations between the MNA rows of its
+   ports and its voltage sources only, instead of walking all pairs of
+   nodes. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::createNoiseMatrix (void)
+{
+    std::map<circuit *, std::vector<int> > rows;
+    circuit * ct;
+
+    // find the MNA rows of each circuit
+    mapRows (rows);
+
+    // collect the non-zero noise-correlations of each circuit
+    Cy.clear ();
+    circuit * root = subnet->getRoot ();
+    for (ct = root; ct != NULL; ct = (circuit *) ct->getNext ())
     {
-        vsc = findVoltageSource (c);
-        // go through each node
-        for (r = 0; r < N; r++)
+        auto it = rows.find (ct);
+        if (it == rows.end ()) continue;
+        std::vector<int> & v = it->second;
+        for (int i = 0; i < (int) v.size (); i++)
         {
-            val = 0.0;
-            n = nlist->getNode (r);
-            for (auto & currentn: *n)/*i = 0; i < n->size(); i++)*/
+            if (v[i] < 0) continue;
+            for (int j = 0; j < (int) v.size (); j++)
             {
-                // is voltage source connected to node ?
-                if (currentn->getCircuit () == vsc)
-                {
-                    ci = vsc->getSize () + c - vsc->getVoltageSource ();
-                    ri = currentn->getPort ();
-                    val += MatVal (vsc->getN (ri, ci));
-                }
+                if (v[j] < 0) continue;
+                nr_type_t val = MatVal (ct->getN (i, j));
+                if (val == 0.0) continue;
+                noiseentry_t e = { v[i], v[j], val };
+                Cy.push_back (e);
             }
-            // put value into Cy matrix
-            C->set (r, c + N, val);
         }
     }
+}
 
+/* The function returns the real part of the quadratic form zn * Cy *
+   conj(zn), i.e. the squared noise quantity of the given transimpedance
+   vector. */
+template <class nr_type_t>
+nr_double_t nasolver<nr_type_t>::calcNoise (tvector<nr_type_t> & zn)
+{
+    nr_complex_t val = 0.0;
+    for (auto & e : Cy)
+        val += zn.get (e.r) * e.val * conj (zn.get (e.c));
+    return real (val);
 }
 
 /* The i matrix is an 1xN matrix with each element of the matrix
@@ -993,9 +1242,14 @@ template <class nr_type_t>
 void nasolver<nr_type_t>::runMNA (void)
 {
 
-    // just solve the equation system here
+    // just solve the equation system here, within a parameter sweep
+    // the LU decomposition of an earlier sweep point is updated
     eqns->setAlgo (eqnAlgo);
-    eqns->passEquationSys (updateMatrix ? A : NULL, x, z);
+    eqns->setLowRank (sweeping);
+    if (isSparse ())
+        eqns->passSparseSys (&sRow, &sCol, updateMatrix ? &sVal : NULL, x, z);
+    else
+        eqns->passEquationSys (updateMatrix ? A : NULL, x, z);
     eqns->solve ();
 
     // if damped Newton-Raphson is requested
@@ -1137,38 +1391,44 @@ void nasolver<nr_type_t>::steepestDescent (void)
 template <class nr_type_t>
 int nasolver<nr_type_t>::checkConvergence (void)
 {
-
     int N = countNodes ();
     int M = countVoltageSources ();
-    nr_double_t v_abs, v_rel, i_abs, i_rel;
-    int r;
+    nr_type_t * xn = x->getData (), * xp = xprev->getData ();
+    nr_type_t * zn = z->getData (), * zp = zprev->getData ();
 
     // check the nodal voltage changes against the allowed absolute
     // and relative tolerance values
-    for (r = 0; r < N; r++)
+    if (!withinTolerance (xn, xp, N, vntol, reltol)) return 0;
+    if (!withinTolerance (xn + N, xp + N, M, abstol, reltol)) return 0;
+
+    // the right hand side changes as well unless a convergence helper
+    // is active
+    if (!convHelper)
     {
-        v_abs = abs (x->get (r) - xprev->get (r));
-        v_rel = abs (x->get (r));
-        if (v_abs >= vntol + reltol * v_rel) return 0;
-        if (!convHelper)
-        {
-            i_abs = abs (z->get (r) - zprev->get (r));
-            i_rel = abs (z->get (r));
-            if (i_abs >= abstol + reltol * i_rel) return 0;
-        }
+        if (!withinTolerance (zn, zp, N, abstol, reltol)) return 0;
+        if (!withinTolerance (zn + N, zp + N, M, vntol, reltol)) return 0;
     }
+    return 1;
+}
 
-    for (r = 0; r < M; r++)
+/* Checks whether the n values of the current vector changed by less than
+   the given absolute plus relative tolerance against the previous
+   vector.  The values are compared in chunks without any branches,
+   thus the compiler is able to vectorise the inner loop and the check
+   still returns early for large vectors. */
+template <class nr_type_t>
+int nasolver<nr_type_t>::withinTolerance (nr_type_t * cur, nr_type_t * prev,
+                                          int n, nr_double_t atol,
+                                          nr_double_t rtol)
+{
+    const int chunk = 256;
+    for (int i = 0; i < n; i += chunk)
     {
-        i_abs = abs (x->get (r + N) - xprev->get (r + N));
-        i_rel = abs (x->get (r + N));
-        if (i_abs >= abstol + reltol * i_rel) return 0;
-        if (!convHelper)
-        {
-            v_abs = abs (z->get (r + N) - zprev->get (r + N));
-            v_rel = abs (z->get (r + N));
-            if (v_abs >= vntol + reltol * v_rel) return 0;
-        }
+        int end = std::min (i + chunk, n);
+        int bad = 0;
+        for (int r = i; r < end; r++)
+            bad |= abs (cur[r] - prev[r]) >= atol + rtol * abs (cur[r]);
+        if (bad) return 0;
     }
     return 1;
 }
@@ -1205,8 +1465,44 @@ void nasolver<nr_type_t>::restartNR (void)
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
-        if (c->isNonLinear ()) c->restartDC ();
+        if (c->isNonLinear ())
+        {
+            c->restartDC ();
+            c->restartBypass ();
+        }
+    }
+}
+
+/* The function invalidates the node voltages remembered by the device
+   bypass of each non-linear circuit. */
+template <class nr_type_t>
+void nasolver<nr_type_t>::restartBypass (void)
+{
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (c->isNonLinear ()) c->restartBypass ();
+    }
+}
+
+/* The evaluation of the circuits uses this function to decide
+   whether the model evaluation of the given circuit can be skipped in
+   the current iteration.  This is the case for non-linear circuits
+   whose node voltages moved by less than the bypass tolerance since
+   their last evaluation.  Their matrix entries are reused then.  If
+   the bypass is off (e.g. in the confirming iteration) the circuits
+   are evaluated, thus their node voltages are remembered as well. */
+template <class nr_type_t>
+bool nasolver<nr_type_t>::bypassCircuit (circuit * c)
+{
+    if (bypassTol <= 0 || !c->isNonLinear () || c->getVoltageSources () > 0)
+        return false;
+    if (!bypass)
+    {
+        c->storeBypass ();
+        return false;
     }
+    return c->bypass (bypassTol, reltol);
 }
 
 /* This function goes through solution (the x vector) and saves the
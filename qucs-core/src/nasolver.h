@@ -31,11 +31,15 @@
 // BUG
 #include "qucs_typedefs.h"
 #endif
+#include <map>
+#include <vector>
+
 #include "tvector.h"
 #include "tmatrix.h"
 #include "eqnsys.h"
 #include "nasolution.h"
 #include "analysis.h"
+#include "threadpool.h"
 
 // Convergence helper definitions.
 #define CONV_None            0
@@ -76,6 +80,8 @@ public:
     {
         if (calculate_func) (*calculate_func) (this);
     }
+    typedef void (* evaluate_func_t) (circuit *, nasolver<nr_type_t> *);
+    void evaluate (evaluate_func_t);
     const char * getHelperDescription (void);
 
     //interface convenience functions
@@ -86,6 +92,7 @@ public:
 
 protected:
     void restartNR (void);
+    void restartBypass (void);
     void savePreviousIteration (void);
     void restorePreviousIteration (void);
     int  countNodes (void);
@@ -96,11 +103,17 @@ protected:
     circuit * findVoltageSource (int);
     void applyNodeset (bool nokeep = true);
     void createNoiseMatrix (void);
+    nr_double_t calcNoise (tvector<nr_type_t> &);
     void runMNA (void);
     void createMatrix (void);
+    int  isMatrixFinite (void);
+    nr_type_t getMatrix (int, int);
     void storeSolution (void);
     void recallSolution (void);
     int  checkConvergence (void);
+    bool bypassCircuit (circuit *);
+    void initThreads (void);
+    void deinitThreads (void);
 
 private:
     void assignVoltageSources (void);
@@ -108,6 +121,10 @@ private:
     void createBMatrix (void);
     void createCMatrix (void);
     void createDMatrix (void);
+    int  isSparse (void);
+    void mapRows (std::map<circuit *, std::vector<int> > &);
+    void createSparseMatrix (void);
+    int  sparseIndex (int, int);
     void createIVector (void);
     void createEVector (void);
     void createZVector (void);
@@ -121,6 +138,9 @@ private:
     void saveBranchCurrents (void);
     nr_type_t MatValX (nr_complex_t, nr_complex_t *);
     nr_type_t MatValX (nr_complex_t, nr_double_t *);
+    static void evaluateThread (void *, int);
+    static int withinTolerance (nr_type_t *, nr_type_t *, int,
+                                nr_double_t, nr_double_t);
 
 protected:
     tvector<nr_type_t> * z;
@@ -128,13 +148,28 @@ protected:
     tvector<nr_type_t> * xprev;
     tvector<nr_type_t> * zprev;
     tmatrix<nr_type_t> * A;
-    tmatrix<nr_type_t> * C;
+
+    // compressed rows of the MNA matrix for the Krylov methods, with
+    // the MNA rows of the ports and voltage sources of each circuit
+    std::vector<int> sRow;
+    std::vector<int> sCol;
+    std::vector<nr_type_t> sVal;
+    std::map<circuit *, std::vector<int> > sRows;
+
+    // one entry of the sparse noise current correlation matrix
+    struct noiseentry_t {
+        int r, c;
+        nr_type_t val;
+    };
+    std::vector<noiseentry_t> Cy;
     int iterations;
     int convHelper;
     int fixpoint;
     int eqnAlgo;
     int updateMatrix;
     nr_double_t gMin, srcFactor;
+    nr_double_t bypassTol;
+    int bypass, bypassed;
     std::string desc;
     nodelist * nlist;
 
@@ -148,6 +183,12 @@ private:
 private:
 
     calculate_func_t calculate_func;
+    evaluate_func_t evaluate_func;
+    // circuits evaluated on the calling thread and in parallel
+    threadpool * pool;
+    std::vector<circuit *> serialCircuits;
+    std::vector<circuit *> parallelCircuits;
+    std::vector<int> threadBypassed;
 };
 
 } // namespace qucs
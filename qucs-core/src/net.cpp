@@ -49,6 +49,7 @@
 #include "nodeset.h"
 #include "equation.h"
 #include "environment.h"
+#include "arena.h"
 #include "component_id.h"
 
 namespace qucs {
@@ -62,6 +63,7 @@ net::net () : object () {
   orgacts = new ptrlist<analysis> ();
   env = NULL;
   nset = NULL;
+  stamps = new arena ();
   srcFactor = 1;
 }
 
@@ -74,6 +76,7 @@ net::net (const std::string &n) : object (n) {
   orgacts = new ptrlist<analysis> ();
   env = NULL;
   nset = NULL;
+  stamps = new arena ();
   srcFactor = 1;
 }
 
@@ -85,6 +88,7 @@ net::~net () {
     n = (circuit *) c->getNext ();
     delete c;
   }
+  delete stamps;
   // delete original actions 
   for(auto * element : *orgacts) {
     delete element;
@@ -107,6 +111,7 @@ net::net (net & n) : object (n) {
   orgacts = new ptrlist<analysis> ();
   env = n.env;
   nset = NULL;
+  stamps = new arena ();
   srcFactor = 1;
 }
 
@@ -170,8 +175,8 @@ void net::removeCircuit (circuit * c, int dropping) {
       drop = c;
     }
   }
-  // really destroy the circuit object
-  else delete c;
+  // really destroy the circuit object unless someone else owns it
+  else if (!c->isPooled ()) delete c;
 }
 
 /* The function returns non-zero if the given circuit is already part
@@ -37,6 +37,7 @@ class nodeset;
 class analysis;
 class dataset;
 class environment;
+class arena;
 
 
 class net : public object
@@ -89,6 +90,7 @@ class net : public object
   void setSrcFactor (nr_double_t f) { srcFactor = f; }
   nr_double_t getSrcFactor (void) { return srcFactor; }
   void setActionNetAll(net *);
+  arena * getArena (void) { return stamps; }
 
  private:
   nodeset * nset;
@@ -97,6 +99,7 @@ class net : public object
   ptrlist<analysis> * actions;
   ptrlist<analysis> * orgacts;
   environment * env;
+  arena * stamps;
   int nPorts;
   int nSources;
   int nCircuits;
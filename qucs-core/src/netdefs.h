@@ -32,8 +32,6 @@ class environment;
 /* Representation of a node list. */
 struct node_t {
   char * node;
-  char * xlate;
-  int xlatenr;
   struct node_t * next;
 };
 
@@ -73,7 +71,6 @@ struct definition_t {
   int nonlinear;
   int nodeset;
   int line;
-  int copy;
   int ncount;
   char * text;
   char * subcircuit;
@@ -81,6 +78,19 @@ struct definition_t {
   struct define_t * define;
 };
 
+/* Instance of a subcircuit.  The elements of the subcircuit are not
+   copied for each instance, the instance refers to the subcircuit
+   definition and only carries the parameters of the instance. */
+struct instance_t {
+  struct definition_t * type;     // subcircuit definition
+  struct definition_t * def;      // instance definition
+  struct instance_t * parent;     // enclosing instance, NULL at top level
+  struct instance_t * children;   // instances of nested subcircuits
+  struct instance_t * next;
+  qucs::environment * env;        // environment of the instance
+  char * path;                    // instance names from the top level
+};
+
 // Structure defining a key value pair.
 struct property_t {
   const char * key; // key name
@@ -161,8 +171,8 @@ struct define_t {
 #define PROP_RNG_MOS      PROP_RNG_STR2 ("nmos", "pmos")
 #define PROP_RNG_TYP      PROP_RNG_STR4 ("lin", "log", "list", "const")
 #define PROP_RNG_SOL \
-  PROP_RNG_STR5 ("CroutLU", "DoolittleLU", "HouseholderQR", \
-		 "HouseholderLQ", "GolubSVD")
+  PROP_RNG_STR7 ("CroutLU", "DoolittleLU", "HouseholderQR", \
+		 "HouseholderLQ", "GolubSVD", "BiCGStab", "CG")
 #define PROP_RNG_DIS \
   PROP_RNG_STR7 ("Kirschning", "Kobayashi", "Yamashita", "Getsinger", \
 		 "Schneider", "Pramanick", "Hammerstad")
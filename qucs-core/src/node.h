@@ -33,9 +33,9 @@ class node : public object
 {
  public:
   //! Constructor creates an unnamed instance of the node class.
-  node () : object (), nNode(0), port(0), internal(0), _circuit(nullptr) {};
+  node () : object (), nNode(0), port(0), internal(0), id(0), _circuit(nullptr) {};
   //! Constructor creates a named instance of the node class.
-  node (char * const n) : object (n), nNode(0), port(0), internal(0), _circuit(nullptr) {};
+  node (char * const n) : object (n), nNode(0), port(0), internal(0), id(0), _circuit(nullptr) {};
   //! Sets the unique number of this node
   void setNode (const int n) { this->nNode = n ; };
   //! Returns the unique number of this node.
@@ -49,11 +49,16 @@ class node : public object
   circuit * getCircuit (void) const { return this->_circuit; };
   void setInternal (int i) { internal = i; }
   int  getInternal (void) { return internal; }
+  //! Sets the number given to this node by the netlist input.
+  void setId (const int i) { this->id = i; };
+  //! Returns the input number of this node, zero if there is none.
+  int  getId (void) const { return this->id; };
 
  private:
   int nNode;
   int port;
   int internal;
+  int id;
   circuit * _circuit;
 };
 
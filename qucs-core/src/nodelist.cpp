@@ -28,6 +28,9 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <map>
+#include <vector>
 
 #include "logging.h"
 #include "object.h"
@@ -45,29 +48,57 @@ namespace qucs {
    nodelist is based on the circuit list and consists of unique nodes
    inside the circuit list only.  Each node in the list has references
    to their actual circuit nodes and thereby to the circuits it is
-   connected to. */
+   connected to.  Nodes numbered by the netlist input are found by
+   their number.  Only nodes created afterwards (e.g. the internal
+   nodes of devices) need a lookup by name, the map of names is built
+   once the first of them is met.  The ground node is always found
+   directly. */
 nodelist::nodelist (net * subnet) {
   sorting = 0;
 
   circuit * c;
+  nodelist_t * ground = NULL;
+  std::vector<nodelist_t *> numbers;
+  std::map<std::string, nodelist_t *> names;
+  bool named = false;
   // go through circuit list and find unique nodes
   for (c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ()) {
     for (int i = 0; i < c->getSize (); i++) {
       node * n = c->getNode (i);
-      if (contains (n->getName ()) == 0) {
-	root.push_front(new nodelist_t(n->getName (), n->getInternal ()));;
-      }
-    }
-  }
-  // add circuit nodes to each unique node in the list
-  for (auto &n : this->root) {
-    for (c = subnet->getRoot (); c != NULL; c = (circuit *) c->getNext ()) {
-      for (int i = 0; i < c->getSize (); i++) {
-	assert (c->getNode(i)->getName () != NULL);
-	if (n->name == c->getNode(i)->getName ()) {
-	  addCircuitNode(n, c->getNode (i));
+      int id = n->getId ();
+      nodelist_t * nl = NULL;
+      assert (n->getName () != NULL);
+      if (id > 0 && id < (int) numbers.size ()) nl = numbers[id];
+      if (nl == NULL) {
+	bool gnd = !strcmp (n->getName (), "gnd");
+	if (gnd) {
+	  nl = ground;
+	}
+	else if (id <= 0 || named) {
+	  if (!named) {
+	    // index the nodes found so far by their names
+	    for (auto it = root.begin (); it != root.end (); it++)
+	      names[(*it)->name] = *it;
+	    named = true;
+	  }
+	  auto it = names.find (n->getName ());
+	  if (it != names.end ()) nl = it->second;
+	}
+	if (nl == NULL) {
+	  nl = new nodelist_t (n->getName (), n->getInternal ());
+	  root.push_front (nl);
+	  if (gnd)
+	    ground = nl;
+	  else if (named)
+	    names[nl->name] = nl;
+	}
+	if (id > 0) {
+	  if (id >= (int) numbers.size ()) numbers.resize (id + 1, NULL);
+	  numbers[id] = nl;
 	}
       }
+      // add circuit node to the unique node
+      addCircuitNode (nl, n);
     }
   }
 }
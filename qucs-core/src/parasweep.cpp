@@ -118,6 +118,7 @@ int parasweep::initialize (void) {
     for (auto *a : *actions) {
       a->initialize ();
       a->setProgress (false);
+      a->setSweeping (true);
     }
   }
   return 0;
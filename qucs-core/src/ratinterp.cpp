@@ -0,0 +1,196 @@
+/*
+ * ratinterp.cpp - adaptive rational interpolation class implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+
+#include "object.h"
+#include "complex.h"
+#include "sweep.h"
+#include "tvector.h"
+#include "ratinterp.h"
+
+// Responses below this fraction of the largest one are judged absolutely.
+#define RATINTERP_FLOOR 1e-6
+
+namespace qucs {
+
+/* Constructor creates an instance of the ratinterp class for the
+   given (monotonic) output grid.  The end points and a few evenly
+   spaced points are scheduled as initial samples. */
+ratinterp::ratinterp (sweep * swp) {
+  grid = swp;
+  order = 6;
+  initial = 9;
+  reltol = 1e-4;
+  int size = grid->getSize ();
+  int n = std::min (size, initial);
+  for (int i = 0; i < n; i++) {
+    int idx = n > 1 ? (int) ((long) i * (size - 1) / (n - 1)) : 0;
+    if (pending.empty () || pending.back () != idx) pending.push_back (idx);
+  }
+}
+
+// Destructor deletes an instance of the ratinterp class.
+ratinterp::~ratinterp () {
+}
+
+/* Returns the position of the given grid index in the list of
+   samples, i.e. the number of samples with a smaller grid index. */
+int ratinterp::locate (int idx) {
+  return std::lower_bound (samples.begin (), samples.end (), idx) -
+    samples.begin ();
+}
+
+// Returns true if the given grid index has already been solved.
+bool ratinterp::isSampled (int idx) {
+  int p = locate (idx);
+  return p < (int) samples.size () && samples[p] == idx;
+}
+
+/* The function stores the response vector solved at the given grid
+   index. */
+void ratinterp::add (int idx, tvector<nr_complex_t> & y) {
+  int p = locate (idx);
+  std::vector<nr_complex_t> r (y.size ());
+  for (int i = 0; i < (int) y.size (); i++) r[i] = y.get (i);
+  if (p < (int) samples.size () && samples[p] == idx) {
+    responses[p] = r;
+    return;
+  }
+  samples.insert (samples.begin () + p, idx);
+  responses.insert (responses.begin () + p, r);
+}
+
+/* This function returns the next grid index which needs to be solved
+   or -1 if the model describes all remaining grid points within the
+   requested tolerance. */
+int ratinterp::next (void) {
+  if (pending.empty ()) refine ();
+  if (pending.empty ()) return -1;
+  int idx = pending.front ();
+  pending.pop_front ();
+  return idx;
+}
+
+/* Bisects each interval between neighbouring samples whose midpoint
+   cannot be predicted within the given tolerance. */
+void ratinterp::refine (void) {
+  if (samples.empty ()) return;
+  tvector<nr_complex_t> y (responses[0].size ());
+  for (int p = 0; p < (int) samples.size () - 1; p++) {
+    if (samples[p + 1] - samples[p] < 2) continue;
+    int m = (samples[p] + samples[p + 1]) / 2;
+    if (evaluate (m, y) > reltol) pending.push_back (m);
+  }
+}
+
+/* Diagonal rational function interpolation (Bulirsch-Stoer) of the
+   response channel 'k' using the 'n' samples starting at position
+   'lo' evaluated at grid index 'idx'.  The interpolated value is
+   stored in 'y' and the last correction term is returned as the error
+   estimate. */
+nr_double_t ratinterp::interpolate (int idx, int lo, int n,
+				    nr_complex_t & y) {
+  const nr_double_t tiny = 1e-25;
+  nr_double_t x = grid->get (idx);
+  nr_double_t h, hh = fabs (x - grid->get (samples[lo]));
+  int i, m, ns = 0;
+
+  for (i = 0; i < n; i++) {
+    h = fabs (x - grid->get (samples[lo + i]));
+    if (h == 0.0) {
+      y = c[i];
+      return 0.0;
+    }
+    else if (h < hh) {
+      ns = i;
+      hh = h;
+    }
+    d[i] = c[i] + tiny;
+  }
+
+  nr_complex_t dy = 0.0, w, t, dd;
+  y = c[ns--];
+  for (m = 1; m < n; m++) {
+    for (i = 0; i < n - m; i++) {
+      w = c[i + 1] - d[i];
+      h = grid->get (samples[lo + i + m]) - x;
+      t = (grid->get (samples[lo + i]) - x) * d[i] / h;
+      dd = t - c[i + 1];
+      // pole at the requested point, keep the estimate finite
+      if (dd == 0.0) dd = tiny;
+      dd = w / dd;
+      d[i] = c[i + 1] * dd;
+      c[i] = t * dd;
+    }
+    dy = (2 * (ns + 1) < (n - m)) ? c[ns + 1] : d[ns--];
+    y += dy;
+  }
+  return abs (dy);
+}
+
+/* The function evaluates the model at the given grid index and stores
+   the responses in 'y'.  It returns the estimated relative error of
+   the worst response or zero if the grid index has been solved. */
+nr_double_t ratinterp::evaluate (int idx, tvector<nr_complex_t> & y) {
+  int p = locate (idx), ns = samples.size ();
+  assert (ns > 0);
+  int channels = responses[0].size ();
+  if (p < ns && samples[p] == idx) {
+    for (int k = 0; k < channels; k++) y.set (k, responses[p][k]);
+    return 0.0;
+  }
+
+  // choose the samples surrounding the requested grid index
+  int n = std::min (order, ns);
+  int lo = std::max (0, p - n / 2);
+  lo = std::max (0, std::min (lo, ns - n));
+  c.resize (n);
+  d.resize (n);
+
+  std::vector<nr_double_t> dy (channels);
+  nr_double_t scale = 0.0;
+  for (int k = 0; k < channels; k++) {
+    nr_complex_t val;
+    for (int i = 0; i < n; i++) c[i] = responses[lo + i][k];
+    dy[k] = interpolate (idx, lo, n, val);
+    y.set (k, val);
+    scale = std::max (scale, abs (val));
+  }
+
+  // relative error of the worst channel
+  nr_double_t err = 0.0, floor = scale * RATINTERP_FLOOR;
+  for (int k = 0; k < channels; k++) {
+    nr_double_t ref = std::max (abs (y.get (k)), floor);
+    if (ref > 0.0) err = std::max (err, dy[k] / ref);
+  }
+  return err;
+}
+
+} // namespace qucs
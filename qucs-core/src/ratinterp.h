@@ -0,0 +1,71 @@
+/*
+ * ratinterp.h - adaptive rational interpolation class definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __RATINTERP_H__
+#define __RATINTERP_H__
+
+#include <vector>
+#include <deque>
+
+namespace qucs {
+
+class sweep;
+template <class nr_type_t> class tvector;
+
+/* The ratinterp class drives an adaptive frequency sweep.  It picks
+   the grid points of the given sweep which actually need to be solved
+   and fills the remaining ones using local diagonal rational
+   (Bulirsch-Stoer) interpolation of the sampled responses. */
+class ratinterp
+{
+ public:
+  ratinterp (sweep *);
+  ~ratinterp ();
+  void setTolerance (nr_double_t t) { reltol = t; }
+  void setOrder (int o) { order = o; }
+  int  next (void);
+  void add (int, tvector<nr_complex_t> &);
+  bool isSampled (int);
+  int  countSamples (void) { return (int) samples.size (); }
+  nr_double_t evaluate (int, tvector<nr_complex_t> &);
+
+ private:
+  void refine (void);
+  int  locate (int);
+  nr_double_t interpolate (int, int, int, nr_complex_t &);
+
+ private:
+  sweep * grid;
+  int order;
+  int initial;
+  nr_double_t reltol;
+  std::vector<int> samples;
+  std::vector< std::vector<nr_complex_t> > responses;
+  std::deque<int> pending;
+  std::vector<nr_complex_t> c, d;
+};
+
+} // namespace qucs
+
+#endif /* __RATINTERP_H__ */
@@ -45,6 +45,8 @@
 #include "nodelist.h"
 #include "netdefs.h"
 #include "characteristic.h"
+#include "tvector.h"
+#include "ratinterp.h"
 #include "spsolver.h"
 #include "constants.h"
 #include "components/component_id.h"
@@ -72,6 +74,7 @@ spsolver::spsolver () : analysis () {
   nlist = NULL;
   tees = crosses = opens = grounds = 0;
   gnd = NULL;
+  joins = 0;
 }
 
 // Constructor creates a named instance of the spsolver class.
@@ -83,12 +86,14 @@ spsolver::spsolver (char * n) : analysis (n) {
   nlist = NULL;
   tees = crosses = opens = grounds = 0;
   gnd = NULL;
+  joins = 0;
 }
 
 // Destructor deletes the spsolver class object.
 spsolver::~spsolver () {
   delete swp;
   delete nlist;
+  deleteJoinCircuits ();
 }
 
 /* The copy constructor creates a new instance of the spsolver class
@@ -103,6 +108,38 @@ spsolver::spsolver (spsolver & n) : analysis (n) {
   swp = n.swp ? new sweep (*n.swp) : NULL;
   nlist = n.nlist ? new nodelist (*n.nlist) : NULL;
   gnd = n.gnd;
+  joins = 0;
+}
+
+/* Returns the circuit receiving the result of the next join.  The
+   order of the joins does not depend on the frequency, so the
+   circuits created for the first frequency (including their S and
+   noise matrices) are used again for all others. */
+circuit * spsolver::joinCircuit (int size) {
+  circuit * result;
+  if (joins < joined.size () && joined[joins]->getSize () == size) {
+    result = joined[joins];
+  }
+  else {
+    result = new circuit (size);
+    result->setPooled (1);
+    // allocate S-parameter and noise corellation matrices
+    result->initSP (); if (noise) result->initNoiseSP ();
+    if (joins < joined.size ()) {
+      delete joined[joins];
+      joined[joins] = result;
+    }
+    else joined.push_back (result);
+  }
+  joins++;
+  return result;
+}
+
+// Deletes the circuits kept for the joins.
+void spsolver::deleteJoinCircuits (void) {
+  for (unsigned int i = 0; i < joined.size (); i++)
+    delete joined[i];
+  joined.clear ();
 }
 
 /* This function joins two nodes of a single circuit (interconnected
@@ -110,12 +147,9 @@ spsolver::spsolver (spsolver & n) : analysis (n) {
 circuit * spsolver::interconnectJoin (node * n1, node * n2) {
 
   circuit * s = n1->getCircuit ();
-  circuit * result = new circuit (s->getSize () - 2);
+  circuit * result = joinCircuit (s->getSize () - 2);
   nr_complex_t p;
 
-  // allocate S-parameter and noise corellation matrices
-  result->initSP (); if (noise) result->initNoiseSP ();
-
   // interconnected port numbers
   int k = n1->getPort (), l = n2->getPort ();
 
@@ -173,12 +207,9 @@ circuit * spsolver::connectedJoin (node * n1, node * n2) {
 
   circuit * s = n1->getCircuit ();
   circuit * t = n2->getCircuit ();
-  circuit * result = new circuit (s->getSize () + t->getSize () - 2);
+  circuit * result = joinCircuit (s->getSize () + t->getSize () - 2);
   nr_complex_t p;
 
-  // allocate S-parameter and noise corellation matrices
-  result->initSP (); if (noise) result->initNoiseSP ();
-
   // connected port numbers
   int k = n1->getPort (), l = n2->getPort ();
 
@@ -566,7 +597,6 @@ void spsolver::init (void) {
    requested frequency and solves it then. */
 int spsolver::solve (void) {
   nr_double_t freq;
-  int ports;
   runs++;
 
   // fetch simulation properties
@@ -576,6 +606,9 @@ int spsolver::solve (void) {
   // run additional noise analysis ?
   noise = !strcmp (getPropertyString ("Noise"), "yes") ? 1 : 0;
 
+  // the join circuits of a former run may lack the noise matrices
+  deleteJoinCircuits ();
+
   // create frequency sweep if necessary
   if (swp == NULL) {
     swp = createSweep ("frequency");
@@ -597,30 +630,29 @@ int spsolver::solve (void) {
   logprint (LOG_STATUS, "NOTIFY: %s: solving SP netlist\n", getName ());
 #endif
 
+  // adaptive sweeps need a monotonic frequency grid
+  int adaptive = !strcmp (getPropertyString ("Adaptive"), "yes") ? 1 : 0;
+  if (adaptive && ((swp->getType () != SWEEP_LINEAR &&
+		    swp->getType () != SWEEP_LOGARITHMIC) ||
+		   (saveCVs & SAVE_CVS))) {
+    logprint (LOG_ERROR, "WARNING: %s: adaptive sweep requires a lin or log "
+	      "sweep without characteristics, solving all points\n",
+	      getName ());
+    adaptive = 0;
+  }
+
   swp->reset ();
-  for (int i = 0; i < swp->getSize (); i++) {
+  for (int i = 0; !adaptive && i < swp->getSize (); i++) {
     freq = swp->next ();
     if (progress) logprogressbar (i, swp->getSize (), 40);
 
-    ports = subnet->countNodes ();
-    subnet->setReduced (0);
-    calc (freq);
-
-#if DEBUG && 0
-    logprint (LOG_STATUS, "NOTIFY: %s: solving netlist for f = %e\n",
-	      getName (), (double) freq);
-#endif
-
-    while (ports > subnet->getPorts ()) {
-      reduce ();
-      ports -= 2;
-    }
-
+    solveFrequency (freq);
     saveResults (freq);
     subnet->getDroppedCircuits (nlist);
     subnet->deleteUnusedCircuits (nlist);
     if (saveCVs & SAVE_CVS) saveCharacteristics (freq);
   }
+  if (adaptive) solveAdaptive ();
   if (progress) logprogressclear (40);
   dropConnections ();
 #if SORTED_LIST
@@ -629,6 +661,100 @@ int spsolver::solve (void) {
   return 0;
 }
 
+/* Computes the s-parameters of all circuits at the given frequency
+   and reduces the netlist until only the signal ports remain. */
+void spsolver::solveFrequency (nr_double_t freq) {
+  int ports = subnet->countNodes ();
+  subnet->setReduced (0);
+  joins = 0;
+  calc (freq);
+
+#if DEBUG && 0
+  logprint (LOG_STATUS, "NOTIFY: %s: solving netlist for f = %e\n",
+	    getName (), (double) freq);
+#endif
+
+  while (ports > subnet->getPorts ()) {
+    reduce ();
+    ports -= 2;
+  }
+}
+
+/* The function returns the number of complex values (s-parameters
+   and noise correlations) held by the reduced netlist. */
+int spsolver::countResults (void) {
+  int n = 0;
+  circuit * root = subnet->getRoot ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) continue;
+    n += c->getSize () * c->getSize () * (noise ? 2 : 1);
+  }
+  return n;
+}
+
+/* This function copies the s-parameters (and noise correlations) of
+   the reduced netlist into the given vector or, if 'store' is
+   non-zero, the values of the vector back into the reduced netlist. */
+void spsolver::exchangeResults (tvector<nr_complex_t> & y, int store) {
+  int k = 0;
+  circuit * root = subnet->getRoot ();
+  for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ()) {
+    if (c->getPort ()) continue;
+    for (int i = 0; i < c->getSize (); i++) {
+      for (int j = 0; j < c->getSize (); j++) {
+	if (store) {
+	  c->setS (i, j, y.get (k++));
+	  if (noise) c->setN (i, j, y.get (k++));
+	}
+	else {
+	  y.set (k++, c->getS (i, j));
+	  if (noise) y.set (k++, c->getN (i, j));
+	}
+      }
+    }
+  }
+}
+
+/* The adaptive SP sweep solves the netlist only at the frequencies
+   requested by the rational interpolation model.  The reduced netlist
+   of the last solved frequency is then reused to save the results of
+   all frequencies in the sweep from that model.  The estimated
+   relative error is saved alongside the results. */
+void spsolver::solveAdaptive (void) {
+  int idx, size = swp->getSize ();
+  tvector<nr_complex_t> y;
+  ratinterp model (swp);
+  model.setTolerance (getPropertyDouble ("AdaptTol"));
+
+  // solve at the frequencies chosen by the model
+  for (idx = model.next (); idx >= 0; idx = model.next ()) {
+    if (model.countSamples () > 0) {
+      subnet->getDroppedCircuits (nlist);
+      subnet->deleteUnusedCircuits (nlist);
+    }
+    if (progress) logprogressbar (model.countSamples (), size, 40);
+    solveFrequency (swp->get (idx));
+    if (model.countSamples () == 0) y = tvector<nr_complex_t> (countResults ());
+    exchangeResults (y, 0);
+    model.add (idx, y);
+  }
+
+#if DEBUG
+  logprint (LOG_STATUS, "NOTIFY: %s: adaptive sweep solved %d of %d "
+	    "frequencies\n", getName (), model.countSamples (), size);
+#endif
+
+  // fill the output grid from the model
+  for (int i = 0; i < size; i++) {
+    nr_double_t err = model.evaluate (i, y);
+    exchangeResults (y, 1);
+    saveResults (swp->get (i));
+    saveVariable ("AdaptErr", err, data->findDependency ("frequency"));
+  }
+  subnet->getDroppedCircuits (nlist);
+  subnet->deleteUnusedCircuits (nlist);
+}
+
 /* The function goes through the list of circuit objects and creates
    tee and cross circuits if necessary.  It looks for nodes in the
    circuit list connected to the given node. */
@@ -1115,6 +1241,8 @@ PROP_OPT [] = {
   { "Values", PROP_LIST, { 10, PROP_NO_STR }, PROP_POS_RANGE },
   { "saveCVs", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
   { "saveAll", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "Adaptive", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
+  { "AdaptTol", PROP_REAL, { 1e-4, PROP_NO_STR }, PROP_RNG_X01I },
   PROP_NO_PROP };
 struct define_t spsolver::anadef =
   { "SP", 0, PROP_ACTION, PROP_NO_SUBSTRATE, PROP_LINEAR, PROP_DEF };
@@ -26,6 +26,7 @@
 #define __SPSOLVER_H__
 
 #include <string>
+#include <vector>
 
 namespace qucs {
 
@@ -35,6 +36,7 @@ class node;
 class vector;
 class sweep;
 class nodelist;
+template <class nr_type_t> class tvector;
 
 class spsolver : public analysis
 {
@@ -47,6 +49,10 @@ class spsolver : public analysis
   void init (void);
   void reduce (void);
   int  solve (void);
+  void solveFrequency (nr_double_t);
+  void solveAdaptive (void);
+  int  countResults (void);
+  void exchangeResults (tvector<nr_complex_t> &, int);
   void insertConnections (void);
   void insertDifferentialPorts (void);
   void insertTee (node **, const char *);
@@ -56,6 +62,8 @@ class spsolver : public analysis
   void insertGround (node *);
   circuit * interconnectJoin (node *, node *);
   circuit * connectedJoin (node *, node *);
+  circuit * joinCircuit (int);
+  void deleteJoinCircuits (void);
   void noiseConnect (circuit *, node *, node *);
   void noiseInterconnect (circuit *, node *, node *);
   void saveResults (nr_double_t);
@@ -78,6 +86,8 @@ class spsolver : public analysis
   sweep * swp;
   nodelist * nlist;
   circuit * gnd;
+  std::vector<circuit *> joined;
+  unsigned int joins;
 };
 
 } // namespace qucs
@@ -0,0 +1,94 @@
+/*
+ * threadpool.cpp - pool of worker threads implementation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#if HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "threadpool.h"
+
+namespace qucs {
+
+/* Constructor creates the given number of threads including the
+   calling thread.  A number less than one selects the number of
+   hardware threads. */
+threadpool::threadpool (int n) {
+  threads = n > 0 ? n : hardwareThreads ();
+  job = NULL;
+  data = NULL;
+  generation = 0;
+  busy = 0;
+  quit = false;
+  for (int i = 1; i < threads; i++)
+    workers.push_back (std::thread (&threadpool::work, this, i));
+}
+
+// Destructor stops and joins the worker threads.
+threadpool::~threadpool () {
+  {
+    std::lock_guard<std::mutex> guard (lock);
+    quit = true;
+  }
+  started.notify_all ();
+  for (std::thread & t : workers) t.join ();
+}
+
+// Returns the number of threads the hardware runs concurrently.
+int threadpool::hardwareThreads (void) {
+  int n = (int) std::thread::hardware_concurrency ();
+  return n > 0 ? n : 1;
+}
+
+/* The function runs the given job on each thread of the pool and
+   returns when all of them are done. */
+void threadpool::run (job_func_t func, void * d) {
+  {
+    std::lock_guard<std::mutex> guard (lock);
+    job = func;
+    data = d;
+    busy = threads - 1;
+    generation++;
+  }
+  started.notify_all ();
+  (*func) (d, 0);
+  std::unique_lock<std::mutex> guard (lock);
+  while (busy > 0) finished.wait (guard);
+}
+
+// This is the loop of each worker thread waiting for the next job.
+void threadpool::work (int i) {
+  unsigned long done = 0;
+  std::unique_lock<std::mutex> guard (lock);
+  while (true) {
+    while (!quit && generation == done) started.wait (guard);
+    if (quit) break;
+    done = generation;
+    guard.unlock ();
+    (*job) (data, i);
+    guard.lock ();
+    if (--busy == 0) finished.notify_one ();
+  }
+}
+
+} // namespace qucs
@@ -0,0 +1,68 @@
+/*
+ * threadpool.h - pool of worker threads definitions
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace qucs {
+
+/* A fixed number of threads running the same job in parallel.  The
+   job gets the index of the thread it runs on, the calling thread
+   takes part as thread zero.  The pool is meant for the many short
+   jobs of an iterative solver, thus the worker threads are kept alive
+   between the jobs. */
+class threadpool
+{
+ public:
+  typedef void (* job_func_t) (void *, int);
+  threadpool (int);
+  ~threadpool ();
+  int getThreads (void) { return threads; }
+  void run (job_func_t, void *);
+  static int hardwareThreads (void);
+
+ private:
+  void work (int);
+
+ private:
+  int threads;
+  std::vector<std::thread> workers;
+  std::mutex lock;
+  std::condition_variable started;
+  std::condition_variable finished;
+  job_func_t job;
+  void * data;
+  unsigned long generation;
+  int busy;
+  bool quit;
+};
+
+} // namespace qucs
+
+#endif /* __THREADPOOL_H__ */
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <cmath>
+#include <algorithm>
 
 #include "compat.h"
 #include "logging.h"
@@ -90,23 +91,55 @@ tmatrix<nr_type_t>::tmatrix (const tmatrix & m) {
   }
 }
 
+/* The move constructor takes over the elements of the given tmatrix
+   object which is left empty. */
+template <class nr_type_t>
+tmatrix<nr_type_t>::tmatrix (tmatrix && m) {
+  rows = m.rows;
+  cols = m.cols;
+  data = m.data;
+  m.rows = m.cols = 0;
+  m.data = NULL;
+}
+
 /* The assignment copy constructor creates a new instance based on the
-   given tmatrix object. */
+   given tmatrix object.  The storage is kept if the size does not
+   change. */
 template <class nr_type_t>
 const tmatrix<nr_type_t>&
 tmatrix<nr_type_t>::operator=(const tmatrix<nr_type_t> & m) {
   if (&m != this) {
+    if (rows * cols != m.rows * m.cols) {
+      delete[] data;
+      data = NULL;
+      if (m.rows > 0 && m.cols > 0)
+	data = new nr_type_t[m.rows * m.cols];
+    }
     rows = m.rows;
     cols = m.cols;
-    delete[] data;
-    if (rows > 0 && cols > 0) {
-      data = new nr_type_t[rows * cols];
+    if (data) {
       memcpy (data, m.data, sizeof (nr_type_t) * rows * cols);
     }
   }
   return *this;
 }
 
+/* The move assignment takes over the elements of the given tmatrix
+   object which is left empty. */
+template <class nr_type_t>
+tmatrix<nr_type_t>&
+tmatrix<nr_type_t>::operator=(tmatrix<nr_type_t> && m) {
+  if (&m != this) {
+    delete[] data;
+    rows = m.rows;
+    cols = m.cols;
+    data = m.data;
+    m.rows = m.cols = 0;
+    m.data = NULL;
+  }
+  return *this;
+}
+
 // Destructor deletes a tmatrix object.
 template <class nr_type_t>
 tmatrix<nr_type_t>::~tmatrix () {
@@ -115,7 +148,7 @@ tmatrix<nr_type_t>::~tmatrix () {
 
 // Returns the tmatrix element at the given row and column.
 template <class nr_type_t>
-nr_type_t tmatrix<nr_type_t>::get (int r, int c) {
+nr_type_t tmatrix<nr_type_t>::get (int r, int c) const {
   assert (r >= 0 && r < rows && c >= 0 && c < cols);
   return data[r * cols + c];
 }
@@ -177,12 +210,7 @@ void tmatrix<nr_type_t>::setCol (int c, tvector<nr_type_t> v) {
 template <class nr_type_t>
 void tmatrix<nr_type_t>::exchangeRows (int r1, int r2) {
   assert (r1 >= 0 && r2 >= 0 && r1 < rows && r2 < rows);
-  nr_type_t * s = new nr_type_t[cols];
-  int len = sizeof (nr_type_t) * cols;
-  memcpy (s, &data[r1 * cols], len);
-  memcpy (&data[r1 * cols], &data[r2 * cols], len);
-  memcpy (&data[r2 * cols], s, len);
-  delete[] s;
+  std::swap_ranges (&data[r1 * cols], &data[(r1 + 1) * cols], &data[r2 * cols]);
 }
 
 // The function swaps the given columns with each other.
@@ -202,13 +230,11 @@ template <class nr_type_t>
 tmatrix<nr_type_t> inverse (tmatrix<nr_type_t> a) {
   nr_double_t MaxPivot;
   nr_type_t f;
-  tmatrix<nr_type_t> b;
-  tmatrix<nr_type_t> e;
   int i, c, r, pivot, n = a.getCols ();
 
-  // create temporary matrix and the result matrix
-  b = tmatrix<nr_type_t> (a);
-  e = teye<nr_type_t> (n);
+  // work on the argument copy and create the result matrix
+  tmatrix<nr_type_t> & b = a;
+  tmatrix<nr_type_t> e = teye<nr_type_t> (n);
 
   // create the eye matrix in 'b' and the result in 'e'
   for (i = 0; i < n; i++) {
@@ -257,9 +283,9 @@ tmatrix<nr_type_t> teye (int n) {
 
 // Intrinsic matrix addition.
 template <class nr_type_t>
-tmatrix<nr_type_t> tmatrix<nr_type_t>::operator += (tmatrix<nr_type_t> a) {
+tmatrix<nr_type_t>& tmatrix<nr_type_t>::operator += (const tmatrix<nr_type_t> & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
-  nr_type_t * src = a.getData ();
+  const nr_type_t * src = a.data;
   nr_type_t * dst = data;
   for (int i = 0; i < rows * cols; i++) *dst++ += *src++;
   return *this;
@@ -267,9 +293,9 @@ tmatrix<nr_type_t> tmatrix<nr_type_t>::operator += (tmatrix<nr_type_t> a) {
 
 // Intrinsic matrix substraction.
 template <class nr_type_t>
-tmatrix<nr_type_t> tmatrix<nr_type_t>::operator -= (tmatrix<nr_type_t> a) {
+tmatrix<nr_type_t>& tmatrix<nr_type_t>::operator -= (const tmatrix<nr_type_t> & a) {
   assert (a.getRows () == rows && a.getCols () == cols);
-  nr_type_t * src = a.getData ();
+  const nr_type_t * src = a.data;
   nr_type_t * dst = data;
   for (int i = 0; i < rows * cols; i++) *dst++ -= *src++;
   return *this;
@@ -277,7 +303,8 @@ tmatrix<nr_type_t> tmatrix<nr_type_t>::operator -= (tmatrix<nr_type_t> a) {
 
 // Matrix multiplication.
 template <class nr_type_t>
-tmatrix<nr_type_t> operator * (tmatrix<nr_type_t> a, tmatrix<nr_type_t> b) {
+tmatrix<nr_type_t> operator * (const tmatrix<nr_type_t> & a,
+			       const tmatrix<nr_type_t> & b) {
   assert (a.getCols () == b.getRows ());
   int r, c, i, n = a.getCols ();
   nr_type_t z;
@@ -38,7 +38,8 @@ tmatrix<nr_type_t> inverse (tmatrix<nr_type_t>);
 template <class nr_type_t>
 tmatrix<nr_type_t> teye (int);
 template <class nr_type_t>
-tmatrix<nr_type_t> operator * (tmatrix<nr_type_t>, tmatrix<nr_type_t>);
+tmatrix<nr_type_t> operator * (const tmatrix<nr_type_t> &,
+			       const tmatrix<nr_type_t> &);
 template <class nr_type_t>
 tvector<nr_type_t> operator * (tmatrix<nr_type_t>, tvector<nr_type_t>);
 template <class nr_type_t>
@@ -52,13 +53,15 @@ class tmatrix
   tmatrix (int);
   tmatrix (int, int);
   tmatrix (const tmatrix &);
+  tmatrix (tmatrix &&);
   const tmatrix& operator = (const tmatrix &);
+  tmatrix& operator = (tmatrix &&);
   ~tmatrix ();
-  nr_type_t get (int, int);
+  nr_type_t get (int, int) const;
   void set (int, int, nr_type_t);
   void set (nr_type_t);
-  int  getCols (void) { return cols; }
-  int  getRows (void) { return rows; }
+  int  getCols (void) const { return cols; }
+  int  getRows (void) const { return rows; }
   nr_type_t * getData (void) { return data; }
   tvector<nr_type_t> getRow (int);
   void setRow (int, tvector<nr_type_t>);
@@ -74,14 +77,14 @@ class tmatrix
 #ifndef _MSC_VER
   friend tmatrix inverse<> (tmatrix);
   friend tmatrix teye<nr_type_t> (int);
-  friend tmatrix operator *<> (tmatrix, tmatrix);
+  friend tmatrix operator *<> (const tmatrix &, const tmatrix &);
   friend tvector<nr_type_t> operator *<> (tmatrix, tvector<nr_type_t>);
   friend tvector<nr_type_t> operator *<> (tvector<nr_type_t>, tmatrix);
 #endif
 
   // intrinsic operators
-  tmatrix operator += (tmatrix);
-  tmatrix operator -= (tmatrix);
+  tmatrix& operator += (const tmatrix &);
+  tmatrix& operator -= (const tmatrix &);
 
   // easy accessor operators
   nr_type_t  operator () (int r, int c) const {
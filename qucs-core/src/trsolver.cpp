@@ -30,6 +30,7 @@
 #include <string.h>
 #include <float.h>
 #include <algorithm>
+#include <map>
 
 #include "compat.h"
 #include "object.h"
@@ -38,6 +39,7 @@
 #include "circuit.h"
 #include "sweep.h"
 #include "net.h"
+#include "arena.h"
 #include "netdefs.h"
 #include "analysis.h"
 #include "nasolver.h"
@@ -46,6 +48,8 @@
 #include "transient.h"
 #include "exception.h"
 #include "exceptionstack.h"
+#include "digital/eventsim.h"
+#include "latency.h"
 
 #define STEPDEBUG   0 // set to zero for release
 #define BREAKPOINTS 0 // exact breakpoint calculation
@@ -69,6 +73,10 @@ trsolver::trsolver ()
     setDescription ("transient");
     for (int i = 0; i < 8; i++) solution[i] = NULL;
     tHistory = NULL;
+    breakTime = -1;
+    breakHit = 0;
+    events = NULL;
+    multirate = NULL;
     relaxTSR = false;
     initialDC = true;
 }
@@ -82,6 +90,10 @@ trsolver::trsolver (const std::string &n)
     setDescription ("transient");
     for (int i = 0; i < 8; i++) solution[i] = NULL;
     tHistory = NULL;
+    breakTime = -1;
+    breakHit = 0;
+    events = NULL;
+    multirate = NULL;
     relaxTSR = false;
     initialDC = true;
 }
@@ -98,6 +110,8 @@ trsolver::~trsolver ()
         }
     }
     delete tHistory;
+    delete events;
+    delete multirate;
 }
 
 /* The copy constructor creates a new instance of the trsolver class
@@ -108,6 +122,11 @@ trsolver::trsolver (trsolver & o)
     swp = o.swp ? new sweep (*o.swp) : NULL;
     for (int i = 0; i < 8; i++) solution[i] = NULL;
     tHistory = o.tHistory ? new history (*o.tHistory) : NULL;
+    histCircuits = o.histCircuits;
+    breakTime = -1;
+    breakHit = 0;
+    events = NULL;
+    multirate = NULL;
     relaxTSR = o.relaxTSR;
     initialDC = o.initialDC;
 }
@@ -197,6 +216,10 @@ int trsolver::solve (void)
         eqnAlgo = ALGO_QR_DECOMPOSITION_LS;
     else if (!strcmp (solver, "GolubSVD"))
         eqnAlgo = ALGO_SV_DECOMPOSITION;
+    else if (!strcmp (solver, "BiCGStab"))
+        eqnAlgo = ALGO_BICGSTAB;
+    else if (!strcmp (solver, "CG"))
+        eqnAlgo = ALGO_CG;
 
     // Perform initial DC analysis.
     if (initialDC)
@@ -212,6 +235,17 @@ int trsolver::solve (void)
     setCalculation ((calculate_func_t) &calcTR);
     solve_pre ();
 
+    // Partition the circuit into blocks which may become latent.
+    if (!strcmp (getPropertyString ("Multirate"), "yes"))
+    {
+        multirate = new latency ();
+        if (!multirate->init (nlist, countNodes (), countVoltageSources ()))
+        {
+            delete multirate;
+            multirate = NULL;
+        }
+    }
+
     // Create time sweep if necessary.
     initSteps ();
     swp->reset ();
@@ -223,6 +257,9 @@ int trsolver::solve (void)
     applyNodeset (false);
     fillSolution (x);
 
+    // Take the initial logic values from the operating point.
+    if (events) events->start ();
+
     // Tell integrators to be initialized.
     setMode (MODE_INIT);
 
@@ -285,6 +322,10 @@ int trsolver::solve (void)
 
                 // step back from the current time value to the previous time
                 if (current > 0) current -= delta;
+                // the shortened step does not reach a breakpoint anymore
+                breakTime = -1;
+                // evaluate all circuits again
+                if (multirate) multirate->wake ();
                 // Reduce step-size (by half) if failed to converge.
                 delta /= 2;
                 if (delta <= deltaMin)
@@ -319,17 +360,22 @@ int trsolver::solve (void)
                 break;
             }
             // return if any errors occured other than convergence failure
-            if (error) return -1;
+            if (error)
+            {
+                deinitTR ();
+                return -1;
+            }
 
             // if the step was rejected, the solution loop is restarted here
             if (rejected) continue;
 
             // check whether Jacobian matrix is still non-singular
-            if (!A->isFinite ())
+            if (!isMatrixFinite ())
             {
                 logprint (LOG_ERROR, "ERROR: %s: Jacobian singular at t = %.3e, "
                           "aborting %s analysis\n", getName (), (double) current,
                           getDescription ().c_str());
+                deinitTR ();
                 return -1;
             }
 
@@ -341,13 +387,18 @@ int trsolver::solve (void)
             if (running > 1)
             {
                 adjustDelta (time);
-                adjustOrder ();
+                // restart with first order behind a breakpoint
+                adjustOrder (breakHit);
             }
             else
             {
                 fillStates ();
                 nextStates ();
                 rejected = 0;
+                if (events) events->update (current, deltaMin);
+                if (multirate)
+                    multirate->update (x, getPropertyDouble ("vntol"),
+                                       getPropertyDouble ("reltol"));
             }
 
             saveCurrent = current;
@@ -390,6 +441,10 @@ int trsolver::solve (void)
     logprint (LOG_STATUS, "NOTIFY: %s: average NR-iterations %g, "
               "%d non-convergences\n", getName (),
               (double) statIterations / statSteps, statConvergence);
+    if (multirate)
+        logprint (LOG_STATUS, "NOTIFY: %s: %d latent blocks, %g%% of the "
+                  "circuit evaluations skipped\n", getName (),
+                  multirate->getBlocks (), 100 * multirate->getSkipped ());
 
     // cleanup
     deinitTR ();
@@ -404,20 +459,17 @@ void trsolver::initHistory (nr_double_t t)
     tHistory->push_back(t);
     tHistory->self ();
     // initialize circuit histories
+    mapHistory ();
     nr_double_t age = 0.0;
-    circuit * root = subnet->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    for (auto & h : histCircuits)
     {
-        if (c->hasHistory ())
+        h.c->applyHistory (tHistory);
+        if (h.c->getHistoryAge () > age)
         {
-            c->applyHistory (tHistory);
-            saveHistory (c);
-            if (c->getHistoryAge () > age)
-            {
-                age = c->getHistoryAge ();
-            }
+            age = h.c->getHistoryAge ();
         }
     }
+    saveHistory ();
     // set maximum required age for all circuits
     tHistory->setAge (age);
 }
@@ -431,43 +483,59 @@ void trsolver::updateHistory (nr_double_t t)
         // update time vector
         tHistory->push_back (t);
         // update circuit histories
-        circuit * root = subnet->getRoot ();
-        for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-        {
-            if (c->hasHistory ()) saveHistory (c);
-        }
+        saveHistory ();
         tHistory->drop ();
     }
 }
 
-// Stores node voltages and branch currents in the given circuits history.
-void trsolver::saveHistory (circuit * c)
+/* The function collects the circuits having a history together with
+   the solution vector indices of their node voltages and branch
+   currents.  This way the node list is scanned once per analysis
+   instead of once per port and time step. */
+void trsolver::mapHistory (void)
 {
-
     int N = countNodes ();
-    int r, i, s = c->getSize ();
+    std::map<circuit *, int> index;
 
-    for (i = 0; i < s; i++)
+    histCircuits.clear ();
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
-        // save node voltages
-        r = findAssignedNode (c, i);
-        if (r < 0)
-            // the node was not found, append a zero to the history
-            // matching this index
-            c->appendHistory (i, 0.0);
-        else
-            // the node was found, append the voltage value to
-            // that node's history
-            c->appendHistory (i, x->get (r));
+        if (!c->hasHistory ()) continue;
+        int s = c->getSize ();
+        histentry_t h;
+        h.c = c;
+        // unassigned nodes get a zero history
+        h.rows.assign (s + c->getVoltageSources (), -1);
+        for (int i = 0; i < c->getVoltageSources (); i++)
+            h.rows[s + i] = c->getVoltageSource () + i + N;
+        index[c] = histCircuits.size ();
+        histCircuits.push_back (h);
     }
+    if (histCircuits.empty ()) return;
 
-    for (i = 0; i < c->getVoltageSources (); i++)
+    for (int r = 0; r < N; r++)
     {
-        // save branch currents
-        r = c->getVoltageSource () + i;
-        c->appendHistory (i + s, x->get (r + N));
+        for (auto & n : *nlist->getNode (r))
+        {
+            auto it = index.find (n->getCircuit ());
+            if (it != index.end ())
+                histCircuits[it->second].rows[n->getPort ()] = r;
+        }
     }
+}
 
+// Stores node voltages and branch currents in the circuits histories.
+void trsolver::saveHistory (void)
+{
+    for (auto & h : histCircuits)
+    {
+        for (int i = 0; i < (int) h.rows.size (); i++)
+        {
+            int r = h.rows[i];
+            h.c->appendHistory (i, r < 0 ? 0.0 : x->get (r));
+        }
+    }
 }
 
 /* This function predicts a start value for the solution vector for
@@ -622,6 +690,8 @@ void trsolver::setDelta (void)
    global truncation error. */
 void trsolver::adjustDelta (nr_double_t t)
 {
+    int landed = breakTime >= 0;
+    breakHit = 0;
     deltaOld = delta;
     delta = checkDelta ();
     if (delta > deltaMax) delta = deltaMax;
@@ -700,6 +770,80 @@ void trsolver::adjustDelta (nr_double_t t)
         nextStates ();
         rejected = 0;
     }
+
+    // the waveform of a source changes abruptly at the accepted point,
+    // the step size estimate from before is meaningless behind it
+    if (landed && !rejected)
+    {
+        current = breakTime;
+        delta = std::max (delta / 10, deltaMin);
+        breakHit = 1;
+    }
+    breakTime = -1;
+
+    // the digital gates react on the accepted point
+    if (events && !rejected) events->update (current, deltaMin);
+
+    // wake up the latent blocks behind a breakpoint, otherwise check
+    // which blocks become latent or active again
+    if (multirate && !rejected)
+    {
+        if (breakHit)
+            multirate->wake ();
+        else
+            multirate->update (x, getPropertyDouble ("vntol"),
+                               getPropertyDouble ("reltol"));
+    }
+
+    // land exactly on the next breakpoint of the sources
+    nr_double_t b = nextBreakpoint ();
+    if (current + delta > b - deltaMin)
+    {
+        delta = b - current;
+        breakTime = b;
+    }
+    else if (current + 2 * delta > b)
+    {
+        // avoid a tiny step right in front of the breakpoint
+        delta = (b - current) / 2;
+    }
+}
+
+/* The function collects the first breakpoint of each circuit.  The
+   sources publish the times at which their waveforms change abruptly,
+   so these need not be discovered by rejected time steps. */
+void trsolver::initBreakpoints (void)
+{
+    breakpoints = decltype (breakpoints) ();
+    breakTime = -1;
+    breakHit = 0;
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        nr_double_t t = c->nextBreakpoint (0);
+        if (std::isfinite (t)) breakpoints.push (breakpoint_t (t, c));
+    }
+}
+
+/* Returns the first breakpoint beyond the current time.  Breakpoints
+   which have been passed are replaced by the following ones of the
+   same circuit.  The pending events of the digital simulation are
+   breakpoints as well. */
+nr_double_t trsolver::nextBreakpoint (void)
+{
+    nr_double_t lim = current + deltaMin;
+    while (!breakpoints.empty () && breakpoints.top ().first <= lim)
+    {
+        circuit * c = breakpoints.top ().second;
+        breakpoints.pop ();
+        nr_double_t t = c->nextBreakpoint (lim);
+        if (std::isfinite (t) && t > lim)
+            breakpoints.push (breakpoint_t (t, c));
+    }
+    nr_double_t b = std::numeric_limits<nr_double_t>::infinity ();
+    if (!breakpoints.empty ()) b = breakpoints.top ().first;
+    if (events) b = std::min (b, events->nextEvent ());
+    return b;
 }
 
 /* The function can be used to increase the current order of the
@@ -732,31 +876,38 @@ void trsolver::adjustOrder (int reduce)
 }
 
 /* Goes through the list of circuit objects and runs its calcDC()
-   function. */
+   function unless the circuit is bypassed. */
 void trsolver::calcDC (trsolver * self)
 {
-    circuit * root = self->getNet()->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    {
-        c->calcDC ();
-    }
+    self->evaluate ((evaluate_func_t) &evalDC);
+}
+
+// Evaluates a single circuit for the initial DC analysis.
+void trsolver::evalDC (circuit * c, trsolver *)
+{
+    c->calcDC ();
 }
 
 /* Goes through the list of circuit objects and runs its calcTR()
-   function. */
+   function unless the circuit is bypassed.  The bypass is restarted
+   for each call of the non-linear solver, thus a bypassed circuit has
+   been evaluated at the current time step with the same step size. */
 void trsolver::calcTR (trsolver * self)
 {
-    circuit * root = self->getNet()->getRoot ();
-    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
-    {
-        c->calcTR (self->current);
-    }
+    self->evaluate ((evaluate_func_t) &evalTR);
+}
+
+// Evaluates a single circuit at the current time step.
+void trsolver::evalTR (circuit * c, trsolver * self)
+{
+    c->calcTR (self->current);
 }
 
 /* Goes through the list of circuit objects and runs its initDC()
    function. */
 void trsolver::initDC (void)
 {
+    subnet->getArena()->restart ();
     circuit * root = subnet->getRoot ();
     for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
     {
@@ -819,13 +970,31 @@ void trsolver::initTR (void)
         setState (sState, (nr_double_t) i, i);
     }
 
+    // run the digital gates event driven if requested
+    if (events) events->release ();
+    delete events;
+    events = NULL;
+    if (!strcmp (getPropertyString ("DigitalMode"), "event"))
+    {
+        events = new eventsim ();
+        if (!events->init (subnet, deltaMax / 16))
+        {
+            events->release ();
+            delete events;
+            events = NULL;
+        }
+    }
+
     // tell circuits about the transient analysis
+    subnet->getArena()->restart ();
     circuit *c, * root = subnet->getRoot ();
     for (c = root; c != NULL; c = (circuit *) c->getNext ())
         initCircuitTR (c);
     // also initialize created circuits
     for (c = root; c != NULL; c = (circuit *) c->getPrev ())
         initCircuitTR (c);
+    // collect the breakpoints of the sources
+    initBreakpoints ();
 }
 
 // This function cleans up some memory used by the transient analysis.
@@ -843,6 +1012,15 @@ void trsolver::deinitTR (void)
         delete tHistory;
         tHistory = NULL;
     }
+    // return the digital gates to their analog models
+    if (events) events->release ();
+    delete events;
+    events = NULL;
+    // evaluate the circuits of latent blocks again
+    if (multirate) multirate->release ();
+    delete multirate;
+    multirate = NULL;
+    deltaRows.clear ();
 }
 
 // The function initialize a single circuit.
@@ -878,7 +1056,7 @@ nr_double_t trsolver::checkDelta (void)
     nr_double_t LTEreltol = getPropertyDouble ("LTEreltol");
     nr_double_t LTEabstol = getPropertyDouble ("LTEabstol");
     nr_double_t LTEfactor = getPropertyDouble ("LTEfactor");
-    nr_double_t dif, rel, tol, lte, q, n =  std::numeric_limits<nr_double_t>::max();
+    nr_double_t n = std::numeric_limits<nr_double_t>::max();
     int N = countNodes ();
     int M = countVoltageSources ();
 
@@ -887,27 +1065,32 @@ nr_double_t trsolver::checkDelta (void)
     // pec = predictor error constant
     nr_double_t pec = getPredictorError (predType, predOrder);
 
-    // go through each solution
+    // the rows of the real voltage sources are skipped
+    if ((int) deltaRows.size () != N + M) initDeltaRows ();
+    const char * use = deltaRows.data ();
+    const char * skip = multirate ? multirate->getLatentRows () : NULL;
+    const nr_double_t * xn = x->getData ();
+    const nr_double_t * xo = SOL(0)->getData ();
+    const nr_double_t inf = std::numeric_limits<nr_double_t>::max();
+
+    // find the largest solution difference relative to its tolerance,
+    // it limits the step size the most
+    nr_double_t e = 0;
     for (int r = 0; r < N + M; r++)
     {
+        nr_double_t dif = fabs (xn[r] - xo[r]);
+        nr_double_t tol = LTEreltol * std::max (fabs (xn[r]), fabs (xo[r]))
+            + LTEabstol;
+        bool valid = use[r] && !(skip && skip[r]) && dif <= inf;
+        nr_double_t q = valid ? dif / tol : 0;
+        e = std::max (e, q);
+    }
 
-        // skip real voltage sources
-        if (r >= N)
-        {
-            if (findVoltageSource(r - N)->isVSource ())
-                continue;
-        }
-
-        dif = x->get (r) - SOL(0)->get (r);
-        if (std::isfinite (dif) && dif != 0)
-        {
-            // use Milne' estimate for the local truncation error
-            rel = MAX (fabs (x->get (r)), fabs (SOL(0)->get (r)));
-            tol = LTEreltol * rel + LTEabstol;
-            lte = LTEfactor * (cec / (pec - cec)) * dif;
-            q =  delta * exp (log (fabs (tol / lte)) / (corrOrder + 1));
-            n = std::min (n, q);
-        }
+    // use Milne' estimate for the local truncation error
+    if (e > 0)
+    {
+        nr_double_t lte = fabs (LTEfactor * (cec / (pec - cec))) * e;
+        n = delta * std::pow (1 / lte, 1.0 / (corrOrder + 1));
     }
 #if STEPDEBUG
     logprint (LOG_STATUS, "DEBUG: delta according to local truncation "
@@ -917,6 +1100,23 @@ nr_double_t trsolver::checkDelta (void)
     return delta;
 }
 
+/* The function marks the rows of the solution vector which take part
+   in the estimate of the local truncation error, i.e. all but the
+   branch currents of the real voltage sources. */
+void trsolver::initDeltaRows (void)
+{
+    int N = countNodes ();
+    int M = countVoltageSources ();
+    deltaRows.assign (N + M, 1);
+    circuit * root = subnet->getRoot ();
+    for (circuit * c = root; c != NULL; c = (circuit *) c->getNext ())
+    {
+        if (!c->isVSource ()) continue;
+        for (int k = 0; k < c->getVoltageSources (); k++)
+            deltaRows[N + c->getVoltageSource () + k] = 0;
+    }
+}
+
 // The function updates the integration coefficients.
 void trsolver::updateCoefficients (nr_double_t delta)
 {
@@ -952,6 +1152,7 @@ PROP_OPT [] =
     { "abstol", PROP_REAL, { 1e-12, PROP_NO_STR }, PROP_RNG_X01I },
     { "vntol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
     { "reltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
+    { "bypasstol", PROP_REAL, { 0, PROP_NO_STR }, PROP_RNGII (0, 1) },
     { "LTEabstol", PROP_REAL, { 1e-6, PROP_NO_STR }, PROP_RNG_X01I },
     { "LTEreltol", PROP_REAL, { 1e-3, PROP_NO_STR }, PROP_RNG_X01I },
     { "LTEfactor", PROP_REAL, { 1, PROP_NO_STR }, PROP_RNGII (1, 16) },
@@ -959,6 +1160,12 @@ PROP_OPT [] =
     { "Solver", PROP_STR, { PROP_NO_VAL, "CroutLU" }, PROP_RNG_SOL },
     { "relaxTSR", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
     { "initialDC", PROP_STR, { PROP_NO_VAL, "yes" }, PROP_RNG_YESNO },
+    { "Threads", PROP_INT, { 1, PROP_NO_STR }, PROP_RNGII (0, 256) },
+    {
+        "DigitalMode", PROP_STR, { PROP_NO_VAL, "analog" },
+        PROP_RNG_STR2 ("analog", "event")
+    },
+    { "Multirate", PROP_STR, { PROP_NO_VAL, "no" }, PROP_RNG_YESNO },
     PROP_NO_PROP
 };
 struct define_t trsolver::anadef =
@@ -25,6 +25,10 @@
 #ifndef __TRSOLVER_H__
 #define __TRSOLVER_H__
 
+#include <vector>
+#include <queue>
+#include <functional>
+
 #include "nasolver.h"
 #include "states.h"
 
@@ -33,6 +37,8 @@ namespace qucs {
 class sweep;
 class circuit;
 class history;
+class eventsim;
+class latency;
 
 class trsolver : public nasolver<nr_double_t>, public states<nr_double_t>
 {
@@ -50,18 +56,24 @@ public:
     void setDelta (void);
     void adjustDelta (nr_double_t);
     void adjustOrder (int reduce = 0);
+    void initBreakpoints (void);
+    nr_double_t nextBreakpoint (void);
     void initTR (void);
     void deinitTR (void);
     static void calcTR (trsolver *);
+    static void evalTR (circuit *, trsolver *);
     void initDC (void);
     static void calcDC (trsolver *);
+    static void evalDC (circuit *, trsolver *);
     void initSteps (void);
     void saveAllResults (nr_double_t);
     nr_double_t checkDelta (void);
+    void initDeltaRows (void);
     void updateCoefficients (nr_double_t);
     void initHistory (nr_double_t);
     void updateHistory (nr_double_t);
-    void saveHistory (circuit *);
+    void mapHistory (void);
+    void saveHistory (void);
     void predictBashford (void);
     void predictEuler (void);
     void predictGear (void);
@@ -96,6 +108,18 @@ protected:
     int statIterations;
     int statConvergence;
     history * tHistory;
+    // circuits with histories and the solution vector indices to save
+    struct histentry_t { circuit * c; std::vector<int> rows; };
+    std::vector<histentry_t> histCircuits;
+    // upcoming breakpoints of the sources, earliest first
+    typedef std::pair<nr_double_t, circuit *> breakpoint_t;
+    std::priority_queue<breakpoint_t, std::vector<breakpoint_t>,
+                        std::greater<breakpoint_t> > breakpoints;
+    nr_double_t breakTime; // breakpoint the current step lands on
+    int breakHit;          // accepted point lies on a breakpoint
+    eventsim * events;     // event driven digital simulation
+    latency * multirate;   // latent blocks of the circuit
+    std::vector<char> deltaRows; // rows limiting the step size
     bool relaxTSR;
     bool initialDC;
     int ohm;
@@ -107,11 +107,9 @@ tvector<nr_type_t> operator + (tvector<nr_type_t> a, tvector<nr_type_t> b) {
 
 // Intrinsic vector addition.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator += (tvector<nr_type_t> a) {
-  assert (a.getSize () == (int)data.size ());
-  std::vector<nr_type_t> * src = a.getData ();
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] += (*src)[i];
+tvector<nr_type_t>& tvector<nr_type_t>::operator += (const tvector<nr_type_t> & a) {
+  assert (a.size () == data.size ());
+  for (std::size_t i = 0; i < data.size (); i++) data[i] += a.data[i];
   return *this;
 }
 
@@ -127,27 +125,23 @@ tvector<nr_type_t> operator - (tvector<nr_type_t> a, tvector<nr_type_t> b) {
 
 // Intrinsic vector subtraction.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator -= (tvector<nr_type_t> a) {
-  assert (a.size () == (int)data.size ());
-  std::vector<nr_type_t> * src = a.getData ();
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] -= (*src)[i];
+tvector<nr_type_t>& tvector<nr_type_t>::operator -= (const tvector<nr_type_t> & a) {
+  assert (a.size () == data.size ());
+  for (std::size_t i = 0; i < data.size (); i++) data[i] -= a.data[i];
   return *this;
 }
 
 // Intrinsic scalar multiplication.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator *= (nr_double_t s) {
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] *= s;
+tvector<nr_type_t>& tvector<nr_type_t>::operator *= (nr_double_t s) {
+  for (std::size_t i = 0; i < data.size (); i++) data[i] *= s;
   return *this;
 }
 
 // Intrinsic scalar division.
 template <class nr_type_t>
-tvector<nr_type_t> tvector<nr_type_t>::operator /= (nr_double_t s) {
-  std::vector<nr_type_t> * dst = data;
-  for (int i = 0; i < (int)data.size (); i++) (*dst)[i] /= s;
+tvector<nr_type_t>& tvector<nr_type_t>::operator /= (nr_double_t s) {
+  for (std::size_t i = 0; i < data.size (); i++) data[i] /= s;
   return *this;
 }
 
@@ -76,6 +76,9 @@ class tvector
   tvector () = default;
   tvector (const std::size_t i) : data(i) {};
   tvector (const tvector &) = default;
+  tvector (tvector &&) = default;
+  tvector & operator = (const tvector &) = default;
+  tvector & operator = (tvector &&) = default;
   ~tvector () = default;
   nr_type_t get (int);
   void set (int, nr_type_t);
@@ -119,10 +122,10 @@ class tvector
 #endif
 
   // intrinsic operators
-  tvector operator += (tvector);
-  tvector operator -= (tvector);
-  tvector operator *= (nr_double_t);
-  tvector operator /= (nr_double_t);
+  tvector& operator += (const tvector &);
+  tvector& operator -= (const tvector &);
+  tvector& operator *= (nr_double_t);
+  tvector& operator /= (nr_double_t);
 
   // assignment operators
   tvector operator = (const nr_type_t);
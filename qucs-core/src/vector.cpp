@@ -46,9 +46,15 @@
 
 namespace qucs {
 
+/* The vector data is kept as real values (rdata) as long as all of
+   them are real.  It is converted into complex values (data) once a
+   complex value is stored or a reference to an item is requested.
+   Both buffers are never in use at the same time. */
+
 // Constructor creates an unnamed instance of the vector class.
 vector::vector () : object () {
   capacity = size = 0;
+  rdata = NULL;
   data = NULL;
   dependencies = NULL;
   origin = NULL;
@@ -61,8 +67,9 @@ vector::vector () : object () {
 vector::vector (int s) : object () {
   assert (s >= 0);
   capacity = size = s;
-  data = s > 0 ? (nr_complex_t *)
-    calloc (capacity, sizeof (nr_complex_t)) : NULL;
+  rdata = s > 0 ? (nr_double_t *)
+    calloc (capacity, sizeof (nr_double_t)) : NULL;
+  data = NULL;
   dependencies = NULL;
   origin = NULL;
   requested = 0;
@@ -74,9 +81,17 @@ vector::vector (int s) : object () {
 vector::vector (int s, nr_complex_t val) : object () {
   assert (s >= 0);
   capacity = size = s;
-  data = s > 0 ? (nr_complex_t *)
-    calloc (capacity, sizeof (nr_complex_t)) : NULL;
-  for (int i = 0; i < s; i++) data[i] = val;
+  rdata = NULL;
+  data = NULL;
+  if (imag (val) != 0.0) {
+    data = s > 0 ? (nr_complex_t *)
+      calloc (capacity, sizeof (nr_complex_t)) : NULL;
+    for (int i = 0; i < s; i++) data[i] = val;
+  } else {
+    rdata = s > 0 ? (nr_double_t *)
+      calloc (capacity, sizeof (nr_double_t)) : NULL;
+    for (int i = 0; i < s; i++) rdata[i] = real (val);
+  }
   dependencies = NULL;
   origin = NULL;
   requested = 0;
@@ -86,6 +101,7 @@ vector::vector (int s, nr_complex_t val) : object () {
 // Constructor creates an named instance of the vector class.
 vector::vector (const std::string &n) : object (n) {
   capacity = size = 0;
+  rdata = NULL;
   data = NULL;
   dependencies = NULL;
   origin = NULL;
@@ -98,8 +114,9 @@ vector::vector (const std::string &n) : object (n) {
   vector::vector (const std::string &n, int s) : object (n) {
   assert (s >= 0);
   capacity = size = s;
-  data = s > 0 ? (nr_complex_t *)
-    calloc (capacity, sizeof (nr_complex_t)) : NULL;
+  rdata = s > 0 ? (nr_double_t *)
+    calloc (capacity, sizeof (nr_double_t)) : NULL;
+  data = NULL;
   dependencies = NULL;
   origin = NULL;
   requested = 0;
@@ -111,8 +128,15 @@ vector::vector (const std::string &n) : object (n) {
 vector::vector (const vector & v) : object (v) {
   size = v.size;
   capacity = v.capacity;
-  data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
-  memcpy (data, v.data, sizeof (nr_complex_t) * size);
+  rdata = NULL;
+  data = NULL;
+  if (v.data) {
+    data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
+    memcpy (data, v.data, sizeof (nr_complex_t) * size);
+  } else if (v.rdata) {
+    rdata = (nr_double_t *) malloc (sizeof (nr_double_t) * capacity);
+    memcpy (rdata, v.rdata, sizeof (nr_double_t) * size);
+  }
   dependencies = v.dependencies ? new strlist (*v.dependencies) : NULL;
   origin = v.origin ? strdup (v.origin) : NULL;
   requested = v.requested;
@@ -128,9 +152,13 @@ const vector& vector::operator=(const vector & v) {
     size = v.size;
     capacity = v.capacity;
     if (data) { free (data); data = NULL; }
-    if (capacity > 0) {
+    if (rdata) { free (rdata); rdata = NULL; }
+    if (capacity > 0 && v.data) {
       data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
       if (size > 0) memcpy (data, v.data, sizeof (nr_complex_t) * size);
+    } else if (capacity > 0 && v.rdata) {
+      rdata = (nr_double_t *) malloc (sizeof (nr_double_t) * capacity);
+      if (size > 0) memcpy (rdata, v.rdata, sizeof (nr_double_t) * size);
     }
   }
   return *this;
@@ -138,6 +166,7 @@ const vector& vector::operator=(const vector & v) {
 
 // Destructor deletes a vector object.
 vector::~vector () {
+  free (rdata);
   free (data);
   delete dependencies;
   free (origin);
@@ -154,47 +183,94 @@ void vector::setDependencies (strlist * s) {
   dependencies = s;
 }
 
+// Converts the real data items into complex ones.
+void vector::promote (void) {
+  if (data) return;
+  data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * (capacity ? capacity : 1));
+  for (int i = 0; i < size; i++) data[i] = nr_complex_t (rdata[i]);
+  free (rdata);
+  rdata = NULL;
+}
+
+/* Converts the data items into real ones.  The imaginary parts are
+   dropped. */
+void vector::makeReal (void) {
+  if (!data) return;
+  rdata = (nr_double_t *) malloc (sizeof (nr_double_t) * (capacity ? capacity : 1));
+  for (int i = 0; i < size; i++) rdata[i] = real (data[i]);
+  free (data);
+  data = NULL;
+}
+
+// Ensures that the vector can hold the given number of data items.
+void vector::reserve (int n) {
+  if (n <= capacity && (data || rdata)) return;
+  capacity = n;
+  if (data)
+    data = (nr_complex_t *) realloc (data, sizeof (nr_complex_t) * capacity);
+  else
+    rdata = (nr_double_t *) realloc (rdata, sizeof (nr_double_t) * capacity);
+}
+
 /* The function appends a new complex data item to the end of the
    vector and ensures that the vector can hold the increasing number
    of data items. */
 void vector::add (nr_complex_t c) {
-  if (data == NULL) {
-    size = 0; capacity = 64;
-    data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
+  if (data == NULL && rdata == NULL) {
+    size = 0;
+    reserve (64);
   }
   else if (size >= capacity) {
-    capacity *= 2;
-    data = (nr_complex_t *) realloc (data, sizeof (nr_complex_t) * capacity);
+    reserve (capacity * 2);
   }
-  data[size++] = c;
+  if (data == NULL && imag (c) != 0.0) promote ();
+  if (data)
+    data[size++] = c;
+  else
+    rdata[size++] = real (c);
 }
 
 /* This function appends the given vector to the vector. */
 void vector::add (vector * v) {
   if (v != NULL) {
-    if (data == NULL) {
-      size = 0; capacity = v->getSize ();
-      data = (nr_complex_t *) malloc (sizeof (nr_complex_t) * capacity);
+    if (data == NULL && rdata == NULL) {
+      size = 0;
+      reserve (v->getSize ());
     }
     else if (size + v->getSize () > capacity) {
-      capacity += v->getSize ();
-      data = (nr_complex_t *) realloc (data, sizeof (nr_complex_t) * capacity);
+      reserve (capacity + v->getSize ());
     }
-    for (int i = 0; i < v->getSize (); i++) data[size++] = v->get (i);
+    if (data == NULL && v->data != NULL) promote ();
+    if (data)
+      for (int i = 0; i < v->getSize (); i++) data[size++] = v->get (i);
+    else
+      for (int i = 0; i < v->getSize (); i++) rdata[size++] = v->rdata[i];
   }
 }
 
 // Returns the complex data item at the given position.
 nr_complex_t vector::get (int i) {
-  return data[i];
+  return data ? data[i] : nr_complex_t (rdata[i]);
+}
+
+// Returns the real part of the data item at the given position.
+nr_double_t vector::getReal (int i) const {
+  return data ? real (data[i]) : rdata[i];
 }
 
 void vector::set (nr_double_t d, int i) {
-  data[i] = nr_complex_t (d);
+  if (data)
+    data[i] = nr_complex_t (d);
+  else
+    rdata[i] = d;
 }
 
 void vector::set (const nr_complex_t z, int i) {
-  data[i] = nr_complex_t (z);
+  if (data == NULL && imag (z) != 0.0) promote ();
+  if (data)
+    data[i] = z;
+  else
+    rdata[i] = real (z);
 }
 
 // The function returns the current size of the vector.
@@ -217,6 +293,11 @@ int vector::checkSizes (vector v1, vector v2) {
 nr_double_t vector::maximum (void) {
   nr_complex_t c;
   nr_double_t d, max_D = -std::numeric_limits<nr_double_t>::max();
+  if (isReal ()) {
+    for (int i = 0; i < getSize (); i++)
+      if (rdata[i] > max_D) max_D = rdata[i];
+    return max_D;
+  }
   for (int i = 0; i < getSize (); i++) {
     c = data[i];
     d = fabs (arg (c)) < pi_over_2 ? abs (c) : -abs (c);
@@ -231,6 +312,11 @@ nr_double_t vector::maximum (void) {
 nr_double_t vector::minimum (void) {
   nr_complex_t c;
   nr_double_t d, min_D = +std::numeric_limits<nr_double_t>::max();
+  if (isReal ()) {
+    for (int i = 0; i < getSize (); i++)
+      if (rdata[i] < min_D) min_D = rdata[i];
+    return min_D;
+  }
   for (int i = 0; i < getSize (); i++) {
     c = data[i];
     d = fabs (arg (c)) < pi_over_2 ? abs (c) : -abs (c);
@@ -244,20 +330,25 @@ nr_double_t vector::minimum (void) {
 vector unwrap (vector v, nr_double_t tol, nr_double_t step) {
   vector result (v.getSize ());
   nr_double_t add = 0;
-  result (0) = v (0);
+  result.set (v.get (0), 0);
   for (int i = 1; i < v.getSize (); i++) {
-    nr_double_t diff = real (v (i) - v (i-1));
+    nr_double_t diff = real (v.get (i) - v.get (i-1));
     if (diff > +tol) {
       add -= step;
     } else if (diff < -tol) {
       add += step;
     }
-    result (i) = v (i) + add;
+    result.set (v.get (i) + add, i);
   }
   return result;
 }
 
 nr_complex_t sum (vector v) {
+  if (v.isReal ()) {
+    nr_double_t result = 0.0;
+    for (int i = 0; i < v.getSize (); i++) result += v.getReal (i);
+    return result;
+  }
   nr_complex_t result (0.0);
   for (int i = 0; i < v.getSize (); i++) result += v.get (i);
   return result;
@@ -270,9 +361,7 @@ nr_complex_t prod (vector v) {
 }
 
 nr_complex_t avg (vector v) {
-  nr_complex_t result (0.0);
-  for (int i = 0; i < v.getSize (); i++) result += v.get (i);
-  return result / (nr_double_t) v.getSize ();
+  return sum (v) / (nr_double_t) v.getSize ();
 }
 
 vector signum (vector v) {
@@ -322,7 +411,7 @@ vector xhypot (vector v1, vector v2) {
   }
   vector res (len);
   for (j = i = n = 0; n < len; n++) {
-    res (n) = xhypot (v1 (i), v2 (j));
+    res.set (xhypot (v1.get (i), v2.get (j)), n);
     if (++i >= len1) i = 0; if (++j >= len2) j = 0;
   }
   return res;
@@ -336,30 +425,34 @@ vector sinc (vector v) {
 
 vector abs (vector v) {
   vector result (v);
+  result.makeReal ();
   for (int i = 0; i < v.getSize (); i++) result.set (abs (v.get (i)), i);
   return result;
 }
 
 vector norm (vector v) {
   vector result (v);
+  result.makeReal ();
   for (int i = 0; i < v.getSize (); i++) result.set (norm (v.get (i)), i);
   return result;
 }
 
 vector arg (vector v) {
   vector result (v);
+  result.makeReal ();
   for (int i = 0; i < v.getSize (); i++) result.set (arg (v.get (i)), i);
   return result;
 }
 
 vector real (vector v) {
   vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result.set (real (v.get (i)), i);
+  result.makeReal ();
   return result;
 }
 
 vector imag (vector v) {
   vector result (v);
+  result.makeReal ();
   for (int i = 0; i < v.getSize (); i++) result.set (imag (v.get (i)), i);
   return result;
 }
@@ -372,6 +465,7 @@ vector conj (vector v) {
 
 vector dB (vector v) {
   vector result (v);
+  result.makeReal ();
   for (int i = 0; i < v.getSize (); i++)
     result.set (10.0 * std::log10 (norm (v.get (i))), i);
   return result;
@@ -448,7 +542,7 @@ vector pow (vector v1, vector v2) {
   }
   vector res (len);
   for (j = i = n = 0; n < len; n++) {
-    res (n) = pow (v1 (i), v2 (j));
+    res.set (pow (v1.get (i), v2.get (j)), n);
     if (++i >= len1) i = 0; if (++j >= len2) j = 0;
   }
   return res;
@@ -571,28 +665,28 @@ vector acoth (vector v) {
 // converts impedance to reflexion coefficient
 vector ztor (vector v, nr_complex_t zref) {
   vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result (i) = ztor (v (i), zref);
+  for (int i = 0; i < v.getSize (); i++) result.set (ztor (v.get (i), zref), i);
   return result;
 }
 
 // converts admittance to reflexion coefficient
 vector ytor (vector v, nr_complex_t zref) {
   vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result (i) = ytor (v (i), zref);
+  for (int i = 0; i < v.getSize (); i++) result.set (ytor (v.get (i), zref), i);
   return result;
 }
 
 // converts reflexion coefficient to impedance
 vector rtoz (vector v, nr_complex_t zref) {
   vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result (i) = rtoz (v (i), zref);
+  for (int i = 0; i < v.getSize (); i++) result.set (rtoz (v.get (i), zref), i);
   return result;
 }
 
 // converts reflexion coefficient to admittance
 vector rtoy (vector v, nr_complex_t zref) {
   vector result (v);
-  for (int i = 0; i < v.getSize (); i++) result (i) = rtoy (v (i), zref);
+  for (int i = 0; i < v.getSize (); i++) result.set (rtoy (v.get (i), zref), i);
   return result;
 }
 
@@ -636,29 +730,43 @@ vector diff (vector var, vector dep, int n) {
 }
 
 vector vector::operator=(const nr_complex_t c) {
+  if (imag (c) == 0.0) return *this = real (c);
+  promote ();
   for (int i = 0; i < size; i++) data[i] = c;
   return *this;
 }
 
 vector vector::operator=(const nr_double_t d) {
-  for (int i = 0; i < size; i++) data[i] = d;
+  makeReal ();
+  for (int i = 0; i < size; i++) rdata[i] = d;
   return *this;
 }
 
 vector vector::operator+=(vector v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] += v (n); if (++n >= len) n = 0; }
+  if (isReal () && v.isReal ()) {
+    for (i = n = 0; i < size; i++) {
+      rdata[i] += v.rdata[n]; if (++n >= len) n = 0; }
+    return *this;
+  }
+  promote ();
+  for (i = n = 0; i < size; i++) { data[i] += v.get (n); if (++n >= len) n = 0; }
   return *this;
 }
 
 vector vector::operator+=(const nr_complex_t c) {
+  if (imag (c) == 0.0) return *this += real (c);
+  promote ();
   for (int i = 0; i < size; i++) data[i] += c;
   return *this;
 }
 
 vector vector::operator+=(const nr_double_t d) {
-  for (int i = 0; i < size; i++) data[i] += d;
+  if (isReal ())
+    for (int i = 0; i < size; i++) rdata[i] += d;
+  else
+    for (int i = 0; i < size; i++) data[i] += d;
   return *this;
 }
 
@@ -697,24 +805,40 @@ vector operator+(const nr_double_t d, vector v) {
 
 vector vector::operator-() {
   vector result (size);
-  for (int i = 0; i < size; i++) result (i) = -data[i];
+  if (isReal ()) {
+    for (int i = 0; i < size; i++) result.rdata[i] = -rdata[i];
+    return result;
+  }
+  result.promote ();
+  for (int i = 0; i < size; i++) result.data[i] = -data[i];
   return result;
 }
 
 vector vector::operator-=(vector v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] -= v (n); if (++n >= len) n = 0; }
+  if (isReal () && v.isReal ()) {
+    for (i = n = 0; i < size; i++) {
+      rdata[i] -= v.rdata[n]; if (++n >= len) n = 0; }
+    return *this;
+  }
+  promote ();
+  for (i = n = 0; i < size; i++) { data[i] -= v.get (n); if (++n >= len) n = 0; }
   return *this;
 }
 
 vector vector::operator-=(const nr_complex_t c) {
+  if (imag (c) == 0.0) return *this -= real (c);
+  promote ();
   for (int i = 0; i < size; i++) data[i] -= c;
   return *this;
 }
 
 vector vector::operator-=(const nr_double_t d) {
-  for (int i = 0; i < size; i++) data[i] -= d;
+  if (isReal ())
+    for (int i = 0; i < size; i++) rdata[i] -= d;
+  else
+    for (int i = 0; i < size; i++) data[i] -= d;
   return *this;
 }
 
@@ -758,17 +882,28 @@ vector operator-(const nr_double_t d, vector v) {
 vector vector::operator*=(vector v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] *= v (n); if (++n >= len) n = 0; }
+  if (isReal () && v.isReal ()) {
+    for (i = n = 0; i < size; i++) {
+      rdata[i] *= v.rdata[n]; if (++n >= len) n = 0; }
+    return *this;
+  }
+  promote ();
+  for (i = n = 0; i < size; i++) { data[i] *= v.get (n); if (++n >= len) n = 0; }
   return *this;
 }
 
 vector vector::operator*=(const nr_complex_t c) {
+  if (imag (c) == 0.0) return *this *= real (c);
+  promote ();
   for (int i = 0; i < size; i++) data[i] *= c;
   return *this;
 }
 
 vector vector::operator*=(const nr_double_t d) {
-  for (int i = 0; i < size; i++) data[i] *= d;
+  if (isReal ())
+    for (int i = 0; i < size; i++) rdata[i] *= d;
+  else
+    for (int i = 0; i < size; i++) data[i] *= d;
   return *this;
 }
 
@@ -808,17 +943,28 @@ vector operator*(const nr_double_t d, vector v) {
 vector vector::operator/=(vector v) {
   int i, n, len = v.getSize ();
   assert (size % len == 0);
-  for (i = n = 0; i < size; i++) { data[i] /= v (n); if (++n >= len) n = 0; }
+  if (isReal () && v.isReal ()) {
+    for (i = n = 0; i < size; i++) {
+      rdata[i] /= v.rdata[n]; if (++n >= len) n = 0; }
+    return *this;
+  }
+  promote ();
+  for (i = n = 0; i < size; i++) { data[i] /= v.get (n); if (++n >= len) n = 0; }
   return *this;
 }
 
 vector vector::operator/=(const nr_complex_t c) {
+  if (imag (c) == 0.0) return *this /= real (c);
+  promote ();
   for (int i = 0; i < size; i++) data[i] /= c;
   return *this;
 }
 
 vector vector::operator/=(const nr_double_t d) {
-  for (int i = 0; i < size; i++) data[i] /= d;
+  if (isReal ())
+    for (int i = 0; i < size; i++) rdata[i] /= d;
+  else
+    for (int i = 0; i < size; i++) data[i] /= d;
   return *this;
 }
 
@@ -866,28 +1012,28 @@ vector operator/(const nr_double_t d, vector v) {
 vector operator%(vector v, const nr_complex_t z) {
   int len = v.getSize ();
   vector result (len);
-  for (int i = 0; i < len; i++) result (i) = v (i) % z;
+  for (int i = 0; i < len; i++) result.set (v.get (i) % z, i);
   return result;
 }
 
 vector operator%(vector v, const nr_double_t d) {
   int len = v.getSize ();
   vector result (len);
-  for (int i = 0; i < len; i++) result (i) = v (i) % d;
+  for (int i = 0; i < len; i++) result.set (v.get (i) % d, i);
   return result;
 }
 
 vector operator%(const nr_complex_t z, vector v) {
   int len = v.getSize ();
   vector result (len);
-  for (int i = 0; i < len; i++) result (i) = z % v (i);
+  for (int i = 0; i < len; i++) result.set (z % v.get (i), i);
   return result;
 }
 
 vector operator%(const nr_double_t d, vector v) {
   int len = v.getSize ();
   vector result (len);
-  for (int i = 0; i < len; i++) result (i) = d % v (i);
+  for (int i = 0; i < len; i++) result.set (d % v.get (i), i);
   return result;
 }
 
@@ -902,7 +1048,7 @@ vector operator%(vector v1, vector v2) {
   }
   vector res (len);
   for (j = i = n = 0; n < len; n++) {
-    res (n) = v1 (i) % v2 (j);
+    res.set (v1.get (i) % v2.get (j), n);
     if (++i >= len1) i = 0;  if (++j >= len2) j = 0;
   }
   return res;
@@ -910,6 +1056,15 @@ vector operator%(vector v1, vector v2) {
 
 /* This function reverses the order of the data list. */
 void vector::reverse (void) {
+  if (isReal ()) {
+    nr_double_t * buffer = (nr_double_t *)
+      malloc (sizeof (nr_double_t) * size);
+    for (int i = 0; i < size; i++) buffer[i] = rdata[size - 1 - i];
+    free (rdata);
+    rdata = buffer;
+    capacity = size;
+    return;
+  }
   nr_complex_t * buffer = (nr_complex_t *)
     malloc (sizeof (nr_complex_t) * size);
   for (int i = 0; i < size; i++) buffer[i] = data[size - 1 - i];
@@ -934,13 +1089,28 @@ char * vector::getOrigin (void) {
 int vector::contains (nr_complex_t val, nr_double_t eps) {
   int count = 0;
   for (int i = 0; i < size; i++) {
-    if (abs (data[i] - val) <= eps) count++;
+    if (abs (get (i) - val) <= eps) count++;
   }
   return count;
 }
 
 // Sorts the vector either in ascending or descending order.
 void vector::sort (bool ascending) {
+  if (isReal ()) {
+    // same order as for complex values, i.e. by magnitude
+    nr_double_t t;
+    for (int i = 0; i < size; i++) {
+      for (int n = 0; n < size - 1; n++) {
+	nr_double_t a = fabs (rdata[n]), b = fabs (rdata[n+1]);
+	if (ascending ? a > b : a < b) {
+	  t = rdata[n];
+	  rdata[n] = rdata[n+1];
+	  rdata[n+1] = t;
+	}
+      }
+    }
+    return;
+  }
   nr_complex_t t;
   for (int i = 0; i < size; i++) {
     for (int n = 0; n < size - 1; n++) {
@@ -1001,6 +1171,14 @@ vector logspace (nr_double_t start, nr_double_t stop, int points) {
 vector cumsum (vector v) {
   vector result (v);
   nr_complex_t val (0.0);
+  if (v.isReal ()) {
+    nr_double_t rval = 0.0;
+    for (int i = 0; i < v.getSize (); i++) {
+      rval += v.rdata[i];
+      result.rdata[i] = rval;
+    }
+    return result;
+  }
   for (int i = 0; i < v.getSize (); i++) {
     val += v.get (i);
     result.set (val, i);
@@ -1167,7 +1345,7 @@ vector polar (vector a, vector p) {
   }
   vector res (len);
   for (j = i = n = 0; n < len; n++) {
-    res (n) = qucs::polar (a (i), p (j));
+    res.set (qucs::polar (a.get (i), p.get (j)), n);
     if (++i >= len1) i = 0;  if (++j >= len2) j = 0;
   }
   return res;
@@ -1198,7 +1376,7 @@ vector atan2 (vector y, vector x) {
   }
   vector res (len);
   for (j = i = n = 0; n < len; n++) {
-    res (n) = atan2 (y (i), x (j));
+    res.set (atan2 (y.get (i), x.get (j)), n);
     if (++i >= len1) i = 0; if (++j >= len2) j = 0;
   }
   return res;
@@ -1219,13 +1397,14 @@ vector dbm2w (vector v) {
 }
 
 nr_double_t integrate (vector v, const nr_double_t h) {
-  nr_double_t s = real (v.get (0) ) / 2;
+  nr_double_t s = v.getReal (0) / 2;
   for (int i = 1; i < v.getSize () - 1; i++)
-    s += real (v.get (i));
-  return (s + real (v.get (v.getSize () - 1) ) / 2) * h;
+    s += v.getReal (i);
+  return (s + v.getReal (v.getSize () - 1) / 2) * h;
 }
 
 nr_complex_t integrate (vector v, const nr_complex_t h) {
+  if (v.isReal ()) return integrate (v, 1.0) * h;
   nr_complex_t s;
   s = v.get (0) / 2.0;
   for (int i = 1; i < v.getSize () - 1; i++)
@@ -1250,6 +1429,17 @@ vector runavg (vector v, const int n) {
   nr_complex_t s (0.0), y;
   int len = v.getSize () - n + 1, i;
   vector result (len);
+  if (v.isReal ()) {
+    nr_double_t rs = 0.0, ry;
+    for (i = 0; i < n; i++) rs += v.rdata[i];
+    ry = rs / n;
+    result.rdata[0] = ry;
+    for (i = 0; i < len - 1; i++) {
+      ry += (v.rdata[i + n] - v.rdata[i]) / n;
+      result.rdata[i + 1] = ry;
+    }
+    return result;
+  }
   for (i = 0; i < n; i++) s += v.get (i);
   y = s / (nr_double_t) n; // first running average value
   result.set (y, 0);
@@ -1272,11 +1462,11 @@ vector smooth(vector v, nr_double_t a) {
   // fill auxiliary vector
   for (i = 0; i < extvlen; i++) {
     if (i < t2) {
-      extv.set (v(0), i);
+      extv.set (v.get (0), i);
     } else if (i >= (len + t2)) {
-      extv.set (v(len-1), i);
+      extv.set (v.get (len-1), i);
     } else {
-      extv.set (v(i - t2), i);
+      extv.set (v.get (i - t2), i);
     }
   }
   return runavg(extv, 2*t2+1);
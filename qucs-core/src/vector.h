@@ -68,10 +68,14 @@ class vector : public object
   ~vector ();
   void add (nr_complex_t);
   void add (vector *);
+  void reserve (int);
   nr_complex_t get (int);
   void set (nr_double_t, int);
   void set (const nr_complex_t, int);
+  nr_double_t getReal (int) const;
   int getSize (void) const;
+  bool isReal (void) const { return data == NULL; }
+  void makeReal (void);
   int checkSizes (vector, vector);
   int getRequested (void) { return requested; }
   void setRequested (int n) { requested = n; }
@@ -96,6 +100,7 @@ class vector : public object
   friend vector  cumsum  (vector);
   friend vector  cumprod (vector);
   friend vector  cumavg  (vector);
+  friend vector  runavg  (vector, const int);
   friend vector  smooth  (vector, const nr_double_t);
   friend vector  groupdelay  (vector, vector);
   friend vector  dbm     (vector, const nr_complex_t);
@@ -229,16 +234,20 @@ class vector : public object
   vector operator /= (const nr_complex_t);
   vector operator /= (const nr_double_t);
 
-  // easy accessor operators
-  nr_complex_t  operator () (int i) const { return data[i]; }
-  nr_complex_t& operator () (int i) { return data[i]; }
+  // easy accessor operators, a reference requires complex storage
+  nr_complex_t  operator () (int i) const {
+    return data ? data[i] : nr_complex_t (rdata[i]); }
+  nr_complex_t& operator () (int i) { if (!data) promote (); return data[i]; }
 
  private:
+  void promote (void);
+
   int requested;
   int size;
   int capacity;
   strlist * dependencies;
-  nr_complex_t * data;
+  nr_double_t * rdata; // values as long as all of them are real ...
+  nr_complex_t * data; // ... complex values otherwise
   char * origin;
 };
 
@@ -0,0 +1,178 @@
+/*
+ * Citi.cpp - Unit test for the CITIfile reader
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdio.h>
+#include <string>
+
+#include "qucs_typedefs.h"
+#include "object.h"
+#include "complex.h"
+#include "vector.h"
+#include "strlist.h"
+#include "dataset.h"
+#include "constants.h"
+#include "check_citi.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// writes the given text into a file and reads it as CITIfile
+static qucs::dataset * load (const char * text, const char * name) {
+  std::string file = ::testing::TempDir () + name;
+  FILE * f = fopen (file.c_str (), "wb");
+  if (f == NULL) return NULL;
+  fputs (text, f);
+  fclose (f);
+  citi_init ();
+  int err = citi_read (file.c_str ());
+  remove (file.c_str ());
+  return err ? NULL : citi_result;
+}
+
+// returns the given variable of the dataset
+static qucs::vector * find (qucs::dataset * d, const char * var) {
+  qucs::vector * v = d->findVariable (var);
+  if (v == NULL) v = d->findDependency (var);
+  EXPECT_TRUE ( v != NULL ) << var;
+  return v;
+}
+
+// returns the given item of a variable of the dataset
+static nr_complex_t get (qucs::dataset * d, const char * var, int i) {
+  qucs::vector * v = find (d, var);
+  return v ? v->get (i) : nr_complex_t (0);
+}
+
+#define EXPECT_COMPLEX_NEAR(a,b) \
+  EXPECT_NEAR ( 0.0 , std::abs ((a) - (b)) , 1e-12 ) << (b)
+
+// indexed data in the various formats, CRLF line endings
+TEST (citi, formats) {
+  qucs::dataset * d = load (
+    "CITIFILE A.01.00\r\n"
+    "# comment\r\n"
+    "NAME DUT\r\n"
+    "VAR FREQ MAG 2\r\n"
+    "DATA S[1,1] RI\r\n"
+    "DATA S[2] MAGANGLE\r\n"
+    "DATA GAIN DBANGLE\r\n"
+    "COMMENT the data follows\r\n"
+    "VAR_LIST_BEGIN\r\n"
+    "1e9\r\n"
+    "2E9\r\n"
+    "VAR_LIST_END\r\n"
+    "BEGIN\r\n"
+    "0.1,-0.2\r\n"
+    " 0.3 , 0.4\r\n"
+    "END\r\n"
+    "\r\n"
+    "BEGIN\r\n"
+    "2,90\r\n"
+    "0.5\r\n"
+    "END\r\n"
+    "BEGIN\r\n"
+    "20,180\r\n"
+    "-6,0\r\n"
+    "END\r\n", "formats.cti");
+  ASSERT_TRUE ( d != NULL );
+  EXPECT_EQ ( 1 , d->countDependencies () );
+  EXPECT_EQ ( 3 , d->countVariables () );
+  EXPECT_COMPLEX_NEAR ( get (d, "FREQ", 1) , nr_complex_t (2e9) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,1]", 0) , nr_complex_t (0.1, -0.2) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,1]", 1) , nr_complex_t (0.3, 0.4) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2]", 0) , nr_complex_t (0, 2) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2]", 1) , nr_complex_t (0.5) );
+  EXPECT_COMPLEX_NEAR ( get (d, "GAIN", 0) , nr_complex_t (-10) );
+  EXPECT_COMPLEX_NEAR ( get (d, "GAIN", 1) , nr_complex_t (std::pow (10.0, -0.3)) );
+  qucs::vector * v = find (d, "S[1,1]");
+  ASSERT_TRUE ( v != NULL && v->getDependencies () != NULL );
+  EXPECT_STREQ ( "FREQ" , v->getDependencies ()->get (0) );
+  delete d;
+}
+
+// two packages with segment lists and two independent variables
+TEST (citi, packages) {
+  qucs::dataset * d = load (
+    "CITIFILE A.01.00\n"
+    "NAME A\n"
+    "VAR FREQ MAG 3\n"
+    "DATA V RI\n"
+    "SEG_LIST_BEGIN\n"
+    "SEG 1 3 3\n"
+    "SEG_LIST_END\n"
+    "BEGIN\n"
+    "1\n2\n3\n"
+    "END\n"
+    "\n"
+    "CITIFILE A.01.00\n"
+    "NAME B\n"
+    "CONSTANT T 1.5 2\n"
+    "VAR X MAG 2\n"
+    "VAR Y MAG 2\n"
+    "DATA W RI\n"
+    "VAR_LIST_BEGIN\n0\n1\nVAR_LIST_END\n"
+    "VAR_LIST_BEGIN\n10\n20\nVAR_LIST_END\n"
+    "BEGIN\n1,1\n2,2\n3,3\n4,4\nEND\n", "packages.cti");
+  ASSERT_TRUE ( d != NULL );
+  EXPECT_EQ ( 3 , d->countDependencies () );
+  EXPECT_COMPLEX_NEAR ( get (d, "A.FREQ", 0) , nr_complex_t (1) );
+  EXPECT_COMPLEX_NEAR ( get (d, "A.FREQ", 2) , nr_complex_t (3) );
+  EXPECT_COMPLEX_NEAR ( get (d, "A.V", 2) , nr_complex_t (3) );
+  EXPECT_COMPLEX_NEAR ( get (d, "B.Y", 1) , nr_complex_t (20) );
+  EXPECT_COMPLEX_NEAR ( get (d, "B.W", 3) , nr_complex_t (4, 4) );
+  qucs::vector * v = find (d, "B.W");
+  ASSERT_TRUE ( v != NULL && v->getDependencies () != NULL );
+  EXPECT_EQ ( 2 , v->getDependencies ()->length () );
+  delete d;
+}
+
+// malformed files are rejected
+TEST (citi, malformed) {
+  const char * files[] = {
+    // missing CITIFILE line
+    "VAR FREQ MAG 1\nBEGIN\n1\nEND\n",
+    // invalid format
+    "CITIFILE A.01.00\nVAR FREQ XY 1\nBEGIN\n1\nEND\n",
+    // invalid number
+    "CITIFILE A.01.00\nVAR FREQ MAG 1\nBEGIN\n1x\nEND\n",
+    // missing END
+    "CITIFILE A.01.00\nVAR FREQ MAG 1\nBEGIN\n1\n",
+    // missing ']'
+    "CITIFILE A.01.00\nVAR F MAG 1\nDATA S[1,1 RI\n"
+    "BEGIN\n1\nEND\nBEGIN\n1\nEND\n",
+    // more data blocks than variables
+    "CITIFILE A.01.00\nVAR FREQ MAG 1\nBEGIN\n1\nEND\nBEGIN\n1\nEND\n",
+    // fewer data blocks than variables
+    "CITIFILE A.01.00\nVAR FREQ MAG 1\nDATA S RI\nBEGIN\n1\nEND\n",
+    // wrong length of independent variable
+    "CITIFILE A.01.00\nVAR FREQ MAG 2\nBEGIN\n1\nEND\n",
+    // wrong length of dependent variable
+    "CITIFILE A.01.00\nVAR FREQ MAG 2\nDATA S RI\n"
+    "BEGIN\n1\n2\nEND\nBEGIN\n1\nEND\n",
+    // header line after the data
+    "CITIFILE A.01.00\nVAR FREQ MAG 1\nBEGIN\n1\nEND\nDATA S RI\n",
+    NULL
+  };
+  for (int i = 0; files[i] != NULL; i++) {
+    EXPECT_TRUE ( load (files[i], "malformed.cti") == NULL ) << files[i];
+    EXPECT_TRUE ( citi_result == NULL ) << files[i];
+  }
+}
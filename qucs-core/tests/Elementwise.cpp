@@ -0,0 +1,115 @@
+/*
+ * Elementwise.cpp - Unit test for fused element-wise vector evaluation
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "qucs_typedefs.h"
+#include "object.h"
+#include "complex.h"
+#include "vector.h"
+#include "equation.h"
+#include "elementwise.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+using namespace qucs::eqn;
+
+// creates a vector constant
+static node * vec (const qucs::vector & v) {
+  constant * c = new constant (TAG_VECTOR);
+  c->v = new qucs::vector (v);
+  return c;
+}
+
+// creates a double constant
+static node * dbl (nr_double_t d) {
+  constant * c = new constant (TAG_DOUBLE);
+  c->d = d;
+  return c;
+}
+
+// creates an application with one or two arguments
+static node * app (const char * f, node * a, node * b = NULL) {
+  application * r = new application (f, b ? 2 : 1);
+  r->args = a;
+  if (b) a->append (b);
+  return r;
+}
+
+// evaluates the given application tree, which must be fused
+static qucs::vector run (node * n) {
+  n->evalType ();
+  EXPECT_EQ ( TAG_VECTOR , n->getType () );
+  EXPECT_TRUE ( elementwise::fusable ((application *) n) );
+  qucs::vector res = *(n->evaluate ()->v);
+  delete n;
+  return res;
+}
+
+// compares the fused result against the one of the vector functions
+static void compare (qucs::vector a, qucs::vector b) {
+  ASSERT_EQ ( b.getSize () , a.getSize () );
+  for (int i = 0; i < a.getSize (); i++) {
+    nr_complex_t d = a.get (i) - b.get (i);
+    EXPECT_LE ( std::abs (d) , 1e-12 * (1 + std::abs (b.get (i))) ) << i;
+  }
+}
+
+// a real vector with more items than a block, and a complex one
+static void data (qucs::vector & x, qucs::vector & s) {
+  for (int i = 0; i < 1000; i++) {
+    x.add (0.01 * i - 3.005);
+    s.add (nr_complex_t (0.5 - 0.001 * i, 0.002 * i));
+  }
+}
+
+// dB(S) - 20 * log10(abs(x)) with complex and real leaves
+TEST (elementwise, complex_chain) {
+  qucs::vector x, s;
+  data (x, s);
+  qucs::vector r = run (app ("-", app ("dB", vec (s)),
+			     app ("*", dbl (20),
+				  app ("log10", app ("abs", vec (x))))));
+  compare (r, qucs::dB (s) - 20 * qucs::log10 (qucs::abs (x)));
+}
+
+// real leaves only, sqrt() gets complex for negative items
+TEST (elementwise, real_chain) {
+  qucs::vector x, s;
+  data (x, s);
+  qucs::vector r = run (app ("+", app ("sqrt", vec (x)),
+			     app ("/", app ("abs", vec (x)), dbl (4))));
+  qucs::vector e = qucs::sqrt (x) + qucs::abs (x) / 4;
+  compare (r, e);
+  EXPECT_FALSE ( r.isReal () );
+
+  r = run (app ("-", app ("abs", vec (x)), app ("*", dbl (2), vec (x))));
+  compare (r, qucs::abs (x) - 2 * x);
+  EXPECT_TRUE ( r.isReal () );
+}
+
+// shorter vector arguments repeat
+TEST (elementwise, repeat) {
+  qucs::vector x, s, y;
+  data (x, s);
+  for (int i = 0; i < 10; i++) y.add (i + 1);
+  qucs::vector r = run (app ("+", app ("abs", vec (s)), vec (y)));
+  compare (r, qucs::abs (s) + y);
+}
@@ -0,0 +1,274 @@
+/*
+ * EqnSys.cpp - Unit test for equation system solver
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "qucs_typedefs.h"
+#include "eqnsys.h"
+#include "exception.h"
+#include "exceptionstack.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// MNA matrix of a resistor ladder with capacitors to ground, driven by
+// a voltage source at its first node
+static void ladder (qucs::tmatrix<nr_double_t> & A,
+		    qucs::tvector<nr_double_t> & B, int n) {
+  nr_double_t g = 1e-3, gc = 1e-2;
+  for (int i = 0; i < n; i++) {
+    A (i, i) += gc;
+    if (i + 1 < n) {
+      A (i, i) += g; A (i + 1, i + 1) += g;
+      A (i, i + 1) -= g; A (i + 1, i) -= g;
+    }
+    B (i) = 1e-6 * (i % 3);
+  }
+  A (0, n) = A (n, 0) = 1;
+  B (n) = 5;
+}
+
+// compressed rows of the given matrix
+static void compress (qucs::tmatrix<nr_double_t> & A, std::vector<int> & row,
+		      std::vector<int> & col, std::vector<nr_double_t> & val) {
+  row.assign (1, 0);
+  col.clear ();
+  val.clear ();
+  for (int r = 0; r < A.getRows (); r++) {
+    for (int c = 0; c < A.getCols (); c++) {
+      if (A (r, c) != 0.0 || r == c) {
+	col.push_back (c);
+	val.push_back (A (r, c));
+      }
+    }
+    row.push_back (col.size ());
+  }
+}
+
+// BiCGStab delivers the same solution as the LU decomposition
+TEST (eqnsys, bicgstab) {
+  const int n = 40;
+  qucs::tmatrix<nr_double_t> A (n + 1), L (n + 1);
+  qucs::tvector<nr_double_t> B (n + 1), X (n + 1), Y (n + 1);
+  ladder (A, B, n);
+  L = A;
+
+  qucs::eqnsys<nr_double_t> lu, it;
+  lu.setAlgo (ALGO_LU_DECOMPOSITION);
+  lu.passEquationSys (&L, &Y, &B);
+  lu.solve ();
+  it.setAlgo (ALGO_BICGSTAB);
+  it.passEquationSys (&A, &X, &B);
+  it.solve ();
+  for (int i = 0; i <= n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+  EXPECT_NEAR (5.0, X (0), 1e-9);
+
+  // new right hand side with the same matrix
+  for (int i = 0; i < n; i++) B (i) = 1e-6;
+  lu.passEquationSys (NULL, &Y, &B);
+  lu.solve ();
+  it.passEquationSys (NULL, &X, &B);
+  it.solve ();
+  for (int i = 0; i <= n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+}
+
+// solving after a few changed stamps updates the earlier decomposition
+TEST (eqnsys, lowrank) {
+  const int n = 40;
+  qucs::tmatrix<nr_double_t> A (n + 1), L (n + 1), M (n + 1);
+  qucs::tvector<nr_double_t> B (n + 1), X (n + 1), Y (n + 1);
+  ladder (A, B, n);
+
+  qucs::eqnsys<nr_double_t> lu, lr;
+  lu.setAlgo (ALGO_LU_DECOMPOSITION);
+  lr.setAlgo (ALGO_LU_DECOMPOSITION);
+  lr.setLowRank (1);
+  for (int k = 0; k < 4; k++) {
+    // change the resistor between nodes 10 and 11, finally all of them
+    nr_double_t g = 1e-3 * k;
+    if (k == 3) for (int i = 0; i < n; i++) A (i, i) += 1e-4;
+    M = A;
+    M (10, 10) += g; M (11, 11) += g;
+    M (10, 11) -= g; M (11, 10) -= g;
+    L = M;
+    lu.passEquationSys (&L, &Y, &B);
+    lu.solve ();
+    lr.passEquationSys (&M, &X, &B);
+    lr.solve ();
+    for (int i = 0; i <= n; i++)
+      EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+
+    // new right hand side with the same matrix
+    B (5) += 1e-6;
+    lu.passEquationSys (NULL, &Y, &B);
+    lu.solve ();
+    lr.passEquationSys (NULL, &X, &B);
+    lr.solve ();
+    for (int i = 0; i <= n; i++)
+      EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+  }
+}
+
+// iterative solvers reuse the arranged matrix for a new right hand side
+TEST (eqnsys, iterative_reuse) {
+  const int n = 20;
+  int algos[] = { ALGO_GAUSS_SEIDEL, ALGO_SOR, ALGO_JACOBI };
+  for (int a = 0; a < 3; a++) {
+    qucs::tmatrix<nr_double_t> A (n), L (n);
+    qucs::tvector<nr_double_t> B (n), X (n), Y (n);
+    for (int i = 0; i < n; i++) {
+      A (i, i) = 4 + i;
+      if (i > 0) A (i, i - 1) = -1;
+      if (i < n - 1) A (i, i + 1) = -1;
+      B (i) = i % 5;
+    }
+    // rows which need to be exchanged for a non-zero diagonal
+    A.exchangeRows (3, 7);
+    B.exchangeRows (3, 7);
+    L = A;
+
+    qucs::eqnsys<nr_double_t> lu, it;
+    lu.setAlgo (ALGO_LU_DECOMPOSITION);
+    lu.passEquationSys (&L, &Y, &B);
+    lu.solve ();
+    it.setAlgo (algos[a]);
+    it.passEquationSys (&A, &X, &B);
+    it.solve ();
+    for (int i = 0; i < n; i++)
+      EXPECT_NEAR (Y (i), X (i), 1e-3 * (1 + fabs (Y (i))));
+
+    for (int k = 0; k < 2; k++) {
+      B (3) += 1; B (12) -= 2;
+      lu.passEquationSys (NULL, &Y, &B);
+      lu.solve ();
+      it.passEquationSys (NULL, &X, &B);
+      it.solve ();
+      for (int i = 0; i < n; i++)
+	EXPECT_NEAR (Y (i), X (i), 1e-3 * (1 + fabs (Y (i))));
+    }
+  }
+}
+
+// BiCGStab on compressed rows without a dense matrix
+TEST (eqnsys, bicgstab_sparse) {
+  const int n = 40;
+  qucs::tmatrix<nr_double_t> A (n + 1);
+  qucs::tvector<nr_double_t> B (n + 1), X (n + 1), Y (n + 1);
+  std::vector<int> row, col;
+  std::vector<nr_double_t> val;
+  ladder (A, B, n);
+  compress (A, row, col, val);
+
+  qucs::eqnsys<nr_double_t> lu, it;
+  lu.setAlgo (ALGO_LU_DECOMPOSITION);
+  lu.passEquationSys (&A, &Y, &B);
+  lu.solve ();
+  it.setAlgo (ALGO_BICGSTAB);
+  it.passSparseSys (&row, &col, &val, &X, &B);
+  it.solve ();
+  for (int i = 0; i <= n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+
+  // new right hand side with the same matrix
+  B (7) += 1e-6;
+  lu.passEquationSys (NULL, &Y, &B);
+  lu.solve ();
+  it.passSparseSys (NULL, NULL, NULL, &X, &B);
+  it.solve ();
+  for (int i = 0; i <= n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+}
+
+// CG solves a resistor grid with grounded capacitors and current
+// sources, it falls back to LU with a voltage source
+TEST (eqnsys, cg) {
+  const int k = 8, n = k * k;
+  qucs::tmatrix<nr_double_t> A (n), L (n);
+  qucs::tvector<nr_double_t> B (n), X (n), Y (n);
+  std::vector<int> row, col;
+  std::vector<nr_double_t> val;
+  for (int i = 0; i < n; i++) {
+    int j = i + 1, d = i + k;
+    nr_double_t g = 1e-3 * (1 + i % 5);
+    A (i, i) += 1e-5;
+    if (j % k) {
+      A (i, i) += g; A (j, j) += g; A (i, j) -= g; A (j, i) -= g;
+    }
+    if (d < n) {
+      A (i, i) += g; A (d, d) += g; A (i, d) -= g; A (d, i) -= g;
+    }
+    B (i) = 1e-6 * (i % 3);
+  }
+  compress (A, row, col, val);
+  L = A;
+
+  qucs::eqnsys<nr_double_t> lu, cg, cs;
+  lu.setAlgo (ALGO_LU_DECOMPOSITION);
+  lu.passEquationSys (&L, &Y, &B);
+  lu.solve ();
+  cg.setAlgo (ALGO_CG);
+  cg.passEquationSys (&A, &X, &B);
+  cg.solve ();
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+  X = qucs::tvector<nr_double_t> (n);
+  cs.setAlgo (ALGO_CG);
+  cs.passSparseSys (&row, &col, &val, &X, &B);
+  cs.solve ();
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR (Y (i), X (i), 1e-9 * (1 + fabs (Y (i))));
+
+  // the matrix of a circuit with voltage source is indefinite
+  const int m = 40;
+  qucs::tmatrix<nr_double_t> V (m + 1);
+  qucs::tvector<nr_double_t> C (m + 1), Z (m + 1);
+  X = qucs::tvector<nr_double_t> (m + 1);
+  ladder (V, C, m);
+  compress (V, row, col, val);
+  lu.passEquationSys (&V, &Z, &C);
+  lu.solve ();
+  cs.passSparseSys (&row, &col, &val, &X, &C);
+  cs.solve ();
+  for (int i = 0; i <= m; i++)
+    EXPECT_NEAR (Z (i), X (i), 1e-9 * (1 + fabs (Z (i))));
+}
+
+// large systems do not fall back to LU, the failure is thrown instead
+TEST (eqnsys, no_convergence) {
+  const int n = 2100;
+  qucs::tmatrix<nr_double_t> A (n + 1);
+  qucs::tvector<nr_double_t> B (n + 1), X (n + 1);
+  std::vector<int> row, col;
+  std::vector<nr_double_t> val;
+  ladder (A, B, n);
+  compress (A, row, col, val);
+  for (int i = 0; i <= n; i++) X (i) = -1;
+
+  // the matrix of a circuit with voltage source is indefinite
+  qucs::eqnsys<nr_double_t> cg;
+  cg.setAlgo (ALGO_CG);
+  cg.passSparseSys (&row, &col, &val, &X, &B);
+  cg.solve ();
+  ASSERT_TRUE ( qucs::estack.top () != NULL );
+  EXPECT_EQ ( qucs::EXCEPTION_NO_CONVERGENCE , qucs::estack.top ()->getCode () );
+  qucs::estack.pop ();
+  for (int i = 0; i <= n; i++) EXPECT_EQ ( -1 , X (i) );
+}
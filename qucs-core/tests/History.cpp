@@ -0,0 +1,83 @@
+/*
+ * History.cpp - Unit test for history class
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "qucs_typedefs.h"
+#include "history.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// the time values are shared, the values belong to the youngest time
+TEST (history, apply) {
+  qucs::history t, h;
+  t.push_back (0.0);
+  t.self ();
+  h.apply (t);
+  h.push_back (5.0);
+  for (int i = 1; i < 1000; i++) {
+    t.push_back (i * 1e-3);
+    h.push_back (5.0 + i);
+  }
+  EXPECT_EQ (1000u, h.size ());
+  EXPECT_DOUBLE_EQ (0.999, h.last ());
+  EXPECT_DOUBLE_EQ (0.5, h.getTfromidx (500));
+  EXPECT_DOUBLE_EQ (505.0, h.getValfromidx (500));
+  EXPECT_DOUBLE_EQ (305.0, h.nearest (0.3003, false));
+  EXPECT_NEAR (305.3, h.nearest (0.3003), 1e-9);
+  EXPECT_NEAR (105.5, h.nearest (0.1005), 1e-9);
+}
+
+// values older than the age are dropped, two of them are kept
+TEST (history, drop) {
+  qucs::history t, h;
+  t.push_back (0.0);
+  t.self ();
+  h.setAge (0.0105);
+  h.apply (t);
+  h.push_back (0.0);
+  for (int i = 1; i < 100000; i++) {
+    t.push_back (i * 1e-3);
+    h.push_back (i);
+  }
+  EXPECT_NEAR (0.012, h.duration (), 1e-9);
+  EXPECT_DOUBLE_EQ (99987.0, h.nearest (0.0, false));
+  EXPECT_DOUBLE_EQ (99999.0, h.nearest (1e3, false));
+}
+
+// truncation removes the time values and values newer than the time
+TEST (history, truncate) {
+  qucs::history t, h;
+  t.push_back (0.0);
+  t.self ();
+  h.apply (t);
+  h.push_back (0.0);
+  for (int i = 1; i < 10; i++) {
+    t.push_back (i);
+    h.push_back (10 * i);
+  }
+  h.truncate (4.5);
+  EXPECT_EQ (5u, t.size ());
+  EXPECT_DOUBLE_EQ (4.0, t.last ());
+  t.push_back (5.5);
+  h.push_back (55.0);
+  EXPECT_DOUBLE_EQ (55.0, h.nearest (5.4, false));
+  EXPECT_DOUBLE_EQ (40.0, h.nearest (4.6, false));
+}
@@ -32,3 +32,30 @@ TEST (matrix, getCols) {
     EXPECT_EQ ( 3 , data.getCols() );
 }
 
+
+TEST (matrix, moveAndInvert) {
+    for (int n = 2; n <= 6; n += 2) {
+      // 2- and 4-port matrices are kept within the object
+      qucs::matrix a (n);
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          a (r, c) = nr_complex_t (r == c ? n + 1 : 1, r - c);
+      qucs::matrix b (a);
+      qucs::matrix i = qucs::inverse (std::move (b));
+      EXPECT_EQ ( 0 , b.getRows() );
+
+      qucs::matrix p;
+      qucs::multiply (a, i, p);
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          EXPECT_NEAR ( r == c ? 1.0 : 0.0 , abs (p (r, c) ), 1e-12 );
+
+      qucs::invert (a);
+      a -= i;
+      a *= 2.0;
+      qucs::matrix m = std::move (a);
+      for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+          EXPECT_EQ ( 0.0 , abs (m (r, c)) );
+    }
+}
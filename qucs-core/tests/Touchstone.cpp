@@ -0,0 +1,190 @@
+/*
+ * Touchstone.cpp - Unit test for the Touchstone file reader
+ *
+ * Copyright (C) 2026 Qucs Team
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this package; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street - Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include <stdio.h>
+#include <string>
+
+#include "qucs_typedefs.h"
+#include "object.h"
+#include "complex.h"
+#include "vector.h"
+#include "matrix.h"
+#include "dataset.h"
+#include "check_touchstone.h"
+
+#include "gtest/gtest.h"  // Google Test
+
+// writes the given text into a file and reads it as Touchstone file
+static qucs::dataset * load (const char * text, const char * name) {
+  std::string file = ::testing::TempDir () + name;
+  FILE * f = fopen (file.c_str (), "wb");
+  if (f == NULL) return NULL;
+  fputs (text, f);
+  fclose (f);
+  touchstone_init ();
+  int err = touchstone_read (file.c_str ());
+  remove (file.c_str ());
+  return err ? NULL : touchstone_result;
+}
+
+// returns the given item of a variable of the dataset
+static nr_complex_t get (qucs::dataset * d, const char * var, int i) {
+  qucs::vector * v = d->findVariable (var);
+  if (v == NULL) v = d->findDependency (var);
+  EXPECT_TRUE ( v != NULL ) << var;
+  return v ? v->get (i) : nr_complex_t (0);
+}
+
+#define EXPECT_COMPLEX_NEAR(a,b) \
+  EXPECT_NEAR ( 0.0 , std::abs ((a) - (b)) , 1e-12 ) << (b)
+
+// 2-port with noise data, '21' precedes '12'
+TEST (touchstone, v1_noise) {
+  qucs::dataset * d = load (
+    "! comment\n"
+    "# MHz S RI R 50\n"
+    "100 0.1 0.2  0.3 0.4  0.5 0.6  0.7 0.8\n"
+    "200 1.1 1.2  1.3 1.4  1.5 1.6  1.7 1.8 ! comment\n"
+    "\n"
+    "100 1.0 0.5 90 0.2\n"
+    "200 2.0 0.4 -90 0.3\n", "v1noise.s2p");
+  ASSERT_TRUE ( d != NULL );
+  EXPECT_COMPLEX_NEAR ( get (d, "frequency", 1) , nr_complex_t (200e6) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,1]", 0) , nr_complex_t (0.1, 0.2) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2,1]", 0) , nr_complex_t (0.3, 0.4) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,2]", 1) , nr_complex_t (1.5, 1.6) );
+  EXPECT_COMPLEX_NEAR ( get (d, "nfreq", 1) , nr_complex_t (200e6) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Fmin", 0) , std::pow (10.0, 0.1) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Sopt", 1) , nr_complex_t (0, -0.4) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Rn", 1) , nr_complex_t (15) );
+  delete d;
+}
+
+// 3-port records continue on the following lines, CRLF line endings
+TEST (touchstone, v1_multiline) {
+  qucs::dataset * d = load (
+    "# GHz S MA R 50\r\n"
+    "1 0.1 0  0.2 0  0.3 0\r\n"
+    "  0.4 0  0.5 0  0.6 0\r\n"
+    "  0.7 0  0.8 0  0.9 0\r\n"
+    "2 0.1 90 0.2 90 0.3 90\r\n"
+    "  0.4 90 0.5 90 0.6 90\r\n"
+    "  0.7 90 0.8 90 0.9 90\r\n", "v1multi.s3p");
+  ASSERT_TRUE ( d != NULL );
+  EXPECT_EQ ( 2 , d->getDependencies ()->getSize () );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2,3]", 0) , nr_complex_t (0.6) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[3,1]", 1) , nr_complex_t (0, 0.7) );
+  EXPECT_COMPLEX_NEAR ( get (d, "frequency", 1) , nr_complex_t (2e9) );
+  delete d;
+}
+
+// Touchstone 2.0 with reference impedance and lower matrix
+TEST (touchstone, v2_lower) {
+  qucs::dataset * d = load (
+    "[Version] 2.0\n"
+    "# Hz S RI R 50\n"
+    "[Number of Ports] 2\n"
+    "[Number of Frequencies] 1\n"
+    "[Reference] 25\n"
+    "  25\n"
+    "[Matrix Format] Lower\n"
+    "[Network Data]\n"
+    "1e6 0 0\n"
+    "    0.5 0  0 0\n"
+    "[End]\n", "v2lower.s2p");
+  ASSERT_TRUE ( d != NULL );
+  // S = [0 0.5; 0.5 0] at 25 Ohms re-normalized to 50 Ohms
+  qucs::matrix s (2);
+  s.set (1, 0, 0.5); s.set (0, 1, 0.5);
+  s = qucs::stos (s, qucs::vector (2, 25), qucs::vector (2, 50));
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,1]", 0) , s.get (0, 0) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[1,2]", 0) , s.get (0, 1) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2,1]", 0) , s.get (1, 0) );
+  EXPECT_COMPLEX_NEAR ( get (d, "S[2,2]", 0) , s.get (1, 1) );
+  delete d;
+}
+
+// Touchstone 2.0 with upper matrix and noise data
+TEST (touchstone, v2_upper_noise) {
+  qucs::dataset * d = load (
+    "[Version] 2.0\n"
+    "# GHz Y RI\n"
+    "[Number of Ports] 2\n"
+    "[Two-Port Data Order] 12_21\n"
+    "[Number of Frequencies] 2\n"
+    "[Number of Noise Frequencies] 1\n"
+    "[Matrix Format] Upper\n"
+    "[Begin Information]\n"
+    "[End Information]\n"
+    "[Network Data]\n"
+    "1 1 2 3 4 5 6\n"
+    "2 7 8 9 10 11 12\n"
+    "[Noise Data]\n"
+    "1 3 0.5 0 0.4\n"
+    "[End]\n", "v2upper.s2p");
+  ASSERT_TRUE ( d != NULL );
+  // Y-parameters are not normalized in Touchstone 2.0 files
+  EXPECT_COMPLEX_NEAR ( get (d, "Y[1,2]", 0) , nr_complex_t (3, 4) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Y[2,1]", 0) , nr_complex_t (3, 4) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Y[2,2]", 1) , nr_complex_t (11, 12) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Sopt", 0) , nr_complex_t (0.5) );
+  EXPECT_COMPLEX_NEAR ( get (d, "Rn", 0) , nr_complex_t (20) );
+  delete d;
+}
+
+// malformed files are rejected
+TEST (touchstone, malformed) {
+  const char * files[] = {
+    // no option line
+    "1 0.1 0\n",
+    // invalid option
+    "# GHz S XY R 50\n1 0.1 0\n",
+    // invalid number
+    "# GHz S MA R 50\n1 0.1 0x\n",
+    // inconsistent record lengths
+    "# GHz S MA R 50\n1 0.1 0 0.2 0 0.3 0 0.4 0\n2 0.1 0 0.2\n",
+    "# GHz S MA R 50\n1 0.1 0\n2 0.1 0 0.3\n",
+    // incomplete record
+    "[Version] 2.0\n# GHz S MA\n[Number of Ports] 2\n[Network Data]\n"
+    "1 0.1 0 0.2 0\n  0.3 0\n[End]\n",
+    // too many values
+    "[Version] 2.0\n# GHz S MA\n[Number of Ports] 1\n[Network Data]\n"
+    "1 0.1 0 0.3\n[End]\n",
+    // decreasing frequency of a 1-port
+    "# GHz S MA R 50\n2 0.1 0\n1 0.1 0\n",
+    // unknown keyword
+    "[Version] 2.0\n# GHz S MA\n[Number of Ports] 1\n[Foo] 1\n"
+    "[Network Data]\n1 0.1 0\n[End]\n",
+    // wrong number of frequencies
+    "[Version] 2.0\n# GHz S MA\n[Number of Ports] 1\n"
+    "[Number of Frequencies] 2\n[Network Data]\n1 0.1 0\n[End]\n",
+    // missing ']'
+    "[Version 2.0\n# GHz S MA\n",
+    // empty file
+    "! nothing\n",
+    NULL
+  };
+  for (int i = 0; files[i] != NULL; i++) {
+    EXPECT_TRUE ( load (files[i], "malformed.snp") == NULL ) << files[i];
+    EXPECT_TRUE ( touchstone_result == NULL ) << files[i];
+  }
+}
@@ -33,3 +33,47 @@ TEST (vector, sum) {
     vec.set(1, k);
   EXPECT_EQ ( 3.0 , qucs::sum(vec) );
 }
+
+TEST (vector, real_storage) {
+  qucs::vector vec;
+  for (int k = 0; k < 100; k++)
+    vec.add (k);
+  EXPECT_TRUE ( vec.isReal () );
+  qucs::vector res = vec + vec;
+  EXPECT_TRUE ( res.isReal () );
+  EXPECT_EQ ( 198.0 , res.getReal (99) );
+  EXPECT_EQ ( 4950.0 , real (qucs::sum (vec)) );
+  EXPECT_TRUE ( qucs::runavg (vec, 10).isReal () );
+
+  // promotion on the first complex value
+  vec.set (nr_complex_t (1, 2), 50);
+  EXPECT_FALSE ( vec.isReal () );
+  EXPECT_EQ ( nr_complex_t (1, 2) , vec.get (50) );
+  EXPECT_EQ ( nr_complex_t (99, 0) , vec.get (99) );
+  EXPECT_TRUE ( qucs::abs (vec).isReal () );
+  EXPECT_FALSE ( (res * nr_complex_t (0, 1)).isReal () );
+}
+
+// real and complex storage sort by magnitude
+TEST (vector, sort) {
+  qucs::vector vec, cvec;
+  nr_double_t v[] = { 3, -5, 1, -2 };
+  for (int k = 0; k < 4; k++) {
+    vec.add (v[k]);
+    cvec.add (v[k]);
+  }
+  cvec.add (nr_complex_t (0, 4));
+  vec.add (4);
+  EXPECT_TRUE ( vec.isReal () );
+  EXPECT_FALSE ( cvec.isReal () );
+  vec.sort ();
+  cvec.sort ();
+  nr_double_t s[] = { 1, -2, 3, 4, -5 };
+  for (int k = 0; k < 5; k++) {
+    EXPECT_EQ ( s[k] , vec.getReal (k) );
+    EXPECT_EQ ( std::abs (vec.get (k)) , std::abs (cvec.get (k)) );
+  }
+  vec.sort (false);
+  EXPECT_EQ ( -5.0 , vec.getReal (0) );
+  EXPECT_EQ ( 1.0 , vec.getReal (4) );
+}
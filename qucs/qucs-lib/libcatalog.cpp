@@ -0,0 +1,309 @@
+/***************************************************************************
+                              libcatalog.cpp
+                             ----------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <algorithm>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QHash>
+#include <QRegExp>
+
+#include "qucslib.h"
+#include "qucslib_common.h"
+#include "libcatalog.h"
+
+// identification of the catalog file, increase the version if the
+// format changes
+#define LIBCATALOG_MAGIC    0x51434c43
+#define LIBCATALOG_VERSION  1
+
+
+LibCatalog::LibCatalog()
+{
+  FileName = QucsSettings.QucsHomeDir.absoluteFilePath("qucslib.cat");
+  if(!load())
+    Libs.clear();
+}
+
+LibCatalog::~LibCatalog()
+{
+}
+
+// -----------------------------------------------------------
+// Returns true if the library file has not changed since it was scanned.
+static bool isCurrent(const LibCatalogLib& Lib)
+{
+  if(Lib.Result == QUCS_COMP_LIB_IO_ERROR)
+    return false;
+  QFileInfo Info(getLibAbsPath(Lib.Path));
+  return Info.exists() && Info.size() == Lib.Size
+      && Info.lastModified() == Lib.Modified;
+}
+
+// -----------------------------------------------------------
+// Sets the libraries of the catalog to the given paths (in this order).
+// Only new or changed library files are scanned. The catalog file is
+// written if anything has changed.
+void LibCatalog::update(const QStringList& Paths)
+{
+  QHash<QString, int> Known;
+  for(int i = 0; i < Libs.size(); i++)
+    Known.insert(Libs.at(i).Path, i);
+
+  bool Changed = (Paths.size() != Libs.size());
+  QList<LibCatalogLib> New;
+  foreach(const QString& Path, Paths) {
+    QHash<QString, int>::const_iterator it = Known.constFind(Path);
+    if(it == Known.constEnd()) {
+      LibCatalogLib Lib;
+      Lib.Path = Path;
+      scan(Lib);
+      New.append(Lib);
+      Changed = true;
+      continue;
+    }
+    New.append(Libs.at(it.value()));
+    if(it.value() != New.size()-1)
+      Changed = true;
+    if(!isCurrent(New.last())) {
+      scan(New.last());
+      Changed = true;
+    }
+  }
+
+  Libs = New;
+  buildIndex();
+  if(Changed)
+    save();
+}
+
+// -----------------------------------------------------------
+// Scans the library with index "l" again if its file has changed.
+// Returns true in this case.
+bool LibCatalog::updateLib(int l)
+{
+  if(l < 0 || l >= Libs.size() || isCurrent(Libs.at(l)))
+    return false;
+  scan(Libs[l]);
+  buildIndex();
+  save();
+  return true;
+}
+
+// -----------------------------------------------------------
+// Returns library and component index of all components whose name
+// contains the given text (case insensitive).
+QList< QPair<int, int> > LibCatalog::search(const QString& Text) const
+{
+  QList< QPair<int, int> > Found;
+  QByteArray Pattern = Text.toLower().toUtf8();
+  if(Pattern.isEmpty() || Pattern.contains('\n'))
+    return Found;
+
+  int Pos = 0;
+  while((Pos = Names.indexOf(Pattern, Pos)) >= 0) {
+    int k = std::upper_bound(NameStart.begin(), NameStart.end(), Pos)
+          - NameStart.begin() - 1;
+    Found.append(NameComp.at(k));
+    // continue with the next name
+    Pos = (k+1 < NameStart.size()) ? NameStart.at(k+1) : Names.size();
+  }
+  return Found;
+}
+
+// -----------------------------------------------------------
+// Reads the definition of a component from its library file. Returns
+// an empty string if the file has changed since it was scanned.
+QString LibCatalog::definition(int l, int c) const
+{
+  if(l < 0 || l >= Libs.size() || c < 0 || c >= Libs.at(l).Comps.size())
+    return QString();
+  const LibCatalogComp& Comp = comp(l, c);
+
+  QFile File(getLibAbsPath(Libs.at(l).Path));
+  if(!File.open(QIODevice::ReadOnly))
+    return QString();
+  if(!File.seek(Comp.Offset))
+    return QString();
+  QString Def = QString::fromLocal8Bit(File.read(Comp.Length));
+  File.close();
+
+  if(!Def.startsWith("<Component " + Comp.Name + ">"))
+    return QString();
+  Def.replace("\r\n", "\n");
+  return Def;
+}
+
+// -----------------------------------------------------------
+// Collects the components of a library file (same checks as
+// "parseComponentLibrary()", but on the raw bytes in order to get the
+// file positions).
+void LibCatalog::scan(LibCatalogLib& Lib) const
+{
+  Lib.Name.clear();
+  Lib.Comps.clear();
+
+  QFileInfo Info(getLibAbsPath(Lib.Path));
+  Lib.Modified = Info.lastModified();
+  Lib.Size = Info.size();
+
+  QFile File(Info.absoluteFilePath());
+  if(!File.open(QIODevice::ReadOnly)) {
+    Lib.Result = QUCS_COMP_LIB_IO_ERROR;
+    return;
+  }
+  QByteArray Data = File.readAll();
+  File.close();
+
+  // header statement <Qucs Library 0.0.18 "libname">
+  Lib.Result = QUCS_COMP_LIB_CORRUPT;
+  int Start = Data.indexOf("<Qucs Library ");
+  if(Start < 0)  return;
+  int End = Data.indexOf('>', Start);
+  if(End < 0)  return;
+  Lib.Name = QString::fromLocal8Bit(Data.mid(Start, End-Start)).section('"', 1, 1);
+
+  Start = Data.indexOf("\n<", End);
+  if(Start < 0) {
+    Lib.Result = QUCS_COMP_LIB_EMPTY;
+    return;
+  }
+  if(Data.mid(Start+2, 14) == "DefaultSymbol>") {
+    End = Data.indexOf("\n</DefaultSymbol>");
+    if(End < 0)  return;
+    Start = End + 3;
+  }
+  Lib.Result = QUCS_COMP_LIB_OK;
+
+  int NameStart, NameEnd, DescrStart, DescrEnd;
+  while((Start=Data.indexOf("\n<Component ", Start)) > 0) {
+    Start++;
+    NameStart = Start + 11;
+    NameEnd = Data.indexOf('>', NameStart);
+    if(NameEnd < 0)  continue;
+
+    End = Data.indexOf("\n</Component>", NameEnd);
+    if(End < 0)  continue;
+    End += 13;
+
+    LibCatalogComp Comp;
+    Comp.Name = QString::fromLocal8Bit(Data.mid(NameStart, NameEnd-NameStart));
+    Comp.Offset = Start;
+    Comp.Length = End - Start;
+
+    // first non-empty line of the description
+    DescrStart = Data.indexOf("<Description>", NameEnd);
+    if(DescrStart > 0 && DescrStart < End) {
+      DescrStart += 13;
+      DescrEnd = Data.indexOf("</Description>", DescrStart);
+      if(DescrEnd > 0 && DescrEnd < End) {
+        QStringList Lines = QString::fromLocal8Bit(
+            Data.mid(DescrStart, DescrEnd-DescrStart)).split('\n');
+        foreach(const QString& s, Lines)
+          if(!s.trimmed().isEmpty()) {
+            Comp.Descr = s.trimmed();
+            break;
+          }
+      }
+    }
+
+    Lib.Comps.append(Comp);
+    Start = End;
+  }
+}
+
+// -----------------------------------------------------------
+// Creates the text searched by "search()".
+void LibCatalog::buildIndex()
+{
+  Names.clear();
+  NameStart.clear();
+  NameComp.clear();
+  for(int l = 0; l < Libs.size(); l++) {
+    const QVector<LibCatalogComp>& Comps = Libs.at(l).Comps;
+    for(int c = 0; c < Comps.size(); c++) {
+      NameStart.append(Names.size());
+      NameComp.append(qMakePair(l, c));
+      Names += Comps.at(c).Name.toLower().toUtf8();
+      Names += '\n';
+    }
+  }
+}
+
+// -----------------------------------------------------------
+bool LibCatalog::load()
+{
+  QFile File(FileName);
+  if(!File.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream Stream(&File);
+  Stream.setVersion(QDataStream::Qt_4_6);
+  quint32 Magic, Version;
+  Stream >> Magic >> Version;
+  if(Magic != LIBCATALOG_MAGIC || Version != LIBCATALOG_VERSION)
+    return false;
+
+  qint32 nLibs, nComps, Result;
+  Stream >> nLibs;
+  for(int l = 0; l < nLibs && Stream.status() == QDataStream::Ok; l++) {
+    LibCatalogLib Lib;
+    Stream >> Lib.Path >> Lib.Name >> Lib.Modified >> Lib.Size
+           >> Result >> nComps;
+    Lib.Result = Result;
+    for(int c = 0; c < nComps && Stream.status() == QDataStream::Ok; c++) {
+      LibCatalogComp Comp;
+      Stream >> Comp.Name >> Comp.Descr >> Comp.Offset >> Comp.Length;
+      Lib.Comps.append(Comp);
+    }
+    Libs.append(Lib);
+  }
+  return Stream.status() == QDataStream::Ok;
+}
+
+// -----------------------------------------------------------
+// Writes the catalog into a temporary file that replaces the old one
+// afterwards, so an interrupted write never leaves a broken catalog.
+bool LibCatalog::save() const
+{
+  QFile File(FileName + ".tmp");
+  if(!File.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QDataStream Stream(&File);
+  Stream.setVersion(QDataStream::Qt_4_6);
+  Stream << quint32(LIBCATALOG_MAGIC) << quint32(LIBCATALOG_VERSION);
+  Stream << qint32(Libs.size());
+  foreach(const LibCatalogLib& Lib, Libs) {
+    Stream << Lib.Path << Lib.Name << Lib.Modified << Lib.Size
+           << qint32(Lib.Result) << qint32(Lib.Comps.size());
+    foreach(const LibCatalogComp& Comp, Lib.Comps)
+      Stream << Comp.Name << Comp.Descr << Comp.Offset << Comp.Length;
+  }
+  File.close();
+  if(Stream.status() != QDataStream::Ok) {
+    File.remove();
+    return false;
+  }
+
+  QFile::remove(FileName);
+  return File.rename(FileName);
+}
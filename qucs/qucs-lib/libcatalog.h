@@ -0,0 +1,88 @@
+/***************************************************************************
+                               libcatalog.h
+                              --------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef LIBCATALOG_H
+#define LIBCATALOG_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+#include <QPair>
+
+
+// One component of a library file.
+struct LibCatalogComp
+{
+  QString Name;    // component name
+  QString Descr;   // first line of the description
+  qint64  Offset;  // byte position of "<Component " in the library file
+  qint64  Length;  // byte length up to the end of "</Component>"
+};
+
+// One library file.
+struct LibCatalogLib
+{
+  QString   Path;     // library path as used by getLibAbsPath()
+  QString   Name;     // library name of the header
+  QDateTime Modified; // time stamp and ...
+  qint64    Size;     // ... size of the file when it was scanned
+  int       Result;   // result of the header check (LIB_PARSE_RESULT)
+  QVector<LibCatalogComp> Comps;
+};
+
+/*!
+ * \brief Catalog of the components of all library files.
+ *
+ * The catalog keeps name, description and file position of every
+ * component.  It is stored in the Qucs home directory and a library
+ * file is only scanned again if its size or time stamp changes.  The
+ * component definitions are read from the library file only when
+ * they are needed (see definition()).
+ */
+class LibCatalog {
+public:
+  LibCatalog();
+ ~LibCatalog();
+
+  void update(const QStringList&);
+  bool updateLib(int);
+
+  int  count() const { return Libs.size(); }
+  const LibCatalogLib& lib(int i) const { return Libs.at(i); }
+  const LibCatalogComp& comp(int l, int c) const { return Libs.at(l).Comps.at(c); }
+
+  QList< QPair<int, int> > search(const QString&) const;
+  QString definition(int, int) const;
+
+private:
+  bool load();
+  bool save() const;
+  void scan(LibCatalogLib&) const;
+  void buildIndex();
+
+  QString FileName;
+  QList<LibCatalogLib> Libs;
+
+  // lower case component names separated by '\n' for the search
+  QByteArray Names;
+  QVector<int> NameStart;  // position of each name within "Names"
+  QVector< QPair<int, int> > NameComp;  // library and component index
+};
+
+#endif /* LIBCATALOG_H */
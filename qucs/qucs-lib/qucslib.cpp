@@ -53,12 +53,14 @@ struct compInfoStruct
 {
   QString libName; // the name of the library where the component is defined
   QString libPath; // the library path (absolute for  user libs, relative for system libs)
-  QString compDef; // the component definition string
+  int libIdx;      // library and ...
+  int compIdx;     // ... component index in the catalog (definition is read on demand)
 };
 
-struct libInfoStruct // a struct is not really needed but useful if we need to add further data...
+struct libInfoStruct
 {
   QString libPath; // the library path (absolute for  user libs, relative for system libs)
+  int libIdx;      // library index in the catalog
 };
 
 Q_DECLARE_METATYPE(compInfoStruct)
@@ -195,7 +197,7 @@ QucsLib::~QucsLib()
 void QucsLib::putLibrariesIntoCombobox()
 {
     QList<QPair<QString, bool> > LibFiles;
-    ComponentLibrary parsedlib;
+    QStringList libPaths;
     QString libPath;
     libInfoStruct lineLibInfo;
     QVariant v;
@@ -220,8 +222,14 @@ void QucsLib::putLibrariesIntoCombobox()
     for (int i = 0; i < LibFiles.count(); ++i ) {
       libPath = LibFiles[i].first;
       libPath.chop(4); // remove extension
-      int result = parseComponentLibrary(libPath, parsedlib, QUCS_COMP_LIB_HEADER_ONLY); // need just the library name
-      switch (result) {
+      libPaths.append(libPath);
+    }
+    // scans new or changed library files only
+    Catalog.update(libPaths);
+
+    for (int i = 0; i < LibFiles.count(); ++i ) {
+      const LibCatalogLib &lib = Catalog.lib(i);
+      switch (lib.Result) {
       case QUCS_COMP_LIB_IO_ERROR:
       {
         QString filename = getLibAbsPath(LibFiles[i].first);
@@ -235,12 +243,12 @@ void QucsLib::putLibrariesIntoCombobox()
         break;
       }
 
-      lineLibInfo = libInfoStruct{libPath};
+      lineLibInfo = libInfoStruct{lib.Path, i};
       v.setValue(lineLibInfo);
       if (LibFiles[i].second) { // it's a system library ?
-        Library->addItem(sysLibPixmap, parsedlib.name, v);
+        Library->addItem(sysLibPixmap, lib.Name, v);
       } else {
-        Library->addItem(userLibPixmap, parsedlib.name, v);
+        Library->addItem(userLibPixmap, lib.Name, v);
       }
     }
     if (UserLibCount > 0) {
@@ -363,10 +371,12 @@ void QucsLib::slotSelectLibrary(int Index)
     v = Library->itemData(Index, Qt::UserRole);
     lineLibInfo = v.value<libInfoStruct>();
 
-    ComponentLibrary parsedlib;
-    int result = parseComponentLibrary (lineLibInfo.libPath, parsedlib);
+    // the library file might have been changed in the meantime
+    int l = lineLibInfo.libIdx;
+    Catalog.updateLib(l);
+    const LibCatalogLib &lib = Catalog.lib(l);
 
-    switch (result)
+    switch (lib.Result)
     {
         case QUCS_COMP_LIB_IO_ERROR:
         {
@@ -381,12 +391,12 @@ void QucsLib::slotSelectLibrary(int Index)
             break;
     }
 
-    // Now go through the rest of the component library, extracting each
-    // component name
-    for (int i = 0; i < parsedlib.components.count (); i++)
+    // the catalog holds the component names of the library
+    for (int i = 0; i < lib.Comps.count (); i++)
     {
-        QListWidgetItem *CompItem = new QListWidgetItem(parsedlib.components[i].name);
-        lineCompInfo = compInfoStruct{parsedlib.name, lineLibInfo.libPath, parsedlib.components[i].definition};
+        QListWidgetItem *CompItem = new QListWidgetItem(lib.Comps[i].Name);
+        CompItem->setToolTip(lib.Comps[i].Descr);
+        lineCompInfo = compInfoStruct{lib.Name, lib.Path, l, i};
         v.setValue(lineCompInfo);
         CompItem->setData(Qt::UserRole, v);
         CompList->addItem(CompItem);
@@ -399,8 +409,6 @@ void QucsLib::slotSelectLibrary(int Index)
 // ----------------------------------------------------
 void QucsLib::slotSearchComponent(const QString &searchText)
 {
-  QList<QPair<QString, bool> > LibFiles;
-  QString libPath;
   compInfoStruct lineCompInfo;
   QVariant v;
 
@@ -420,65 +428,18 @@ void QucsLib::slotSearchComponent(const QString &searchText)
     return;
   }
 
-  bool findComponent = false;
-
-  // user libraries
-  QStringList UserLibFiles = UserLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, UserLibFiles) // build list with full path
-    LibFiles.append(qMakePair(UserLibDir.absoluteFilePath(s), false));
-
-  // system libraries
-  QStringList SysLibFiles = SysLibDir.entryList(QStringList("*.lib"), QDir::Files, QDir::Name);
-  foreach(QString s, SysLibFiles) // build list with relative path
-    LibFiles.append(qMakePair(s, true));
-
-  QFile File;
-  QTextStream ReadWhole;
-  QString LibraryString, LibName, CompName;
-  int Start, End, NameStart, NameEnd;
-  for(auto it = LibFiles.begin(); it != LibFiles.end(); it++) { // all library files
-    QString libPath = (*it).first;
-    libPath.chop(4); // remove extension
-    File.setFileName(getLibAbsPath(libPath));
-    if(!File.open(QIODevice::ReadOnly))  continue;
-
-    ReadWhole.setDevice(&File);
-    LibraryString = ReadWhole.readAll();
-    File.close();
-
-    Start = LibraryString.indexOf("<Qucs Library ");
-    if(Start < 0)  continue;
-    End = LibraryString.indexOf('>', Start);
-    if(End < 0)  continue;
-    LibName = LibraryString.mid(Start, End-Start).section('"', 1, 1);
-
-    // check all components of the current library
-    while((Start=LibraryString.indexOf("\n<Component ", Start)) > 0) {
-      Start++;
-      NameStart = Start + 11;
-      NameEnd = LibraryString.indexOf('>', NameStart);
-      if(NameEnd < 0)  continue;
-      CompName = LibraryString.mid(NameStart, NameEnd-NameStart);
-
-      End = LibraryString.indexOf("\n</Component>", NameEnd);
-      if(End < 0)  continue;
-      End += 13;
-
-      // does search criterion match ?
-      if(CompName.indexOf(searchText, 0, Qt::CaseInsensitive) >= 0) {
-        if(!findComponent) {
-	  CompList->clear();
-        }
-        findComponent = true;
-        QListWidgetItem *CompItem = new QListWidgetItem(CompName);
-
-        lineCompInfo = compInfoStruct{LibName, libPath, LibraryString.mid(Start, End-Start)};
-        v.setValue(lineCompInfo);
-        CompItem->setData(Qt::UserRole, v);
-        CompList->addItem(CompItem);
-      }
-      Start = End;
-    }
+  // look up the component names in the catalog
+  QList<QPair<int, int> > Found = Catalog.search(searchText);
+  for(auto it = Found.begin(); it != Found.end(); it++) {
+    const LibCatalogLib &lib = Catalog.lib((*it).first);
+    const LibCatalogComp &comp = lib.Comps.at((*it).second);
+    QListWidgetItem *CompItem = new QListWidgetItem(comp.Name);
+    CompItem->setToolTip(comp.Descr);
+
+    lineCompInfo = compInfoStruct{lib.Name, lib.Path, (*it).first, (*it).second};
+    v.setValue(lineCompInfo);
+    CompItem->setData(Qt::UserRole, v);
+    CompList->addItem(CompItem);
   }
 }
 
@@ -530,36 +491,45 @@ void QucsLib::slotShowComponent(QListWidgetItem *Item)
           break;
     }
 
+    // read the component definition from the library file
+    QString compDef = Catalog.definition(lineCompInfo.libIdx, lineCompInfo.compIdx);
+    if(compDef.isEmpty())
+    {
+        QMessageBox::critical(this, tr("Error"),
+            tr("Library \"%1\" has changed, please select it again.").arg(lineCompInfo.libName));
+        return;
+    }
+
     QString content;
-    if(!getSection("Description", lineCompInfo.compDef, content))
+    if(!getSection("Description", compDef, content))
     {
         QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
         return;
     }
     CompDescr->append(content);
 
-    if(!getSection("Model", lineCompInfo.compDef, content))
+    if(!getSection("Model", compDef, content))
     {
         QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
         return;
     }
     Symbol->ModelString = content;
 
-    if(!getSection("VHDLModel", lineCompInfo.compDef, content))
+    if(!getSection("VHDLModel", compDef, content))
     {
         QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
         return;
     }
     Symbol->VHDLModelString = content;
 
-    if(!getSection("VerilogModel", lineCompInfo.compDef, content))
+    if(!getSection("VerilogModel", compDef, content))
     {
         QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
         return;
     }
     Symbol->VerilogModelString = content;
 
-    if(!getSection("Symbol", lineCompInfo.compDef, content))
+    if(!getSection("Symbol", compDef, content))
     {
         QMessageBox::critical(this, tr("Error"), tr("Library is corrupt."));
         return;
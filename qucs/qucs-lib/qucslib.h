@@ -30,6 +30,7 @@
 #include <QComboBox>
 
 #include "symbolwidget.h"
+#include "libcatalog.h"
 
 
 // Application settings.
@@ -77,6 +78,7 @@ private:
 
   int UserLibCount;
   int libCurIdx;
+  LibCatalog Catalog;
   SymbolWidget *Symbol;
   QTextEdit    *CompDescr;
   QVBoxLayout  *all;
@@ -55,6 +55,14 @@ AC_Sim::AC_Sim()
   Props.append(new Property("Noise", "no", false,
 			QObject::tr("calculate noise voltages")+
 			" [yes, no]"));
+  Props.append(new Property("Adaptive", "no", false,
+			QObject::tr("solve at adaptively chosen frequencies only")+
+			" [yes, no]"));
+  Props.append(new Property("AdaptTol", "1e-4", false,
+			QObject::tr("relative error of the adaptive sweep")));
+  Props.append(new Property("NoiseOut", "all", false,
+			QObject::tr("noise outputs, all saved nodes or probes only")+
+			" [all, probes]"));
 }
 
 AC_Sim::~AC_Sim()
@@ -64,7 +64,7 @@ DC_Sim::DC_Sim()
 	" [none, gMinStepping, SteepestDescent, LineSearch, Attenuation, SourceStepping]"));
   Props.append(new Property("Solver", "CroutLU", false,
 	QObject::tr("method for solving the circuit matrix")+
-	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD]"));
+	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD, BiCGStab, CG]"));
 }
 
 DC_Sim::~DC_Sim()
@@ -65,7 +65,7 @@ ETR_Sim::ETR_Sim()
 	QObject::tr("overestimation of local truncation error")));
   Props.append(new Property("Solver", "CroutLU", false,
 	QObject::tr("method for solving the circuit matrix")+
-	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD]"));
+	" [CroutLU, DoolittleLU, HouseholderQR, HouseholderLQ, GolubSVD, BiCGStab, CG]"));
   Props.append(new Property("relaxTSR", "no", false,
 	QObject::tr("relax time step raster")+" [no, yes]"));
   Props.append(new Property("initialDC", "yes", false,
@@ -64,6 +64,11 @@ SP_Sim::SP_Sim()
   Props.append(new Property("saveAll", "no", false,
 	QObject::tr("save subcircuit characteristic values into dataset")+
 	" [yes, no]"));
+  Props.append(new Property("Adaptive", "no", false,
+	QObject::tr("solve at adaptively chosen frequencies only")+
+	" [yes, no]"));
+  Props.append(new Property("AdaptTol", "1e-4", false,
+	QObject::tr("relative error of the adaptive sweep")));
 }
 
 SP_Sim::~SP_Sim()
@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <cmath>
 #include <float.h>
+#include <algorithm>
 #if HAVE_IEEEFP_H
 # include <ieeefp.h>
 #endif
@@ -516,6 +517,17 @@ void Diagram::calcData(Graph *g)
   double Dummy = 0.0;  // not used
   double *py = &Dummy;
 
+  Axis *pa;
+  if(g->yAxisNo == 0)  pa = &yAxis;
+  else  pa = &zAxis;
+
+  // Lines of large cartesian graphs are decimated to screen resolution.
+  bool Lod = false;
+  std::vector<int> Samples;
+  if(g->Style < GRAPHSTYLE_STAR)  if(Name == "Rect")
+    Lod = g->buildLod(pa->log);
+  if(Lod)  Size = 4096;   // enlarged as needed
+
   g->resizeScrPoints(Size);
   auto p = g->begin();
   auto p_end = g->begin();
@@ -524,29 +536,26 @@ void Diagram::calcData(Graph *g)
   ++p;
   assert(p!=g->end());
 
-  Axis *pa;
-  if(g->yAxisNo == 0)  pa = &yAxis;
-  else  pa = &zAxis;
-
   switch(g->Style) {
     case GRAPHSTYLE_SOLID: // ***** solid line ****************************
     case GRAPHSTYLE_DASH:
     case GRAPHSTYLE_DOT:
     case GRAPHSTYLE_LONGDASH:
 
-      for(i=g->countY; i>0; i--) {  // every branch of curves
+      for(i=0; i<g->countY; i++) {  // every branch of curves
+	int n = g->axis(0)->count;
+	if(Lod) {
+	  decimate(g, i, pa, Samples);
+	  n = Samples.size();
+	}
 	px = g->axis(0)->Points;
-	calcCoordinateP(px, pz, py, p, pa);
-	++px;
-	pz += 2;
-	++p;
-	for(z=g->axis(0)->count-1; z>0; z--) {  // every point
+	pz = g->cPointsY + 2*i*g->axis(0)->count;
+	for(z=0; z<n; z++) {  // every point
+	  int k = Lod ? Samples[z] : z;
 	  FIT_MEMORY_SIZE;  // need to enlarge memory block ?
-	  calcCoordinateP(px, pz, py, p, pa);
-	  ++px;
-	  pz += 2;
+	  calcCoordinateP(px+k, pz+2*k, py, p, pa);
 	  ++p;
-	  if(Counter >= 2)   // clipping only if an axis is manual
+	  if(z > 0)  if(Counter >= 2)   // clipping only if an axis is manual
 	    clip(p);
 	}
 	if((p-3)->isStrokeEnd() && !(p-3)->isBranchEnd())
@@ -589,6 +598,63 @@ for(int zz=0; zz<60; zz+=2)
   // unreachable
 }
 
+// -------------------------------------------------------
+// level of detail: runs of points narrower than this (in x direction)
+// are reduced to their first, least, greatest and last point
+#define LOD_WIDTH  0.25
+
+static void collectBucket(Diagram const *d, Graph const *g, int b, int L,
+                          int j, int Span, Axis const *pa,
+                          std::vector<int>& Samples)
+{
+  int n = g->count(0);
+  int first = j*Span, last = std::min(first+Span, n) - 1;
+  if(first == last) {
+    Samples.push_back(first);
+    return;
+  }
+
+  const double *px = g->axis(0)->Points;
+  const double *pz = g->cPointsY + 2*b*n;
+  const int *pb = g->lodBucket(L, b, j);
+  if(pb[0] >= 0) {
+    double Dummy = 0.0;
+    float x1, x2, y;
+    d->calcCoordinate(px+first, pz+2*first, &Dummy, &x1, &y, pa);
+    d->calcCoordinate(px+last, pz+2*last, &Dummy, &x2, &y, pa);
+    if(fabs(x2-x1) <= LOD_WIDTH) {
+      int Idx[4] = {first, pb[0], pb[1], last};
+      std::sort(Idx, Idx+4);
+      for(int i=0; i<4; i++)
+        if(i == 0 || Idx[i] != Idx[i-1])
+          Samples.push_back(Idx[i]);
+      return;
+    }
+  }
+
+  // too wide (or invalid values) -> look at the next finer level
+  Span /= LOD_FANOUT;
+  int cEnd = std::min((j+1)*LOD_FANOUT, g->lodBuckets(L-1));
+  for(int c=j*LOD_FANOUT; c<cEnd; c++) {
+    if(L == 1)  Samples.push_back(c);
+    else  collectBucket(d, g, b, L-1, c, Span, pa, Samples);
+  }
+}
+
+/*!
+ * Collects the indices of the points of branch "b" which have to be
+ * drawn, using the min/max pyramid of the graph.
+ */
+void Diagram::decimate(Graph const *g, int b, Axis const *pa,
+                       std::vector<int>& Samples) const
+{
+  Samples.clear();
+  int L = g->lodLevels(), Span = 1;
+  for(int i=0; i<L; i++)  Span *= LOD_FANOUT;
+  for(int j=0; j<g->lodBuckets(L); j++)
+    collectBucket(this, g, b, L, j, Span, pa, Samples);
+}
+
 // -------------------------------------------------------
 void Diagram::Bounding(int& _x1, int& _y1, int& _x2, int& _y2)
 {
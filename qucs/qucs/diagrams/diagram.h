@@ -142,6 +142,7 @@ protected:
   void rectClip(Graph::iterator &) const;
 
   virtual void calcData(Graph*);
+  void decimate(Graph const*, int, Axis const*, std::vector<int>&) const;
 
 private:
   int Bounding_x1, Bounding_x2, Bounding_y1, Bounding_y2;
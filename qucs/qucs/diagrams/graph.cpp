@@ -18,6 +18,7 @@
 
 #include <stdlib.h>
 #include <iostream>
+#include <algorithm>
 
 #include <QPainter>
 #include <QDebug>
@@ -41,6 +42,9 @@ Graph::Graph(Diagram const* d, const QString& _Line) :
 
   cPointsY = 0;
   gy=NULL;
+
+  LodData = 0;
+  LodAbs = false;
 }
 
 Graph::~Graph()
@@ -350,19 +354,126 @@ std::pair<double,double> Graph::findSample(std::vector<double>& VarPos) const
   for(unsigned ii=0; (pD=axis(ii)); ++ii) {
     double* pp = pD->Points;
     double v = VarPos[nVarPos];
-    for(unsigned i=pD->count; i>1; i--) {  // find appropiate marker position
-      if(fabs(v-(*pp)) < fabs(v-(*(pp+1)))) break;
-      pp++;
-      n += m;
+    int i = 0;
+    if(pD->ascending()) {  // bisect sorted axis
+      i = std::lower_bound(pp, pp+pD->count, v) - pp;
+      if(i >= pD->count)  i = pD->count-1;
+      else if(i > 0)
+        if(fabs(v-pp[i-1]) < fabs(v-pp[i]))  i--;
     }
+    else
+      for(; i < pD->count-1; i++)  // find appropiate marker position
+        if(fabs(v-pp[i]) < fabs(v-pp[i+1])) break;
 
+    n += m*i;
     m *= pD->count;
-    VarPos[nVarPos++] = *pp;
+    VarPos[nVarPos++] = pp[i];
   }
 
   return std::pair<double,double>(cPointsY[2*n], cPointsY[2*n+1]);
 }
 
+// -----------------------------------------------------------------------
+bool DataX::ascending() const
+{
+  if(Ascending < 0) {
+    Ascending = (count > 0 && std::isfinite(Points[0]));
+    for(int i=1; Ascending && i<count; i++)
+      if(!(Points[i] >= Points[i-1]) || !std::isfinite(Points[i]))
+        Ascending = 0;
+  }
+  return Ascending;
+}
+
+// -----------------------------------------------------------------------
+// level of detail
+#define LOD_MINIMUM 4096  // smaller graphs are always drawn completely
+
+// Value the vertical screen coordinate is monotonic in (see
+// RectDiagram::calcCoordinate()).
+static inline double lodKey(const double *y, bool Abs)
+{
+  if(Abs || fabs(y[1]) > 1e-250)  return sqrt(y[0]*y[0] + y[1]*y[1]);
+  return y[0];
+}
+
+/*!
+ * Creates a min/max pyramid of the branches, if the graph is large and
+ * its x values are sorted. Each bucket of level L covers LOD_FANOUT^L
+ * points and stores the index of its least and greatest value, or -1
+ * if it contains non-finite values. "Abs" selects the magnitude as key
+ * (logarithmic y axis). Returns false if there is no pyramid.
+ */
+bool Graph::buildLod(bool Abs)
+{
+  DataX const *pD = axis(0);
+  if(!cPointsY || !pD || pD->count < LOD_MINIMUM || !pD->ascending()) {
+    LodLevels.clear();
+    LodData = 0;
+    return false;
+  }
+  if(LodData == cPointsY && LodLoaded == lastLoaded && LodAbs == Abs)
+    return true;   // still valid
+
+  LodLevels.clear();
+  LodData = cPointsY;
+  LodLoaded = lastLoaded;
+  LodAbs = Abs;
+
+  int n = pD->count;
+  for(int nb = n; nb > 1; ) {
+    int nbNext = (nb + LOD_FANOUT-1) / LOD_FANOUT;
+    std::vector<int> Level(2*countY*nbNext);
+    const int *pPrev = LodLevels.empty() ? 0 : &LodLevels.back()[0];
+
+    for(int b=0; b<countY; b++) {
+      const double *pz = cPointsY + 2*b*n;
+      for(int j=0; j<nbNext; j++) {
+        int iMin = -1, iMax = -1;
+        double vMin = 0.0, vMax = 0.0;
+        int c = j*LOD_FANOUT, cEnd = std::min(c+LOD_FANOUT, nb);
+        for(; c<cEnd; c++) {
+          int cMin = c, cMax = c;
+          if(pPrev) {
+            cMin = pPrev[2*(b*nb+c)];
+            cMax = pPrev[2*(b*nb+c)+1];
+            if(cMin < 0) break;
+          }
+          double kMin = lodKey(pz+2*cMin, Abs);
+          double kMax = lodKey(pz+2*cMax, Abs);
+          if(!std::isfinite(kMin) || !std::isfinite(kMax)) break;
+          if(iMin < 0 || kMin < vMin) { iMin = cMin;  vMin = kMin; }
+          if(iMax < 0 || kMax > vMax) { iMax = cMax;  vMax = kMax; }
+        }
+        if(c < cEnd)  iMin = iMax = -1;  // not usable
+        Level[2*(b*nbNext+j)]   = iMin;
+        Level[2*(b*nbNext+j)+1] = iMax;
+      }
+    }
+
+    LodLevels.push_back(std::vector<int>());
+    LodLevels.back().swap(Level);
+    nb = nbNext;
+  }
+  return true;
+}
+
+// -----------------------------------------------------------------------
+// Number of buckets per branch in level "L" (level 0 are the points).
+int Graph::lodBuckets(int L) const
+{
+  if(L == 0)  return count(0);
+  return LodLevels[L-1].size() / (2*countY);
+}
+
+// -----------------------------------------------------------------------
+// Returns index of least and greatest value of bucket "j" in level "L"
+// of branch "b".
+const int* Graph::lodBucket(int L, int b, int j) const
+{
+  return &LodLevels[L-1][2*(b*lodBuckets(L)+j)];
+}
+
 // -----------------------------------------------------------------------
 // meaning of the values in a graph "Points" list
 #define STROKEEND   -2
@@ -57,7 +57,8 @@ class ViewPainter;
 
 struct DataX {
   DataX(const QString& Var_, double *Points_=0, int count_=0)
-       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY) {};
+       : Var(Var_), Points(Points_), count(count_), Min(INFINITY), Max(-INFINITY),
+         Ascending(-1) {};
  ~DataX() { if(Points) delete[] Points; };
   QString Var;
   double *Points;
@@ -66,16 +67,21 @@ struct DataX {
 public:
   const double& min()const {return Min;}
   const double& max()const {return Max;}
+  bool ascending() const; // finite points in ascending order ?
 public: // only called from Graph. cleanup later.
   const double& min(const double& x){if (Min<x) Min=x; return Min;}
   const double& max(const double& x){if (Max>x) Max=x; return Max;}
 private:
   double Min;
   double Max;
+  mutable int Ascending;  // -1 = not checked yet
 };
 
 struct Axis;
 
+// level of detail: buckets merged into one bucket of the next level
+#define LOD_FANOUT  4
+
 /*!
  * prepare data for plotting purposes in Diagram.
  * a Graph is a list of graphs (bug?!)
@@ -176,10 +182,21 @@ public: // marker related
   void createMarkerText() const;
   std::pair<double,double> findSample(std::vector<double>&) const;
   Diagram const* parentDiagram() const{return diagram;}
+public: // level of detail, min/max decimation of the branches
+  bool buildLod(bool);
+  int  lodLevels() const { return LodLevels.size(); }
+  int  lodBuckets(int) const;
+  const int* lodBucket(int, int, int) const;
 private:
   QVector<DataX*>  cPointsX;
   std::vector<ScrPt> ScrPoints; // data in screen coordinates
   Diagram const* diagram;
+
+  // index of least and greatest value in each bucket of each level
+  std::vector< std::vector<int> > LodLevels;
+  const double *LodData;  // data and mode the levels were built for
+  QDateTime LodLoaded;
+  bool LodAbs;
 };
 
 #endif
@@ -29,6 +29,8 @@
 #include <cmath>
 #include <float.h>
 #include <limits.h>
+#include <string.h>
+#include <algorithm>
 #if HAVE_IEEEFP_H
 # include <ieeefp.h>
 #endif
@@ -37,6 +39,12 @@
 #include "qucs.h"
 #include "misc.h"
 
+#include <QList>
+#include <QtConcurrentMap>
+
+// grids with fewer points are projected in the calling thread
+#define PROJECT_PARALLEL  16384
+
 Rect3DDiagram::Rect3DDiagram(int _cx, int _cy) : Diagram(_cx, _cy)
 {
   x1 = 10;     // position of label text
@@ -46,6 +54,7 @@ Rect3DDiagram::Rect3DDiagram(int _cx, int _cy) : Diagram(_cx, _cy)
   x3 = 207;    // with some distance for right axes text
 
   Mem = pMem = 0;  // auxiliary buffer for hidden lines
+  BoundX1 = BoundX2 = 0;
 
   Name = "Rect3D"; // BUG
   // symbolic diagram painting
@@ -197,7 +206,7 @@ void Rect3DDiagram::finishMarkerCoordinates(float& fCX, float& fCY) const
 
 // ------------------------------------------------------------
 void Rect3DDiagram::calcCoordinate3D(double x, double y, double zr, double zi,
-					tPoint3D *p, tPointZ *pz)
+					tPoint3D *p, tPointZ *pz) const
 {
   if(zAxis.log) {
     zr = sqrt(zr*zr + zi*zi);
@@ -239,12 +248,100 @@ void Rect3DDiagram::calcCoordinate3D(double x, double y, double zr, double zi,
   pz->z = float(calcZ_2D(x, y, zr));
 }
 
+// ------------------------------------------------------------
+// Projects the rows "r1" up to "r2"-1 of the grid of graph "g". The
+// pointers "p" and "zp" point to the first point of the graph.
+void Rect3DDiagram::projectRows(Graph const *g, int r1, int r2,
+				tPoint3D *p, tPointZ *zp) const
+{
+  double Dummy = 0.0;  // number for 1-dimensional data in 3D cartesian
+  const double *px, *py, *pz;
+  int dx = g->axis(0)->count;
+  int dy = 0;
+  if(g->countY > 1)  dy = g->axis(1)->count;
+
+  for(int r=r1; r<r2; r++) {   // y coordinates
+    px = g->axis(0)->Points;
+    py = &Dummy;
+    if(dy > 0)  py = g->axis(1)->Points + r % dy;
+    pz = g->cPointsY + 2*r*dx;
+    for(int j=r*dx; j<(r+1)*dx; j++) { // x coordinates
+      calcCoordinate3D(*(px++), *py, *pz, *(pz+1), p+j, zp+j);
+      pz += 2;
+    }
+  }
+}
+
+// ------------------------------------------------------------
+// Function object projecting a block of rows for QtConcurrent.
+struct Rect3DProjection {
+  Rect3DProjection(Rect3DDiagram const *d_, Graph const *g_,
+                   tPoint3D *p_, tPointZ *zp_, int Rows_)
+    : d(d_), g(g_), p(p_), zp(zp_), Rows(Rows_) {}
+  typedef void result_type;
+
+  void operator()(int& Block) const {
+    int r1 = Block * Rows;
+    d->projectRows(g, r1, std::min(r1 + Rows, g->countY), p, zp);
+  }
+
+  Rect3DDiagram const *d;
+  Graph const *g;
+  tPoint3D *p;
+  tPointZ *zp;
+  int Rows;
+};
+
+// ------------------------------------------------------------
+// Calculates the 2D coordinates of all grid points of graph "g". Large
+// grids are split into blocks of rows projected in parallel.
+void Rect3DDiagram::projectGraph(Graph const *g, tPoint3D *p, tPointZ *zp) const
+{
+  int dx = g->axis(0)->count;
+  if(dx * g->countY < PROJECT_PARALLEL) {
+    projectRows(g, 0, g->countY, p, zp);
+    return;
+  }
+
+  int Rows = std::max(1, PROJECT_PARALLEL / (4*dx));
+  QList<int> Blocks;
+  for(int b=0; b*Rows < g->countY; b++)
+    Blocks.append(b);
+  QtConcurrent::blockingMap(Blocks, Rect3DProjection(this, g, p, zp, Rows));
+}
+
+// ------------------------------------------------------------
+// Returns everything the projection of the graph points depends on,
+// i.e. the view and the data.
+std::vector<double> Rect3DDiagram::projectionKey() const
+{
+  double View[] = {
+    double(rotX), double(rotY), double(rotZ), double(x2), double(y2),
+    xorig, yorig, cxx, cxy, cxz, cyx, cyy, cyz, czx, czy, czz,
+    xAxis.low, xAxis.up, double(xAxis.log),
+    yAxis.low, yAxis.up, double(yAxis.log),
+    zAxis.low, zAxis.up, double(zAxis.log) };
+  std::vector<double> Key(View, View + sizeof(View)/sizeof(double));
+
+  foreach(Graph *g, Graphs) {
+    Key.push_back(double(quintptr(g->cPointsY)));
+    if(!g->cPointsY)  continue;
+    Key.push_back(double(g->lastLoaded.toTime_t()) +
+                  1e-3*double(g->lastLoaded.time().msec()));
+    Key.push_back(double(g->countY));
+    Key.push_back(double(g->count(0)));
+  }
+  return Key;
+}
+
 // --------------------------------------------------------------
 bool Rect3DDiagram::isHidden(int x, int y, tBound *Bounds, char *zBuffer)
 {
   // remember the boundings of the polygon
   if( (Bounds+x)->max < y )  (Bounds+x)->max = y;
   if( (Bounds+x)->min > y )  (Bounds+x)->min = y;
+  if(x < BoundX1)  BoundX1 = x;
+  if(x > BoundX2)  BoundX2 = x;
 
   // diagram area already used ?
   return ( *(zBuffer + (y>>3) + x * ((y2+7)>>3)) & (1 << (y & 7)) ) != 0;
@@ -368,25 +465,36 @@ void Rect3DDiagram::calcLine(tPoint3D* &p, tPoint3D* &MemEnd,
 }
 
 // --------------------------------------------------------------
-// Compare functions for GNU qsort routine.
-int Rect3DDiagram::comparePoint3D(const void *Point1, const void *Point2)
+// Compare functions for std::stable_sort.
+bool Rect3DDiagram::comparePoint3D(const tPoint3D& Point1, const tPoint3D& Point2)
 {
-  return ((tPoint3D*)Point1)->No - ((tPoint3D*)Point2)->No;
+  return Point1.No < Point2.No;
 }
-int Rect3DDiagram::comparePointZ(const void *Point1, const void *Point2)
+bool Rect3DDiagram::comparePointZ(const tPointZ& Point1, const tPointZ& Point2)
 {
-  if((((tPointZ*)Point2)->z - ((tPointZ*)Point1)->z) < 0.0f)
-    return -1;
-  return 1;
+  return Point1.z > Point2.z;
+}
+
+// --------------------------------------------------------------
+// Sets the bits "j1" up to "j2" of a z-buffer column.
+static void markColumn(char *pc, int j1, int j2)
+{
+  int b1 = j1 >> 3, b2 = j2 >> 3;
+  char m1 = char(0xFF << (j1 & 7));
+  char m2 = char(0xFF >> (7 - (j2 & 7)));
+  if(b1 == b2) {
+    *(pc + b1) |= m1 & m2;
+    return;
+  }
+  *(pc + b1) |= m1;
+  memset(pc + b1 + 1, 0xFF, b2 - b1 - 1);
+  *(pc + b2) |= m2;
 }
 
 // --------------------------------------------------------------
 // Removes the invisible parts of the graph.
 void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
 {
-  double Dummy = 0.0;  // number for 1-dimensional data in 3D cartesian
-  double *px, *py, *pz;
-
   tPoint3D *p;
   int i, j, z, dx, dy, Size=0;
   // pre-calculate buffer size to avoid reallocations in the first step
@@ -409,16 +517,22 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
   pMem = Mem;
   tPointZ *zp = zMem, *zp_tmp;
 
+  // The projection only changes with the view or the data.
+  std::vector<double> Key = projectionKey();
+  bool Cached = (Key == ProjKey);
+  if(!Cached) {
+    ProjKey.clear();
+    ProjPoints.clear();
+    ProjZ.clear();
+  }
+  int Pos = 0;   // position in projection cache
+
   // ...............................................................
   foreach(Graph *g, Graphs) {
 
-    pz = g->cPointsY;
-    if(!pz) continue;
+    if(!g->cPointsY) continue;
     if(g->numAxes() < 1) continue;
 
-    py = &Dummy;
-    if(g->countY > 1)  py = g->axis(1)->Points;
-
     p = pMem;  // save status for cross grid
     zp_tmp = zp;
     // ..........................................
@@ -426,19 +540,22 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     dx = g->axis(0)->count;
     if(g->countY > 1)  dy = g->axis(1)->count;
     else  dy = 0;
-    for(i=g->countY-1; i>=0; i--) {   // y coordinates
-      px = g->axis(0)->Points;
-    
-      for(j=dx; j>0; j--) { // x coordinates
-        calcCoordinate3D(*(px++), *py, *pz, *(pz+1), pMem++, zp++);
-        pz += 2;
-      }
-
-      (pMem-1)->done |= 8;  // mark as "last in line"
-      py++;
-      if(dy > 0) if((i % dy) == 0)
-        py = g->axis(1)->Points;
+    z = dx * g->countY;
+    if(Cached) {
+      std::copy(ProjPoints.begin()+Pos, ProjPoints.begin()+Pos+z, pMem);
+      std::copy(ProjZ.begin()+Pos, ProjZ.begin()+Pos+z, zp);
     }
+    else {
+      projectGraph(g, pMem, zp);
+      ProjPoints.insert(ProjPoints.end(), pMem, pMem+z);
+      ProjZ.insert(ProjZ.end(), zp, zp+z);
+    }
+    Pos += z;
+    pMem += z;
+    zp += z;
+
+    for(i=g->countY; i>0; i--)   // y coordinates
+      (p + i*dx - 1)->done |= 8;  // mark as "last in line"
     (pMem-1)->done |= 512;  // mark as "last point before grid"
 
     // ..........................................
@@ -496,6 +613,7 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     }  // of "if(hideLines)"
 
   }  // of "for(Graphs)"
+  if(!Cached)  ProjKey = Key;
 
 
   if(!hideLines) {  // do not hide invisible lines
@@ -518,7 +636,7 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
   // Sort z-coordinates (greatest first).
   // After this the polygons that have the smallest distance to the
   // viewer are on top of the list and thus, will be processed first.
-  qsort(zMem, Size, sizeof(tPointZ), comparePointZ);
+  std::stable_sort(zMem, zMem+Size, comparePointZ);
 
 #if 0
   qDebug("--------------------------- z sorting");
@@ -532,6 +650,13 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
   // malloc_8xsize added (see comment before malloc_8xsize declaration)
   tPoint3D *MemEnd = Mem + malloc_8xsize*2*Size - 5;   // limit of buffer
 
+  // the polygon bounding buffer is reset only where it was used
+  for(i=x2; i>=0; i--) {
+    (Bounds+i)->max = INT_MIN;
+    (Bounds+i)->min = INT_MAX;
+  }
+  int yBits = 8*((y2+7)>>3) - 1;   // last bit of a z-buffer column
+
   zp = zMem;
   foreach(Graph *g, Graphs) {
     if(!g->cPointsY) continue;
@@ -542,11 +667,8 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
     // look for hidden lines ...
     for(int No = g->countY/dy * (dx-1)*(dy-1); No>0; No--) {
 
-      // reset the polygon bounding buffer
-      for(i=x2; i>=0; i--) {
-        (Bounds+i)->max = INT_MIN;
-        (Bounds+i)->min = INT_MAX;
-      }
+      BoundX1 = INT_MAX;
+      BoundX2 = INT_MIN;
 
       // work on all 4 lines of polygon
       p = Mem + zp->No;  // polygon corner coordinates
@@ -562,12 +684,17 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
       calcLine(p, MemEnd, Bounds, zBuffer);
 
       // mark the area of the polygon (stored in "*Bounds") as used
-      for(i=x2-1; i>=0; i--)  // all x coordinates
-        if( (Bounds+i)->max > INT_MIN) {
+      // and reset the bounding buffer for the next one
+      for(i=std::max(BoundX1, 0); i<=std::min(BoundX2, x2); i++) {
+        if(i < x2)  if( (Bounds+i)->max > INT_MIN) {
           pc = zBuffer + i * ((y2+7)>>3);
-          for(j=(Bounds+i)->min; j<=(Bounds+i)->max; j++) // all y coordinates
-            *(pc + (j>>3)) |= (1 << (j & 7));
+          j = std::max((Bounds+i)->min, 0);
+          z = std::min((Bounds+i)->max, yBits);
+          if(j <= z)  markColumn(pc, j, z); // all y coordinates
         }
+        (Bounds+i)->max = INT_MIN;
+        (Bounds+i)->min = INT_MAX;
+      }
 
       zp++;   // next polygon
     }
@@ -583,7 +710,7 @@ void Rect3DDiagram::removeHiddenLines(char *zBuffer, tBound *Bounds)
   free(zMem);
 
   // sort "No" (least one first)
-  qsort(Mem, pMem - Mem, sizeof(tPoint3D), comparePoint3D);
+  std::stable_sort(Mem, pMem, comparePoint3D);
 
 #if 0
   qDebug("--------------------------- last sorting %d", pMem-Mem);
@@ -20,6 +20,8 @@
 
 #include "diagram.h"
 
+#include <vector>
+
 
 struct tPoint3D {
   int   x, y;
@@ -69,18 +71,30 @@ private:
   double calcY_2D(double, double, double) const;
   double calcZ_2D(double, double, double) const;
 
-  static int comparePoint3D(const void*, const void*);
-  static int comparePointZ(const void*, const void*);
+  static bool comparePoint3D(const tPoint3D&, const tPoint3D&);
+  static bool comparePointZ(const tPointZ&, const tPointZ&);
   bool isHidden(int, int, tBound*, char*);
   void enlargeMemoryBlock(tPoint3D* &);
   void calcLine(tPoint3D* &, tPoint3D* &, tBound*, char*);
-  void calcCoordinate3D(double, double, double, double, tPoint3D*, tPointZ*);
+  void calcCoordinate3D(double, double, double, double, tPoint3D*, tPointZ*) const;
+  void projectRows(Graph const*, int, int, tPoint3D*, tPointZ*) const;
+  void projectGraph(Graph const*, tPoint3D*, tPointZ*) const;
+  std::vector<double> projectionKey() const;
   void removeHiddenLines(char*, tBound*);
   void removeHiddenCross(int, int, int, int, char*, tBound*);
 
+  friend struct Rect3DProjection;
+
   float  xorig, yorig; // where is the 3D origin with respect to cx/cy
   double cxx, cxy, cxz, cyx, cyy, cyz, czx, czy, czz; // coefficients 3D -> 2D
   double scaleX, scaleY;
+
+  int BoundX1, BoundX2;  // columns used by the current polygon
+
+  // projected grid points of all graphs for the view in "ProjKey"
+  std::vector<double>   ProjKey;
+  std::vector<tPoint3D> ProjPoints;
+  std::vector<tPointZ>  ProjZ;
 };
 
 #endif
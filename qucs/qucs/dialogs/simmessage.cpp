@@ -806,7 +806,7 @@ void SimMessage::FinishSimulation(int Status)
 	ifile.close();
       }
       if(((Optimize_Sim*)SimOpt)->loadASCOout())
-	((Schematic*)DocWidget)->setChanged(true,true);
+	((Schematic*)DocWidget)->setChanged(true,true,'*',true);
     }
   }
 
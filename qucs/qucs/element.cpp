@@ -17,6 +17,8 @@
 
 #include "element.h"
 
+#include <QtAlgorithms>
+
 Element::Element()
 {
   Type = isDummyElement;
@@ -43,3 +45,89 @@ void Element::setCenter(int, int, bool)
 void Element::getCenter(int&, int&)
 {
 }
+
+
+// *******************************************************************
+// *****                     ElementGrid                         *****
+// *******************************************************************
+
+// Size of the grid cells (as power of two) and the maximum number of
+// cells an element is filed in.
+#define ELEMENT_CELL_SHIFT  6
+#define ELEMENT_CELL_LIMIT 64
+
+// -------------------------------------------------------------
+quint64 ElementGrid::cell(int i, int j)
+{
+  return (quint64(quint32(i)) << 32) | quint64(quint32(j));
+}
+
+// -------------------------------------------------------------
+void ElementGrid::clear()
+{
+  Cells.clear();
+  Large.clear();
+  All.clear();
+}
+
+// -------------------------------------------------------------
+// Files the element that can be selected within the rectangle x1/y1,
+// x2/y2 (x1 <= x2 and y1 <= y2).
+void ElementGrid::insert(Element *pe, int x1, int y1, int x2, int y2)
+{
+  Entry e(All.size(), pe);
+  All.append(e);
+
+  int i1 = x1 >> ELEMENT_CELL_SHIFT, i2 = x2 >> ELEMENT_CELL_SHIFT;
+  int j1 = y1 >> ELEMENT_CELL_SHIFT, j2 = y2 >> ELEMENT_CELL_SHIFT;
+  if((qint64(i2) - i1 + 1) * (qint64(j2) - j1 + 1) > ELEMENT_CELL_LIMIT) {
+    Large.append(e);
+    return;
+  }
+
+  for(int i = i1; i <= i2; i++)
+    for(int j = j1; j <= j2; j++)
+      Cells.insert(cell(i, j), e);
+}
+
+// -------------------------------------------------------------
+// Returns the elements in reverse list order without duplicates.
+QList<Element*> ElementGrid::sorted(QList<Entry>& entries)
+{
+  qSort(entries);
+  QList<Element*> found;
+  for(int z = entries.size()-1; z >= 0; z--)
+    if(found.isEmpty() || found.last() != entries.at(z).second)
+      found.append(entries.at(z).second);
+  return found;
+}
+
+// -------------------------------------------------------------
+// Returns all elements that may be selected at the given position.
+QList<Element*> ElementGrid::findAt(int x, int y) const
+{
+  QList<Entry> entries = Large + Cells.values(
+          cell(x >> ELEMENT_CELL_SHIFT, y >> ELEMENT_CELL_SHIFT));
+  return sorted(entries);
+}
+
+// -------------------------------------------------------------
+// Returns all elements whose selection area touches the rectangle
+// x1/y1, x2/y2 (x1 <= x2 and y1 <= y2).
+QList<Element*> ElementGrid::findIn(int x1, int y1, int x2, int y2) const
+{
+  int i1 = x1 >> ELEMENT_CELL_SHIFT, i2 = x2 >> ELEMENT_CELL_SHIFT;
+  int j1 = y1 >> ELEMENT_CELL_SHIFT, j2 = y2 >> ELEMENT_CELL_SHIFT;
+
+  // for large rectangles it is cheaper to take every element
+  QList<Entry> entries;
+  if((qint64(i2) - i1 + 1) * (qint64(j2) - j1 + 1) > qint64(Cells.size()))
+    entries = All;
+  else {
+    entries = Large;
+    for(int i = i1; i <= i2; i++)
+      for(int j = j1; j <= j2; j++)
+        entries += Cells.values(cell(i, j));
+  }
+  return sorted(entries);
+}
@@ -39,6 +39,9 @@
 
 #include <QPen>
 #include <QBrush>
+#include <QList>
+#include <QMultiHash>
+#include <Q3PtrList>
 
 class Node;
 class QPainter;
@@ -164,4 +167,76 @@ public:
   WireLabel *Label;
 };
 
+
+/** \class ElementGrid
+  * \brief coarse grid of elements sorted by their selection area
+  *
+  * Every element is filed in all grid cells its selection area touches,
+  * so that a click or a selection rectangle only needs to test the
+  * elements around it. The elements must be inserted in list order, the
+  * lookups return them in reverse order, i.e. the topmost one first.
+  */
+class ElementGrid {
+public:
+  void clear();
+  uint count() const { return All.size(); }
+  void insert(Element*, int, int, int, int);
+  QList<Element*> findAt(int, int) const;
+  QList<Element*> findIn(int, int, int, int) const;
+
+private:
+  typedef QPair<int, Element*> Entry;   // number in list order, element
+  static quint64 cell(int, int);
+  static QList<Element*> sorted(QList<Entry>&);
+
+  QMultiHash<quint64, Entry> Cells;
+  QList<Entry> Large;   // elements too large to be filed in cells
+  QList<Entry> All;
+};
+
+
+/** \class ElementList
+  * \brief list of schematic elements that remembers the changed ones
+  *
+  * Every element inserted into or removed from the list is noted, as well
+  * as every element passed to touch() after being changed in place. The
+  * undo stack thus only needs to look at these elements. The value noted
+  * tells whether the element is still listed.
+  */
+template <class T> class ElementList : public Q3PtrList<T> {
+public:
+  T* take() {
+    T *pe = Q3PtrList<T>::take();
+    if(pe) Touched.insert(pe, false);
+    return pe;
+  }
+  T* take(uint index) {
+    T *pe = Q3PtrList<T>::take(index);
+    if(pe) Touched.insert(pe, false);
+    return pe;
+  }
+  // The element must be listed, elements noted before keep their value.
+  void touch(T *pe) {
+    if(!Touched.contains(pe)) Touched.insert(pe, true);
+  }
+  QHash<Element*, bool> takeTouched() {
+    QHash<Element*, bool> h = Touched;
+    Touched.clear();
+    return h;
+  }
+
+protected:
+  Q3PtrCollection::Item newItem(Q3PtrCollection::Item d) {
+    Touched.insert((T*)d, true);
+    return d;
+  }
+  void deleteItem(Q3PtrCollection::Item d) {
+    Touched.insert((T*)d, false);
+    if(this->autoDelete()) delete (T*)d;
+  }
+
+private:
+  QHash<Element*, bool> Touched;
+};
+
 #endif
@@ -150,6 +150,7 @@ void MouseActions::editLabel(Schematic *Doc, WireLabel *pl)
   QString Value = Dia->InitValue->text();
   delete Dia;
 
+  Doc->touchElement(pl->pOwner);
   if(Name.isEmpty() && Value.isEmpty()) { // if nothing entered, delete label
     pl->pOwner->Label = 0;   // delete name of wire
     delete pl;
@@ -212,6 +213,11 @@ void MouseActions::endElementMoving(Schematic *Doc, Q3PtrList<Element> *movEleme
       case isVMovingLabel:
 	Doc->insertNodeLabel((WireLabel*)pe);
 	break;
+      case isHWireLabel:
+      case isVWireLabel:
+      case isNodeLabel:   // moved in place, so note the change of its owner
+	Doc->touchElement(((WireLabel*)pe)->pOwner);
+	break;
       case isMarker:
 	assert(dynamic_cast<Marker*>(pe));
 	break;
@@ -898,6 +904,9 @@ void MouseActions::MPressLabel(Schematic *Doc, QMouseEvent*, float fX, float fY)
   Value = Dia->InitValue->text();
   delete Dia;
 
+  Doc->touchElement(pe);   // owner of the old name
+  if(pw) Doc->touchElement(pw);
+  else Doc->touchElement(pn);
   if(Name.isEmpty() && Value.isEmpty() ) { // if nothing entered, delete name
     if(pe) {
       if(((Conductor*)pe)->Label)
@@ -1840,6 +1849,7 @@ void MouseActions::MReleaseMoveText(Schematic *Doc, QMouseEvent *Event)
 
   ((Component*)focusElement)->tx = MAx1 - ((Component*)focusElement)->cx;
   ((Component*)focusElement)->ty = MAy1 - ((Component*)focusElement)->cy;
+  Doc->touchElement(focusElement);
   Doc->viewport()->update();
   drawn = false;
   Doc->setChanged(true, true);
@@ -1933,6 +1943,7 @@ void MouseActions::editElement(Schematic *Doc, QMouseEvent *Event)
            Doc->Components->append(c);
          }
 
+         Doc->touchElement(c);
          Doc->setChanged(true, true);
          c->entireBounds(x1,y1,x2,y2, Doc->textCorr());
          Doc->enlargeView(x1,y1,x2,y2);
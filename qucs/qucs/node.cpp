@@ -82,3 +82,120 @@ void Node::setName(const QString& Name_, const QString& Value_, int x_, int y_)
   Label->pOwner = this;
   Label->initValue = Value_;
 }
+
+
+// *******************************************************************
+// *****                       NodeList                          *****
+// *******************************************************************
+
+// Size of the grid cells (as power of two) used for the node lookup.
+#define NODE_CELL_SHIFT 5
+
+// -------------------------------------------------------------
+// Returns the key of the grid cell containing the given position.
+quint64 NodeList::cell(int x, int y)
+{
+  return (quint64(quint32(x >> NODE_CELL_SHIFT)) << 32) |
+          quint64(quint32(y >> NODE_CELL_SHIFT));
+}
+
+// -------------------------------------------------------------
+// Returns the node lying exactly at the given position (or 0).
+Node* NodeList::findAt(int x, int y) const
+{
+  quint64 key = cell(x, y);
+  QMultiHash<quint64, Node*>::const_iterator it = Grid.constFind(key);
+  for(; it != Grid.constEnd() && it.key() == key; ++it)
+    if(it.value()->cx == x) if(it.value()->cy == y)
+      return it.value();
+  return 0;
+}
+
+// -------------------------------------------------------------
+// Returns a node that can be selected at the given position (or 0).
+// The selection area of a node never exceeds the four cells around.
+Node* NodeList::findNear(int x, int y) const
+{
+  int dx[4] = {-5, 5, -5, 5}, dy[4] = {-5, -5, 5, 5};
+  for(int i = 0; i < 4; i++) {
+    quint64 key = cell(x+dx[i], y+dy[i]);
+    int z;
+    for(z = 0; z < i; z++)   // skip cells already tested
+      if(cell(x+dx[z], y+dy[z]) == key) break;
+    if(z < i) continue;
+
+    QMultiHash<quint64, Node*>::const_iterator it = Grid.constFind(key);
+    for(; it != Grid.constEnd() && it.key() == key; ++it)
+      if(it.value()->getSelected(x, y))
+        return it.value();
+  }
+  return 0;
+}
+
+// -------------------------------------------------------------
+// Returns all nodes lying within the rectangle x1/y1, x2/y2 (borders
+// included), where x1 <= x2 and y1 <= y2.
+QList<Node*> NodeList::findIn(int x1, int y1, int x2, int y2) const
+{
+  QList<Node*> found;
+  int i1 = x1 >> NODE_CELL_SHIFT, i2 = x2 >> NODE_CELL_SHIFT;
+  int j1 = y1 >> NODE_CELL_SHIFT, j2 = y2 >> NODE_CELL_SHIFT;
+
+  // for large rectangles it is cheaper to test every node
+  if((qint64(i2) - i1 + 1) * (qint64(j2) - j1 + 1) > qint64(Grid.size())) {
+    foreach(Node *pn, Grid)
+      if(pn->cx >= x1) if(pn->cx <= x2) if(pn->cy >= y1) if(pn->cy <= y2)
+        found.append(pn);
+    return found;
+  }
+
+  for(int i = i1; i <= i2; i++)
+    for(int j = j1; j <= j2; j++) {
+      quint64 key = (quint64(quint32(i)) << 32) | quint64(quint32(j));
+      QMultiHash<quint64, Node*>::const_iterator it = Grid.constFind(key);
+      for(; it != Grid.constEnd() && it.key() == key; ++it) {
+        Node *pn = it.value();
+        if(pn->cx >= x1) if(pn->cx <= x2) if(pn->cy >= y1) if(pn->cy <= y2)
+          found.append(pn);
+      }
+    }
+  return found;
+}
+
+// -------------------------------------------------------------
+Node* NodeList::take()
+{
+  Node *pn = ElementList<Node>::take();
+  if(pn) Grid.remove(cell(pn->cx, pn->cy), pn);
+  Changes++;
+  return pn;
+}
+
+// -------------------------------------------------------------
+Node* NodeList::take(uint index)
+{
+  Node *pn = ElementList<Node>::take(index);
+  if(pn) Grid.remove(cell(pn->cx, pn->cy), pn);
+  Changes++;
+  return pn;
+}
+
+// -------------------------------------------------------------
+// Called by the list for every node being inserted.
+Q3PtrCollection::Item NodeList::newItem(Item d)
+{
+  Node *pn = (Node*)d;
+  Grid.insert(cell(pn->cx, pn->cy), pn);
+  Changes++;
+  return ElementList<Node>::newItem(d);
+}
+
+// -------------------------------------------------------------
+// Called by the list for every node being removed (or cleared).
+void NodeList::deleteItem(Item d)
+{
+  Node *pn = (Node*)d;
+  Grid.remove(cell(pn->cx, pn->cy), pn);
+  Changes++;
+  ElementList<Node>::deleteItem(d);   // deletes the node if auto delete
+}
@@ -21,6 +21,7 @@
 #include "element.h"
 
 #include <Q3PtrList>
+#include <QMultiHash>
 
 class ViewPainter;
 
@@ -40,4 +41,27 @@ public:
   int State;	 // remember some things during some operations
 };
 
+// List of schematic nodes that additionally keeps the nodes sorted into
+// a coarse grid, so that looking up a node by its position does not
+// need to scan the whole list. Nodes never move while being listed.
+class NodeList : public ElementList<Node> {
+public:
+  NodeList() { Changes = 0; }
+  uint changes() const { return Changes; }  // counts insertions and removals
+  Node* findAt(int, int) const;
+  Node* findNear(int, int) const;
+  QList<Node*> findIn(int, int, int, int) const;
+  Node* take();
+  Node* take(uint);
+
+protected:
+  Item newItem(Item);
+  void deleteItem(Item);
+
+private:
+  static quint64 cell(int, int);
+  QMultiHash<quint64, Node*> Grid;
+  uint Changes;
+};
+
 #endif
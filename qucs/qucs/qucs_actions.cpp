@@ -883,7 +883,8 @@ void QucsApp::slotChangeProps()
   else {
     ChangeDialog *d = new ChangeDialog((Schematic*)Doc);
     if(d->exec() == QDialog::Accepted) {
-      ((Schematic*)Doc)->setChanged(true, true);
+      // may have changed any component, so compare all records
+      ((Schematic*)Doc)->setChanged(true, true, '*', true);
       ((Schematic*)Doc)->viewport()->update();
     }
   }
@@ -1120,6 +1121,7 @@ void QucsApp::slotApplyCompText()
               break;  // found component with the same name ?
           if(!pc2) {
             pc->Name = editText->text();
+            Doc->touchElement(pc);
             Doc->setChanged(true, true);  // only one undo state
           }
         }
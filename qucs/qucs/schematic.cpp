@@ -55,10 +55,10 @@
 #include "misc.h"
 
 // just dummies for empty lists
-Q3PtrList<Wire>      SymbolWires;
-Q3PtrList<Node>      SymbolNodes;
+WireList             SymbolWires;
+NodeList             SymbolNodes;
 Q3PtrList<Diagram>   SymbolDiags;
-Q3PtrList<Component> SymbolComps;
+ElementList<Component> SymbolComps;
 
 
 Schematic::Schematic(QucsApp *App_, const QString& Name_)
@@ -77,6 +77,7 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
   tmpUsedX1 = tmpUsedY1 = tmpViewX1 = tmpViewY1 = -200;
   tmpUsedX2 = tmpUsedY2 = tmpViewX2 = tmpViewY2 =  200;
   tmpScale = 1.0;
+  GridsValid = false;
 
   DocComps.setAutoDelete(true);
   DocWires.setAutoDelete(true);
@@ -85,11 +86,11 @@ Schematic::Schematic(QucsApp *App_, const QString& Name_)
   DocPaints.setAutoDelete(true);
   SymbolPaints.setAutoDelete(true);
 
-  // The 'i' means state for being unchanged.
-  undoActionIdx = 0;
-  undoAction.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
-  undoSymbolIdx = 0;
-  undoSymbol.append(new QString(" i\n</>\n</>\n</>\n</>\n"));
+  // The first step is the state of being unchanged.
+  undoAction.push(' ');
+  undoAction.setUnchanged();
+  undoSymbol.push(' ');
+  undoSymbol.setUnchanged();
 
   isVerilog = false;
   creatingLib = false;
@@ -195,6 +196,7 @@ void Schematic::becomeCurrent(bool update)
 	tr("Edit Circuit Symbol\n\nEdits the symbol for this schematic"));
   }
 
+  GridsValid = false;   // lists are switched below
   if(symbolMode) {
     Nodes = &SymbolNodes;
     Wires = &SymbolWires;
@@ -208,8 +210,8 @@ void Schematic::becomeCurrent(bool update)
       setChanged(true, true);
     }
 
-    emit signalUndoState(undoSymbolIdx != 0);
-    emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
+    emit signalUndoState(undoSymbol.canUndo());
+    emit signalRedoState(undoSymbol.canRedo());
   }
   else {
     Nodes = &DocNodes;
@@ -218,8 +220,8 @@ void Schematic::becomeCurrent(bool update)
     Paintings = &DocPaints;
     Components = &DocComps;
 
-    emit signalUndoState(undoActionIdx != 0);
-    emit signalRedoState(undoActionIdx != undoAction.size()-1);
+    emit signalUndoState(undoAction.canUndo());
+    emit signalRedoState(undoAction.canRedo());
     if(update)
       reloadGraphs();   // load recent simulation data
   }
@@ -241,8 +243,10 @@ void Schematic::setName (const QString& Name_)
 }
 
 // ---------------------------------------------------
-// Sets the document to be changed or not to be changed.
-void Schematic::setChanged(bool c, bool fillStack, char Op)
+// Sets the document to be changed or not to be changed. With "fillStack"
+// an undo step is created from the elements noted by their lists, "all"
+// compares every element instead (for changes not noted).
+void Schematic::setChanged(bool c, bool fillStack, char Op, bool all)
 {
   if((!DocChanged) && c)
     emit signalFileChanged(true);
@@ -251,6 +255,7 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
   DocChanged = c;
 
   showBias = -1;   // schematic changed => bias points may be invalid
+  GridsValid = false;
 
   if(!fillStack)
     return;
@@ -258,51 +263,27 @@ void Schematic::setChanged(bool c, bool fillStack, char Op)
 
   // ................................................
   if(symbolMode) {  // for symbol edit mode
-    while(undoSymbol.size() > undoSymbolIdx + 1) {
-      delete undoSymbol.last();
-      undoSymbol.pop_back();
-    }
-
-    undoSymbol.append(new QString(createSymbolUndoString(Op)));
-    undoSymbolIdx++;
+    recordPaintings(undoSymbol, SymbolPaints);
+    undoSymbol.push(Op);
 
     emit signalUndoState(true);
     emit signalRedoState(false);
 
-    while(static_cast<unsigned int>(undoSymbol.size()) > QucsSettings.maxUndo) { // "while..." because
-      delete undoSymbol.first();
-      undoSymbol.pop_front();
-      undoSymbolIdx--;
-    }
+    undoSymbol.limit(QucsSettings.maxUndo); // "maxUndo" could be decreased meanwhile
     return;
   }
 
   // ................................................
   // for schematic edit mode
-  while(undoAction.size() > undoActionIdx + 1) {
-    delete undoAction.last();
-    undoAction.pop_back();
-  }
-
-  if(Op == 'm') {   // only one for move marker
-    if (undoAction.at(undoActionIdx)->at(0) == Op) {
-      delete undoAction.last();
-      undoAction.pop_back();
-      undoActionIdx--;
-    }
-  }
-
-  undoAction.append(new QString(createUndoString(Op)));
-  undoActionIdx++;
+  // only the elements differing from the recent state are stored,
+  // subsequent steps for move marker ('m') are merged into one
+  recordChanges(all);
+  undoAction.push(Op);
 
   emit signalUndoState(true);
   emit signalRedoState(false);
 
-  while(static_cast<unsigned int>(undoAction.size()) > QucsSettings.maxUndo) { // "while..." because
-    delete undoAction.first(); // "maxUndo" could be decreased meanwhile
-    undoAction.pop_front();
-    undoActionIdx--;
-  }
+  undoAction.limit(QucsSettings.maxUndo); // "maxUndo" could be decreased meanwhile
   return;
 }
 
@@ -1090,6 +1071,7 @@ bool Schematic::rotateElements()
 	x2 = pl->x1;
 	pl->x1 = pl->y1 - y1 + x1;
 	pl->y1 = x1 - x2 + y1;
+	touchElement(pl->pOwner);   // label of a not selected wire
 	break;
       case isNodeLabel:
 	pl = (WireLabel*)pe;
@@ -1169,6 +1151,7 @@ bool Schematic::mirrorXComponents()
       case isVWireLabel:
 	pl = (WireLabel*)pe;
 	pl->y1 = y1 - pl->y1;
+	touchElement(pl->pOwner);   // label of a not selected wire
 	break;
       case isNodeLabel:
 	pl = (WireLabel*)pe;
@@ -1237,6 +1220,7 @@ bool Schematic::mirrorYComponents()
       case isVWireLabel:
         pl = (WireLabel*)pe;
         pl->x1 = x1 - pl->x1;
+        touchElement(pl->pOwner);   // label of a not selected wire
         break;
       case isNodeLabel:
         pl = (WireLabel*)pe;
@@ -1309,23 +1293,14 @@ bool Schematic::load()
   if(!loadDocument()) return false;
   lastSaved = QDateTime::currentDateTime();
 
-  while(!undoAction.isEmpty()) {
-    delete undoAction.last();
-    undoAction.pop_back();
-  }
-  undoActionIdx = 0;
-  while(!undoSymbol.isEmpty()) {
-    delete undoSymbol.last();
-    undoSymbol.pop_back();
-  }
+  undoAction.clear();
+  undoSymbol.clear();
   symbolMode = true;
   setChanged(false, true); // "not changed" state, but put on undo stack
-  undoSymbolIdx = 0;
-  undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+  undoSymbol.setUnchanged();
   symbolMode = false;
-  setChanged(false, true); // "not changed" state, but put on undo stack
-  undoActionIdx = 0;
-  undoAction.at(undoActionIdx)->replace(1, 1, 'i');
+  setChanged(false, true, '*', true); // records of all elements
+  undoAction.setUnchanged();
 
   // The undo stack of the circuit symbol is initialized when first
   // entering its edit mode.
@@ -1358,18 +1333,9 @@ int Schematic::save()
   if(result >= 0) {
     setChanged(false);
 
-    QVector<QString *>::iterator it;
-    for (it = undoAction.begin(); it != undoAction.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
-    }
-    //(1) = 'i';   // state of being unchanged
-    undoAction.at(undoActionIdx)->replace(1, 1, 'i');
-
-    for (it = undoSymbol.begin(); it != undoSymbol.end(); it++) {
-      (*it)->replace(1, 1, ' '); //at(1) = ' '; state of being changed
-    }
-    //at(1) = 'i';   // state of being unchanged
-    undoSymbol.at(undoSymbolIdx)->replace(1, 1, 'i');
+    // all other states become "changed" ones
+    undoAction.setUnchanged();
+    undoSymbol.setUnchanged();
   }
   // update the subcircuit file lookup hashes
   QucsMain->updateSchNameHash();
@@ -1620,16 +1586,18 @@ int Schematic::adjustPortNumbers()
 bool Schematic::undo()
 {
   if(symbolMode) {
-    if (undoSymbolIdx == 0) { return false; }
+    if (!undoSymbol.undo()) { return false; }
 
-    rebuildSymbol(undoSymbol.at(--undoSymbolIdx));
+    applyChanges(undoSymbol, SymbolPaints);
+    recordPaintings(undoSymbol, SymbolPaints);
+    undoSymbol.discard();   // changes are already in the stack
     adjustPortNumbers();  // set port names
 
-    emit signalUndoState(undoSymbolIdx != 0);
-    emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
+    emit signalUndoState(undoSymbol.canUndo());
+    emit signalRedoState(undoSymbol.canRedo());
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i' && 
-        undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.isUnchanged() && 
+        undoAction.isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1640,20 +1608,22 @@ bool Schematic::undo()
 
 
   // ...... for schematic edit mode .......
-  if (undoActionIdx == 0) { return false; }
+  if (!undoAction.undo()) { return false; }
 
-  rebuild(undoAction.at(--undoActionIdx));
+  applyChanges(undoAction, DocPaints);
+  recordChanges(false);
+  undoAction.discard();   // changes are already in the stack
   reloadGraphs();  // load recent simulation data
 
-  emit signalUndoState(undoActionIdx != 0);
-  emit signalRedoState(undoActionIdx != undoAction.size()-1);
+  emit signalUndoState(undoAction.canUndo());
+  emit signalRedoState(undoAction.canRedo());
 
-  if(undoAction.at(undoActionIdx)->at(1) == 'i') {
-    if(undoSymbol.isEmpty()) {
+  if(undoAction.isUnchanged()) {
+    if(undoSymbol.size() == 0) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1667,16 +1637,18 @@ bool Schematic::undo()
 bool Schematic::redo()
 {
   if(symbolMode) {
-    if (undoSymbolIdx == undoSymbol.size() - 1) { return false; }
+    if (!undoSymbol.redo()) { return false; }
 
-    rebuildSymbol(undoSymbol.at(++undoSymbolIdx));
+    applyChanges(undoSymbol, SymbolPaints);
+    recordPaintings(undoSymbol, SymbolPaints);
+    undoSymbol.discard();   // changes are already in the stack
     adjustPortNumbers();  // set port names
 
-    emit signalUndoState(undoSymbolIdx != 0);
-    emit signalRedoState(undoSymbolIdx != undoSymbol.size()-1);
+    emit signalUndoState(undoSymbol.canUndo());
+    emit signalRedoState(undoSymbol.canRedo());
 
-    if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i'
-        && undoAction.at(undoActionIdx)->at(1) == 'i') {
+    if(undoSymbol.isUnchanged()
+        && undoAction.isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1688,20 +1660,22 @@ bool Schematic::redo()
 
   //
   // ...... for schematic edit mode .......
-  if (undoActionIdx == undoAction.size()-1) { return false; }
+  if (!undoAction.redo()) { return false; }
 
-  rebuild(undoAction.at(++undoActionIdx));
+  applyChanges(undoAction, DocPaints);
+  recordChanges(false);
+  undoAction.discard();   // changes are already in the stack
   reloadGraphs();  // load recent simulation data
 
-  emit signalUndoState(undoActionIdx != 0);
-  emit signalRedoState(undoActionIdx != undoAction.size()-1);
+  emit signalUndoState(undoAction.canUndo());
+  emit signalRedoState(undoAction.canRedo());
 
-  if (undoAction.at(undoActionIdx)->at(1) == 'i') {
-    if(undoSymbol.isEmpty()) {
+  if (undoAction.isUnchanged()) {
+    if(undoSymbol.size() == 0) {
       setChanged(false, false);
       return true;
     }
-    else if(undoSymbol.at(undoSymbolIdx)->at(1) == 'i') {
+    else if(undoSymbol.isUnchanged()) {
       setChanged(false, false);
       return true;
     }
@@ -1845,7 +1819,8 @@ bool Schematic::elementsOnGrid()
       count = true;
     }
 
-  if(count) setChanged(true, true);
+  // labels are moved in place, so compare the records of all elements
+  if(count) setChanged(true, true, '*', true);
   return count;
 }
 
@@ -31,6 +31,7 @@
 #include "node.h"
 #include "qucsdoc.h"
 #include "viewpainter.h"
+#include "undostack.h"
 #include "diagrams/diagram.h"
 #include "paintings/painting.h"
 #include "components/component.h"
@@ -40,6 +41,8 @@
 #include <QVector>
 #include <QStringList>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QSet>
 
 class QTextStream;
 class QTextEdit;
@@ -75,6 +78,24 @@ struct SubFile {
 };
 typedef QMap<QString, SubFile> SubMap;
 
+// subcircuit used within a cached subcircuit netlist
+struct SubUse {
+  QString File;          // file name identifier
+  QString Name;          // name as given in the subcircuit component
+  QStringList PortTypes; // its data types of in/out signals when netlisted
+};
+
+// netlist of a subcircuit schematic, kept across simulation runs
+struct SubNetlist {
+  QString File;          // schematic file ...
+  QDateTime Modified;    // ... its time stamp ...
+  qint64 Size;           // ... and size when netlisted
+  QString Netlist;       // definition of the subcircuit itself
+  QStringList PortTypes; // data types of in/out signals
+  QList<SubUse> Uses;    // subcircuits it contains
+};
+typedef QMap<QString, SubNetlist> SubNetlistMap;
+
 class Schematic : public Q3ScrollView, public QucsDoc {
   Q_OBJECT
 public:
@@ -82,7 +103,7 @@ public:
  ~Schematic();
 
   void setName(const QString&);
-  void setChanged(bool, bool fillStack=false, char Op='*');
+  void setChanged(bool, bool fillStack=false, char Op='*', bool all=false);
   void paintGrid(ViewPainter*, int, int, int, int);
   void print(QPrinter*, QPainter*, bool, bool);
 
@@ -127,11 +148,11 @@ public:
 
   // The pointers points to the current lists, either to the schematic
   // elements "Doc..." or to the symbol elements "SymbolPaints".
-  Q3PtrList<Wire>      *Wires, DocWires;
-  Q3PtrList<Node>      *Nodes, DocNodes;
+  WireList             *Wires, DocWires;
+  NodeList             *Nodes, DocNodes;
   Q3PtrList<Diagram>   *Diagrams, DocDiags;
   Q3PtrList<Painting>  *Paintings, DocPaints;
-  Q3PtrList<Component> *Components, DocComps;
+  ElementList<Component> *Components, DocComps;
 
   Q3PtrList<Painting>  SymbolPaints;  // symbol definition for subcircuit
 
@@ -152,10 +173,8 @@ public:
   int tmpViewX1, tmpViewY1, tmpViewX2, tmpViewY2;
   int tmpUsedX1, tmpUsedY1, tmpUsedX2, tmpUsedY2;
 
-  int undoActionIdx;
-  QVector<QString *> undoAction;
-  int undoSymbolIdx;
-  QVector<QString *> undoSymbol;    // undo stack for circuit symbol
+  UndoStack undoAction;
+  UndoStack undoSymbol;    // undo stack for circuit symbol
 
   /*! \brief Get (schematic) file reference */
   QFileInfo getFileInfo (void) { return FileInfo; }
@@ -202,6 +221,7 @@ private:
    ******************************************************************** */
 
 public:
+  void  touchElement(Element*);
   Node* insertNode(int, int, Element*);
   Node* selectedNode(int, int);
 
@@ -263,6 +283,14 @@ private:
   void copyComponents2(int&, int&, int&, int&, QList<Element *> *);
   bool copyComps2WiresPaints(int&, int&, int&, int&, QList<Element *> *);
   int  copyElements(int&, int&, int&, int&, QList<Element *> *);
+  void updateSelectGrids();
+
+  // Elements sorted by the area they can be selected in. The grids are
+  // rebuilt on demand after the schematic has changed.
+  ElementGrid NodeGrid, WireGrid, CompGrid, PaintGrid;
+  bool  GridsValid;
+  uint  GridChanges;   // insertions and removals of nodes and wires
+  float GridScale, GridCorr;
 
 
 /* ********************************************************************
@@ -274,7 +302,8 @@ private:
 public:
   static int testFile(const QString &);
   bool createLibNetlist(QTextStream*, QPlainTextEdit*, int);
-  bool createSubNetlist(QTextStream *, int&, QStringList&, QPlainTextEdit*, int);
+  bool createSubNetlist(QTextStream *, QTextStream *, int&, QStringList&,
+                        QPlainTextEdit*, int);
   void createSubNetlistPlain(QTextStream*, QPlainTextEdit*, int);
   int  prepareNetlist(QTextStream&, QStringList&, QPlainTextEdit*);
   QString createNetlist(QTextStream&, int);
@@ -296,10 +325,11 @@ private:
   QString createClipboardFile();
   bool    pasteFromClipboard(QTextStream *, Q3PtrList<Element>*);
 
-  QString createUndoString(char);
-  bool    rebuild(QString *);
-  QString createSymbolUndoString(char);
-  bool    rebuildSymbol(QString *);
+  QString undoRecord(Element*, int) const;
+  void    updateRecords(UndoStack&, int, const QHash<Element*, bool>&);
+  void    recordChanges(bool);
+  void    recordPaintings(UndoStack&, Q3PtrList<Painting>&);
+  bool    applyChanges(UndoStack&, Q3PtrList<Painting>&);
 
   static void createNodeSet(QStringList&, int&, Conductor*, Node*);
   void throughAllNodes(bool, QStringList&, int&);
@@ -309,6 +339,10 @@ private:
   void beginNetlistDigital(QTextStream &);
   void endNetlistDigital(QTextStream &);
   bool throughAllComps(QTextStream *, int&, QStringList&, QPlainTextEdit *, int);
+  bool netlistSubcircuit(const QString&, const QString&, QTextStream *, int&,
+                         QStringList&, QPlainTextEdit *, int, QStringList&);
+  QString subNetlistKey(const QString&, const QString&, int) const;
+  bool isSubNetlistCurrent(const QString&, int, QSet<QString>&) const;
 
   DigMap Signals; // collecting node names for VHDL signal declarations
   QStringList PortTypes;
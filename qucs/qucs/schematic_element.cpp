@@ -18,6 +18,7 @@
 #include <limits.h>
 
 #include "schematic.h"
+#include "paintings/arrow.h"
 #include <Q3PtrList>
 #include <QDebug>
 
@@ -28,29 +29,38 @@
    *****                                                         *****
    ******************************************************************* */
 
+// Notes a component, wire or node that was changed without being taken
+// out of its list, so that the next undo step looks at it.
+void Schematic::touchElement(Element *pe)
+{
+    if(!pe) return;
+    if(pe->Type & isComponent) Components->touch((Component*)pe);
+    else if(pe->Type == isWire) Wires->touch((Wire*)pe);
+    else if(pe->Type == isNode) Nodes->touch((Node*)pe);
+}
+
+// ---------------------------------------------------
+
 // Inserts a port into the schematic and connects it to another node if
 // the coordinates are identical. The node is returned.
 Node* Schematic::insertNode(int x, int y, Element *e)
 {
     Node *pn;
     // check if new node lies upon existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == x) if(pn->cy == y)
-            {
-                pn->Connections.append(e);
-                break;
-            }
-
-    if(pn == 0)   // create new node, if no existing one lies at this position
+    pn = Nodes->findAt(x, y);
+    if(pn != 0)
     {
-        pn = new Node(x, y);
-        Nodes->append(pn);
-        pn->Connections.append(e);  // connect schematic node to component node
+        pn->Connections.append(e);
+        return pn;   // return, if node is not new
     }
-    else return pn;   // return, if node is not new
+
+    // create new node, if no existing one lies at this position
+    pn = new Node(x, y);
+    Nodes->append(pn);
+    pn->Connections.append(e);  // connect schematic node to component node
 
     // check if the new node lies upon an existing wire
-    for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
+    foreach(Wire *pw, Wires->crossing(x, y))
     {
         if(pw->x1 == x)
         {
@@ -75,11 +85,7 @@ Node* Schematic::insertNode(int x, int y, Element *e)
 // ---------------------------------------------------
 Node* Schematic::selectedNode(int x, int y)
 {
-    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next()) // test nodes
-        if(pn->getSelected(x, y))
-            return pn;
-
-    return 0;
+    return Nodes->findNear(x, y);
 }
 
 
@@ -96,8 +102,7 @@ int Schematic::insertWireNode1(Wire *w)
 {
     Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next()) // check every node
-        if(pn->cx == w->x1) if(pn->cy == w->y1) break;
+    pn = Nodes->findAt(w->x1, w->y1);
 
     if(pn != 0)
     {
@@ -109,7 +114,7 @@ int Schematic::insertWireNode1(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    foreach(Wire *ptr2, Wires->crossing(w->x1, w->y1))
     {
         if(ptr2->x1 == w->x1)
         {
@@ -346,8 +351,7 @@ int Schematic::insertWireNode2(Wire *w)
 {
     Node *pn;
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())  // check every node
-        if(pn->cx == w->x2) if(pn->cy == w->y2) break;
+    pn = Nodes->findAt(w->x2, w->y2);
 
     if(pn != 0)
     {
@@ -359,7 +363,7 @@ int Schematic::insertWireNode2(Wire *w)
 
 
     // check if the new node lies upon an existing wire
-    for(Wire *ptr2 = Wires->first(); ptr2 != 0; ptr2 = Wires->next())
+    foreach(Wire *ptr2, Wires->crossing(w->x2, w->y2))
     {
         if(ptr2->x1 == w->x2)
         {
@@ -620,39 +624,19 @@ int Schematic::insertWire(Wire *w)
     // Check if the new line covers existing nodes.
     // In order to also check new appearing wires -> use "for"-loop
     for(pw = Wires->current(); pw != 0; pw = Wires->next())
-        for(pn = Nodes->first(); pn != 0; )    // check every node
+        for(;;)
         {
-            if(pn->cx == pw->x1)
+            // find the covered node nearest to the beginning of the wire
+            // (the wire gets shorter or the node is deleted in every turn)
+            pn = 0;
+            foreach(Node *pn1, Nodes->findIn(pw->x1, pw->y1, pw->x2, pw->y2))
             {
-                if(pn->cy <= pw->y1)
-                {
-                    pn = Nodes->next();
-                    continue;
-                }
-                if(pn->cy >= pw->y2)
-                {
-                    pn = Nodes->next();
-                    continue;
-                }
-            }
-            else if(pn->cy == pw->y1)
-            {
-                if(pn->cx <= pw->x1)
-                {
-                    pn = Nodes->next();
-                    continue;
-                }
-                if(pn->cx >= pw->x2)
-                {
-                    pn = Nodes->next();
-                    continue;
-                }
-            }
-            else
-            {
-                pn = Nodes->next();
-                continue;
+                if(pn1->cx+pn1->cy <= pw->x1+pw->y1) continue;
+                if(pn1->cx+pn1->cy >= pw->x2+pw->y2) continue;
+                if(pn) if(pn->cx+pn->cy < pn1->cx+pn1->cy) continue;
+                pn = pn1;
             }
+            if(pn == 0) break;
 
             n1 = 2;
             n2 = 3;
@@ -711,8 +695,6 @@ int Schematic::insertWire(Wire *w)
             pw->y1 = pn2->cy;
             pw->Port1 = pn2;
             pn2->Connections.append(pw);
-
-            pn = Nodes->next();
         }
 
     if (Wires->containsRef (w))  // if two wire lines with different labels ...
@@ -743,11 +725,7 @@ void Schematic::selectWireLine(Element *pe, Node *pn, bool ctrl)
 // ---------------------------------------------------
 Wire* Schematic::selectedWire(int x, int y)
 {
-    for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
-        if(pw->getSelected(x, y))
-            return pw;
-
-    return 0;
+    return Wires->findNear(x, y);
 }
 
 // ---------------------------------------------------
@@ -757,6 +735,7 @@ Wire* Schematic::splitWire(Wire *pw, Node *pn)
     Wire *newWire = new Wire(pn->cx, pn->cy, pw->x2, pw->y2, pn, pw->Port2);
     newWire->isSelected = pw->isSelected;
 
+    touchElement(pw);
     pw->x2 = pn->cx;
     pw->y2 = pn->cy;
     pw->Port2 = pn;
@@ -810,6 +789,7 @@ bool Schematic::oneTwoWires(Node *n)
                         e1->Label->Type = isVWireLabel;
                 }
 
+                touchElement(e1);
                 e1->x2 = e2->x2;
                 e1->y2 = e2->y2;
                 e1->Port2 = e2->Port2;
@@ -968,6 +948,91 @@ void Schematic::markerUpDown(bool up, Q3PtrList<Element> *Elements)
    *****                                                         *****
    ******************************************************************* */
 
+/* Files the nodes, wires, components and paintings into the grids used
+   to select them, unless the grids are still up to date. Nodes and
+   wires are filed together with their labels, components together with
+   their text, and paintings including the area for resizing them.
+*/
+void Schematic::updateSelectGrids()
+{
+    // Nodes and wires are created and deleted by many edit operations,
+    // so their lists count it. All other changes call setChanged().
+    float Corr = textCorr();
+    uint  Changes = Nodes->changes() + Wires->changes();
+    if(GridsValid) if(GridChanges == Changes)
+        if(GridScale == Scale) if(GridCorr == Corr)
+            if(CompGrid.count() == Components->count())
+                if(PaintGrid.count() == Paintings->count())
+                    return;
+
+    GridsValid = true;
+    GridChanges = Changes;
+    GridScale = Scale;
+    GridCorr = Corr;
+    NodeGrid.clear();
+    WireGrid.clear();
+    CompGrid.clear();
+    PaintGrid.clear();
+
+    int x1, y1, x2, y2;
+    WireLabel *pl;
+    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next())
+    {
+        x1 = pn->cx-5;
+        y1 = pn->cy-5;
+        x2 = pn->cx+5;
+        y2 = pn->cy+5;
+        pl = pn->Label;
+        if(pl)     // rectangle selection takes the label above its origin
+        {
+            x1 = qMin(x1, qMin(pl->x1, pl->x1+pl->x2));
+            x2 = qMax(x2, qMax(pl->x1, pl->x1+pl->x2));
+            y1 = qMin(y1, qMin(pl->y1-pl->y2, pl->y1+pl->y2));
+            y2 = qMax(y2, qMax(pl->y1-pl->y2, pl->y1+pl->y2));
+        }
+        NodeGrid.insert(pn, x1, y1, x2, y2);
+    }
+
+    for(Wire *pw = Wires->first(); pw != 0; pw = Wires->next())
+    {
+        x1 = pw->x1-5;
+        y1 = pw->y1-5;
+        x2 = pw->x2+5;
+        y2 = pw->y2+5;
+        pl = pw->Label;
+        if(pl)
+        {
+            x1 = qMin(x1, qMin(pl->x1, pl->x1+pl->x2));
+            x2 = qMax(x2, qMax(pl->x1, pl->x1+pl->x2));
+            y1 = qMin(y1, qMin(pl->y1, pl->y1+pl->y2));
+            y2 = qMax(y2, qMax(pl->y1, pl->y1+pl->y2));
+        }
+        WireGrid.insert(pw, x1, y1, x2, y2);
+    }
+
+    for(Component *pc = Components->first(); pc != 0; pc = Components->next())
+    {
+        pc->entireBounds(x1, y1, x2, y2, Corr);
+        CompGrid.insert(pc, x1, y1, x2, y2);
+    }
+
+    int d = int(5.0 / Scale) + 1;  // area for line select and resizing
+    for(Painting *pp = Paintings->first(); pp != 0; pp = Paintings->next())
+    {
+        pp->Bounding(x1, y1, x2, y2);
+        if(pp->Name == "Arrow ")   // the head may lie beside the line
+        {
+            Arrow *pa = (Arrow*)pp;
+            x1 = qMin(x1, pp->cx+qMin(pa->xp1, pa->xp2));
+            x2 = qMax(x2, pp->cx+qMax(pa->xp1, pa->xp2));
+            y1 = qMin(y1, pp->cy+qMin(pa->yp1, pa->yp2));
+            y2 = qMax(y2, pp->cy+qMax(pa->yp1, pa->yp2));
+        }
+        PaintGrid.insert(pp, x1-d, y1-d, x2+d, y2+d);
+    }
+}
+
+// ---------------------------------------------------
 /* Selects the element that contains the coordinates x/y.
    Returns the pointer to the element.
 
@@ -985,9 +1050,12 @@ Element* Schematic::selectElement(float fX, float fY, bool flag, int *index)
     WireLabel *pl = 0;
     float Corr = textCorr(); // for selecting text
 
+    updateSelectGrids();
+
     // test all nodes and their labels
-    for(Node *pn = Nodes->last(); pn != 0; pn = Nodes->prev())
+    foreach(Element *pe, NodeGrid.findAt(x, y))
     {
+        Node *pn = (Node*)pe;
         if(!flag)
         {
             // The element cannot be deselected
@@ -1040,8 +1108,9 @@ Element* Schematic::selectElement(float fX, float fY, bool flag, int *index)
     }
 
     // test all wires and wire labels
-    for(Wire *pw = Wires->last(); pw != 0; pw = Wires->prev())
+    foreach(Element *pe, WireGrid.findAt(x, y))
     {
+        Wire *pw = (Wire*)pe;
         if(pw->getSelected(x, y))
         {
             if(flag)
@@ -1094,8 +1163,9 @@ Element* Schematic::selectElement(float fX, float fY, bool flag, int *index)
     }
 
     // test all components
-    for(Component *pc = Components->last(); pc != 0; pc = Components->prev())
+    foreach(Element *pe, CompGrid.findAt(x, y))
     {
+        Component *pc = (Component*)pe;
         if(pc->getSelected(x, y))
         {
             if(flag)
@@ -1251,8 +1321,9 @@ Element* Schematic::selectElement(float fX, float fY, bool flag, int *index)
     }
 
     // test all paintings
-    for(Painting *pp = Paintings->last(); pp != 0; pp = Paintings->prev())
+    foreach(Element *pe, PaintGrid.findAt(x, y))
     {
+        Painting *pp = (Painting*)pe;
         if(pp->isSelected)
         {
             if(pp->resizeTouched(fX, fY, Corr))
@@ -1475,10 +1546,12 @@ void Schematic::deselectElements(Element *e)
 }
 
 // ---------------------------------------------------
-// Selects elements that lie within the rectangle x1/y1, x2/y2.
+// Selects elements that lie within the rectangle x1/y1, x2/y2. All
+// other elements are deselected, unless 'flag' is true. Returns the
+// number of elements within the rectangle.
 int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
 {
-    int  z=0;   // counts selected elements
+    int  z=0;   // counts elements within the rectangle
     int  cx1, cy1, cx2, cy2;
 
     // exchange rectangle coordinates to obtain x1 < x2 and y1 < y2
@@ -1491,56 +1564,50 @@ int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
     y1 = cy1;
     y2 = cy2;
 
-    // test all components
-    for(Component *pc = Components->first(); pc != 0; pc = Components->next())
+    updateSelectGrids();
+    if(!flag) deselectElements(0);
+
+    // test all components within the rectangle
+    foreach(Element *pe, CompGrid.findIn(x1, y1, x2, y2))
     {
+        Component *pc = (Component*)pe;
         pc->Bounding(cx1, cy1, cx2, cy2);
         if(cx1 >= x1) if(cx2 <= x2) if(cy1 >= y1) if(cy2 <= y2)
                     {
                         pc->isSelected = true;
                         z++;
-                        continue;
                     }
-        if(pc->isSelected &= flag) z++;
     }
 
 
-    Wire *pw;
-    for(pw = Wires->first(); pw != 0; pw = Wires->next())   // test all wires
+    WireLabel *pl=0;
+    foreach(Element *pe, WireGrid.findIn(x1, y1, x2, y2))   // test all wires
     {
+        Wire *pw = (Wire*)pe;
         if(pw->x1 >= x1) if(pw->x2 <= x2) if(pw->y1 >= y1) if(pw->y2 <= y2)
                     {
                         pw->isSelected = true;
                         z++;
-                        continue;
                     }
-        if(pw->isSelected &= flag) z++;
-    }
-
 
-    // test all wire labels *********************************
-    WireLabel *pl=0;
-    for(pw = Wires->first(); pw != 0; pw = Wires->next())
-    {
-        if(pw->Label)
+        // test the wire label
+        pl = pw->Label;
+        if(pl)
         {
-            pl = pw->Label;
             if(pl->x1 >= x1) if((pl->x1+pl->x2) <= x2)
                     if(pl->y1 >= y1) if((pl->y1+pl->y2) <= y2)
                         {
                             pl->isSelected = true;
                             z++;
-                            continue;
                         }
-            if(pl->isSelected &= flag) z++;
         }
     }
 
 
     // test all node labels *************************************
-    for(Node *pn = Nodes->first(); pn != 0; pn = Nodes->next())
+    foreach(Element *pe, NodeGrid.findIn(x1, y1, x2, y2))
     {
-        pl = pn->Label;
+        pl = ((Node*)pe)->Label;
         if(pl)
         {
             if(pl->x1 >= x1) if((pl->x1+pl->x2) <= x2)
@@ -1548,9 +1615,7 @@ int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
                         {
                             pl->isSelected = true;
                             z++;
-                            continue;
                         }
-            if(pl->isSelected &= flag) z++;
         }
     }
 
@@ -1558,12 +1623,8 @@ int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
     // test all diagrams *******************************************
     for(Diagram *pd = Diagrams->first(); pd != 0; pd = Diagrams->next())
     {
-        // test graphs of diagram
+        // test markers of graphs
         foreach(Graph *pg, pd->Graphs)
-        {
-            if(pg->isSelected &= flag) z++;
-
-            // test markers of graph
             foreach(Marker *pm, pg->Markers)
             {
                 pm->Bounding(cx1, cy1, cx2, cy2);
@@ -1571,11 +1632,8 @@ int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
                             {
                                 pm->isSelected = true;
                                 z++;
-                                continue;
                             }
-                if(pm->isSelected &= flag) z++;
             }
-        }
 
         // test diagram itself
         pd->Bounding(cx1, cy1, cx2, cy2);
@@ -1583,22 +1641,19 @@ int Schematic::selectElements(int x1, int y1, int x2, int y2, bool flag)
                     {
                         pd->isSelected = true;
                         z++;
-                        continue;
                     }
-        if(pd->isSelected &= flag) z++;
     }
 
     // test all paintings *******************************************
-    for(Painting *pp = Paintings->first(); pp != 0; pp = Paintings->next())
+    foreach(Element *pe, PaintGrid.findIn(x1, y1, x2, y2))
     {
+        Painting *pp = (Painting*)pe;
         pp->Bounding(cx1, cy1, cx2, cy2);
         if(cx1 >= x1) if(cx2 <= x2) if(cy1 >= y1) if(cy2 <= y2)
                     {
                         pp->isSelected = true;
                         z++;
-                        continue;
                     }
-        if(pp->isSelected &= flag) z++;
     }
 
     return z;
@@ -1986,6 +2041,7 @@ bool Schematic::deleteElements()
         if(pw->Label)
             if(pw->Label->isSelected)
             {
+                touchElement(pw);
                 delete pw->Label;
                 pw->Label = 0;
                 sel = true;
@@ -2005,6 +2061,7 @@ bool Schematic::deleteElements()
         if(pn->Label)
             if(pn->Label->isSelected)
             {
+                touchElement(pn);
                 delete pn->Label;
                 pn->Label = 0;
                 sel = true;
@@ -2531,6 +2588,7 @@ void Schematic::insertRawComponent(Component *c, bool noOptimize)
         Element *pe = getWireLabel(c->Ports.first()->Connection);
         if(pe) if((pe->Type & isComponent) == 0)
             {
+                touchElement(pe);
                 delete ((Conductor*)pe)->Label;
                 ((Conductor*)pe)->Label = 0;
             }
@@ -2544,6 +2602,7 @@ void Schematic::recreateComponent(Component *Comp)
 
     WireLabel **plMem=0, **pl;
     int PortCount = Comp->Ports.count();
+    touchElement(Comp);
 
     if(PortCount > 0)
     {
@@ -2554,6 +2613,7 @@ void Schematic::recreateComponent(Component *Comp)
             if(pp->Connection->Connections.count() < 2)
             {
                 *(pl++) = pp->Connection->Label;
+                touchElement(pp->Connection);
                 pp->Connection->Label = 0;
             }
             else  *(pl++) = 0;
@@ -2619,6 +2679,7 @@ void Schematic::insertComponent(Component *c)
             Element *pe = getWireLabel(c->Ports.first()->Connection);
             if(pe) if((pe->Type & isComponent) == 0)
                 {
+                    touchElement(pe);
                     delete ((Conductor*)pe)->Label;
                     ((Conductor*)pe)->Label = 0;
                 }
@@ -2664,6 +2725,7 @@ void Schematic::activateCompsWithinRect(int x1, int y1, int x2, int y2)
         pc->Bounding(cx1, cy1, cx2, cy2);
         if(cx1 >= x1) if(cx2 <= x2) if(cy1 >= y1) if(cy2 <= y2)
                     {
+                        touchElement(pc);
                         a = pc->isActive - 1;
 
                         if(pc->Ports.count() > 1)
@@ -2695,6 +2757,7 @@ bool Schematic::activateSpecifiedComponent(int x, int y)
         pc->Bounding(x1, y1, x2, y2);
         if(x >= x1) if(x <= x2) if(y >= y1) if(y <= y2)
                     {
+                        touchElement(pc);
                         a = pc->isActive - 1;
 
                         if(pc->Ports.count() > 1)
@@ -2725,6 +2788,7 @@ bool Schematic::activateSelectedComponents()
     for(Component *pc = Components->first(); pc != 0; pc = Components->next())
         if(pc->isSelected)
         {
+            touchElement(pc);
             a = pc->isActive - 1;
 
             if(pc->Ports.count() > 1)
@@ -2754,6 +2818,7 @@ void Schematic::setCompPorts(Component *pc)
     WireLabel *pl;
     Q3PtrList<WireLabel> LabelCache;
 
+    touchElement(pc);
     foreach(Port *pp, pc->Ports)
     {
         pp->Connection->Connections.removeRef((Element*)pc);// delete connections
@@ -2973,6 +3038,7 @@ void Schematic::oneLabel(Node *n1)
         {
             if(named)
             {
+                touchElement(pn);
                 delete pn->Label;
                 pn->Label = 0;    // erase double names
             }
@@ -2993,6 +3059,7 @@ void Schematic::oneLabel(Node *n1)
                         named = true;
                         if(pl)
                         {
+                            touchElement(pl->pOwner);
                             pl->pOwner->Label = 0;
                             delete pl;
                         }
@@ -3014,6 +3081,7 @@ void Schematic::oneLabel(Node *n1)
             {
                 if(named)
                 {
+                    touchElement(pw);
                     delete pw->Label;
                     pw->Label = 0;    // erase double names
                 }
@@ -3035,9 +3103,7 @@ int Schematic::placeNodeLabel(WireLabel *pl)
     int y = pl->cy;
 
     // check if new node lies upon an existing node
-    for(pn = Nodes->first(); pn != 0; pn = Nodes->next())
-        if(pn->cx == x) if(pn->cy == y) break;
-
+    pn = Nodes->findAt(x, y);
     if(!pn)  return -1;
 
     Element *pe = getWireLabel(pn);
@@ -3049,10 +3115,12 @@ int Schematic::placeNodeLabel(WireLabel *pl)
             return -2;  // ground potential
         }
 
+        touchElement(pe);
         delete ((Conductor*)pe)->Label;
         ((Conductor*)pe)->Label = 0;
     }
 
+    touchElement(pn);
     pn->Label = pl;   // insert node label
     pl->Type = isNodeLabel;
     pl->pOwner = pn;
@@ -3113,7 +3181,10 @@ void Schematic::insertNodeLabel(WireLabel *pl)
     if(pw)    // lies label on existing wire ?
     {
         if(getWireLabel(pw->Port1) == 0)  // wire not yet labeled ?
+        {
+            touchElement(pw);
             pw->setName(pl->Name, pl->initValue, 0, pl->cx, pl->cy);
+        }
 
         delete pl;
         return;
@@ -3157,6 +3228,7 @@ void Schematic::copyLabels(int& x1, int& y1, int& x2, int& y2,
                 if(pl->x1+pl->x2 > x2) x2 = pl->x1+pl->x2;
                 if(pl->y1 > y2) y2 = pl->y1;
                 ElementCache->append(pl);
+                touchElement(pl->pOwner);
                 pl->pOwner->Label = 0;   // erase connection
                 pl->pOwner = 0;
             }
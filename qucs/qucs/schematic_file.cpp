@@ -24,6 +24,7 @@
 #include <QDir>
 #include <QStringList>
 #include <QPlainTextEdit>
+#include <QTextDocument>
 #include <Q3PtrList>
 #include <QTextStream>
 #include <QList>
@@ -47,6 +48,11 @@
 // global to also work within the subcircuits.
 SubMap FileList;
 
+// Netlists of subcircuit schematics created by former simulation runs.
+// A subcircuit is netlisted again only if its file or the port types of
+// one of its subcircuits have changed.
+SubNetlistMap SubNetlists;
+
 
 // -------------------------------------------------------------
 // Creates a Qucs file format (without document properties) in the returning
@@ -620,16 +626,15 @@ void Schematic::simpleInsertComponent(Component *c)
     y = pp->y+c->cy;
 
     // check if new node lies upon existing node
-    for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-      if(pn->cx == x) if(pn->cy == y) {
-	if (!pn->DType.isEmpty()) {
-	  pp->Type = pn->DType;
-	}
-	if (!pp->Type.isEmpty()) {
-	  pn->DType = pp->Type;
-	}
-	break;
+    pn = DocNodes.findAt(x, y);
+    if(pn != 0) {
+      if (!pn->DType.isEmpty()) {
+	pp->Type = pn->DType;
+      }
+      if (!pp->Type.isEmpty()) {
+	pn->DType = pp->Type;
       }
+    }
 
     if(pn == 0) { // create new node, if no existing one lies at this position
       pn = new Node(x, y);
@@ -683,8 +688,7 @@ void Schematic::simpleInsertWire(Wire *pw)
 {
   Node *pn;
   // check if first wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x1) if(pn->cy == pw->y1) break;
+  pn = DocNodes.findAt(pw->x1, pw->y1);
 
   if(!pn) {   // create new node, if no existing one lies at this position
     pn = new Node(pw->x1, pw->y1);
@@ -697,6 +701,7 @@ void Schematic::simpleInsertWire(Wire *pw)
       pn->Label->Type = isNodeLabel;
       pn->Label->pOwner = pn;
     }
+    DocNodes.touch(pn);
     delete pw;           // delete wire because this is not a wire
     return;
   }
@@ -704,8 +709,7 @@ void Schematic::simpleInsertWire(Wire *pw)
   pw->Port1 = pn;
 
   // check if second wire node lies upon existing node
-  for(pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->cx == pw->x2) if(pn->cy == pw->y2) break;
+  pn = DocNodes.findAt(pw->x2, pw->y2);
 
   if(!pn) {   // create new node, if no existing one lies at this position
     pn = new Node(pw->x2, pw->y2);
@@ -937,102 +941,174 @@ bool Schematic::loadDocument()
 }
 
 // -------------------------------------------------------------
-// Creates a Qucs file format (without document properties) in the returning
-// string. This is used to save state for undo operation.
-QString Schematic::createUndoString(char Op)
+// Returns the record of the element "pe" for the undo stack, i.e. its
+// line(s) in the Qucs file format. A node is only represented by its
+// label (saved as a wire with length zero), so nodes without label have
+// no record.
+QString Schematic::undoRecord(Element *pe, int Kind) const
 {
-  Wire *pw;
-  Diagram *pd;
-  Painting *pp;
-  Component *pc;
-
-  // Build element document.
-  QString s = "  \n";
-  s.replace(0,1,Op);
-  for(pc = DocComps.first(); pc != 0; pc = DocComps.next()) {
-    QTextStream str(&s);
-    saveComponent(str, pc);
-    s += "\n";
+  QString s;
+  switch(Kind) {
+    case UndoStack::CompRecord: {
+        QTextStream str(&s);
+        saveComponent(str, (Component*)pe);
+      }
+      break;
+    case UndoStack::WireRecord:
+      s = ((Wire*)pe)->save();
+      break;
+    case UndoStack::LabelRecord:
+      if(((Node*)pe)->Label)  s = ((Node*)pe)->Label->save();
+      break;
+    case UndoStack::DiagRecord:
+      s = ((Diagram*)pe)->save();
+      break;
+    case UndoStack::PaintRecord:
+      s = "<"+((Painting*)pe)->save()+">";
+      break;
   }
-  s += "</>\n";  // short end flag
-
-  for(pw = DocWires.first(); pw != 0; pw = DocWires.next())
-    s += pw->save()+"\n";
-  // save all labeled nodes as wires
-  for(Node *pn = DocNodes.first(); pn != 0; pn = DocNodes.next())
-    if(pn->Label) s += pn->Label->save()+"\n";
-  s += "</>\n";
-
-  for(pd = DocDiags.first(); pd != 0; pd = DocDiags.next())
-    s += pd->save()+"\n";
-  s += "</>\n";
-
-  for(pp = DocPaints.first(); pp != 0; pp = DocPaints.next())
-    s += "<"+pp->save()+">\n";
-  s += "</>\n";
-
   return s;
 }
 
 // -------------------------------------------------------------
-// Same as "createUndoString(char Op)" but for symbol edit mode.
-QString Schematic::createSymbolUndoString(char Op)
+// Passes the records of the elements to the undo stack. Elements with
+// the value "false" are not listed anymore and must not be accessed.
+void Schematic::updateRecords(UndoStack& Stack, int Kind,
+                              const QHash<Element*, bool>& Elements)
 {
-  Painting *pp;
-
-  // Build element document.
-  QString s = "  \n";
-  s.replace(0,1,Op);
-  s += "</>\n";  // short end flag for components
-  s += "</>\n";  // short end flag for wires
-  s += "</>\n";  // short end flag for diagrams
-
-  for(pp = SymbolPaints.first(); pp != 0; pp = SymbolPaints.next())
-    s += "<"+pp->save()+">\n";
-  s += "</>\n";
+  QHash<Element*, bool>::const_iterator it;
+  for(it = Elements.constBegin(); it != Elements.constEnd(); ++it)
+    if(it.value())  Stack.update(it.key(), Kind, undoRecord(it.key(), Kind));
+    else  Stack.update(it.key(), Kind, QString());
+}
 
-  return s;
+// -------------------------------------------------------------
+// Returns all elements of "List" (value "true") and all elements with a
+// record in "Stack" that are not listed anymore (value "false").
+template <class T>
+static QHash<Element*, bool> allElements(Q3PtrList<T>& List,
+                                         const UndoStack& Stack, int Kind)
+{
+  QHash<Element*, bool> Elements;
+  foreach(Element *pe, Stack.elements(Kind))
+    Elements.insert(pe, false);
+  for(Q3PtrListIterator<T> it(List); it.current(); ++it)
+    Elements.insert(it.current(), true);
+  return Elements;
 }
 
 // -------------------------------------------------------------
-// Is quite similiar to "loadDocument()" but with less error checking.
-// Used for "undo" function.
-bool Schematic::rebuild(QString *s)
+// Collects the changes of the schematic elements for the next undo step.
+// Only the components, wires and nodes noted by their lists (inserted,
+// removed or touched) are compared, unless "all" is set by actions that
+// change elements without noting them. Diagrams and paintings are few,
+// so they are always compared completely.
+void Schematic::recordChanges(bool all)
 {
-  DocWires.clear();	// delete whole document
-  DocNodes.clear();
-  DocComps.clear();
-  DocDiags.clear();
-  DocPaints.clear();
+  if(all) {
+    DocComps.takeTouched();
+    DocWires.takeTouched();
+    DocNodes.takeTouched();
+    updateRecords(undoAction, UndoStack::CompRecord,
+                  allElements(DocComps, undoAction, UndoStack::CompRecord));
+    updateRecords(undoAction, UndoStack::WireRecord,
+                  allElements(DocWires, undoAction, UndoStack::WireRecord));
+    updateRecords(undoAction, UndoStack::LabelRecord,
+                  allElements(DocNodes, undoAction, UndoStack::LabelRecord));
+  }
+  else {
+    updateRecords(undoAction, UndoStack::CompRecord, DocComps.takeTouched());
+    updateRecords(undoAction, UndoStack::WireRecord, DocWires.takeTouched());
+    updateRecords(undoAction, UndoStack::LabelRecord, DocNodes.takeTouched());
+  }
 
-  QString Line;
-  QTextStream stream(s, QIODevice::ReadOnly);
-  Line = stream.readLine();  // skip identity byte
+  updateRecords(undoAction, UndoStack::DiagRecord,
+                allElements(DocDiags, undoAction, UndoStack::DiagRecord));
+  recordPaintings(undoAction, DocPaints);
+}
 
-  // read content *************************
-  if(!loadComponents(&stream))  return false;
-  if(!loadWires(&stream))  return false;
-  if(!loadDiagrams(&stream, &DocDiags))  return false;
-  if(!loadPaintings(&stream, &DocPaints)) return false;
+// -------------------------------------------------------------
+// Same as "recordChanges()" but only for the paintings "List", e.g. for
+// symbol edit mode.
+void Schematic::recordPaintings(UndoStack& Stack, Q3PtrList<Painting>& List)
+{
+  updateRecords(Stack, UndoStack::PaintRecord,
+                allElements(List, Stack, UndoStack::PaintRecord));
+}
 
-  return true;
+// -------------------------------------------------------------
+// Disconnects the element "pe" from the node "pn". The node is deleted if
+// it is open and has no label.
+static void detachNode(NodeList& Nodes, Node *pn, Element *pe)
+{
+  pn->Connections.removeRef(pe);
+  if(pn->Connections.isEmpty())
+    if(!pn->Label)  Nodes.removeRef(pn);
 }
 
 // -------------------------------------------------------------
-// Same as "rebuild(QString *s)" but for symbol edit mode.
-bool Schematic::rebuildSymbol(QString *s)
+// Applies the changes handed out by "undo()" or "redo()" of "Stack": The
+// elements with the former records are deleted, the ones with the new
+// records are created like in "loadDocument()", i.e. without optimizing
+// the wires. "Paints" is the list the painting records belong to.
+bool Schematic::applyChanges(UndoStack& Stack, Q3PtrList<Painting>& Paints)
 {
-  SymbolPaints.clear();	// delete whole document
+  QString Insert[UndoStack::Records];
+  Element *pe;
+  Component *pc;
+  Wire *pw;
+  Node *pn;
 
-  QString Line;
-  QTextStream stream(s, QIODevice::ReadOnly);
-  Line = stream.readLine();  // skip identity byte
+  foreach(const UndoStack::Change& c, Stack.changes()) {
+    if(!c.After.isEmpty())  Insert[c.Kind] += c.After + "\n";
+    if(c.Before.isEmpty())  continue;
 
-  // read content *************************
-  Line = stream.readLine();  // skip components
-  Line = stream.readLine();  // skip wires
-  Line = stream.readLine();  // skip diagrams
-  if(!loadPaintings(&stream, &SymbolPaints)) return false;
+    pe = Stack.find(c.Kind, c.Before);
+    if(!pe)  continue;   // should never happen
+    // forget the record at once, another element may have the same one
+    Stack.update(pe, c.Kind, QString());
+
+    switch(c.Kind) {
+      case UndoStack::CompRecord:
+        pc = (Component*)pe;
+        foreach(Port *pp, pc->Ports)
+          detachNode(DocNodes, pp->Connection, pc);
+        DocComps.removeRef(pc);
+        break;
+      case UndoStack::WireRecord:
+        pw = (Wire*)pe;
+        if(pw->Label)  delete pw->Label;
+        pw->Label = 0;
+        detachNode(DocNodes, pw->Port1, pw);
+        detachNode(DocNodes, pw->Port2, pw);
+        DocWires.removeRef(pw);
+        break;
+      case UndoStack::LabelRecord:
+        pn = (Node*)pe;
+        delete pn->Label;
+        pn->Label = 0;
+        if(pn->Connections.isEmpty())  DocNodes.removeRef(pn);
+        break;
+      case UndoStack::DiagRecord:
+        DocDiags.removeRef((Diagram*)pe);
+        break;
+      case UndoStack::PaintRecord:
+        Paints.removeRef((Painting*)pe);
+        break;
+    }
+  }
+
+  // node labels are loaded as wires with length zero
+  QString s = Insert[UndoStack::CompRecord] + "</>\n"
+            + Insert[UndoStack::WireRecord] + Insert[UndoStack::LabelRecord]
+            + "</>\n" + Insert[UndoStack::DiagRecord] + "</>\n"
+            + Insert[UndoStack::PaintRecord] + "</>\n";
+  QTextStream stream(&s, QIODevice::ReadOnly);
+
+  if(!loadComponents(&stream))  return false;
+  if(!loadWires(&stream))  return false;
+  if(!loadDiagrams(&stream, &DocDiags))  return false;
+  if(!loadPaintings(&stream, &Paints)) return false;
 
   return true;
 }
@@ -1280,44 +1356,24 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
       FileList.insert(f, sub);
 
 
-      // load subcircuit schematic
+      // load subcircuit schematic (or take its former netlist)
       s = pc->Props.first()->Value;
-      Schematic *d = new Schematic(0, pc->getSubcircuitFile());
-      if(!d->loadDocument())      // load document if possible
-      {
-          delete d;
-          /// \todo implement error/warning message dispatcher for GUI and CLI modes.
-          QString message = QObject::tr("ERROR: Cannot load subcircuit \"%1\".").arg(s);
-          if (QucsMain) // GUI is running
-            ErrText->appendPlainText(message);
-          else // command line
-            qCritical() << "Schematic::throughAllComps" << message;
-          return false;
-      }
-      d->DocName = s;
-      d->isVerilog = isVerilog;
-      d->isAnalog = isAnalog;
-      d->creatingLib = creatingLib;
-      r = d->createSubNetlist(stream, countInit, Collect, ErrText, NumPorts);
-      if (r)
-      {
-        i = 0;
-        // save in/out signal types of subcircuit
-        foreach(Port *pp, pc->Ports)
-        {
-            //if(i>=d->PortTypes.count())break;
-            pp->Type = d->PortTypes[i];
-            pp->Connection->DType = pp->Type;
-            i++;
-        }
-        sub.PortTypes = d->PortTypes;
-        FileList.insert(f, sub);
-      }
-      delete d;
+      r = netlistSubcircuit(f, s, stream, countInit, Collect, ErrText,
+                            NumPorts, sub.PortTypes);
       if(!r)
       {
         return false;
       }
+
+      i = 0;
+      // save in/out signal types of subcircuit
+      foreach(Port *pp, pc->Ports)
+      {
+          pp->Type = sub.PortTypes[i];
+          pp->Connection->DType = pp->Type;
+          i++;
+      }
+      FileList.insert(f, sub);
       continue;
     } // if(pc->Model == "Sub")
 
@@ -1415,6 +1471,141 @@ bool Schematic::throughAllComps(QTextStream *stream, int& countInit,
   return true;
 }
 
+// ---------------------------------------------------
+// Returns the key of a subcircuit in "SubNetlists". The netlist depends
+// on the file, on the name (it gives the subcircuit type), on the kind
+// of simulation and on the number of ports of a truth table run.
+QString Schematic::subNetlistKey(const QString& File, const QString& Name,
+                                 int NumPorts) const
+{
+  QString Mode = isAnalog ? "A" : (isVerilog ? "V" : "D");
+  return File + "\n" + Name + "\n" + Mode + QString::number(NumPorts);
+}
+
+// ---------------------------------------------------
+// Checks whether the netlist stored for "Key" is still valid, i.e. the
+// files of it and of all its subcircuits are unchanged. "Visited" stops
+// recursive subcircuits.
+bool Schematic::isSubNetlistCurrent(const QString& Key, int NumPorts,
+                                    QSet<QString>& Visited) const
+{
+  if(Visited.contains(Key))
+    return true;
+  Visited.insert(Key);
+
+  SubNetlistMap::const_iterator it = SubNetlists.constFind(Key);
+  if(it == SubNetlists.constEnd())
+    return false;
+  const SubNetlist& Sub = it.value();
+  QFileInfo Info(Sub.File);
+  if(Info.lastModified() != Sub.Modified || Info.size() != Sub.Size)
+    return false;
+
+  foreach(const SubUse& Use, Sub.Uses) {
+    QString k = subNetlistKey(Use.File, Use.Name, NumPorts);
+    if(!isSubNetlistCurrent(k, NumPorts, Visited))
+      return false;
+    // port types of digital subcircuits go into the netlist
+    if(SubNetlists.value(k).PortTypes != Use.PortTypes)
+      return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------
+// Writes the subcircuit schematic "File" (called "Name") and the
+// subcircuits it contains into "stream", as far as they are not yet
+// part of the netlist. A netlist created by a former run is used again
+// if it is still valid. The port types of the subcircuit are returned
+// in "Types".
+bool Schematic::netlistSubcircuit(const QString& File, const QString& Name,
+                   QTextStream *stream, int& countInit, QStringList& Collect,
+                   QPlainTextEdit *ErrText, int NumPorts, QStringList& Types)
+{
+  QString Key = subNetlistKey(File, Name, NumPorts);
+  QSet<QString> Visited;
+  if(!creatingLib && isSubNetlistCurrent(Key, NumPorts, Visited)) {
+    SubNetlist Sub = SubNetlists.value(Key);
+    foreach(const SubUse& Use, Sub.Uses) {
+      if(FileList.contains(Use.File))
+        continue;   // insert each subcircuit just one time
+      SubFile sub = SubFile("SCH", Use.File);
+      FileList.insert(Use.File, sub);
+      if(!netlistSubcircuit(Use.File, Use.Name, stream, countInit, Collect,
+                            ErrText, NumPorts, sub.PortTypes))
+        return false;
+      FileList.insert(Use.File, sub);
+    }
+    (*stream) << Sub.Netlist;
+    Types = Sub.PortTypes;
+    return true;
+  }
+
+  Schematic *d = new Schematic(0, File);
+  if(!d->loadDocument())      // load document if possible
+  {
+      delete d;
+      /// \todo implement error/warning message dispatcher for GUI and CLI modes.
+      QString message = QObject::tr("ERROR: Cannot load subcircuit \"%1\".").arg(Name);
+      if (QucsMain) // GUI is running
+        ErrText->appendPlainText(message);
+      else // command line
+        qCritical() << "Schematic::throughAllComps" << message;
+      return false;
+  }
+  d->DocName = Name;
+  d->isVerilog = isVerilog;
+  d->isAnalog = isAnalog;
+  d->creatingLib = creatingLib;
+
+  // Messages and node sets are not part of the stored netlist, so
+  // subcircuits creating them are netlisted on every run.
+  int Messages = ErrText->document()->characterCount();
+  int NodeSets = Collect.count();
+
+  // the own definition is kept apart from the ones of its subcircuits
+  QString Netlist;
+  QTextStream NetStream(&Netlist);
+  if(!d->createSubNetlist(stream, &NetStream, countInit, Collect, ErrText,
+                          NumPorts)) {
+    delete d;
+    return false;
+  }
+  NetStream.flush();
+  (*stream) << Netlist;
+  Types = d->PortTypes;
+
+  bool Keep = !creatingLib && Collect.count() == NodeSets
+           && ErrText->document()->characterCount() == Messages;
+  SubNetlist Sub;
+  Sub.File = File;
+  Sub.Modified = QFileInfo(File).lastModified();
+  Sub.Size = QFileInfo(File).size();
+  Sub.Netlist = Netlist;
+  Sub.PortTypes = Types;
+  for(Component *pc = d->DocComps.first(); pc != 0; pc = d->DocComps.next()) {
+    if(pc->isActive != COMP_IS_ACTIVE) continue;
+    if(pc->Model == "Sub") {
+      SubUse Use;
+      Use.File = pc->getSubcircuitFile();
+      Use.Name = pc->Props.first()->Value;
+      Use.PortTypes = FileList.value(Use.File).PortTypes;
+      Sub.Uses.append(Use);
+    }
+    // other file based components are not tracked
+    else if(pc->Model == "SPICE" || pc->Model == "VHDL" ||
+            pc->Model == "Verilog" || dynamic_cast<LibComp*>(pc))
+      Keep = false;
+  }
+  delete d;
+
+  if(Keep)
+    SubNetlists.insert(Key, Sub);
+  else
+    SubNetlists.remove(Key);
+  return true;
+}
+
 // ---------------------------------------------------
 // Follows the wire lines in order to determine the node names for
 // each component. Output into "stream", NodeSets are collected in
@@ -1769,9 +1960,11 @@ int NumPorts)
   }
 }
 // ---------------------------------------------------
-// Write the netlist as subcircuit to the text stream 'stream'.
-bool Schematic::createSubNetlist(QTextStream *stream, int& countInit,
-                     QStringList& Collect, QPlainTextEdit *ErrText, int NumPorts)
+// Write the netlist as subcircuit to the text stream 'SubStream', the
+// subcircuits used by it go into 'stream'.
+bool Schematic::createSubNetlist(QTextStream *stream, QTextStream *SubStream,
+                     int& countInit, QStringList& Collect,
+                     QPlainTextEdit *ErrText, int NumPorts)
 {
 //  int Collect_count = Collect.count();   // position for this subcircuit
 
@@ -1790,7 +1983,7 @@ bool Schematic::createSubNetlist(QTextStream *stream, int& countInit,
       else it++;*/
 
   // Emit subcircuit components
-  createSubNetlistPlain(stream, ErrText, NumPorts);
+  createSubNetlistPlain(SubStream, ErrText, NumPorts);
 
   Signals.clear();  // was filled in "giveNodeNames()"
   return true;
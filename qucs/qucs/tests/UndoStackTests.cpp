@@ -0,0 +1,111 @@
+#include "undostack.h"
+
+#include <QTest>
+
+// the stack uses elements only as keys, so they are never dereferenced
+#define ELEMENT(n)  ((Element*)quintptr(8*(n)))
+
+class UndoStackTests : public QObject {
+  Q_OBJECT
+private slots:
+  void testUndoRedo() {
+
+    UndoStack stack;
+    stack.update(ELEMENT(1), UndoStack::CompRecord, "<R 1>");
+    stack.update(ELEMENT(2), UndoStack::CompRecord, "<C 2>");
+    stack.push(' ');     // first step holds no changes
+    stack.setUnchanged();
+
+    // insert a component
+    stack.update(ELEMENT(3), UndoStack::CompRecord, "<L 3>");
+    stack.update(ELEMENT(1), UndoStack::CompRecord, "<R 1>");  // unchanged
+    stack.push('*');
+
+    // move a component and replace another one by a wire
+    stack.update(ELEMENT(1), UndoStack::CompRecord, "<R 5>");
+    stack.update(ELEMENT(2), UndoStack::CompRecord, QString());
+    stack.update(ELEMENT(4), UndoStack::WireRecord, "<100 0 200 0>");
+    stack.push('*');
+    QCOMPARE(stack.size(), 3);
+    QCOMPARE(stack.find(UndoStack::CompRecord, "<R 5>"), ELEMENT(1));
+    QVERIFY(!stack.find(UndoStack::CompRecord, "<C 2>"));
+
+    QVERIFY(stack.undo());
+    QCOMPARE(stack.changes().size(), 3);
+    const UndoStack::Change& c = stack.changes().first();   // reversed
+    QCOMPARE(c.Kind, int(UndoStack::WireRecord));
+    QCOMPARE(c.Before, QString("<100 0 200 0>"));
+    QVERIFY(c.After.isEmpty());
+    QCOMPARE(stack.changes().last().Before, QString("<R 5>"));
+    QCOMPARE(stack.changes().last().After, QString("<R 1>"));
+
+    QVERIFY(stack.undo());
+    QCOMPARE(stack.changes().size(), 1);
+    QCOMPARE(stack.changes().first().Before, QString("<L 3>"));
+    QVERIFY(stack.isUnchanged());
+    QVERIFY(!stack.undo());
+
+    QVERIFY(stack.redo());
+    QCOMPARE(stack.changes().first().After, QString("<L 3>"));
+    QVERIFY(stack.redo());
+    QCOMPARE(stack.changes().size(), 3);
+    QVERIFY(!stack.redo());
+
+    // new step discards the redo part
+    stack.undo();
+    stack.discard();   // changes applied by the caller
+    stack.update(ELEMENT(3), UndoStack::CompRecord, QString());
+    stack.push('*');
+    QCOMPARE(stack.size(), 3);
+    QVERIFY(!stack.canRedo());
+  }
+
+  void testMergeMarker() {
+
+    UndoStack stack;
+    stack.update(ELEMENT(1), UndoStack::DiagRecord, "<Rect 0>");
+    stack.push(' ');
+
+    // subsequent marker moves become one step
+    for(int i = 1; i <= 5; i++) {
+      stack.update(ELEMENT(1), UndoStack::DiagRecord,
+                   "<Rect " + QString::number(i) + ">");
+      stack.push('m');
+    }
+    QCOMPARE(stack.size(), 2);
+    QCOMPARE(stack.op(), QChar('m'));
+    QVERIFY(stack.undo());
+    QCOMPARE(stack.changes().size(), 1);
+    QCOMPARE(stack.changes().first().Before, QString("<Rect 5>"));
+    QCOMPARE(stack.changes().first().After, QString("<Rect 0>"));
+    stack.discard();
+
+    // moving back to the former state leaves no change
+    stack.redo();
+    stack.discard();
+    stack.update(ELEMENT(1), UndoStack::DiagRecord, "<Rect 0>");
+    stack.push('m');
+    QCOMPARE(stack.size(), 2);
+    QVERIFY(stack.undo());
+    QVERIFY(stack.changes().isEmpty());
+  }
+
+  void testLimit() {
+
+    UndoStack stack;
+    stack.push(' ');
+    for(int i = 0; i < 10; i++) {
+      stack.update(ELEMENT(1), UndoStack::CompRecord,
+                   "<R " + QString::number(i) + ">");
+      stack.push('*');
+    }
+    stack.limit(4);
+    QCOMPARE(stack.size(), 4);
+    QCOMPARE(stack.index(), 3);
+    while(stack.undo()) ;
+    QCOMPARE(stack.changes().first().After, QString("<R 6>"));
+  }
+};
+
+QTEST_MAIN(UndoStackTests)
+#include "UndoStackTests.moc"
@@ -0,0 +1,204 @@
+/***************************************************************************
+                              undostack.cpp
+                             ---------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "undostack.h"
+
+
+UndoStack::UndoStack()
+{
+  Idx = -1;
+  Bytes = 0;
+}
+
+UndoStack::~UndoStack()
+{
+}
+
+// -------------------------------------------------------------
+// Forgets the history and the records of all elements.
+void UndoStack::clear()
+{
+  Steps.clear();
+  Idx = -1;
+  Bytes = 0;
+  Pending.clear();
+  Apply.clear();
+  for(int i = 0; i < Records; i++) {
+    Record[i].clear();
+    Owner[i].clear();
+  }
+}
+
+// -------------------------------------------------------------
+// Memory needed by a change.
+int UndoStack::changeSize(const Change& c)
+{
+  return (c.Before.length() + c.After.length()) * sizeof(QChar)
+         + sizeof(Change);
+}
+
+// -------------------------------------------------------------
+// Appends a new step with the changes collected since the last one
+// behind the current step. All steps after the current one are
+// discarded (no redo anymore). Subsequent steps with the "Op" 'm' (move
+// marker) are merged into one.
+void UndoStack::push(QChar Op)
+{
+  while(Steps.size() > Idx+1) {
+    Bytes -= Steps.last().Bytes;
+    Steps.removeLast();
+  }
+
+  if(Op == 'm') if(Idx > 0) if(Steps.last().Op == Op) {
+    merge(Steps.last());
+    Steps.last().Unchanged = false;
+    Pending.clear();
+    return;
+  }
+
+  Step New;
+  New.Op = Op;
+  New.Unchanged = false;
+  New.Bytes = 0;
+  if(!Steps.isEmpty()) {   // first step needs no changes
+    New.Changes = Pending;
+    foreach(const Change& c, Pending)
+      New.Bytes += changeSize(c);
+  }
+  Pending.clear();
+
+  Bytes += New.Bytes;
+  Steps.append(New);
+  Idx = Steps.size()-1;
+}
+
+// -------------------------------------------------------------
+// Adds the pending changes to the step "s". A change of an element
+// already changed by "s" is joined with that change.
+void UndoStack::merge(Step& s)
+{
+  foreach(const Change& c, Pending) {
+    int i;
+    for(i = s.Changes.size()-1; i >= 0; i--) {
+      const Change& p = s.Changes.at(i);
+      if(p.Kind == c.Kind) if(!p.After.isEmpty()) if(p.After == c.Before)
+        break;
+    }
+
+    if(i < 0) {
+      s.Changes.append(c);
+      s.Bytes += changeSize(c);
+      Bytes += changeSize(c);
+      continue;
+    }
+
+    Change& p = s.Changes[i];
+    s.Bytes -= changeSize(p);
+    Bytes -= changeSize(p);
+    p.After = c.After;
+    if(p.After == p.Before) {   // back at its former state
+      s.Changes.removeAt(i);
+      continue;
+    }
+    s.Bytes += changeSize(p);
+    Bytes += changeSize(p);
+  }
+}
+
+// -------------------------------------------------------------
+// Steps back. The changes of the current step are handed out reversed.
+bool UndoStack::undo()
+{
+  if(!canUndo()) return false;
+
+  Apply.clear();
+  const QList<Change>& List = Steps.at(Idx--).Changes;
+  for(int i = List.size()-1; i >= 0; i--) {
+    Change c = List.at(i);
+    c.Before.swap(c.After);
+    Apply.append(c);
+  }
+  return true;
+}
+
+// -------------------------------------------------------------
+bool UndoStack::redo()
+{
+  if(!canRedo()) return false;
+  Apply = Steps.at(++Idx).Changes;
+  return true;
+}
+
+// -------------------------------------------------------------
+// Removes the oldest steps until at most "Max" are left and the changes
+// fit into UNDO_MAX_BYTES. The current step is never removed.
+void UndoStack::limit(unsigned int Max)
+{
+  while(Idx > 0 &&
+        (static_cast<unsigned int>(Steps.size()) > Max || Bytes > UNDO_MAX_BYTES))
+    dropFirst();
+}
+
+// -------------------------------------------------------------
+// The second oldest step becomes the first one, so it needs no changes
+// anymore.
+void UndoStack::dropFirst()
+{
+  Bytes -= Steps.first().Bytes;
+  Steps.removeFirst();
+  Step& First = Steps.first();
+  Bytes -= First.Bytes;
+  First.Changes.clear();
+  First.Bytes = 0;
+  Idx--;
+}
+
+// -------------------------------------------------------------
+// Marks the current step to be the state of the saved file.
+void UndoStack::setUnchanged()
+{
+  for(int i = 0; i < Steps.size(); i++)
+    Steps[i].Unchanged = (i == Idx);
+}
+
+// -------------------------------------------------------------
+// Sets the record of the element "pe" of the given kind. An empty record
+// means that the element does not exist (anymore). A differing record is
+// collected for the next step.
+void UndoStack::update(Element *pe, int Kind, const QString& s)
+{
+  QString Old = Record[Kind].value(pe);
+  if(Old == s) return;
+
+  Change c;
+  c.Kind = Kind;
+  c.Before = Old;
+  c.After = s;
+  Pending.append(c);
+
+  if(!Old.isEmpty())  Owner[Kind].remove(Old, pe);
+  if(s.isEmpty())  Record[Kind].remove(pe);
+  else {
+    Record[Kind].insert(pe, s);
+    Owner[Kind].insert(s, pe);
+  }
+}
+
+// -------------------------------------------------------------
+// Returns an element with the given record (or 0).
+Element* UndoStack::find(int Kind, const QString& s) const
+{
+  return Owner[Kind].value(s, 0);
+}
@@ -0,0 +1,104 @@
+/***************************************************************************
+                               undostack.h
+                              -------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Qucs Team
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef UNDOSTACK_H
+#define UNDOSTACK_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMultiHash>
+
+class Element;
+
+// Upper limit for the text held by the changes of one undo stack.
+#define UNDO_MAX_BYTES  (16 << 20)
+
+
+/*!
+ * \brief Undo history of a schematic as a chain of element changes.
+ *
+ * Every element is represented by its record, i.e. its line(s) in the
+ * schematic file. A step holds the elements inserted, deleted, moved or
+ * edited by the action it was created for, each one with its record
+ * before and after. Undo and redo hand out these changes to be applied
+ * on the element lists.
+ *
+ * The stack also keeps the records of the current state. update() is
+ * called for every element that might have been changed, the differing
+ * records are collected for the next step created by push().
+ */
+class UndoStack {
+public:
+  // kinds of records
+  enum { CompRecord, WireRecord, LabelRecord, DiagRecord, PaintRecord,
+         Records };
+
+  struct Change {
+    int Kind;
+    QString Before, After;   // record of the element, empty if not existing
+  };
+
+  UndoStack();
+ ~UndoStack();
+
+  void clear();
+  void push(QChar);
+  bool undo();
+  bool redo();
+  void limit(unsigned int);
+
+  int  index() const { return Idx; }
+  int  size() const { return Steps.size(); }
+  bool canUndo() const { return Idx > 0; }
+  bool canRedo() const { return Idx < Steps.size()-1; }
+
+  QChar op() const { return Steps.at(Idx).Op; }
+  bool isUnchanged() const { return Steps.at(Idx).Unchanged; }
+  void setUnchanged();
+
+  // changes to be applied after undo() or redo()
+  const QList<Change>& changes() const { return Apply; }
+
+  void update(Element*, int, const QString&);
+  void discard() { Pending.clear(); }
+  Element* find(int, const QString&) const;
+  QList<Element*> elements(int Kind) const { return Record[Kind].keys(); }
+
+private:
+  struct Step {
+    QChar Op;
+    bool Unchanged;
+    QList<Change> Changes;  // from the previous step to this one
+    int Bytes;
+  };
+
+  static int changeSize(const Change&);
+  void merge(Step&);
+  void dropFirst();
+
+  QList<Step> Steps;
+  int Idx;
+  int Bytes;
+
+  QList<Change> Pending;  // changes not yet in a step
+  QList<Change> Apply;
+
+  QHash<Element*, QString> Record[Records];
+  QMultiHash<QString, Element*> Owner[Records];  // elements of a record
+};
+
+#endif
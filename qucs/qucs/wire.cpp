@@ -206,3 +206,74 @@ bool Wire::load(const QString& _s)
 
   return true;
 }
+
+
+// *******************************************************************
+// *****                       WireList                          *****
+// *******************************************************************
+
+// -------------------------------------------------------------
+// Returns all wires whose row or column contains the given point. The
+// point itself does not need to lie on them.
+QList<Wire*> WireList::crossing(int x, int y) const
+{
+  return Columns.values(x) + Rows.values(y);
+}
+
+// -------------------------------------------------------------
+// Returns a wire that can be selected at the given position (or 0).
+Wire* WireList::findNear(int x, int y) const
+{
+  for(int z = -5; z <= 5; z++) {
+    foreach(Wire *pw, Rows.values(y+z))
+      if(pw->getSelected(x, y)) return pw;
+    foreach(Wire *pw, Columns.values(x+z))
+      if(pw->getSelected(x, y)) return pw;
+  }
+  return 0;
+}
+
+// -------------------------------------------------------------
+void WireList::unregister(Wire *pw)
+{
+  if(Horizontal.take(pw)) Rows.remove(pw->y1, pw);
+  else Columns.remove(pw->x1, pw);
+  Changes++;
+}
+
+// -------------------------------------------------------------
+Wire* WireList::take()
+{
+  Wire *pw = ElementList<Wire>::take();
+  if(pw) unregister(pw);
+  return pw;
+}
+
+// -------------------------------------------------------------
+Wire* WireList::take(uint index)
+{
+  Wire *pw = ElementList<Wire>::take(index);
+  if(pw) unregister(pw);
+  return pw;
+}
+
+// -------------------------------------------------------------
+// Called by the list for every wire being inserted.
+Q3PtrCollection::Item WireList::newItem(Item d)
+{
+  Wire *pw = (Wire*)d;
+  Horizontal.insert(pw, pw->isHorizontal());
+  if(pw->isHorizontal()) Rows.insert(pw->y1, pw);
+  else Columns.insert(pw->x1, pw);
+  Changes++;
+  return ElementList<Wire>::newItem(d);
+}
+
+// -------------------------------------------------------------
+// Called by the list for every wire being removed (or cleared).
+void WireList::deleteItem(Item d)
+{
+  Wire *pw = (Wire*)d;
+  unregister(pw);
+  ElementList<Wire>::deleteItem(d);   // deletes the wire if auto delete
+}
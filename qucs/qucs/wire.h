@@ -23,6 +23,9 @@
 #include "components/component.h"    // because of struct Port
 #include "wirelabel.h"
 
+#include <Q3PtrList>
+#include <QMultiHash>
+
 class QPainter;
 class QString;
 
@@ -47,4 +50,27 @@ public:
   bool    isHorizontal();
 };
 
+// List of schematic wires that additionally sorts the wires by the row
+// (horizontal wires) or column (vertical wires) they lie on. While being
+// listed a wire may change its length, but never its row or column.
+class WireList : public ElementList<Wire> {
+public:
+  WireList() { Changes = 0; }
+  uint changes() const { return Changes; }  // counts insertions and removals
+  QList<Wire*> crossing(int, int) const;
+  Wire* findNear(int, int) const;
+  Wire* take();
+  Wire* take(uint);
+
+protected:
+  Item newItem(Item);
+  void deleteItem(Item);
+
+private:
+  void unregister(Wire*);
+  QMultiHash<int, Wire*> Rows, Columns;
+  QHash<Wire*, bool> Horizontal;  // orientation when inserted
+  uint Changes;
+};
+
 #endif